@@ -78,6 +78,7 @@ elseif OS == "linux" then
 		"Cg",
 		"CgGL",
 		"freetype",
+		"pthread",
 	}
 	
 	package.buildoptions = { "-rdynamic `sdl-config --cflags` `freetype-config --cflags` `ode-config --cflags`" }
@@ -87,3 +88,244 @@ else
 	error("Unsupported Operating System: " .. OS)
 end
 
+
+
+-- Data Cooker ---------------------------------------------------------------
+
+package = newpackage()
+package.name = "Cooker"
+package.kind = "exe"
+package.language = "c++"
+
+package.files = {
+	"tools/cooker/Cooker.cpp",
+	"tools/common/TextureFactoryHeadless.cpp",
+	"src/AnimationController.cpp",
+	"src/AnimationSequence.cpp",
+	"src/AssetCache.cpp",
+	"src/BoundingVolume.cpp",
+	"src/BufferPool.cpp",
+	"src/Core.cpp",
+	"src/File.cpp",
+	"src/FileFuncs.cpp",
+	"src/FileMapping.cpp",
+	"src/FileName.cpp",
+	"src/FileText.cpp",
+	"src/KeyFrame.cpp",
+	"src/logger.cpp",
+	"src/mat3.cpp",
+	"src/mat4.cpp",
+	"src/Material.cpp",
+	"src/Mesh.cpp",
+	"src/MeshBuilder.cpp",
+	"src/ModelBinary.cpp",
+	"src/ModelLoader.cpp",
+	"src/ModelLoaderMD2.cpp",
+	"src/ModelLoaderMD3.cpp",
+	"src/ModelLoaderMulti.cpp",
+	"src/ModelLoaderOBJ.cpp",
+	"src/ModelLoaderSingle.cpp",
+	"src/myassert.cpp",
+	"src/PackFile.cpp",
+	"src/PropertyBag.cpp",
+	"src/PropertyBagBinary.cpp",
+	"src/PropertyBagParser.cpp",
+	"src/PropertyBagStorage.cpp",
+	"src/RangeAllocator.cpp",
+	"src/ResourceBuffer.cpp",
+	"src/StackWalker.cpp",
+	"src/Thread.cpp",
+	"src/tstring.cpp",
+	"src/VertexBlend.cpp",
+	"src/VertexFormat.cpp",
+	"src/VirtualFileSystem.cpp"
+}
+
+if OS == "windows" then
+	package.includepaths = {
+		"src/",
+		"external/windows/boost/include/",
+		"external/windows/glew/include/"
+	}
+else
+	package.includepaths = {
+		"src/"
+	}
+	
+	package.links = {
+		"pthread"
+	}
+end
+
+
+
+-- Data Packer ---------------------------------------------------------------
+
+package = newpackage()
+package.name = "Packer"
+package.kind = "exe"
+package.language = "c++"
+
+package.files = {
+	"tools/packer/Packer.cpp",
+	"src/Core.cpp",
+	"src/File.cpp",
+	"src/FileFuncs.cpp",
+	"src/FileMapping.cpp",
+	"src/FileName.cpp",
+	"src/logger.cpp",
+	"src/myassert.cpp",
+	"src/PackFile.cpp",
+	"src/StackWalker.cpp",
+	"src/Thread.cpp",
+	"src/tstring.cpp",
+	"src/VirtualFileSystem.cpp"
+}
+
+if OS == "windows" then
+	package.includepaths = {
+		"src/",
+		"external/windows/boost/include/"
+	}
+else
+	package.includepaths = {
+		"src/"
+	}
+	
+	package.links = {
+		"pthread"
+	}
+end
+
+
+
+-- Headless Tests ------------------------------------------------------------
+
+package = newpackage()
+package.name = "Tests"
+package.kind = "exe"
+package.language = "c++"
+
+package.files = {
+	matchfiles("tools/tests/*.h", "tools/tests/*.cpp"),
+	"tools/common/TextureFactoryHeadless.cpp",
+	"src/AnimationController.cpp",
+	"src/AnimationSequence.cpp",
+	"src/AssetCache.cpp",
+	"src/BoundingVolume.cpp",
+	"src/BufferPool.cpp",
+	"src/ComponentSchema.cpp",
+	"src/Core.cpp",
+	"src/File.cpp",
+	"src/FileFuncs.cpp",
+	"src/FileMapping.cpp",
+	"src/FileName.cpp",
+	"src/FileText.cpp",
+	"src/KeyFrame.cpp",
+	"src/logger.cpp",
+	"src/mat3.cpp",
+	"src/mat4.cpp",
+	"src/Material.cpp",
+	"src/Mesh.cpp",
+	"src/MeshBuilder.cpp",
+	"src/ModelBinary.cpp",
+	"src/ModelLoader.cpp",
+	"src/ModelLoaderMD3.cpp",
+	"src/ModelLoaderSingle.cpp",
+	"src/myassert.cpp",
+	"src/PackFile.cpp",
+	"src/PropertyBag.cpp",
+	"src/PropertyBagBinary.cpp",
+	"src/PropertyBagParser.cpp",
+	"src/PropertyBagStorage.cpp",
+	"src/RangeAllocator.cpp",
+	"src/ResourceBuffer.cpp",
+	"src/StackWalker.cpp",
+	"src/Thread.cpp",
+	"src/tstring.cpp",
+	"src/VertexBlend.cpp",
+	"src/VertexFormat.cpp",
+	"src/VirtualFileSystem.cpp"
+}
+
+if OS == "windows" then
+	package.includepaths = {
+		"src/",
+		"external/windows/boost/include/",
+		"external/windows/glew/include/"
+	}
+else
+	package.includepaths = {
+		"src/"
+	}
+	
+	package.links = {
+		"pthread"
+	}
+end
+
+
+
+-- Headless Benchmarks -------------------------------------------------------
+
+package = newpackage()
+package.name = "Benchmarks"
+package.kind = "exe"
+package.language = "c++"
+
+package.files = {
+	matchfiles("tools/benchmarks/*.h", "tools/benchmarks/*.cpp"),
+	"tools/common/TextureFactoryHeadless.cpp",
+	"src/AnimationController.cpp",
+	"src/AnimationSequence.cpp",
+	"src/AssetCache.cpp",
+	"src/BoundingVolume.cpp",
+	"src/BufferPool.cpp",
+	"src/Core.cpp",
+	"src/File.cpp",
+	"src/FileFuncs.cpp",
+	"src/FileMapping.cpp",
+	"src/FileName.cpp",
+	"src/FileText.cpp",
+	"src/KeyFrame.cpp",
+	"src/logger.cpp",
+	"src/mat3.cpp",
+	"src/mat4.cpp",
+	"src/Material.cpp",
+	"src/Mesh.cpp",
+	"src/MeshBuilder.cpp",
+	"src/ModelBinary.cpp",
+	"src/ModelLoader.cpp",
+	"src/ModelLoaderMD3.cpp",
+	"src/ModelLoaderSingle.cpp",
+	"src/myassert.cpp",
+	"src/PackFile.cpp",
+	"src/PropertyBag.cpp",
+	"src/PropertyBagBinary.cpp",
+	"src/PropertyBagParser.cpp",
+	"src/PropertyBagStorage.cpp",
+	"src/RangeAllocator.cpp",
+	"src/ResourceBuffer.cpp",
+	"src/StackWalker.cpp",
+	"src/Thread.cpp",
+	"src/tstring.cpp",
+	"src/VertexBlend.cpp",
+	"src/VertexFormat.cpp",
+	"src/VirtualFileSystem.cpp"
+}
+
+if OS == "windows" then
+	package.includepaths = {
+		"src/",
+		"external/windows/boost/include/",
+		"external/windows/glew/include/"
+	}
+else
+	package.includepaths = {
+		"src/"
+	}
+	
+	package.links = {
+		"pthread"
+	}
+end
@@ -0,0 +1,15 @@
+#ifndef ACTION_SLEEP_H
+#define ACTION_SLEEP_H
+
+#include "EventHandler.h"
+
+/**
+Message to notify components that the actor is going to sleep.
+A sleeping actor is not updated until it is woken again.
+*/
+class ActionSleep : public Action {
+public:
+	ActionSleep() { /* Do Nothing */ }
+};
+
+#endif
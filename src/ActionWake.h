@@ -0,0 +1,15 @@
+#ifndef ACTION_WAKE_H
+#define ACTION_WAKE_H
+
+#include "EventHandler.h"
+
+/**
+Message to wake a sleeping actor, or to keep an awake actor from falling
+asleep for a while longer.
+*/
+class ActionWake : public Action {
+public:
+	ActionWake() { /* Do Nothing */ }
+};
+
+#endif
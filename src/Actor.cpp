@@ -12,6 +12,8 @@ Actor::Actor(const ActorID uid)
 		: ScopedEventHandler(uid, 0) {
 	reset();
 	REGISTER_HANDLER(Actor::handleActionDeleteActor);
+	REGISTER_HANDLER(Actor::handleActionWake);
+	REGISTER_HANDLER(Actor::handleEventPositionUpdate);
 }
 
 Actor::~Actor() {
@@ -20,15 +22,137 @@ Actor::~Actor() {
 
 void Actor::reset() {
 	zombie = false;
+	templateFile = FileName();
+	asleep = false;
+	updating = false;
+	idleFrames = 0;
+	lastReportedPosition.zero();
+	positionReported = false;
+	world = 0;
 	components.clear();
+	routes.clear();
 	ScopedEventHandler::clear();
 }
 
 void Actor::update(float milliseconds) {
+	idleFrames++;
+	
+	// Messages the actor sends to itself while updating are not stimuli
+	updating = true;
+	
 	for (ComponentsList::const_iterator i = components.begin();
 	     i != components.end(); ++i) {
 		(*i)->update(milliseconds);
 	}
+	
+	updating = false;
+}
+
+void Actor::updateAsleep(float milliseconds) {
+	updating = true;
+	
+	for (ComponentsList::const_iterator i = components.begin();
+	     i != components.end(); ++i) {
+		(*i)->updateAsleep(milliseconds);
+	}
+	
+	updating = false;
+}
+
+void Actor::recvMessage(const Message *message) {
+	ASSERT(message, "Null parameter: message");
+	
+	const MessageTypeID type = message->getTypeID();
+	
+	if (!updating && type < routes.size() && routes[type].stimulus) {
+		wake();
+	}
+	
+	dispatch(message);
+}
+
+void Actor::dispatch(const Message *message) {
+	ScopedEventHandlerSubscriber::recvMessage(message);
+	
+	const MessageTypeID type = message->getTypeID();
+	
+	if (type < routes.size()) {
+		const vector<Component*> &handlers = routes[type].components;
+		
+		for (vector<Component*>::const_iterator i = handlers.begin();
+		     i != handlers.end(); ++i) {
+			(*i)->recvMessage(message);
+		}
+	}
+}
+
+void Actor::buildMessageRoutes() {
+	routes.clear();
+	
+	vector<MessageTypeID> types;
+	
+	for (ComponentsList::const_iterator i = components.begin();
+	     i != components.end(); ++i) {
+		types.clear();
+		(*i)->getHandledTypes(types);
+		
+		for (vector<MessageTypeID>::const_iterator j = types.begin();
+		     j != types.end(); ++j) {
+			if (*j >= routes.size()) {
+				routes.resize(*j + 1);
+			}
+			
+			routes[*j].components.push_back(i->get());
+			routes[*j].stimulus = true;
+		}
+	}
+	
+	// Bookkeeping messages are handled by every actor and wake none of them
+	const MessageTypeID bookkeeping[] = {
+		getMessageTypeID(typeid(ActionSleep)),
+		getMessageTypeID(typeid(ActionDeleteActor)),
+		getMessageTypeID(typeid(ActionDebugEnable)),
+		getMessageTypeID(typeid(ActionDebugDisable))
+	};
+	
+	for (size_t i = 0; i < sizeof(bookkeeping)/sizeof(bookkeeping[0]); ++i) {
+		if (bookkeeping[i] < routes.size()) {
+			routes[bookkeeping[i]].stimulus = false;
+		}
+	}
+}
+
+void Actor::sleep() {
+	if (!asleep) {
+		asleep = true;
+		
+		ActionSleep m;
+		dispatch(&m);
+	}
+}
+
+void Actor::wake() {
+	idleFrames = 0;
+	
+	if (asleep) {
+		asleep = false;
+		
+		ActionWake m;
+		dispatch(&m);
+	}
+}
+
+void Actor::handleActionWake(const ActionWake *) {
+	wake();
+}
+
+void Actor::handleEventPositionUpdate(const EventPositionUpdate *event) {
+	lastReportedPosition = event->position;
+	positionReported = true;
+	
+	if (world) {
+		world->getSpatialIndex().update(getUID(), lastReportedPosition);
+	}
 }
 
 void Actor::load(const ComponentDataSet &componentsData,
@@ -36,37 +160,39 @@ void Actor::load(const ComponentDataSet &componentsData,
                  const vec3 &initialVelocity,
                  World*const world) {
 	reset();
+	this->world = world;
 	
 	// List of components along-side the data they will be loading
-	vector<tuple<shared_ptr<Component>, PropertyBag> > componentsWithData;
+	vector<tuple<shared_ptr<Component>, const ComponentDataSet::Entry*> >
+	componentsWithData;
 	
 	// Create all components before loading component data
 	for (ComponentDataSet::const_iterator i = componentsData.begin();
 	     i != componentsData.end(); ++i) {
 		shared_ptr<Component> component
-		= Component::createComponent(i->first,
+		= Component::createComponent(i->name,
 		                             ScopedEventHandler::genName(),
 		                             this);
 		                             
 		if (component) {
 			components.push_back(component);
-			componentsWithData.push_back(make_tuple(component, i->second));
+			componentsWithData.push_back(make_tuple(component, &(*i)));
 			ScopedEventHandler::registerSubscriber(component.get());
 		}
 	}
 	
+	buildMessageRoutes();
+	
 	{
 		MessagePassWorld m(world);
 		recvMessage(&m);
 	}
 	
 	// Have components load data
-	for (vector<tuple<shared_ptr<Component>, PropertyBag> >::iterator
+	for (vector<tuple<shared_ptr<Component>, const ComponentDataSet::Entry*> >::iterator
 	     i = componentsWithData.begin();
 	     i != componentsWithData.end(); ++i) {
-		shared_ptr<Component> &component = i->get<0>();
-		const PropertyBag &data = i->get<1>();
-		component->load(data);
+		loadComponent(*i->get<0>(), *i->get<1>());
 	}
 	
 	// Declare the object's initial position
@@ -74,6 +200,51 @@ void Actor::load(const ComponentDataSet &componentsData,
 	
 }
 
+void Actor::loadComponent(Component &component,
+                          const ComponentDataSet::Entry &entry) {
+	if (entry.compiled) {
+		component.load(*entry.compiled);
+	} else {
+		component.load(entry.data);
+	}
+}
+
+void Actor::deactivate() {
+	for (ComponentsList::const_iterator i = components.begin();
+	     i != components.end(); ++i) {
+		(*i)->resetMembers();
+	}
+}
+
+void Actor::reactivate(const ComponentDataSet &componentsData,
+                       const vec3 &initialPosition,
+                       const vec3 &initialVelocity,
+                       World*const world) {
+	zombie = false;
+	asleep = false;
+	idleFrames = 0;
+	positionReported = false;
+	this->world = world;
+	
+	{
+		MessagePassWorld m(world);
+		recvMessage(&m);
+	}
+	
+	// Components were created in the same order as the template data
+	ASSERT(components.size() == componentsData.size(),
+	       "Recycled actor does not match its template");
+	
+	ComponentsList::iterator component = components.begin();
+	
+	for (ComponentDataSet::const_iterator i = componentsData.begin();
+	     i != componentsData.end(); ++i, ++component) {
+		loadComponent(**component, *i);
+	}
+	
+	broadcastInitialPosition(initialPosition, initialVelocity);
+}
+
 shared_ptr<const Component> Actor::getComponent(const string &comType) const {
 	for (ComponentsList::const_iterator i = components.begin();
 	     i != components.end(); ++i) {
@@ -7,6 +7,9 @@
 #include "ComponentDataSet.h"
 
 #include "ActionDeleteActor.h"
+#include "ActionSleep.h"
+#include "ActionWake.h"
+#include "EventPositionUpdate.h"
 
 class ActorSet;
 class World;
@@ -44,12 +47,54 @@ public:
 	                  const vec3 &initialVelocity,
 	                  World*const world);
 	                  
+	/**
+	Puts a dead actor to sleep so that it may be recycled later.
+	Every component is reset to defaults with resetMembers(). Physics
+	bodies and geoms were disabled when the actor was deleted, and are
+	enabled again when the actor is reactivated.
+	*/
+	void deactivate();
+	
+	/**
+	Brings a deactivated actor back to life, reusing its components.
+	The actor must have been created from the same template as the data.
+	@param componentsData Component name and associated data for each component
+	@param initialPosition Initial position of the object
+	@param initialVelocity Initial velocity of the object
+	@param world World where the object is located
+	*/
+	void reactivate(const ComponentDataSet &componentsData,
+	                const vec3 &initialPosition,
+	                const vec3 &initialVelocity,
+	                World*const world);
+	                
+	/**
+	Gets the template that the actor was spawned from
+	@return Template file name, or an empty file name if the actor was not
+	        spawned from a template and may not be recycled
+	*/
+	inline const FileName& getTemplate() const {
+		return templateFile;
+	}
+	
+	/** Sets the template that the actor was spawned from */
+	inline void setTemplate(const FileName &templateFile) {
+		this->templateFile = templateFile;
+	}
+	
 	/**
 	Updates the object without displaying it
 	@param deltaTime milliseconds since the last tick
 	*/
 	virtual void update(float deltaTime);
 	
+	/**
+	Updates the object while it is asleep. Components only do work that
+	must continue while asleep, such as keeping the actor visible.
+	@param deltaTime milliseconds since the last tick
+	*/
+	void updateAsleep(float deltaTime);
+	
 	/** Determines whether the actor has a particular component or not */
 	bool hasComponent(const string &name) const;
 	
@@ -64,7 +109,66 @@ public:
 		return zombie;
 	}
 	
+	/**
+	Receives a message of some kind.
+	Messages that any component reacts to count as a stimulus and will wake
+	the actor, unless they were generated by the actor's own update.
+	Only the components that handle the type of message receive it.
+	@param message Some message
+	*/
+	virtual void recvMessage(const Message *message);
+	
+	/** Puts the actor to sleep so that it is no longer updated */
+	void sleep();
+	
+	/** Wakes the actor and resets its idle counter */
+	void wake();
+	
+	/** Indicates that the actor is asleep and should not be updated */
+	inline bool isAsleep() const {
+		return asleep;
+	}
+	
+	/** Gets the number of updates since the actor last received a stimulus */
+	inline unsigned int getIdleFrames() const {
+		return idleFrames;
+	}
+	
+	/**
+	Gets the last position reported by the actor's components
+	@return position, or the origin if hasPosition() is false
+	*/
+	inline const vec3& getPosition() const {
+		return lastReportedPosition;
+	}
+	
+	/** Indicates that the actor has reported a position */
+	inline bool hasPosition() const {
+		return positionReported;
+	}
+	
 private:
+	/** Explicit requests to wake the actor always count as a stimulus */
+	void handleActionWake(const ActionWake *action);
+	
+	/**
+	Track the actor's position for proximity tests and keep the world's
+	spatial index up to date
+	*/
+	void handleEventPositionUpdate(const EventPositionUpdate *event);
+	
+	/**
+	Builds the table of components that handle each type of message.
+	Called once the actor's components have been created.
+	*/
+	void buildMessageRoutes();
+	
+	/**
+	Passes a message to the actor's own handlers and to the components
+	that handle its type, without treating it as a stimulus
+	*/
+	void dispatch(const Message *message);
+	
 	/** Receive command to delete the actor entirely */
 	void handleActionDeleteActor(const ActionDeleteActor *action);
 	
@@ -72,14 +176,59 @@ private:
 	void broadcastInitialPosition(const vec3 &initialPosition,
 	                              const vec3 &initialVelocity);
 	                              
+	/**
+	Loads a component from its entry in the template data, preferring the
+	data compiled by the component's schema
+	*/
+	static void loadComponent(Component &component,
+	                          const ComponentDataSet::Entry &entry);
+	                          
 private:
 	typedef vector<shared_ptr<Component> > ComponentsList;
 	
 	/** Game object's components */
 	ComponentsList components;
 	
+	/** Where the actor delivers one type of message */
+	struct MessageRoute {
+		MessageRoute() : stimulus(false) { /* Do nothing */ }
+		
+		/** Components with a handler for the message, in creation order */
+		vector<Component*> components;
+		
+		/**
+		Indicates that the message wakes the actor: one of its components
+		handles the message and it is not just bookkeeping
+		*/
+		bool stimulus;
+	};
+	
+	/** Routes indexed by message type ID; types past the end go nowhere */
+	vector<MessageRoute> routes;
+	
 	/** Indicates that the manager may delete us */
 	bool zombie;
+	
+	/** Template the actor was spawned from, used to recycle the actor */
+	FileName templateFile;
+	
+	/** Indicates that the actor is asleep and should not be updated */
+	bool asleep;
+	
+	/** Indicates that the actor is in the middle of its own update */
+	bool updating;
+	
+	/** Number of updates since the actor last received a stimulus */
+	unsigned int idleFrames;
+	
+	/** Last position reported by the actor's components */
+	vec3 lastReportedPosition;
+	
+	/** Indicates that lastReportedPosition is valid */
+	bool positionReported;
+	
+	/** World where the actor is located (may be null) */
+	World *world;
 };
 
 // Garbage Collected pointer to an actor
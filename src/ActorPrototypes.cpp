@@ -0,0 +1,57 @@
+#include "stdafx.h"
+#include "VirtualFileSystem.h"
+#include "ActorPrototypes.h"
+
+ActorPrototypes::FileNameToPrototype ActorPrototypes::cache;
+
+const ComponentDataSet& ActorPrototypes::get(const FileName &fileName) {
+	FileNameToPrototype::iterator iter = cache.find(fileName);
+	
+	if (iter == cache.end()) {
+		size_t numErrors = 0;
+		iter = cache.insert(make_pair(fileName, parse(fileName, numErrors))).first;
+	}
+	
+	return iter->second;
+}
+
+size_t ActorPrototypes::loadAll(const FileName &directory) {
+	vector<FileName> files;
+	VirtualFileSystem::list(directory, files);
+	
+	size_t numErrors = 0;
+	size_t numTemplates = 0;
+	
+	for (vector<FileName>::const_iterator i = files.begin();
+	     i != files.end(); ++i) {
+		if (i->getExtension() != ".xml") {
+			continue;
+		}
+		
+		cache[*i] = parse(*i, numErrors);
+		numTemplates++;
+	}
+	
+	TRACE("Loaded " + sizet_to_string(numTemplates) + " actor templates from "
+	      + directory.str() + " with " + sizet_to_string(numErrors)
+	      + " schema errors");
+	      
+	return numErrors;
+}
+
+ComponentDataSet ActorPrototypes::parse(const FileName &fileName,
+                                        size_t &numErrors) {
+	const PropertyBag templateData = PropertyBag::fromFile(fileName);
+	const PropertyBag base = templateData.getBag("components");
+	ComponentDataSet prototype = ComponentDataSet::parse(base);
+	
+	vector<string> errors;
+	prototype.compile(errors);
+	
+	for (size_t i=0; i<errors.size(); ++i) {
+		ERR(fileName.str() + ": " + errors[i]);
+	}
+	
+	numErrors += errors.size();
+	return prototype;
+}
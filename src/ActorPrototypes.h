@@ -0,0 +1,83 @@
+#ifndef ACTOR_PROTOTYPES_H
+#define ACTOR_PROTOTYPES_H
+
+#include "ComponentDataSet.h"
+
+/**
+Cache of actor templates.
+Each actor definition file (e.g. data/actorDefs/*.xml) is parsed exactly once
+into an immutable prototype, with the data of each component that has a
+schema compiled at the same time. Actors are then spawned from a copy of the
+prototype, with any per-instance specializations merged over that copy.
+Edited templates are picked up without restarting the game when the file
+watcher reports them, through invalidate().
+*/
+class ActorPrototypes {
+private:
+	/** Component data parsed from each template's "components" tag */
+	typedef map<FileName, ComponentDataSet> FileNameToPrototype;
+	
+	/** Stores previously parsed actor templates */
+	static FileNameToPrototype cache;
+	
+public:
+	/**
+	Gets the prototype for an actor template, parsing the file if necessary
+	@param fileName File that contains the actor definition
+	@return immutable component data for the template
+	*/
+	static const ComponentDataSet& get(const FileName &fileName);
+	
+	/**
+	Creates component data for a new actor instance
+	@param fileName File that contains the actor definition
+	@return copy of the prototype component data
+	*/
+	static ComponentDataSet instantiate(const FileName &fileName) {
+		return get(fileName);
+	}
+	
+	/**
+	Creates component data for a new actor instance
+	@param fileName File that contains the actor definition
+	@param specialization Per-instance modifications to the template data
+	@return copy of the prototype with specializations merged in
+	*/
+	static ComponentDataSet instantiate(const FileName &fileName,
+	                                    const PropertyBag &specialization) {
+		return ComponentDataSet::merge(get(fileName),
+		                               ComponentDataSet::parse(specialization));
+	}
+	
+	/**
+	Loads every actor template in a directory, so that schema errors in any
+	of them are reported up front instead of when the actor is first spawned
+	@param directory Directory holding actor definitions
+	@return number of schema errors found
+	*/
+	static size_t loadAll(const FileName &directory);
+	
+	/** Discards all cached prototypes */
+	static void clear() {
+		cache.clear();
+	}
+	
+	/**
+	Discards the prototype of a changed file, so that it is parsed again
+	@param fileName File that has changed
+	*/
+	static void invalidate(const FileName &fileName) {
+		cache.erase(fileName);
+	}
+	
+private:
+	/**
+	Parses an actor template file and compiles its component data
+	@param fileName File that contains the actor definition
+	@param numErrors Incremented for each schema error, which is logged
+	@return prototype parsed from the file
+	*/
+	static ComponentDataSet parse(const FileName &fileName, size_t &numErrors);
+};
+
+#endif
@@ -4,6 +4,9 @@
 #include "ComponentPhysics.h"
 #include "ComponentPhysicsBody.h"
 #include "ActorSet.h"
+#include "World.h"
+#include "ActorPrototypes.h"
+#include "ProfileScope.h"
 
 #include "EventCollisionOccurred.h"
 
@@ -16,6 +19,7 @@ UniqueIdFactory<ActorID> ActorSet::nameFactory(100);
 void ActorSet::clear() {
 	ScopedEventHandler::clear();
 	actors.clear();
+	clearPool();
 	displayDebugRendering = false;
 }
 
@@ -37,25 +41,49 @@ void ActorSet::destroy() {
 		actors.erase(iter);
 	}
 	
+	clearPool();
 	displayDebugRendering = false;
 }
 
 void ActorSet::spawn(const ComponentDataSet &data,
                      const vec3 &position,
                      const vec3 &velocity) {
-	const SpawnRequest r = make_tuple(data, position, velocity);
+	const SpawnRequest r = make_tuple(data, position, velocity, FileName());
 	spawnRequests.push(r);
 }
 
-void ActorSet::_spawn(const SpawnRequest &spawnData) {
+void ActorSet::spawn(const FileName &templateFile,
+                     const ComponentDataSet &data,
+                     const vec3 &position,
+                     const vec3 &velocity) {
+	const SpawnRequest r = make_tuple(data, position, velocity, templateFile);
+	spawnRequests.push(r);
+}
+
+ActorPtr ActorSet::spawnImmediately(const FileName &templateFile,
+                                    const ComponentDataSet &data,
+                                    const vec3 &position,
+                                    const vec3 &velocity) {
+	return _spawn(make_tuple(data, position, velocity, templateFile));
+}
+
+ActorPtr ActorSet::_spawn(const SpawnRequest &spawnData) {
 	const ComponentDataSet &data = spawnData.get<0>();
 	const vec3 &position = spawnData.get<1>();
 	const vec3 &velocity = spawnData.get<2>();
+	const FileName &templateFile = spawnData.get<3>();
+	
+	churnTimer.beginTiming();
 	
-	const tuple<ActorID, ActorPtr> t = create();
-	const ActorPtr object = t.get<1>();
+	ActorPtr object = takeFromPool(templateFile);
 	
-	object->load(data, position, velocity, world);
+	if (object) {
+		object->reactivate(data, position, velocity, world);
+	} else {
+		object = create().get<1>();
+		object->load(data, position, velocity, world);
+		object->setTemplate(templateFile);
+	}
 	
 	// initially set debug display state
 	if (displayDebugRendering) {
@@ -65,6 +93,94 @@ void ActorSet::_spawn(const SpawnRequest &spawnData) {
 		ActionDebugDisable m;
 		object->recvAction(&m);
 	}
+	
+	spawns++;
+	spawnMilliseconds += churnTimer.endTiming();
+	
+	return object;
+}
+
+ActorPtr ActorSet::takeFromPool(const FileName &templateFile) {
+	if (templateFile == FileName()) {
+		return ActorPtr(); // actor may not be recycled
+	}
+	
+	ActorPool::iterator i = pool.find(templateFile);
+	
+	if (i == pool.end() || i->second.empty()) {
+		poolMisses++;
+		return ActorPtr();
+	}
+	
+	poolHits++;
+	
+	ActorPtr actor = i->second.back();
+	i->second.pop_back();
+	
+	// Actor begins receiving messages from this set again
+	actors.insert(make_pair(actor->getUID(), actor));
+	registerSubscriber(actor.get());
+	actor->setParentScope(this);
+	
+	return actor;
+}
+
+bool ActorSet::returnToPool(ActorPtr actor) {
+	ASSERT(actor, "Null parameter: actor");
+	
+	const FileName &templateFile = actor->getTemplate();
+	
+	if (templateFile == FileName()) {
+		return false;
+	}
+	
+	vector<ActorPtr> &pooled = pool[templateFile];
+	
+	if (pooled.size() >= maxPooledActorsPerTemplate) {
+		return false;
+	}
+	
+	actor->deactivate();
+	pooled.push_back(actor);
+	return true;
+}
+
+void ActorSet::clearPool() {
+	if (poolHits + poolMisses > 0) {
+		TRACE("Actor pool hit rate: " + ftos(getPoolHitRate() * 100.0f) + "% ("
+		      + sizet_to_string(poolHits) + " of "
+		      + sizet_to_string(poolHits + poolMisses) + " spawns)");
+	}
+	
+	if (spawns + despawns > 0) {
+		TRACE("Actor churn: " + sizet_to_string(spawns) + " spawns took "
+		      + ftos((float)spawnMilliseconds) + "ms, "
+		      + sizet_to_string(despawns) + " despawns took "
+		      + ftos((float)despawnMilliseconds) + "ms");
+	}
+	
+	pool.clear();
+	poolHits = 0;
+	poolMisses = 0;
+	spawns = 0;
+	spawnMilliseconds = 0.0;
+	despawns = 0;
+	despawnMilliseconds = 0.0;
+}
+
+float ActorSet::getPoolHitRate() const {
+	const size_t spawns = poolHits + poolMisses;
+	return (spawns==0) ? 0.0f : (float)poolHits / spawns;
+}
+
+size_t ActorSet::getNumPooledActors() const {
+	size_t count = 0;
+	
+	for (ActorPool::const_iterator i = pool.begin(); i != pool.end(); ++i) {
+		count += i->second.size();
+	}
+	
+	return count;
 }
 
 tuple<ActorID, ActorPtr> ActorSet::create() {
@@ -92,17 +208,40 @@ ActorPtr ActorSet::get(ActorID id) {
 }
 
 void ActorSet::update(float deltaTime) {
+	findActorsNearPlayers();
+	
 	for (iterator i = begin(); i!=end(); ++i) {
 		ActorPtr actor = i->second;
 		
-		if (actor) {
-			actor->update(deltaTime);
+		if (!actor) {
+			continue;
+		}
+		
+		const bool nearPlayers = isNearPlayers(*actor);
+		
+		if (actor->isAsleep()) {
+			if (nearPlayers) {
+				actor->wake();
+			} else {
+				actor->updateAsleep(deltaTime);
+				continue;
+			}
+		}
+		
+		actor->update(deltaTime);
+		
+		if (!nearPlayers && actor->getIdleFrames() >= sleepFrames) {
+			actor->sleep();
 		}
 	}
 	
-	while (!spawnRequests.empty()) {
-		_spawn(spawnRequests.front());
-		spawnRequests.pop();
+	if (!spawnRequests.empty()) {
+		PROFILE("Spawn Actors");
+		
+		while (!spawnRequests.empty()) {
+			_spawn(spawnRequests.front());
+			spawnRequests.pop();
+		}
 	}
 	
 	reapZombieActors();
@@ -123,8 +262,19 @@ void ActorSet::reapZombieActors() {
 		ActorPtr actor = p.second;
 		
 		if (actor && actor->isZombie()) {
+			churnTimer.beginTiming();
+			
 			removeSubscriber(id);
 			actors.erase(id);
+			
+			if (world) {
+				world->getSpatialIndex().remove(id);
+			}
+			
+			returnToPool(actor);
+			
+			despawns++;
+			despawnMilliseconds += churnTimer.endTiming();
 		}
 		
 		iter = nextIter;
@@ -142,23 +292,84 @@ void ActorSet::load(const PropertyBag &objects, World *_world) {
 		const PropertyBag decl = objects.getBag("object", i);
 		const FileName templateFile = decl.getFileName("template");
 		const vec3 initialPosition = decl.getVec3("position");
-		const PropertyBag templateData = PropertyBag::fromFile(templateFile);
-		const PropertyBag base = templateData.getBag("components");
 		
-		ComponentDataSet s = ComponentDataSet::load(base, decl);
+		ComponentDataSet s = ActorPrototypes::instantiate(templateFile, decl);
 		
 		object->load(s, initialPosition, vec3(0,0,0), world);
 		object->setParentScope(this);
 	}
 }
 
+void ActorSet::setSleepParameters(float radius, unsigned int frames) {
+	sleepRadius = radius;
+	sleepFrames = frames;
+}
+
+size_t ActorSet::getNumSleepingActors() const {
+	size_t count = 0;
+	
+	for (const_iterator i = begin(); i!=end(); ++i) {
+		if (i->second && i->second->isAsleep()) {
+			count++;
+		}
+	}
+	
+	return count;
+}
+
+void ActorSet::findActorsNearPlayers() {
+	actorsNearPlayers.clear();
+	playersHavePositions = false;
+	
+	if (!world) {
+		return;
+	}
+	
+	const ActorSet &players = world->players;
+	const SpatialIndex &spatialIndex = world->getSpatialIndex();
+	
+	for (const_iterator i = players.begin(); i!=players.end(); ++i) {
+		if (i->second && i->second->hasPosition()) {
+			playersHavePositions = true;
+			spatialIndex.queryRadius(i->second->getPosition(),
+			                         sleepRadius,
+			                         actorsNearPlayers);
+		}
+	}
+	
+	// Players close to each other will have found some of the same actors
+	sort(actorsNearPlayers.begin(), actorsNearPlayers.end());
+	actorsNearPlayers.erase(unique(actorsNearPlayers.begin(),
+	                               actorsNearPlayers.end()),
+	                        actorsNearPlayers.end());
+}
+
+bool ActorSet::isNearPlayers(const Actor &actor) const {
+	if (!actor.hasPosition() || !playersHavePositions) {
+		return true;
+	}
+	
+	return binary_search(actorsNearPlayers.begin(),
+	                     actorsNearPlayers.end(),
+	                     actor.getUID());
+}
+
 bool ActorSet::isMember(ActorID id) const {
 	const_iterator i = actors.find(id);
 	return (id!=INVALID_ID) && (i != actors.end());
 }
 
 ActorSet::ActorSet()
-		:world(0) {
+		:world(0),
+		poolHits(0),
+		poolMisses(0),
+		spawns(0),
+		spawnMilliseconds(0.0),
+		despawns(0),
+		despawnMilliseconds(0.0),
+		sleepRadius(30.0f),
+		sleepFrames(60),
+		playersHavePositions(false) {
 	REGISTER_HANDLER(ActorSet::handleActionDebugEnable);
 	REGISTER_HANDLER(ActorSet::handleActionDebugDisable);
 	clear();
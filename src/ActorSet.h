@@ -2,6 +2,8 @@
 #define _ACTOR_SET_H_
 
 #include "Actor.h"
+#include "FrameTimer.h"
+#include "SpatialIndex.h"
 
 #include "ScopedEventHandler.h"
 
@@ -40,8 +42,17 @@ public:
 	typedef MapHandleToObject::const_iterator const_iterator;
 	
 private:
-	/** Tuple containing component data, initial position, and velocity */
-	typedef tuple<ComponentDataSet, vec3, vec3> SpawnRequest;
+	/**
+	Tuple containing component data, initial position, velocity, and the
+	template file that the component data was instantiated from
+	*/
+	typedef tuple<ComponentDataSet, vec3, vec3, FileName> SpawnRequest;
+	
+	/** Deactivated actors, keyed by the template they were spawned from */
+	typedef map<FileName, vector<ActorPtr> > ActorPool;
+	
+	/** Maximum number of deactivated actors kept for each template */
+	static const size_t maxPooledActorsPerTemplate = 64;
 	
 	/** Generates unique names for objects */
 	static UniqueIdFactory<ActorID> nameFactory;
@@ -52,6 +63,41 @@ private:
 	World *world;
 	bool displayDebugRendering;
 	
+	/** Dead actors kept around to be recycled by later spawns */
+	ActorPool pool;
+	
+	/** Number of template spawns that recycled a pooled actor */
+	size_t poolHits;
+	
+	/** Number of template spawns that had to create a new actor */
+	size_t poolMisses;
+	
+	/** Times spawns and despawns to measure the cost of actor churn */
+	Timer churnTimer;
+	
+	/** Number of actors spawned and the total milliseconds it took */
+	size_t spawns;
+	double spawnMilliseconds;
+	
+	/** Number of zombie actors reaped and the total milliseconds it took */
+	size_t despawns;
+	double despawnMilliseconds;
+	
+	/** Actors farther than this from every player may fall asleep */
+	float sleepRadius;
+	
+	/** Actors may fall asleep after this many updates without a stimulus */
+	unsigned int sleepFrames;
+	
+	/**
+	Sorted IDs of the actors within the sleep radius of some player,
+	gathered once per update and reused between updates
+	*/
+	SpatialIndex::ActorIDList actorsNearPlayers;
+	
+	/** Indicates that at least one player reported a position this update */
+	bool playersHavePositions;
+	
 public:
 	virtual string getTypeString() const {
 		return "ActorSet";
@@ -65,7 +111,16 @@ public:
 	@param xml The XML data source
 	@param zone The home zone of the object
 	*/
-	ActorSet(const PropertyBag &data, World *world) {
+	ActorSet(const PropertyBag &data, World *world)
+			: poolHits(0),
+			poolMisses(0),
+			spawns(0),
+			spawnMilliseconds(0.0),
+			despawns(0),
+			despawnMilliseconds(0.0),
+			sleepRadius(30.0f),
+			sleepFrames(60),
+			playersHavePositions(false) {
 		ASSERT(world!=0, "zone was NULL");
 		clear();
 		load(data, world);
@@ -139,6 +194,43 @@ public:
 	           const vec3 &position,
 	           const vec3 &velocity);
 	           
+	/**
+	Requests that an actor be created from a template at the next tick.
+	Actors spawned this way are recycled through the actor pool.
+	@param templateFile Template that the component data was instantiated from
+	@param data Component layout and data for the object
+	@param position Initial position of the object
+	@param position Initial velocity of the object
+	*/
+	void spawn(const FileName &templateFile,
+	           const ComponentDataSet &data,
+	           const vec3 &position,
+	           const vec3 &velocity);
+	           
+	/**
+	Creates an actor from a template right now, recycling a pooled actor if
+	one is available.
+	@param templateFile Template that the component data was instantiated from
+	@param data Component layout and data for the object
+	@param position Initial position of the object
+	@param position Initial velocity of the object
+	@return the new actor
+	*/
+	ActorPtr spawnImmediately(const FileName &templateFile,
+	                          const ComponentDataSet &data,
+	                          const vec3 &position,
+	                          const vec3 &velocity);
+	                          
+	/**
+	Gets the fraction of template spawns that were satisfied by recycling
+	a pooled actor
+	@return hit rate within [0, 1]
+	*/
+	float getPoolHitRate() const;
+	
+	/** Gets the number of deactivated actors waiting in the pool */
+	size_t getNumPooledActors() const;
+	
 	/**
 	Gets an actor from the set
 	@param uid The GUID of the actor to retrieve
@@ -162,6 +254,20 @@ public:
 	/** Deletes zombie actors */
 	void reapZombieActors();
 	
+	/**
+	Sets the conditions under which actors fall asleep. An actor falls
+	asleep when it is outside the radius of all players and has received
+	no stimulus for the specified number of updates. Sleeping actors are
+	not updated until they are woken by a message, a collision, or a
+	player moving within the radius.
+	@param radius Distance from the nearest player
+	@param frames Number of updates without a stimulus
+	*/
+	void setSleepParameters(float radius, unsigned int frames);
+	
+	/** Gets the number of actors in the set that are asleep */
+	size_t getNumSleepingActors() const;
+	
 private:
 	void handleActionDebugEnable(const ActionDebugEnable *) {
 		displayDebugRendering = true;
@@ -171,8 +277,37 @@ private:
 		displayDebugRendering = false;
 	}
 	
+	/**
+	Queries the world's spatial index around each player to find the actors
+	within the sleep radius of any player
+	*/
+	void findActorsNearPlayers();
+	
+	/**
+	Determines whether an actor is within the sleep radius of any player.
+	Actors that have never reported a position are always considered near.
+	findActorsNearPlayers must be called first.
+	*/
+	bool isNearPlayers(const Actor &actor) const;
+	                   
 	/** Spawns an object right now */
-	void _spawn(const SpawnRequest &data);
+	ActorPtr _spawn(const SpawnRequest &data);
+	
+	/**
+	Takes a deactivated actor for the template out of the pool
+	@param templateFile Template the actor must have been spawned from
+	@return Pooled actor, or null if the pool has none for the template
+	*/
+	ActorPtr takeFromPool(const FileName &templateFile);
+	
+	/**
+	Deactivates a dead actor and holds onto it for recycling
+	@return true if the actor was pooled
+	*/
+	bool returnToPool(ActorPtr actor);
+	
+	/** Discards all pooled actors and resets pool and churn statistics */
+	void clearPool();
 };
 
 #endif
@@ -1,132 +1,218 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
 #include "AnimationController.h"
 
-AnimationController::AnimationController() {
+AnimationStatistics::AnimationStatistics()
+		: instances(0),
+		workingSets(0),
+		workingSetBytes(0) {}
+
+string AnimationStatistics::toString() const {
+	const size_t perInstance = (instances == 0) ? 0 : workingSetBytes / instances;
+	
+	return sizet_to_string(instances) + " instances, " +
+	       sizet_to_string(workingSets) + " with working meshes of " +
+	       sizet_to_string(workingSetBytes) + " bytes (" +
+	       sizet_to_string(perInstance) + " bytes per instance)";
+}
+
+AnimationController::~AnimationController() {
+	MutexLock lock(getStatisticsMutex());
+	AnimationStatistics &statistics = getMutableStatistics();
+	statistics.instances--;
+	
+	if (workingSetBytes > 0) {
+		statistics.workingSets--;
+		statistics.workingSetBytes -= workingSetBytes;
+	}
+}
+
+AnimationController::AnimationController()
+		: workingSetBytes(0) {
 	clear();
+	
+	MutexLock lock(getStatisticsMutex());
+	getMutableStatistics().instances++;
 }
 
 AnimationController::AnimationController(const AnimationController &a)
 		: animations(a.animations),
-		current(a.current) { /* Do Nothing */ }
+		current(a.current),
+		time(a.time),
+		speed(a.speed),
+		finished(a.finished),
+		workingSetBytes(0) {
+	MutexLock lock(getStatisticsMutex());
+	getMutableStatistics().instances++;
+}
 
 void AnimationController::update(float milliseconds) {
-	ASSERT(current < animations.size(),
-	       "Invalid m_nCurrentAnimation: " + sizet_to_string(current));
-	       
-	animations[current].update(milliseconds);
+	const AnimationSequence &animation = getAnimation();
+	const float length = animation.getLength();
+	
+	time += milliseconds * speed;
+	
+	// Loop the animation if it goes past the end
+	if (time > length) {
+		if (animation.isLooping()) {
+			while (time > length) time -= length;
+			finished = false;
+		} else {
+			finished = true;
+			time = length;
+		}
+	}
 }
 
 const AnimationSequence& AnimationController::getAnimation() const {
-	ASSERT(current < animations.size(),
-	       "Invalid animation handle: " + sizet_to_string(current));
-	       
-	return animations[current];
-}
-
-AnimationSequence& AnimationController::getAnimation() {
-	ASSERT(current < animations.size(),
+	ASSERT(current < animations->size(),
 	       "Invalid animation handle: " + sizet_to_string(current));
 	       
-	return animations[current];
+	return (*animations)[current];
 }
 
 const AnimationSequence& AnimationController::getAnimation(size_t handle) const {
-	ASSERT(handle < animations.size(),
+	ASSERT(handle < animations->size(),
 	       "Invalid animation handle: " + sizet_to_string(handle));
 	       
-	return animations[handle];
+	return (*animations)[handle];
 }
 
 size_t AnimationController::addAnimation(AnimationSequence &animation) {
-	animations.push_back(animation);
-	return animations.size()-1;
+	ASSERT(animations.unique(),
+	       "Cannot add animations to a model that has other instances");
+	animations->push_back(animation);
+	return animations->size()-1;
 }
 
 size_t AnimationController::getAnimationHandle(const string &name) const {
-	for (size_t i=0; i<animations.size(); ++i) {
-		if (animations[i].getName() == name)
+	for (size_t i=0; i<animations->size(); ++i) {
+		if ((*animations)[i].getName() == name)
 			return i;
 	}
 	
 	return 0;
 }
 
-bool AnimationController::requestAnimationChange(size_t handle, float speed) {
-	ASSERT(handle < animations.size(),
+bool AnimationController::requestAnimationChange(size_t handle, float _speed) {
+	ASSERT(handle < animations->size(),
 	       "Invalid handle: " + sizet_to_string(handle));
 	       
-	ASSERT(current < animations.size(),
-	       "Invalid m_nCurrentAnimation: " + sizet_to_string(current));
-	       
-	AnimationSequence &currentSequence = animations[current];
-	AnimationSequence &requestedSequence = animations[handle];
+	const AnimationSequence &currentSequence = getAnimation();
+	const AnimationSequence &requestedSequence = getAnimation(handle);
 	
 	// Fail if the current is animation is super high priority
-	if (!currentSequence.isFinished() && currentSequence.isHighPriority())
+	if (!finished && currentSequence.isHighPriority())
 		return false;
 		
 	// Fail if the current animation has a higher priority
-	if (!currentSequence.isFinished() &&
+	if (!finished &&
 	    currentSequence.getPriority() > requestedSequence.getPriority())
 		return false;
 		
 	// Fail if the requested animation is already playing
 	if (current == handle) {
 		// change the speed, though
-		currentSequence.setSpeed(speed);
+		speed = _speed;
 		
 		/*
 		      If the current animation is already playing, but IS finished, then
 		      fall-through to restart the animation
 		      */
-		if (!currentSequence.isFinished())
+		if (!finished)
 			return false;
 	}
 	
 	// Fulfill the request
 	current = handle;
-	animations[current].setTime(0.0f);
-	animations[current].setSpeed(speed);
+	time = 0.0f;
+	finished = false;
+	speed = _speed;
 	
 	return true;
 }
 
-float AnimationController::calculateCylindricalRadius() {
-	ASSERT(current < animations.size(),
-	       "Invalid m_nCurrentAnimation: " + sizet_to_string(current));
-	       
-	return animations[current].calculateCylindricalRadius();
+float AnimationController::getHeight() const {
+	const AnimationSequence &idle = getAnimation(getAnimationHandle("idle"));
+	return idle.getKeyFrames()[0].getBounds().getHeight();
 }
 
-float AnimationController::calculateRadius() {
-	ASSERT(current < animations.size(),
-	       "Invalid m_nCurrentAnimation: " + sizet_to_string(current));
-	       
-	return animations[current].calculateRadius();
+void AnimationController::clear() {
+	animations = shared_ptr<Animations>(new Animations());
+	resetPlayback();
 }
 
-float AnimationController::calculateHeight() {
-	ASSERT(current < animations.size(),
-	       "Invalid m_nCurrentAnimation: " + sizet_to_string(current));
-	       
-	return animations[getAnimationHandle("idle")].calculateHeight();
+void AnimationController::resetPlayback() {
+	current = 0;
+	time = 0.0f;
+	speed = 1.0f;
+	finished = false;
 }
 
-void AnimationController::clear() {
-	current = 0;
-	animations.clear();
+void AnimationController::getGeometryChunks(vector<GeometryChunk> &m,
+                                            float quantum) const {
+	const MeshSet &frame = getAnimation().getFrame(time, workingSet, quantum);
+	
+	countWorkingSet();
+	
+	for (MeshSet::const_iterator i=frame.begin(); i!=frame.end(); ++i) {
+		(*i)->getGeometryChunks(m);
+	}
 }
 
-void AnimationController::getGeometryChunks( vector<GeometryChunk> &m ) const {
-	ASSERT(current < animations.size(),
-	       "Invalid current animation: " + sizet_to_string(current));
-	       
-	animations[current].getGeometryChunks(m);
+void AnimationController::countWorkingSet() const {
+	size_t bytes = 0;
+	
+	const MeshSet &meshes = workingSet.meshes;
+	
+	for (MeshSet::const_iterator i=meshes.begin(); i!=meshes.end(); ++i) {
+		bytes += (*i)->vertexArray->getSize() + (*i)->normalArray->getSize();
+	}
+	
+	if (bytes == workingSetBytes) {
+		return;
+	}
+	
+	MutexLock lock(getStatisticsMutex());
+	AnimationStatistics &statistics = getMutableStatistics();
+	
+	if (workingSetBytes == 0) {
+		statistics.workingSets++;
+	} else if (bytes == 0) {
+		statistics.workingSets--;
+	}
+	
+	statistics.workingSetBytes += bytes;
+	statistics.workingSetBytes -= workingSetBytes;
+	workingSetBytes = bytes;
+}
+
+size_t AnimationController::getMemoryUsage() const {
+	return getFootprint().packed;
 }
 
-void AnimationController::uniformScale( float scale ) {
-	for (vector<AnimationSequence>::iterator i=animations.begin();
-	     i!=animations.end(); ++i) {
-		i->uniformScale(scale);
+VertexFootprint AnimationController::getFootprint() const {
+	VertexFootprint footprint;
+	
+	for (Animations::const_iterator i=animations->begin();
+	     i!=animations->end(); ++i) {
+		footprint += i->getFootprint();
 	}
-}
\ No newline at end of file
+	
+	return footprint;
+}
+
+Mutex& AnimationController::getStatisticsMutex() {
+	static Mutex mutex;
+	return mutex;
+}
+
+AnimationStatistics& AnimationController::getMutableStatistics() {
+	static AnimationStatistics statistics;
+	return statistics;
+}
+
+AnimationStatistics AnimationController::getStatistics() {
+	MutexLock lock(getStatisticsMutex());
+	return getMutableStatistics();
+}
@@ -2,12 +2,39 @@
 #define _ANIMATION_CONTROLLER_H_
 
 #include "AnimationSequence.h"
+#include "Thread.h"
 
-/** Manages a set of animation sequences */
+/** Counters describing the animated model instances in existence */
+struct AnimationStatistics {
+	/** Animation controllers in existence */
+	size_t instances;
+	
+	/** Instances that have created meshes to interpolate key frames into */
+	size_t workingSets;
+	
+	/** GPU memory used by the vertices and normals of those meshes */
+	size_t workingSetBytes;
+	
+	/** Constructor */
+	AnimationStatistics();
+	
+	/** Gets a readable summary of the counters */
+	string toString() const;
+};
+
+/**
+Manages a set of animation sequences. The sequences, and the key frames
+they hold, are shared by every instance of a model and never change once
+loaded. Each instance only holds the state of its playback and the meshes
+that key frames are interpolated into, which are created when it is first
+drawn between two key frames.
+*/
 class AnimationController {
 private:
+	typedef vector<AnimationSequence> Animations;
+	
 	/** Stores a list of all the model's animations */
-	vector<AnimationSequence> animations;
+	shared_ptr<Animations> animations;
 	
 	/**
 	Records which of the above animation objects is currently being
@@ -15,15 +42,44 @@ private:
 	*/
 	size_t current;
 	
+	/** Time into the current animation (milliseconds) */
+	float time;
+	
+	/** Multiply all Time Elapsed values by this to control animation speed */
+	float speed;
+	
+	/**
+	Flags whether the current animation has been completed
+	If it loops, then this is always false
+	*/
+	bool finished;
+	
+	/** Meshes that key frames are interpolated into */
+	mutable WorkingSet workingSet;
+	
+	/** GPU memory counted for the working set (see AnimationStatistics) */
+	mutable size_t workingSetBytes;
+	
 public:
+	/** Destructor */
+	~AnimationController();
+	
 	/** Constructs a blank animation controller */
 	AnimationController();
 	
-	/** Constructs a copy of another animation controller */
+	/**
+	Constructs another instance of the model of an animation controller.
+	The instance shares the animations and copies the playback state.
+	*/
 	AnimationController(const AnimationController &animationController);
 	
-	/** Get all the static meshes for this tick */
-	void getGeometryChunks(vector<GeometryChunk> &m) const;
+	/**
+	Get all the static meshes for this tick
+	@param m Returns the geometry chunks
+	@param quantum Step, in key frames, that the position between key
+	       frames is rounded to (see AnimationSequence::getFrame)
+	*/
+	void getGeometryChunks(vector<GeometryChunk> &m, float quantum = 0.0f) const;
 	
 	/**
 	Updates the current animation
@@ -44,13 +100,8 @@ public:
 	const AnimationSequence& getAnimation() const;
 	
 	/**
-	Gets the current animation
-	@return The current animation
-	*/
-	AnimationSequence& getAnimation();
-	
-	/**
-	Adds an animation sequence to the controller
+	Adds an animation sequence to the controller. Only while the model is
+	being loaded, before it has any other instances.
 	@param animation Animation sequence to add
 	@return The animation handle
 	*/
@@ -69,7 +120,7 @@ public:
 	@return Number of animations
 	*/
 	size_t getNumAnimations() const {
-		return animations.size();
+		return animations->size();
 	}
 	
 	/**
@@ -96,12 +147,19 @@ public:
 	*/
 	bool requestAnimationChange(size_t handle, float speed=1.0f);
 	
+	/**
+	Returns to the start of the first animation at normal speed, whatever
+	the priority of the animation playing now. An instance that is reused
+	for another actor starts over this way.
+	*/
+	void resetPlayback();
+	
 	/**
 	Gets the time into the current animation
 	@return time into the animation
 	*/
 	float getTime() const {
-		return getAnimation().getTime();
+		return time;
 	}
 	
 	/**
@@ -113,38 +171,70 @@ public:
 	}
 	
 	/**
-	Calculates and returns the radius of the smallest sphere entirely
-	 enclosing the model.
-	@param time The time into the current animation
-	@return radius
+	Gets the number of vertices blended to draw the current animation
+	between two key frames
+	@return Number of vertices
 	*/
-	float calculateRadius();
+	size_t getNumVertices() const {
+		return getAnimation().getNumVertices();
+	}
+	
+	/** Indicates whether or not the current animation has finished yet */
+	bool isFinished() const {
+		return finished;
+	}
 	
 	/**
-	Calculates and returns the radius of the smallest cylinder entirely
-	 enclosing the model.
-	@param time The time into the current animation
-	@return cylinder radius
+	Gets the bounds of the model at any time into the current animation.
+	These are computed once, when the model is loaded.
 	*/
-	float calculateCylindricalRadius();
+	inline const BoundingVolume& getBounds() const {
+		return getAnimation().getBounds();
+	}
 	
 	/**
-	Calculates and returns the height of the model
+	Gets the height of the model at rest, which is that of the first key
+	frame of its idle animation
 	@return height
 	*/
-	float calculateHeight();
+	float getHeight() const;
 	
-	/** Creates a copy of this animation controller */
+	/** Creates another instance of the model of this animation controller */
 	inline shared_ptr<AnimationController> clone() const {
 		AnimationController *a = new AnimationController(*this);
 		return shared_ptr<AnimationController>(a);
 	}
 	
-	void uniformScale(float scale);
+	/**
+	Gets the memory used by the meshes of all animations, which is shared
+	by every instance
+	@return Size of the meshes, in bytes
+	*/
+	size_t getMemoryUsage() const;
+	
+	/**
+	Gets the memory used by the meshes of all animations, along with the
+	memory they would use if they were not packed
+	*/
+	VertexFootprint getFootprint() const;
+	
+	/** Gets the counters describing the instances in existence */
+	static AnimationStatistics getStatistics();
 	
 private:
+	AnimationController& operator=(const AnimationController&);
+	
 	/** Reset all variables to their default state */
 	void clear();
+	
+	/** Counts the GPU memory of the working set in the statistics */
+	void countWorkingSet() const;
+	
+	/** Gets the mutex guarding the statistics */
+	static Mutex& getStatisticsMutex();
+	
+	/** Gets the statistics for modification, with the mutex held */
+	static AnimationStatistics& getMutableStatistics();
 };
 
 #endif
@@ -0,0 +1,125 @@
+#include "stdafx.h"
+#include "AnimationLOD.h"
+#include "Frustum.h"
+
+extern Frustum g_Frustum;
+
+AnimationLODStatistics::AnimationLODStatistics()
+		: requests(0),
+		culled(0),
+		continuous(0),
+		stepped(0),
+		keyFramesOnly(0),
+		overBudget(0),
+		budgetDistance(0.0f) {}
+
+string AnimationLODStatistics::toString() const {
+	return sizet_to_string(requests) + " models: " +
+	       sizet_to_string(culled) + " culled, " +
+	       sizet_to_string(continuous) + " blended continuously, " +
+	       sizet_to_string(stepped) + " blended in steps, " +
+	       sizet_to_string(keyFramesOnly) + " drawn from key frames (" +
+	       sizet_to_string(overBudget) + " over budget); " +
+	       "budget reached at " + ftos(budgetDistance) + " units last frame";
+}
+
+AnimationLOD::AnimationLOD()
+		: nearDistance(15.0f),
+		farDistance(40.0f),
+		budget(0),
+		budgetDistance(40.0f) {
+	eye.zero();
+	
+	for (int i=0; i<BANDS; ++i) {
+		demand[i] = 0;
+	}
+}
+
+void AnimationLOD::setParameters(float _nearDistance,
+                                 float _farDistance,
+                                 size_t _budget) {
+	ASSERT(_nearDistance >= 0.0f, "Near distance is negative");
+	ASSERT(_farDistance > _nearDistance, "Far distance is not beyond near distance");
+	
+	nearDistance = _nearDistance;
+	farDistance = _farDistance;
+	budget = _budget;
+	budgetDistance = farDistance;
+	
+	for (int i=0; i<BANDS; ++i) {
+		demand[i] = 0;
+	}
+}
+
+int AnimationLOD::getBand(float distance) const {
+	const int band = (int)(distance / farDistance * BANDS);
+	return min(max(band, 0), BANDS-1);
+}
+
+void AnimationLOD::beginFrame(const vec3 &_eye) {
+	eye = _eye;
+	
+	// Serve the nearest models of the last frame until the budget runs out
+	budgetDistance = farDistance;
+	
+	if (budget > 0) {
+		size_t total = 0;
+		
+		for (int i=0; i<BANDS; ++i) {
+			total += demand[i];
+			
+			if (total > budget) {
+				budgetDistance = farDistance * i / BANDS;
+				break;
+			}
+		}
+	}
+	
+	statistics.budgetDistance = budgetDistance;
+	
+	for (int i=0; i<BANDS; ++i) {
+		demand[i] = 0;
+	}
+}
+
+bool AnimationLOD::choose(const vec3 &center,
+                          float radius,
+                          size_t vertices,
+                          float &quantum) {
+	statistics.requests++;
+	
+	// The frustum is that of the last frame drawn, so allow for the camera
+	// having moved a little since
+	if (!g_Frustum.isSphereWithin(center, radius * 1.5f)) {
+		statistics.culled++;
+		return false;
+	}
+	
+	const float distance = max(eye.distance(center) - radius, 0.0f);
+	
+	if (distance >= farDistance * 2.0f) {
+		quantum = 2.0f;
+		statistics.keyFramesOnly++;
+		return true;
+	} else if (distance >= farDistance) {
+		quantum = 1.0f;
+		statistics.keyFramesOnly++;
+		return true;
+	}
+	
+	demand[getBand(distance)] += vertices;
+	
+	if (distance >= budgetDistance) {
+		quantum = 1.0f;
+		statistics.keyFramesOnly++;
+		statistics.overBudget++;
+	} else if (distance >= nearDistance) {
+		quantum = 1.0f / STEPS;
+		statistics.stepped++;
+	} else {
+		quantum = 0.0f;
+		statistics.continuous++;
+	}
+	
+	return true;
+}
@@ -0,0 +1,125 @@
+#ifndef _ANIMATION_LOD_H_
+#define _ANIMATION_LOD_H_
+
+#include "vec3.h"
+
+/** Counters describing the animated models drawn, ever */
+struct AnimationLODStatistics {
+	/** Models drawn, or skipped for lying outside the view */
+	size_t requests;
+	
+	/** Models outside the view, whose animations only advanced in time */
+	size_t culled;
+	
+	/** Models blended continuously between key frames */
+	size_t continuous;
+	
+	/** Models blended at a few steps between key frames */
+	size_t stepped;
+	
+	/** Models drawn from key frames without blending */
+	size_t keyFramesOnly;
+	
+	/** Models pushed down to key frames by the vertex budget */
+	size_t overBudget;
+	
+	/** Distance beyond which the budget allowed no blending, last frame */
+	float budgetDistance;
+	
+	/** Constructor */
+	AnimationLODStatistics();
+	
+	/** Gets a readable summary of the counters */
+	string toString() const;
+};
+
+/**
+Chooses how precisely each animated model is drawn from its distance to
+the camera and from whether it lies within the view frustum. Models that
+cannot be seen are not blended at all. Nearby models are blended between
+key frames every frame; farther ones only change pose a few times between
+key frames, and distant ones snap to key frames, then to every other key
+frame. As each pose is kept by the model's working set, a model that does
+not change pose costs nothing to draw again.
+
+The number of vertices blended per frame is also kept within a budget.
+Each frame records how many vertices would be blended at each distance,
+and the next frame refuses blending beyond the distance at which the
+nearest models already use up the budget.
+*/
+class AnimationLOD {
+public:
+	/** Poses per key frame, for models blended at a few steps */
+	static const int STEPS = 4;
+	
+	/** Constructor */
+	AnimationLOD();
+	
+	/**
+	Sets the distances at which the detail drops
+	@param nearDistance Models within this distance are blended
+	       continuously
+	@param farDistance Models beyond this distance snap to key frames, and
+	       beyond twice this distance to every other key frame
+	@param budget Vertices that may be blended per frame, or zero for no
+	       limit
+	*/
+	void setParameters(float nearDistance, float farDistance, size_t budget);
+	
+	/**
+	Starts a new frame
+	@param eye Position of the camera
+	*/
+	void beginFrame(const vec3 &eye);
+	
+	/**
+	Chooses the detail to draw an animated model at, and records the
+	vertices it would blend against the budget of the following frame
+	@param center Center of the bounding sphere of the model
+	@param radius Radius of the bounding sphere of the model
+	@param vertices Vertices blended to draw the model between key frames
+	@param quantum Returns the step that the position between key frames
+	       is rounded to, in key frames: zero to blend continuously, one to
+	       snap to key frames, or two to snap to every other key frame
+	@return false if the model is outside the view and need not be drawn
+	*/
+	bool choose(const vec3 &center,
+	            float radius,
+	            size_t vertices,
+	            float &quantum);
+	
+	/** Gets the counters describing the models drawn */
+	inline const AnimationLODStatistics& getStatistics() const {
+		return statistics;
+	}
+	
+private:
+	/** Number of distance bands tracked for the budget */
+	static const int BANDS = 32;
+	
+	/** Gets the band of the budget histogram for a distance */
+	int getBand(float distance) const;
+	
+	/** Models within this distance are blended continuously */
+	float nearDistance;
+	
+	/** Models beyond this distance snap to key frames */
+	float farDistance;
+	
+	/** Vertices that may be blended per frame, or zero for no limit */
+	size_t budget;
+	
+	/** Position of the camera */
+	vec3 eye;
+	
+	/** Models beyond this distance are not blended during this frame */
+	float budgetDistance;
+	
+	/** Vertices asked to be blended during this frame, by distance */
+	size_t demand[BANDS];
+	
+	/** Counters describing the models drawn */
+	AnimationLODStatistics statistics;
+};
+
+#endif
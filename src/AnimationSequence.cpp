@@ -1,5 +1,7 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
 #include "AnimationSequence.h"
+#include "VertexBlend.h"
 
 AnimationSequence::AnimationSequence(const vector<KeyFrame> &_keyFrames,
                                      const string &name,
@@ -10,16 +12,15 @@ AnimationSequence::AnimationSequence(const vector<KeyFrame> &_keyFrames,
                                      float _fps)
 		: m_strName(name),
 		m_Priority(priority),
-		m_Time(0.0f),
-		m_TimeScalar(1.0f),
 		m_bLooping(looping),
-		fps(_fps),
-		m_bFinished(false) {
+		fps(_fps) {
 	keyFrames.reserve(length);
 	for (size_t i=0; i<length; ++i)
 		keyFrames.push_back(_keyFrames[start+i]);
 		
-	createWorkingSetOfMeshes(keyFrames[0].getMeshes());
+	ASSERT(!keyFrames.empty(), "no keyframes in the animation sequence");
+	
+	calculateBounds();
 }
 
 AnimationSequence::AnimationSequence(const vector<KeyFrame> &_keyFrames,
@@ -30,73 +31,54 @@ AnimationSequence::AnimationSequence(const vector<KeyFrame> &_keyFrames,
 		: keyFrames(_keyFrames),
 		m_strName(name),
 		m_Priority(priority),
-		m_Time(0.0f),
-		m_TimeScalar(1.0f),
 		m_bLooping(looping),
-		fps(_fps),
-		m_bFinished(false) {
-	createWorkingSetOfMeshes(keyFrames[0].getMeshes());
-}
-
-AnimationSequence::AnimationSequence(const AnimationSequence &animation)
-		: keyFrames(animation.keyFrames),
-		m_strName(animation.m_strName),
-		m_Priority(animation.m_Priority),
-		m_Time(animation.m_Time),
-		m_TimeScalar(animation.m_TimeScalar),
-		m_bLooping(animation.m_bLooping),
-		fps(animation.fps),
-		m_bFinished(animation.m_bFinished) {
-	createWorkingSetOfMeshes(animation.meshes);
-}
-
-AnimationSequence::~AnimationSequence() {
-	for (size_t i=0; i<meshes.size(); ++i) delete meshes[i];
-	meshes.clear();
+		fps(_fps) {
+	ASSERT(!keyFrames.empty(), "no keyframes in the animation sequence");
+	
+	calculateBounds();
 }
 
-void AnimationSequence::createWorkingSetOfMeshes(const vector<Mesh*> &model) {
-	for (vector<Mesh*>::const_iterator i=model.begin();
-	     i!=model.end();
-	     ++i) {
-		meshes.push_back(new Mesh(*i));
+void AnimationSequence::calculateBounds() {
+	bounds = BoundingVolume();
+	
+	for (vector<KeyFrame>::const_iterator i=keyFrames.begin();
+	     i!=keyFrames.end(); ++i) {
+		bounds.merge(i->getBounds());
 	}
 }
 
-void AnimationSequence::update(float millisecondsDelta) {
-	m_Time += millisecondsDelta * m_TimeScalar;
-	
-	// Loop the animation if it goes past the end
-	if (m_Time > getLength()) {
-		if (m_bLooping == true) {
-			while (m_Time > getLength()) m_Time -= getLength();
-			m_bFinished = false;
-		} else {
-			m_bFinished = true;
-			m_Time = getLength();
-		}
+void AnimationSequence::prepareWorkingSet(WorkingSet &workingSet) const {
+	const MeshSet &model = keyFrames[0].getMeshes();
+	MeshSet &meshes = workingSet.meshes;
+	
+	bool matches = meshes.size() == model.size();
+	
+	for (size_t i=0; matches && i<model.size(); ++i) {
+		matches = meshes[i]->vertexArray->getNumber() ==
+		          model[i]->vertexArray->getNumber();
 	}
-}
-
-void AnimationSequence::setTime(float Time) {
-	m_Time = Time;
-	m_bFinished = false;
-}
-
-float AnimationSequence::calculateRadius(function<float(Mesh *)> fn) const {
-	const vector<Mesh*> meshes = getFrame(0.0f);
 	
-	if (meshes.empty())
-		return 0.0f;
+	if (!matches) {
+		meshes.clear();
+		workingSet.lower = workingSet.upper = 0;
 		
-	vector<float> top(meshes.size());
-	transform(meshes.begin(), meshes.end(), top.begin(), fn);
-	sort(top.begin(), top.end(), greater<float>());
-	return top[0];
+		for (MeshSet::const_iterator i=model.begin(); i!=model.end(); ++i) {
+			meshes.push_back((*i)->createWorkingCopy());
+		}
+	}
+	
+	// A working set left by another animation of the model only needs the
+	// static buffers of this one
+	for (size_t i=0; i<model.size(); ++i) {
+		if (meshes[i]->indexArray != model[i]->indexArray) {
+			meshes[i]->shareStaticBuffers(*model[i]);
+		}
+	}
 }
 
-const vector<Mesh*>& AnimationSequence::getFrame(float milliseconds) const {
-	ASSERT(!keyFrames.empty(), "no keyframes in the animation sequence");
+const MeshSet& AnimationSequence::getFrame(float milliseconds,
+                                           WorkingSet &workingSet,
+                                           float quantum) const {
 	ASSERT(milliseconds>=0.0f, "Time is before beginning of the animation");
 	
 	if (keyFrames.size() == 1)
@@ -107,20 +89,19 @@ const vector<Mesh*>& AnimationSequence::getFrame(float milliseconds) const {
 	if (milliseconds > length)
 		milliseconds = length;
 		
-	const float frameOfAnimation = (milliseconds / length) * (keyFrames.size() - 1);
+	const float lastFrame = (float)(keyFrames.size() - 1);
+	float frameOfAnimation = (milliseconds / length) * lastFrame;
+	
+	// Round to the nearest pose allowed at this level of detail
+	if (quantum > 0.0f) {
+		frameOfAnimation = floor(frameOfAnimation / quantum + 0.5f) * quantum;
+		frameOfAnimation = min(frameOfAnimation, lastFrame);
+	}
+	
 	const size_t lowerFrame = (size_t)floor(frameOfAnimation);
 	const size_t upperFrame = (size_t)ceil(frameOfAnimation);
 	const float bias = frameOfAnimation - lowerFrame;
 	
-	return getFrame(lowerFrame, upperFrame, bias);
-}
-
-const vector<Mesh*>& AnimationSequence::getFrame(size_t lowerFrame, size_t upperFrame, float bias) const {
-	ASSERT(!keyFrames.empty(), "no keyframes in the animation sequence");
-	
-	if (keyFrames.size()==1)
-		return keyFrames[0].getMeshes();
-		
 	ASSERT(lowerFrame < keyFrames.size(), "lower keyframe out of range:" + sizet_to_string(lowerFrame));
 	ASSERT(upperFrame < keyFrames.size(), "upper keyframe out of range: "+ sizet_to_string(upperFrame));
 	ASSERT(bias >= 0.0f && bias <= 1.0f, "bias is out of range: " + ftos(bias));
@@ -128,51 +109,66 @@ const vector<Mesh*>& AnimationSequence::getFrame(size_t lowerFrame, size_t upper
 	if (lowerFrame == upperFrame)
 		return(keyFrames[lowerFrame].getMeshes());
 		
-	const vector<Mesh*> &meshesA = keyFrames[lowerFrame].getMeshes();
-	const vector<Mesh*> &meshesB = keyFrames[upperFrame].getMeshes();
+	const KeyFrame *lower = &keyFrames[lowerFrame];
+	const KeyFrame *upper = &keyFrames[upperFrame];
+	
+	if (workingSet.lower == lower &&
+	    workingSet.upper == upper &&
+	    workingSet.bias == bias) {
+		VertexBlend::countReusedFrame();
+		return workingSet.meshes;
+	}
+	
+	prepareWorkingSet(workingSet);
+	
+	const MeshSet &meshes = workingSet.meshes;
+	const MeshSet &meshesA = lower->getMeshes();
+	const MeshSet &meshesB = upper->getMeshes();
+	
+	const double begin = Thread::getMilliseconds();
+	size_t vertices = 0;
 	
 	for (size_t i=0; i<meshes.size(); ++i) {
-		Mesh*const mesh = meshes[i];
-		const Mesh*const a = meshesA[i];
-		const Mesh*const b = meshesB[i];
-		
-		interpolate(bias, *mesh, *a, *b);
+		meshes[i]->interpolate(bias, *meshesA[i], *meshesB[i]);
+		vertices += meshes[i]->vertexArray->getNumber();
 	}
 	
+	VertexBlend::countFrame(vertices, Thread::getMilliseconds() - begin);
+	
+	workingSet.lower = lower;
+	workingSet.upper = upper;
+	workingSet.bias = bias;
+	
 	return meshes;
 }
 
-float AnimationSequence::calculateHeight() const {
-	const vector<Mesh*> meshes = keyFrames[0].getMeshes();
+size_t AnimationSequence::getMemoryUsage() const {
+	return getFootprint().packed;
+}
+
+VertexFootprint AnimationSequence::getFootprint() const {
+	VertexFootprint footprint;
 	
-	if (meshes.empty())
-		return 0.0f;
+	for (vector<KeyFrame>::const_iterator i=keyFrames.begin();
+	     i!=keyFrames.end(); ++i) {
+		const MeshSet &m = i->getMeshes();
 		
-	vector<float> top(meshes.size());
-	transform(meshes.begin(), meshes.end(), top.begin(), bind(&Mesh::calculateHeight, _1));
-	sort(top.begin(), top.end(), greater<float>());
-	return top[0];
+		for (MeshSet::const_iterator j=m.begin(); j!=m.end(); ++j) {
+			footprint += (*j)->getFootprint();
+		}
+	}
+	
+	return footprint;
 }
 
-void AnimationSequence::getGeometryChunks( vector<GeometryChunk> &m ) const {
-	GeometryChunk gc;
-	const vector<Mesh*> &frame = getFrame();
+size_t AnimationSequence::getNumVertices() const {
+	const MeshSet &meshes = keyFrames[0].getMeshes();
 	
-	m.reserve(frame.size());
+	size_t vertices = 0;
 	
-	for (vector<Mesh*>::const_iterator i=frame.begin();
-	     i!=frame.end(); ++i) {
-		(*i)->getGeometryChunk(gc);
-		m.push_back(gc);
+	for (MeshSet::const_iterator i=meshes.begin(); i!=meshes.end(); ++i) {
+		vertices += (*i)->vertexArray->getNumber();
 	}
+	
+	return vertices;
 }
-
-void AnimationSequence::uniformScale( float scale ) {
-	for (vector<KeyFrame>::iterator i=keyFrames.begin();
-	     i!=keyFrames.end(); ++i) {
-		vector<Mesh*> &meshes = i->getMeshes();
-		for (vector<Mesh*>::iterator j=meshes.begin(); j!=meshes.end();++j) {
-			(*j)->uniformScale(scale);
-		}
-	}
-}
\ No newline at end of file
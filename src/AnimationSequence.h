@@ -5,12 +5,36 @@
 #include "Mesh.h"
 #include "KeyFrame.h"
 
-/** Records keyframe timing and arrangement for ana animation */
+/**
+Meshes that an instance of a model interpolates key frames into, along
+with the key frames and bias they last received. Asking for the same frame
+again, such as while the instance is paused or asleep, does not blend the
+key frames again.
+*/
+struct WorkingSet {
+	/** Meshes holding the interpolated frame */
+	MeshSet meshes;
+	
+	/** Key frames last interpolated into the meshes, or null for none */
+	const KeyFrame *lower, *upper;
+	
+	/** Interpolation bias last used */
+	float bias;
+	
+	/** Constructor creates an empty working set */
+	WorkingSet()
+			: lower(0),
+			upper(0),
+			bias(0.0f) {}
+};
+
+/**
+Records keyframe timing and arrangement for ana animation. The sequence is
+immutable once loaded and is shared by every instance of the model; the
+time into the animation is kept by each AnimationController instead.
+*/
 class AnimationSequence {
 public:
-	/** Destructor */
-	~AnimationSequence();
-	
 	/**
 	Loads the AnimationSequence from an XML source
 	@param keyFrames All keyframes in the mesh
@@ -47,12 +71,6 @@ public:
 	                  bool looping,
 	                  float fps);
 	                  
-	/**
-	Copy constructor
-	@param animation The animation to copy
-	*/
-	AnimationSequence(const AnimationSequence &animation);
-	
 	/** Gets the name of the animation */
 	inline const string& getName() const {
 		return m_strName;
@@ -63,11 +81,6 @@ public:
 		return m_Priority;
 	}
 	
-	/** Gets the current time into the animation */
-	inline float getTime() const {
-		return m_Time;
-	}
-	
 	/**
 	Gets the length of the animation in milliseconds
 	@return milliseconds
@@ -93,16 +106,6 @@ public:
 		return fps;
 	}
 	
-	/** Gets the time scalar of the animation */
-	inline float getSpeed() const {
-		return m_TimeScalar;
-	}
-	
-	/** Indicates whether or not the animation has finished yet */
-	inline bool isFinished() const {
-		return m_bFinished;
-	}
-	
 	/** Indicates whether or not the animation is looping */
 	inline bool isLooping() const {
 		return m_bLooping;
@@ -116,120 +119,80 @@ public:
 		return keyFrames.size();
 	}
 	
-	/** Get all the static meshes for this tick */
-	void getGeometryChunks(vector<GeometryChunk> &m) const;
-	
-	/**
-	Updates the animation
-	@param timeDelta The time elapsed since the last update
-	*/
-	void update(float timeDelta);
-	
-	/** Change the time into animation */
-	void setTime(float time);
-	
-	/** Change the speed of the animation */
-	inline void setSpeed(float timeScalar) {
-		m_TimeScalar = timeScalar;
+	/** Gets the key frames of the animation */
+	inline const vector<KeyFrame>& getKeyFrames() const {
+		return keyFrames;
 	}
 	
-	inline float calculateCylindricalRadius() const {
-		return calculateRadius(&Mesh::calculateCylindricalRadius);
-	}
-	
-	inline float calculateRadius() const {
-		return calculateRadius(&Mesh::calculateSphericalRadius);
-	}
-	
-	float calculateHeight() const;
-	
-	/** Creates a geometry object in ODE that uses this mesh's geometry */
-	tuple<dGeomID,dTriMeshDataID> createGeom(dSpaceID physicsSpace) const {
-		return meshes[0]->createGeom(physicsSpace);
-	}
-	
-	void uniformScale(float scale);
-	
-private:
 	/**
-	Calculates the radius of the mesh using the given radius calculation func.
-	(e.g. Cylindrical radius or spherical radius)
-	@param time Time (seconds) into the animation
-	@param fn
-	@return Radius of the mesh
+	Gets the meshes of the animation at the specified time
+	@param milliseconds The time into the animation
+	@param workingSet Meshes that key frames are interpolated into, when
+	       the time falls between two of them. These are created, or
+	       created again, when they do not match the key frames.
+	@param quantum Step, in key frames, that the position between key
+	       frames is rounded to (see AnimationLOD). Zero to blend at any
+	       position; one or more to draw key frames only.
+	@return Either the meshes of a key frame or the working set
 	*/
-	float calculateRadius(function<float(Mesh *)> fn) const;
+	const MeshSet& getFrame(float milliseconds,
+	                        WorkingSet &workingSet,
+	                        float quantum = 0.0f) const;
 	
 	/**
-	Copy the meshes to create a working set.
-	We assume all keyframes have the same number of meshes and each
-	   corresponding mesh is identical except in vertex placement
-	@param model keyframes meshes
+	Gets the bounds of every key frame of the animation together, which
+	enclose the model at any time into the animation. They are merged from
+	the bounds of the key frames as the animation is created.
 	*/
-	void createWorkingSetOfMeshes(const vector<Mesh*> &model);
+	inline const BoundingVolume& getBounds() const {
+		return bounds;
+	}
 	
 	/**
-	Gets the frame of animation for the specified time
-	@param millisecondsIntoAnimation The time into the animation
-	@return The frame of animation
+	Gets the memory used by the key frames
+	@return Size of the meshes, in bytes
 	*/
-	const vector<Mesh*>& getFrame(float millisecondsIntoAnimation) const;
+	size_t getMemoryUsage() const;
+	
+	/** Gets the memory used by the key frames, packed and unpacked */
+	VertexFootprint getFootprint() const;
 	
 	/**
-	Gets the frame of animation by interpolating between the given key frames
-	@param lowerFrame Index of the lower key frame
-	@param upperFrame Index of the upper key frame
-	@param bias 0.0 to 1.0 indicating the bias between the key frames
-	@return The frame of animation
-	*/
-	const vector<Mesh*>& getFrame(size_t lowerFrame,
-	                              size_t upperFrame,
-	                              float bias) const;
-	                              
-	/**
-	Gets the frame of animation for the current time
-	@return The frame of animation
+	Gets the number of vertices in each frame of the animation, which are
+	blended when drawing it between two key frames
+	@return Number of vertices
 	*/
-	inline const vector<Mesh*>& getFrame() const {
-		return getFrame(getTime());
-	}
+	size_t getNumVertices() const;
 	
-	static void interpolate(const float bias,
-	                        Mesh &o,
-	                        const Mesh &a,
-	                        const Mesh &b) {
-		o.interpolate(bias, a, b);
-	}
+private:
+	/** Merges the bounds of the key frames into the bounds of the animation */
+	void calculateBounds();
 	
-	/** A working copy of the mesh */
-	mutable vector<Mesh*> meshes;
+	/**
+	Prepares the working set to receive interpolated key frames.
+	We assume all keyframes have the same number of meshes and each
+	   corresponding mesh is identical except in vertex placement
+	@param workingSet Meshes to prepare
+	*/
+	void prepareWorkingSet(WorkingSet &workingSet) const;
 	
 	/** The key frames of the animation */
 	vector<KeyFrame> keyFrames;
 	
+	/** Bounds of every key frame together */
+	BoundingVolume bounds;
+	
 	/** The name of the animation */
 	string m_strName;
 	
 	/** Used for determining the chosen animation during request conflicts */
 	float m_Priority;
 	
-	/** Time into the animation (milliseconds) */
-	float m_Time;
-	
-	/** Multiply all Time Elapsed values by this to control animation speed */
-	float m_TimeScalar;
-	
 	/** Whether or not the animation loops at the end of the sequence. */
 	bool m_bLooping;
 	
 	/** base animation FPS */
 	float fps;
-	
-	/**
-	Flags whether the animation has been completed
-	If m_bLooping, then this is always false
-	*/
-	bool m_bFinished;
 };
 
 #endif
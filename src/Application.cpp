@@ -6,12 +6,24 @@
 #include "Application.h"
 #include "AnimationControllerFactory.h"
 #include "devil_wrapper.h"
+#include "VirtualFileSystem.h"
+#include "AssetLoader.h"
+#include "AssetCache.h"
+#include "ModelLoader.h"
+#include "ActorPrototypes.h"
+#include "BufferPool.h"
+#include "BufferBackendGL.h"
 
 shared_ptr<AnimationControllerFactory> g_ModelFactory;
 shared_ptr<Timer> g_FrameTimer;
+shared_ptr<AssetLoader> g_AssetLoader;
+shared_ptr<BufferPool> g_BufferPool;
 
 Application *g_Application = 0;
 
+/** Time, in milliseconds, that each tick may spend finishing asset loads */
+static const float ASSET_LOADER_BUDGET = 4.0f;
+
 /** @brief Application entry-point.
  *  @param argc The number of arguments in argv
  *  @param argv Argument vector
@@ -82,9 +94,14 @@ void Application::start() {
 //	FileName workingDirectory = getApplicationDirectory().append(FileName("../../"));
 //	setWorkingDirectory(workingDirectory);
 
+	initializeFileSystem();
+	initializeFileWatcher();
+	initializeAssetLoader();
+	initializeActorPrototypes();
 	SDL_Init(SDL_INIT_EVERYTHING);
 	dInitODE();
 	initializeRenderer();
+	initializeBufferPool();
 	initializeDevIL();
 	
 	initializeJoystickDevices();
@@ -99,6 +116,65 @@ void Application::start() {
 	TRACE("Application start-up completed");
 }
 
+void Application::initializeFileSystem() {
+	const FileName packFileName("data.pak");
+	
+	// Packed data is optional; without it, data is read from loose files
+	if (isFileOnDisk(packFileName)) {
+		VirtualFileSystem::mount(packFileName, FileName("data"));
+	}
+}
+
+void Application::initializeAssetLoader() {
+	// One thread reads files, and the remaining processors parse them
+	const size_t numProcessors = Thread::getNumProcessors();
+	const size_t numWorkers = max(numProcessors, (size_t)2) - 1;
+	
+	g_AssetLoader = shared_ptr<AssetLoader>(new AssetLoader(1, numWorkers));
+	TRACE("Asset loader started with " + sizet_to_string(numWorkers) + " workers");
+}
+
+void Application::initializeActorPrototypes() {
+	const size_t numErrors = ActorPrototypes::loadAll(FileName("data/actorDefs"));
+	
+	if (numErrors > 0) {
+		ERR("Actor templates have " + sizet_to_string(numErrors)
+		    + " schema errors; see above");
+	}
+}
+
+void Application::initializeFileWatcher() {
+#ifndef NDEBUG
+	// Release builds cache assets for good; debug builds reload edited files
+	fileWatcher.watch(FileName("data"));
+#endif
+}
+
+void Application::reloadChangedFiles() {
+	set<FileName> changed;
+	fileWatcher.poll(changed);
+	
+	for (set<FileName>::const_iterator i = changed.begin();
+	     i != changed.end();
+	     ++i) {
+		FileName fileName = *i;
+		
+		// A cooked bag stands in for its source file
+		if (fileName.getExtension() == ".bag") {
+			fileName = FileName(FileName::stripExtension(fileName.str()) + ".xml");
+		}
+		
+		TRACE("File changed: " + fileName.str());
+		
+		PropertyBag::invalidate(*i);
+		ActorPrototypes::invalidate(fileName);
+		ModelLoader::invalidate(fileName);
+		textureFactory.reload(fileName);
+		soundSystem->invalidate(fileName);
+		world->reloadMapIfChanged(fileName);
+	}
+}
+
 void Application::initializeDevIL() {
 	ilInit();
 	iluInit();
@@ -139,6 +215,7 @@ void Application::initializeJoystickDevices() {
 void Application::tick( float timeStep ) {
 	PROFILE("Total Tick");
 	
+	g_BufferPool->beginFrame();
 	updateScene(timeStep);
 	drawScene();
 	
@@ -149,8 +226,10 @@ void Application::tick( float timeStep ) {
 
 void Application::updateScene( float timeStep ) {
 	PROFILE("Update Scene");
+	reloadChangedFiles();
 	renderer->setupScene();
 	input->poll();
+	g_AssetLoader->update(ASSET_LOADER_BUDGET);
 	gameStateMachine->update(timeStep);
 	renderer->tick(timeStep);
 	kernel.update(timeStep);
@@ -199,6 +278,31 @@ void Application::destroy() {
 	kernel.destroy();
 	TRACE("Kernel has been shutdown");
 	
+	g_AssetLoader.reset();
+	TRACE("Asset loader has been shutdown");
+	
+	// Stop relaying messages to the subsystems released below
+	ScopedEventHandler::clear();
+	
+	/*
+	Meshes in the world and in the model cache hold pages of the buffer
+	pool, so release them before the pool, and release the pool while the
+	GL context still exists.
+	*/
+	gameStateMachine.reset();
+	
+	if (world) {
+		world->destroy();
+		world.reset();
+	}
+	TRACE("Game world has been released");
+	
+	ModelLoader::clearCache();
+	TRACE("Model cache has been cleared");
+	
+	g_BufferPool.reset();
+	TRACE("Buffer pool has been shutdown");
+	
 	soundSystem.reset();
 	TRACE("Sound subsystem has been shutdown");
 	
@@ -232,6 +336,12 @@ void Application::initializeRenderer() {
 	TRACE("Renderer initialized");
 }
 
+void Application::initializeBufferPool() {
+	shared_ptr<BufferBackend> backend(new BufferBackendGL());
+	g_BufferPool = shared_ptr<BufferPool>(new BufferPool(backend));
+	TRACE("Buffer pool initialized");
+}
+
 void Application::handleInputKeyPress(const InputKeyPress *input) {
 	switch (input->key) {
 	case SDLK_q: {
@@ -240,6 +350,10 @@ void Application::handleInputKeyPress(const InputKeyPress *input) {
 	}
 	break;
 	
+	case SDLK_F10:
+		TRACE("Resident assets:\n" + AssetCacheBase::dumpAll());
+		break;
+		
 	case SDLK_F11:
 		takeScreenShot("screen");
 		break;
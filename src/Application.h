@@ -14,6 +14,7 @@
 #include "Renderer.h"
 #include "ActionApplicationQuit.h"
 #include "ProfileScope.h"
+#include "FileWatcher.h"
 
 #include "GLFT_Font.hpp"
 
@@ -65,9 +66,27 @@ private:
 	/** Start DevIL */
 	void initializeDevIL();
 	
+	/** Mounts the pack files of game data, if there are any */
+	void initializeFileSystem();
+	
+	/** Starts the threads that load assets in the background */
+	void initializeAssetLoader();
+	
+	/** Loads every actor template, reporting all schema errors up front */
+	void initializeActorPrototypes();
+	
+	/** Starts watching the game data for changes, in debug builds */
+	void initializeFileWatcher();
+	
+	/** Reloads the assets whose files have changed since the last tick */
+	void reloadChangedFiles();
+	
 	/** Start OpenGL */
 	void initializeRenderer();
 	
+	/** Creates the pool of buffer objects that meshes are stored in */
+	void initializeBufferPool();
+	
 	/** Closes all joysticks */
 	void closeJoysticks();
 	
@@ -118,6 +137,7 @@ private:
 	TextureFactory textureFactory;
 	shared_ptr<Renderer> renderer;
 	shared_ptr<World> world;
+	FileWatcher fileWatcher;
 };
 
 #endif
@@ -0,0 +1,82 @@
+#include "Core.h"
+#include "AssetCache.h"
+
+AssetCacheBase::~AssetCacheBase() {
+	MutexLock lock(getCachesMutex());
+	getCaches().remove(this);
+}
+
+AssetCacheBase::AssetCacheBase(const string &_name, size_t _budget)
+		: budget(_budget),
+		residentSize(0),
+		uses(0),
+		name(_name) {
+	MutexLock lock(getCachesMutex());
+	getCaches().push_back(this);
+}
+
+size_t AssetCacheBase::getBudget() const {
+	MutexLock lock(mutex);
+	return budget;
+}
+
+void AssetCacheBase::setBudget(size_t _budget) {
+	{
+		MutexLock lock(mutex);
+		budget = _budget;
+	}
+	
+	trim();
+}
+
+size_t AssetCacheBase::getResidentSize() const {
+	MutexLock lock(mutex);
+	return residentSize;
+}
+
+string AssetCacheBase::describe() const {
+	return name + ": " + sizet_to_string(residentSize)
+	       + " of " + sizet_to_string(budget) + " bytes resident";
+}
+
+void AssetCacheBase::trimAll() {
+	MutexLock lock(getCachesMutex());
+	for_each(getCaches().begin(), getCaches().end(), bind(&AssetCacheBase::trim, _1));
+}
+
+string AssetCacheBase::dumpAll() {
+	MutexLock lock(getCachesMutex());
+	string s;
+	
+	for (list<AssetCacheBase*>::const_iterator i = getCaches().begin();
+	     i != getCaches().end();
+	     ++i) {
+		s += (*i)->dump();
+	}
+	
+	return s;
+}
+
+string AssetCacheBase::summarizeAll() {
+	MutexLock lock(getCachesMutex());
+	string s;
+	
+	for (list<AssetCacheBase*>::const_iterator i = getCaches().begin();
+	     i != getCaches().end();
+	     ++i) {
+		MutexLock cacheLock((*i)->mutex);
+		s += (*i)->describe() + "\n";
+	}
+	
+	return s;
+}
+
+list<AssetCacheBase*>& AssetCacheBase::getCaches() {
+	static list<AssetCacheBase*> caches;
+	return caches;
+}
+
+Mutex& AssetCacheBase::getCachesMutex() {
+	static Mutex mutex;
+	return mutex;
+}
@@ -0,0 +1,276 @@
+#ifndef _ASSET_CACHE_H_
+#define _ASSET_CACHE_H_
+
+#include "Thread.h"
+
+/**
+Category of cached assets with a memory budget.
+
+Assets are shared through reference counted handles. The cache keeps one
+reference to each resident asset, so an asset that nothing else references
+is merely unreferenced, and stays resident until its category goes over
+budget; then unreferenced assets are evicted, least recently used first.
+Assets in use are never evicted, so a category may exceed its budget for as
+long as they are held.
+
+Every cache registers itself so that all categories may be trimmed and
+reported on together.
+*/
+class AssetCacheBase {
+public:
+	/** Destructor */
+	virtual ~AssetCacheBase();
+	
+	/**
+	Constructor
+	@param name Name of the category of assets
+	@param budget Number of bytes that may stay resident
+	*/
+	AssetCacheBase(const string &name, size_t budget);
+	
+	/** Gets the name of the category */
+	inline const string& getName() const {
+		return name;
+	}
+	
+	/** Gets the number of bytes that may stay resident */
+	size_t getBudget() const;
+	
+	/**
+	Changes the budget, evicting assets if the category is now over budget
+	@param budget Number of bytes that may stay resident
+	*/
+	void setBudget(size_t budget);
+	
+	/** Gets the number of bytes resident */
+	size_t getResidentSize() const;
+	
+	/** Gets the number of assets resident */
+	virtual size_t getNumResident() const = 0;
+	
+	/** Evicts unreferenced assets until the category is within its budget */
+	virtual void trim() = 0;
+	
+	/**
+	Describes the resident assets
+	@return One line for the category, then one line for each asset
+	*/
+	virtual string dump() const = 0;
+	
+	/** Trims every category */
+	static void trimAll();
+	
+	/** Describes the resident assets of every category */
+	static string dumpAll();
+	
+	/** Describes every category, without listing its assets */
+	static string summarizeAll();
+	
+protected:
+	/** Describes the category, without its assets; the caller holds the mutex */
+	string describe() const;
+	
+	/** Guards the cache */
+	mutable Mutex mutex;
+	
+	/** Number of bytes that may stay resident */
+	size_t budget;
+	
+	/** Number of bytes resident */
+	size_t residentSize;
+	
+	/** Counts uses of assets, to order them from least recently used */
+	unsigned int uses;
+	
+private:
+	AssetCacheBase(const AssetCacheBase&);
+	AssetCacheBase& operator=(const AssetCacheBase&);
+	
+	/**
+	Gets the registered caches.
+	Caches are static objects, so the list is first used, and constructed,
+	during static initialization.
+	*/
+	static list<AssetCacheBase*>& getCaches();
+	
+	/** Guards the list of caches; constructed along with the list */
+	static Mutex& getCachesMutex();
+	
+	/** Name of the category of assets */
+	string name;
+};
+
+/** Cache of one type of asset */
+template<typename T>
+class AssetCache : public AssetCacheBase {
+public:
+	/** Reference counted handle to an asset */
+	typedef shared_ptr<T> Handle;
+	
+	/**
+	Constructor
+	@param name Name of the category of assets
+	@param budget Number of bytes that may stay resident
+	*/
+	AssetCache(const string &name, size_t budget)
+			: AssetCacheBase(name, budget) {}
+	
+	/**
+	Gets a resident asset, marking it as recently used
+	@param fileName File the asset was loaded from
+	@return The asset, or null if it is not resident
+	*/
+	Handle find(const FileName &fileName) {
+		MutexLock lock(mutex);
+		typename map<FileName, Entry>::iterator i = entries.find(fileName);
+		
+		if (i == entries.end()) {
+			return Handle();
+		}
+		
+		i->second.lastUse = ++uses;
+		return i->second.asset;
+	}
+	
+	/**
+	Makes an asset resident, replacing any asset already cached under the
+	same name, and trims the category
+	@param fileName File the asset was loaded from
+	@param asset Asset to cache
+	@param size Number of bytes used by the asset
+	@return The asset
+	*/
+	Handle insert(const FileName &fileName, const Handle &asset, size_t size) {
+		ASSERT(asset, "Null asset: " + fileName.str());
+		
+		{
+			MutexLock lock(mutex);
+			Entry &entry = entries[fileName];
+			residentSize = residentSize - entry.size + size;
+			entry.asset = asset;
+			entry.size = size;
+			entry.lastUse = ++uses;
+		}
+		
+		trim();
+		
+		return asset;
+	}
+	
+	/**
+	Drops the cache's reference to an asset
+	@param fileName File the asset was loaded from
+	*/
+	void remove(const FileName &fileName) {
+		Handle evicted; // released once the lock is dropped
+		MutexLock lock(mutex);
+		typename map<FileName, Entry>::iterator i = entries.find(fileName);
+		
+		if (i != entries.end()) {
+			evicted = i->second.asset;
+			residentSize -= i->second.size;
+			entries.erase(i);
+		}
+	}
+	
+	/**
+	Drops the cache's references to all assets loaded from a directory
+	@param directory Directory, as returned by FileName::getPath
+	*/
+	void removeInDirectory(const FileName &directory) {
+		vector<Handle> evicted; // released once the lock is dropped
+		MutexLock lock(mutex);
+		typename map<FileName, Entry>::iterator i = entries.begin();
+		
+		while (i != entries.end()) {
+			if (i->first.getPath() == directory) {
+				evicted.push_back(i->second.asset);
+				residentSize -= i->second.size;
+				entries.erase(i++);
+			} else {
+				++i;
+			}
+		}
+	}
+	
+	/** Drops the cache's references to all assets */
+	void clear() {
+		map<FileName, Entry> evicted; // released once the lock is dropped
+		MutexLock lock(mutex);
+		evicted.swap(entries);
+		residentSize = 0;
+	}
+	
+	virtual size_t getNumResident() const {
+		MutexLock lock(mutex);
+		return entries.size();
+	}
+	
+	virtual void trim() {
+		vector<Handle> evicted; // released once the lock is dropped
+		MutexLock lock(mutex);
+		
+		/*
+		A linear search for each eviction is fine, as each category holds at
+		most a few hundred assets and trimming only happens on a load.
+		*/
+		while (residentSize > budget) {
+			typename map<FileName, Entry>::iterator victim = entries.end();
+			
+			for (typename map<FileName, Entry>::iterator i = entries.begin();
+			     i != entries.end();
+			     ++i) {
+				if (i->second.asset.unique() &&
+				    (victim == entries.end() ||
+				     i->second.lastUse < victim->second.lastUse)) {
+					victim = i;
+				}
+			}
+			
+			if (victim == entries.end()) {
+				break; // everything left is in use
+			}
+			
+			evicted.push_back(victim->second.asset);
+			residentSize -= victim->second.size;
+			entries.erase(victim);
+		}
+	}
+	
+	virtual string dump() const {
+		MutexLock lock(mutex);
+		string s = describe() + "\n";
+		
+		for (typename map<FileName, Entry>::const_iterator i = entries.begin();
+		     i != entries.end();
+		     ++i) {
+			const long references = i->second.asset.use_count() - 1;
+			
+			s += "\t" + i->first.str()
+			     + ": " + sizet_to_string(i->second.size) + " bytes, "
+			     + itos((int)references) + " references\n";
+		}
+		
+		return s;
+	}
+	
+private:
+	/** Resident asset */
+	struct Entry {
+		Entry() : size(0), lastUse(0) {}
+		
+		/** The cache's reference to the asset */
+		Handle asset;
+		
+		/** Number of bytes used by the asset */
+		size_t size;
+		
+		/** Value of the use counter at the last use of the asset */
+		unsigned int lastUse;
+	};
+	
+	/** Resident assets */
+	map<FileName, Entry> entries;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "Core.h"
+#include "AssetLoader.h"
+
+AssetLoader::~AssetLoader() {
+	// The pools finish their queued work as they are destroyed
+}
+
+AssetLoader::AssetLoader(size_t numIOThreads,
+                         size_t numWorkerThreads,
+                         bool _uploads)
+		: uploads(_uploads),
+		numPending(0),
+		workers(numWorkerThreads),
+		ioThreads(numIOThreads) {}
+
+void AssetLoader::load(const shared_ptr<AssetRequest> &request,
+                       const AssetRequest::Callback &callback) {
+	ASSERT(request, "Null request");
+	ASSERT(request->getState() == AssetRequest::REQUEST_PENDING,
+	       "Request has already been loaded: " + request->getFileName().str());
+	
+	request->callback = callback;
+	
+	{
+		MutexLock lock(mutex);
+		numPending++;
+	}
+	
+	ioThreads.add(bind(&AssetLoader::read, this, request));
+}
+
+void AssetLoader::read(shared_ptr<AssetRequest> request) {
+	if (request->read()) {
+		request->setState(AssetRequest::REQUEST_PARSING);
+		workers.add(bind(&AssetLoader::parse, this, request));
+	} else {
+		request->setState(AssetRequest::REQUEST_FAILED);
+		queueForMainThread(request);
+	}
+}
+
+void AssetLoader::parse(shared_ptr<AssetRequest> request) {
+	const bool ok = request->parse();
+	request->setState(ok ? AssetRequest::REQUEST_FINALIZING
+	                  : AssetRequest::REQUEST_FAILED);
+	queueForMainThread(request);
+}
+
+void AssetLoader::queueForMainThread(const shared_ptr<AssetRequest> &request) {
+	{
+		MutexLock lock(mutex);
+		ready.push_back(request);
+	}
+	
+	readySignal.post();
+}
+
+bool AssetLoader::finalizeNext() {
+	shared_ptr<AssetRequest> request;
+	
+	{
+		MutexLock lock(mutex);
+		
+		if (ready.empty()) {
+			return false;
+		}
+		
+		request = ready.front();
+		ready.pop_front();
+	}
+	
+	if (request->getState() == AssetRequest::REQUEST_FINALIZING) {
+		const bool ok = request->finalize(uploads);
+		request->setState(ok ? AssetRequest::REQUEST_COMPLETE
+		                  : AssetRequest::REQUEST_FAILED);
+	}
+	
+	request->file.close();
+	
+	if (!request->succeeded()) {
+		ERR("Failed to load asset: " + request->getFileName().str());
+	}
+	
+	{
+		MutexLock lock(mutex);
+		numPending--;
+	}
+	
+	if (request->callback) {
+		request->callback(*request);
+	}
+	
+	return true;
+}
+
+void AssetLoader::update(float budget) {
+	const double deadline = Thread::getMilliseconds() + budget;
+	
+	while (finalizeNext() && Thread::getMilliseconds() < deadline);
+}
+
+void AssetLoader::wait(const shared_ptr<AssetRequest> &request) {
+	ASSERT(request, "Null request");
+	
+	while (!request->isDone()) {
+		if (!finalizeNext()) {
+			readySignal.wait();
+		}
+	}
+}
+
+size_t AssetLoader::getNumPending() const {
+	MutexLock lock(mutex);
+	return numPending;
+}
@@ -0,0 +1,117 @@
+#ifndef _ASSET_LOADER_H_
+#define _ASSET_LOADER_H_
+
+#include "AssetRequest.h"
+#include "ThreadPool.h"
+
+/**
+Loads assets in the background.
+
+Requests are read by a pool of I/O threads and parsed by a pool of worker
+threads, and then wait for the main thread to finish them in update(),
+which is given a time budget so that a burst of loads cannot stall a frame.
+Callbacks are always called on the main thread, from update() or wait().
+
+A loader created without uploads skips everything that would go to the
+graphics or sound device, so that loading can be exercised headless.
+*/
+class AssetLoader {
+public:
+	/** Finishes reading and parsing the queued requests, then stops */
+	~AssetLoader();
+	
+	/**
+	Constructor
+	@param numIOThreads Number of threads reading files
+	@param numWorkerThreads Number of threads parsing assets
+	@param uploads If false, requests never upload to the graphics or
+	       sound device
+	*/
+	AssetLoader(size_t numIOThreads, size_t numWorkerThreads, bool uploads = true);
+	
+	/**
+	Starts loading an asset
+	@param request Asset to load; it must not have been loaded before
+	@param callback Called on the main thread once the request is done
+	*/
+	void load(const shared_ptr<AssetRequest> &request,
+	          const AssetRequest::Callback &callback = AssetRequest::Callback());
+	
+	/**
+	Finishes requests that have been read and parsed, on the main thread.
+	At least one waiting request is finished on each call.
+	@param budget Time, in milliseconds, after which to stop finishing
+	       requests until the next call
+	*/
+	void update(float budget);
+	
+	/**
+	Blocks until a request is done, finishing requests on the calling
+	thread, which must be the main thread, as they become ready
+	@param request Request to wait for
+	*/
+	void wait(const shared_ptr<AssetRequest> &request);
+	
+	/** Gets the number of requests that are not yet done */
+	size_t getNumPending() const;
+	
+	/** Determines whether requests may upload to the devices */
+	inline bool areUploadsEnabled() const {
+		return uploads;
+	}
+	
+	/**
+	Lends the worker threads to CPU work that the main thread waits on,
+	such as building a map. Such work must not wait on the loader itself.
+	*/
+	inline ThreadPool& getWorkers() {
+		return workers;
+	}
+	
+private:
+	AssetLoader(const AssetLoader&);
+	AssetLoader& operator=(const AssetLoader&);
+	
+	/** Runs the I/O stage of a request */
+	void read(shared_ptr<AssetRequest> request);
+	
+	/** Runs the CPU stage of a request */
+	void parse(shared_ptr<AssetRequest> request);
+	
+	/** Hands a request over to the main thread */
+	void queueForMainThread(const shared_ptr<AssetRequest> &request);
+	
+	/**
+	Runs the main thread stage of the next request waiting for it
+	@return false if no request was waiting
+	*/
+	bool finalizeNext();
+	
+	/** Indicates that requests may upload to the devices */
+	bool uploads;
+	
+	/** Guards the members below */
+	mutable Mutex mutex;
+	
+	/** Requests waiting for the main thread */
+	deque<shared_ptr<AssetRequest> > ready;
+	
+	/** Number of requests that are not yet done */
+	size_t numPending;
+	
+	/** Signalled whenever a request is handed to the main thread */
+	Semaphore readySignal;
+	
+	/*
+	Pools are destroyed in reverse order, and the I/O threads feed the
+	workers, so the workers must be declared first.
+	*/
+	
+	/** Threads that parse assets */
+	ThreadPool workers;
+	
+	/** Threads that read files */
+	ThreadPool ioThreads;
+};
+
+#endif
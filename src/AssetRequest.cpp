@@ -0,0 +1,24 @@
+#include "Core.h"
+#include "AssetRequest.h"
+
+bool AssetRequest::read() {
+	if (!file.open(fileName)) {
+		ERR("Failed to open file: " + fileName.str());
+		return false;
+	}
+	
+	// Fault in every page of a mapped file now, rather than during parsing
+	const size_t PAGE_SIZE = 4096;
+	const U8 *data = file.getData();
+	volatile U8 sum = 0;
+	
+	for (size_t i=0; i<file.getSize(); i+=PAGE_SIZE) {
+		sum += data[i];
+	}
+	
+	return true;
+}
+
+bool AssetRequest::finalize(bool) {
+	return true;
+}
@@ -0,0 +1,115 @@
+#ifndef _ASSET_REQUEST_H_
+#define _ASSET_REQUEST_H_
+
+#include "FileMapping.h"
+#include "Thread.h"
+
+/**
+Asset being loaded by an AssetLoader.
+
+Loading passes through three stages. The file is read on an I/O thread,
+then parsed (decoded, built into meshes and so on) on a worker thread, and
+finally finished on the main thread, which is the only thread that may touch
+OpenGL or the sound device. Subclasses implement the stages for each kind of
+asset. The request itself serves as the handle to the asset: the game may
+poll its state, or pass a callback to the loader to be told of completion.
+*/
+class AssetRequest {
+public:
+	/** Progress of a request */
+	enum State {
+		REQUEST_PENDING,    // Waiting to be read
+		REQUEST_PARSING,    // Read, waiting to be parsed
+		REQUEST_FINALIZING, // Parsed, waiting for the main thread
+		REQUEST_COMPLETE,   // Loaded successfully
+		REQUEST_FAILED      // Failed to load
+	};
+	
+	/** Called on the main thread once a request is complete or failed */
+	typedef function<void (AssetRequest &request)> Callback;
+	
+	/** Destructor */
+	virtual ~AssetRequest() {}
+	
+	/**
+	Constructor
+	@param fileName File to load
+	*/
+	AssetRequest(const FileName &_fileName)
+			: fileName(_fileName),
+			state(REQUEST_PENDING) {}
+	
+	/** Gets the file being loaded */
+	inline const FileName& getFileName() const {
+		return fileName;
+	}
+	
+	/** Gets the progress of the request */
+	State getState() const {
+		MutexLock lock(mutex);
+		return state;
+	}
+	
+	/** Determines whether the request has finished, successfully or not */
+	bool isDone() const {
+		const State s = getState();
+		return s == REQUEST_COMPLETE || s == REQUEST_FAILED;
+	}
+	
+	/** Determines whether the asset was loaded successfully */
+	bool succeeded() const {
+		return getState() == REQUEST_COMPLETE;
+	}
+	
+protected:
+	/**
+	I/O stage, run on an I/O thread. By default, opens the file and reads
+	every page of it, so that the worker does not stall on the disk.
+	@return true if successful
+	*/
+	virtual bool read();
+	
+	/**
+	CPU stage, run on a worker thread once the file has been read
+	@return true if successful
+	*/
+	virtual bool parse() = 0;
+	
+	/**
+	Main thread stage, for work such as OpenGL uploads. By default, does
+	nothing.
+	@param uploads If false, nothing may be sent to the graphics or sound
+	       device, as the loader is running headless
+	@return true if successful
+	*/
+	virtual bool finalize(bool uploads);
+	
+	/** Contents of the file, from the I/O stage until the end of finalizing */
+	FileMapping file;
+	
+private:
+	friend class AssetLoader;
+	
+	AssetRequest(const AssetRequest&);
+	AssetRequest& operator=(const AssetRequest&);
+	
+	/** Changes the progress of the request */
+	void setState(State s) {
+		MutexLock lock(mutex);
+		state = s;
+	}
+	
+	/** File to load */
+	FileName fileName;
+	
+	/** Progress of the request */
+	State state;
+	
+	/** Called once the request is complete or failed */
+	Callback callback;
+	
+	/** Guards the state */
+	mutable Mutex mutex;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#include "Core.h"
+#include "AssetRequestPropertyBag.h"
+#include "PropertyBagBinary.h"
+#include "PropertyBagParser.h"
+
+AssetRequestPropertyBag::AssetRequestPropertyBag(const FileName &fileName)
+		: AssetRequest(fileName),
+		cooked(false) {}
+
+bool AssetRequestPropertyBag::read() {
+	cooked = PropertyBagBinary::isCookedFileUsable(getFileName());
+	
+	const FileName fileName = cooked
+	                          ? PropertyBagBinary::getCookedFileName(getFileName())
+	                          : getFileName();
+	
+	if (!file.open(fileName)) {
+		ERR("Failed to open file: " + fileName.str());
+		return false;
+	}
+	
+	return true;
+}
+
+bool AssetRequestPropertyBag::parse() {
+	if (cooked) {
+		return PropertyBagBinary::load(file.getData(), file.getSize(), bag);
+	} else {
+		return PropertyBagParser::parse(file.begin(), file.end(), bag);
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef _ASSET_REQUEST_PROPERTY_BAG_H_
+#define _ASSET_REQUEST_PROPERTY_BAG_H_
+
+#include "AssetRequest.h"
+#include "PropertyBag.h"
+
+/**
+Loads a property bag file in the background, preferring the cooked form of
+the file as PropertyBag::loadFromFile does
+*/
+class AssetRequestPropertyBag : public AssetRequest {
+public:
+	/**
+	Constructor
+	@param fileName Source XML file to load
+	*/
+	AssetRequestPropertyBag(const FileName &fileName);
+	
+	/** Gets the loaded bag, once the request is complete */
+	inline const PropertyBag& getBag() const {
+		return bag;
+	}
+	
+protected:
+	virtual bool read();
+	virtual bool parse();
+	
+private:
+	/** Indicates that the cooked file is being loaded */
+	bool cooked;
+	
+	/** Loaded bag */
+	PropertyBag bag;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#include "stdafx.h"
+#include "AssetRequestSound.h"
+#include "SoundSystem.h"
+
+AssetRequestSound::AssetRequestSound(SoundSystem *_soundSystem,
+                                     const FileName &fileName)
+		: AssetRequest(fileName),
+		soundSystem(_soundSystem) {
+	ASSERT(soundSystem, "Null parameter: soundSystem");
+}
+
+bool AssetRequestSound::parse() {
+	return file.isOpen();
+}
+
+bool AssetRequestSound::finalize(bool uploads) {
+	if (uploads) {
+		return soundSystem->cacheSample(getFileName(), file) != 0;
+	}
+	
+	return true;
+}
@@ -0,0 +1,30 @@
+#ifndef _ASSET_REQUEST_SOUND_H_
+#define _ASSET_REQUEST_SOUND_H_
+
+#include "AssetRequest.h"
+
+class SoundSystem;
+
+/**
+Reads a sound file in the background. FMOD may only be used from the main
+thread, so the sample is decoded and cached there, from memory.
+*/
+class AssetRequestSound : public AssetRequest {
+public:
+	/**
+	Constructor
+	@param soundSystem Sound system to cache the sample in
+	@param fileName Sound file to load
+	*/
+	AssetRequestSound(SoundSystem *soundSystem, const FileName &fileName);
+	
+protected:
+	virtual bool parse();
+	virtual bool finalize(bool uploads);
+	
+private:
+	/** Sound system to cache the sample in */
+	SoundSystem *soundSystem;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "stdafx.h"
+#include "AssetRequestTexture.h"
+#include "devil_wrapper.h"
+
+AssetRequestTexture::AssetRequestTexture(TextureFactory *_factory,
+                                         const TextureFactory::HandlePtr &_handle,
+                                         bool _repeat)
+		: AssetRequest(_handle->getFileName()),
+		factory(_factory),
+		handle(_handle),
+		repeat(_repeat),
+		width(0),
+		height(0),
+		bytesPerPixel(0) {}
+
+bool AssetRequestTexture::parse() {
+	// DevIL has a single current image, so decoding is serialized
+	MutexLock lock(devil_getMutex());
+	
+	unsigned int imageName = devil_loadImage(getFileName(),
+	                                         file.getData(),
+	                                         file.getSize());
+	
+	width = ilGetInteger(IL_IMAGE_WIDTH);
+	height = ilGetInteger(IL_IMAGE_HEIGHT);
+	bytesPerPixel = ilGetInteger(IL_IMAGE_BYTES_PER_PIXEL);
+	
+	const unsigned char *data = ilGetData();
+	
+	if (data) {
+		pixels.assign(data, data + width*height*bytesPerPixel);
+	}
+	
+	ilDeleteImages(1, &imageName);
+	
+	return !pixels.empty();
+}
+
+bool AssetRequestTexture::finalize(bool uploads) {
+	if (uploads) {
+		handle->id = TextureFactory::uploadTexture(&pixels[0],
+		                                           width,
+		                                           height,
+		                                           bytesPerPixel,
+		                                           repeat);
+		                                           
+		// Now that the size of the texture is known, account for it
+		factory->textures.insert(getFileName(),
+		                         handle,
+		                         TextureFactory::getTextureSize(width,
+		                                                        height,
+		                                                        bytesPerPixel));
+	}
+	
+	pixels.clear();
+	
+	return true;
+}
@@ -0,0 +1,51 @@
+#ifndef _ASSET_REQUEST_TEXTURE_H_
+#define _ASSET_REQUEST_TEXTURE_H_
+
+#include "AssetRequest.h"
+#include "TextureFactory.h"
+
+/**
+Loads a texture in the background. The image is decoded on a worker thread
+and uploaded to OpenGL on the main thread, after which the texture handle
+refers to the new texture.
+*/
+class AssetRequestTexture : public AssetRequest {
+public:
+	/**
+	Constructor
+	@param factory Factory whose cache holds the texture
+	@param handle Handle to receive the texture
+	@param repeat Indicates that we want GL_REPEAT, as opposed to GL_CLAMP
+	*/
+	AssetRequestTexture(TextureFactory *factory,
+	                    const TextureFactory::HandlePtr &handle,
+	                    bool repeat);
+	
+protected:
+	virtual bool parse();
+	virtual bool finalize(bool uploads);
+	
+private:
+	/** Factory whose cache holds the texture */
+	TextureFactory *factory;
+	
+	/** Handle to receive the texture */
+	TextureFactory::HandlePtr handle;
+	
+	/** Indicates that we want GL_REPEAT, as opposed to GL_CLAMP */
+	bool repeat;
+	
+	/** Decoded pixels */
+	vector<unsigned char> pixels;
+	
+	/** Width of the decoded image */
+	int width;
+	
+	/** Height of the decoded image */
+	int height;
+	
+	/** Bytes per pixel of the decoded image */
+	int bytesPerPixel;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "Core.h"
+#include "BoundingVolume.h"
+
+const float BoundingVolume::TOLERANCE = 1.0f / 4096.0f;
+
+BoundingVolume::BoundingVolume()
+		: empty(true),
+		minimum(0.0f, 0.0f, 0.0f),
+		maximum(0.0f, 0.0f, 0.0f),
+		sphereCenter(0.0f, 0.0f, 0.0f),
+		sphereRadius(0.0f),
+		radius(0.0f),
+		cylindricalRadius(0.0f) {}
+
+BoundingVolume::BoundingVolume(const vec3 *points, int count)
+		: empty(count <= 0),
+		minimum(0.0f, 0.0f, 0.0f),
+		maximum(0.0f, 0.0f, 0.0f),
+		sphereCenter(0.0f, 0.0f, 0.0f),
+		sphereRadius(0.0f),
+		radius(0.0f),
+		cylindricalRadius(0.0f) {
+	if (empty) {
+		return;
+	}
+	
+	minimum = maximum = points[0];
+	
+	float radiusSqr = 0.0f;
+	float cylindricalRadiusSqr = 0.0f;
+	
+	for (int i=0; i<count; ++i) {
+		const vec3 &p = points[i];
+		
+		minimum = vec3(min(minimum.x, p.x), min(minimum.y, p.y), min(minimum.z, p.z));
+		maximum = vec3(max(maximum.x, p.x), max(maximum.y, p.y), max(maximum.z, p.z));
+		
+		radiusSqr = max(radiusSqr, p.getMagnitudeSqr());
+		cylindricalRadiusSqr = max(cylindricalRadiusSqr, p.x*p.x + p.y*p.y);
+	}
+	
+	radius = sqrtf(radiusSqr);
+	cylindricalRadius = sqrtf(cylindricalRadiusSqr);
+	
+	// The sphere about the center of the box is not the smallest, but it is
+	// found in one more pass and is rarely much larger
+	sphereCenter = (minimum + maximum) * 0.5f;
+	
+	float sphereRadiusSqr = 0.0f;
+	
+	for (int i=0; i<count; ++i) {
+		sphereRadiusSqr = max(sphereRadiusSqr, sphereCenter.distanceSqr(points[i]));
+	}
+	
+	sphereRadius = sqrtf(sphereRadiusSqr);
+}
+
+BoundingVolume::BoundingVolume(const vec3 &_minimum,
+                               const vec3 &_maximum,
+                               const vec3 &_sphereCenter,
+                               float _sphereRadius,
+                               float _radius,
+                               float _cylindricalRadius)
+		: empty(false),
+		minimum(_minimum),
+		maximum(_maximum),
+		sphereCenter(_sphereCenter),
+		sphereRadius(_sphereRadius),
+		radius(_radius),
+		cylindricalRadius(_cylindricalRadius) {}
+
+void BoundingVolume::merge(const BoundingVolume &bounds) {
+	if (bounds.empty) {
+		return;
+	}
+	
+	if (empty) {
+		*this = bounds;
+		return;
+	}
+	
+	minimum = vec3(min(minimum.x, bounds.minimum.x),
+	               min(minimum.y, bounds.minimum.y),
+	               min(minimum.z, bounds.minimum.z));
+	maximum = vec3(max(maximum.x, bounds.maximum.x),
+	               max(maximum.y, bounds.maximum.y),
+	               max(maximum.z, bounds.maximum.z));
+	
+	radius = max(radius, bounds.radius);
+	cylindricalRadius = max(cylindricalRadius, bounds.cylindricalRadius);
+	
+	// Smallest sphere enclosing both spheres
+	const float distance = sphereCenter.distance(bounds.sphereCenter);
+	
+	if (distance + bounds.sphereRadius <= sphereRadius) {
+		return;
+	} else if (distance + sphereRadius <= bounds.sphereRadius) {
+		sphereCenter = bounds.sphereCenter;
+		sphereRadius = bounds.sphereRadius;
+	} else {
+		const float mergedRadius = (distance + sphereRadius + bounds.sphereRadius) * 0.5f;
+		const float shift = (mergedRadius - sphereRadius) / distance;
+		
+		sphereCenter = sphereCenter + (bounds.sphereCenter - sphereCenter) * shift;
+		sphereRadius = mergedRadius;
+	}
+}
+
+bool BoundingVolume::isValid() const {
+	return empty ||
+	       (minimum.x <= maximum.x &&
+	        minimum.y <= maximum.y &&
+	        minimum.z <= maximum.z &&
+	        sphereRadius >= 0.0f &&
+	        radius >= 0.0f &&
+	        cylindricalRadius >= 0.0f);
+}
+
+bool BoundingVolume::encloses(const vec3 &p) const {
+	if (empty) {
+		return false;
+	}
+	
+	const float e = TOLERANCE * (radius + 1.0f);
+	
+	return p.x >= minimum.x - e && p.x <= maximum.x + e &&
+	       p.y >= minimum.y - e && p.y <= maximum.y + e &&
+	       p.z >= minimum.z - e && p.z <= maximum.z + e &&
+	       p.getMagnitude() <= radius + e &&
+	       sqrtf(p.x*p.x + p.y*p.y) <= cylindricalRadius + e &&
+	       sphereCenter.distance(p) <= sphereRadius + e;
+}
+
+float BoundingVolume::getHeight() const {
+	return max(maximum.z, 0.0f) - min(minimum.z, 0.0f);
+}
+
+float BoundingVolume::getHeightBelowGround() const {
+	return min(minimum.z, 0.0f);
+}
+
+string BoundingVolume::toString() const {
+	if (empty) {
+		return "empty bounds";
+	}
+	
+	return "box (" + ftos(minimum.x) + ", " + ftos(minimum.y) + ", " + ftos(minimum.z) +
+	       ") to (" + ftos(maximum.x) + ", " + ftos(maximum.y) + ", " + ftos(maximum.z) +
+	       "), sphere of radius " + ftos(sphereRadius) +
+	       ", radius " + ftos(radius) + " about the origin";
+}
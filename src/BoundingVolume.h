@@ -0,0 +1,131 @@
+#ifndef _BOUNDING_VOLUME_H_
+#define _BOUNDING_VOLUME_H_
+
+#include "vec3.h"
+
+/**
+Bounds of a piece of geometry: an axis-aligned box, a sphere, and the radii
+of the sphere and of the vertical cylinder about the origin that models are
+measured by. Bounds are computed from the vertices once, when the geometry
+is built or loaded, and the bounds of several pieces of geometry (the
+meshes of a key frame, the key frames of an animation) are merged without
+returning to their vertices.
+*/
+class BoundingVolume {
+public:
+	/** Constructs empty bounds, which enclose nothing */
+	BoundingVolume();
+	
+	/**
+	Computes the bounds of a set of points
+	@param points Points to enclose
+	@param count Number of points
+	*/
+	BoundingVolume(const vec3 *points, int count);
+	
+	/**
+	Constructs bounds from values computed earlier
+	@param minimum Minimum corner of the box
+	@param maximum Maximum corner of the box
+	@param sphereCenter Center of the bounding sphere
+	@param sphereRadius Radius of the bounding sphere
+	@param radius Distance of the farthest point from the origin
+	@param cylindricalRadius Distance of the farthest point from the z axis
+	*/
+	BoundingVolume(const vec3 &minimum,
+	               const vec3 &maximum,
+	               const vec3 &sphereCenter,
+	               float sphereRadius,
+	               float radius,
+	               float cylindricalRadius);
+	
+	/** Indicates that the bounds enclose nothing */
+	inline bool isEmpty() const {
+		return empty;
+	}
+	
+	/** Enlarges the bounds to enclose other bounds as well */
+	void merge(const BoundingVolume &bounds);
+	
+	/**
+	Determines whether the bounds are well-formed: the box is not inside
+	out and no radius is negative
+	*/
+	bool isValid() const;
+	
+	/**
+	Determines whether the box, the sphere and both radii about the origin
+	enclose a point, allowing for a small error in the stored bounds
+	*/
+	bool encloses(const vec3 &point) const;
+	
+	/** Gets the minimum corner of the axis-aligned box */
+	inline const vec3& getMinimum() const {
+		return minimum;
+	}
+	
+	/** Gets the maximum corner of the axis-aligned box */
+	inline const vec3& getMaximum() const {
+		return maximum;
+	}
+	
+	/** Gets the center of the bounding sphere */
+	inline const vec3& getSphereCenter() const {
+		return sphereCenter;
+	}
+	
+	/** Gets the radius of the bounding sphere */
+	inline float getSphereRadius() const {
+		return sphereRadius;
+	}
+	
+	/** Gets the radius of the smallest sphere about the origin enclosing the geometry */
+	inline float getRadius() const {
+		return radius;
+	}
+	
+	/**
+	Gets the radius of the smallest vertical cylinder about the origin
+	enclosing the geometry
+	*/
+	inline float getCylindricalRadius() const {
+		return cylindricalRadius;
+	}
+	
+	/**
+	Gets the height of the geometry, from the lower of its bottom and the
+	ground plane (z=0) to the higher of its top and the ground plane
+	*/
+	float getHeight() const;
+	
+	/**
+	Gets the depth of the geometry below the ground plane (z=0)
+	@return Lowest z, or zero if the geometry is entirely above the ground
+	*/
+	float getHeightBelowGround() const;
+	
+	/** Gets a readable summary of the bounds */
+	string toString() const;
+	
+private:
+	/** Largest error allowed by encloses, relative to the size of the bounds */
+	static const float TOLERANCE;
+	
+	/** Indicates that the bounds enclose nothing */
+	bool empty;
+	
+	/** Corners of the axis-aligned box */
+	vec3 minimum, maximum;
+	
+	/** Bounding sphere, centered on the center of the box when computed */
+	vec3 sphereCenter;
+	float sphereRadius;
+	
+	/** Distance of the farthest point from the origin */
+	float radius;
+	
+	/** Distance of the farthest point from the z axis */
+	float cylindricalRadius;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "stdafx.h"
+#include "BufferBackendGL.h"
+
+GLuint BufferBackendGL::create(GLenum target, size_t size, GLenum usage) {
+	GLuint handle = 0;
+	
+	CHECK_GL_ERROR();
+	glGenBuffers(1, &handle);
+	glBindBuffer(target, handle);
+	glBufferData(target, size, 0, usage);
+	CHECK_GL_ERROR();
+	
+	return handle;
+}
+
+void BufferBackendGL::destroy(GLuint handle) {
+	glDeleteBuffers(1, &handle);
+}
+
+void BufferBackendGL::upload(GLenum target,
+                             GLuint handle,
+                             size_t offset,
+                             size_t size,
+                             const void *data) {
+	CHECK_GL_ERROR();
+	glBindBuffer(target, handle);
+	glBufferSubData(target, offset, size, data);
+	CHECK_GL_ERROR();
+}
+
+void BufferBackendGL::orphan(GLenum target,
+                             GLuint handle,
+                             size_t size,
+                             GLenum usage) {
+	CHECK_GL_ERROR();
+	glBindBuffer(target, handle);
+	glBufferData(target, size, 0, usage);
+	CHECK_GL_ERROR();
+}
+
+void BufferBackendGL::bind(GLenum target, GLuint handle) {
+	CHECK_GL_ERROR();
+	glBindBuffer(target, handle);
+	CHECK_GL_ERROR();
+}
@@ -0,0 +1,27 @@
+#ifndef _BUFFER_BACKEND_GL_H_
+#define _BUFFER_BACKEND_GL_H_
+
+#include "BufferPool.h"
+
+/** Backend that reaches the graphics device through OpenGL */
+class BufferBackendGL : public BufferBackend {
+public:
+	virtual GLuint create(GLenum target, size_t size, GLenum usage);
+	
+	virtual void destroy(GLuint handle);
+	
+	virtual void upload(GLenum target,
+	                    GLuint handle,
+	                    size_t offset,
+	                    size_t size,
+	                    const void *data);
+	
+	virtual void orphan(GLenum target,
+	                    GLuint handle,
+	                    size_t size,
+	                    GLenum usage);
+	                    
+	virtual void bind(GLenum target, GLuint handle);
+};
+
+#endif
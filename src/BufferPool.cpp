@@ -0,0 +1,263 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "BufferPool.h"
+
+BufferBackendNull::BufferBackendNull()
+		: nextHandle(1) {}
+		
+GLuint BufferBackendNull::create(GLenum, size_t, GLenum) {
+	return nextHandle++;
+}
+
+void BufferBackendNull::destroy(GLuint) {}
+
+void BufferBackendNull::upload(GLenum, GLuint, size_t, size_t, const void *) {}
+
+void BufferBackendNull::orphan(GLenum, GLuint, size_t, GLenum) {}
+
+void BufferBackendNull::bind(GLenum, GLuint) {}
+
+BufferPage::~BufferPage() {
+	backend->destroy(handle);
+}
+
+BufferPage::BufferPage(const shared_ptr<BufferBackend> &_backend,
+                       GLenum target,
+                       GLenum usage,
+                       size_t capacity)
+		: allocator(capacity, BufferPool::GRANULARITY),
+		backend(_backend),
+		handle(0) {
+	ASSERT(backend, "Null parameter: backend");
+	handle = backend->create(target, allocator.getCapacity(), usage);
+}
+
+BufferRange::BufferRange()
+		: block(0),
+		handle(0),
+		offset(0),
+		size(0),
+		frame(0) {}
+
+BufferPoolStatistics::BufferPoolStatistics()
+		: pagesCreated(0),
+		pages(0),
+		dedicated(0),
+		uploads(0),
+		bytesUploaded(0),
+		bytesStreamed(0),
+		streamOverflows(0) {}
+
+string BufferPoolStatistics::toString() const {
+	return sizet_to_string(pages) + " pages (" +
+	       sizet_to_string(pagesCreated) + " created, " +
+	       sizet_to_string(dedicated) + " dedicated), " +
+	       sizet_to_string(uploads) + " uploads of " +
+	       sizet_to_string(bytesUploaded) + " bytes, " +
+	       sizet_to_string(bytesStreamed) + " bytes streamed last frame, " +
+	       sizet_to_string(streamOverflows) + " stream overflows; " +
+	       ranges.toString();
+}
+
+BufferPool::~BufferPool() {
+	for (map<GLenum, Ring>::const_iterator i=rings.begin(); i!=rings.end(); ++i) {
+		backend->destroy(i->second.handle);
+	}
+}
+
+BufferPool::BufferPool(const shared_ptr<BufferBackend> &_backend,
+                       size_t _pageSize,
+                       size_t _ringSize)
+		: backend(_backend),
+		pageSize(_pageSize),
+		ringSize(_ringSize),
+		frame(1),
+		bytesStreamed(0) {
+	ASSERT(backend, "Null parameter: backend");
+	ASSERT(pageSize >= GRANULARITY, "Page size is too small");
+}
+
+bool BufferPool::isStatic(BUFFER_USAGE usage) {
+	return usage == STATIC_DRAW || usage == STATIC_READ || usage == STATIC_COPY;
+}
+
+BufferRange BufferPool::allocate(GLenum target,
+                                 BUFFER_USAGE usage,
+                                 size_t size) {
+	ASSERT(size > 0, "Cannot allocate an empty range");
+	
+	const bool stat = isStatic(usage);
+	const GLenum glUsage = stat ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
+	
+	BufferRange range;
+	
+	if (size > pageSize) {
+		// Too large to share a page, so it gets a page of its own. The page
+		// is not held by the pool and goes away with the range.
+		range.page = shared_ptr<BufferPage>(new BufferPage(backend,
+		                                                   target,
+		                                                   glUsage,
+		                                                   size));
+		range.block = range.page->allocator.allocate(size);
+		statistics.pagesCreated++;
+		statistics.dedicated++;
+	} else {
+		Pages &pages = pageSets[make_pair(target, stat)];
+		
+		for (Pages::const_iterator i=pages.begin(); i!=pages.end(); ++i) {
+			const size_t block = (*i)->allocator.allocate(size);
+			
+			if (block != RangeAllocator::NONE) {
+				range.page = *i;
+				range.block = block;
+				break;
+			}
+		}
+		
+		if (!range.page) {
+			range.page = shared_ptr<BufferPage>(new BufferPage(backend,
+			                                                   target,
+			                                                   glUsage,
+			                                                   pageSize));
+			range.block = range.page->allocator.allocate(size);
+			pages.push_back(range.page);
+			statistics.pagesCreated++;
+		}
+	}
+	
+	ASSERT(range.block != RangeAllocator::NONE, "Failed to allocate range");
+	
+	range.handle = range.page->getHandle();
+	range.offset = range.page->allocator.getOffset(range.block);
+	range.size = size;
+	
+	return range;
+}
+
+void BufferPool::free(BufferRange &range) {
+	if (range.page) {
+		range.page->allocator.free(range.block);
+	}
+	
+	range = BufferRange();
+}
+
+void BufferPool::upload(GLenum target,
+                        const BufferRange &range,
+                        size_t offset,
+                        size_t size,
+                        const void *data) {
+	ASSERT(offset + size <= range.size, "Write past the end of the range");
+	
+	backend->upload(target, range.handle, range.offset + offset, size, data);
+	
+	statistics.uploads++;
+	statistics.bytesUploaded += size;
+}
+
+BufferPool::Ring& BufferPool::getRing(GLenum target) {
+	map<GLenum, Ring>::iterator i = rings.find(target);
+	
+	if (i != rings.end()) {
+		return i->second;
+	}
+	
+	Ring &ring = rings[target];
+	ring.handle = backend->create(target, ringSize, GL_STREAM_DRAW);
+	ring.capacity = ringSize;
+	ring.head = 0;
+	ring.overflow = 0;
+	return ring;
+}
+
+BufferRange BufferPool::stream(GLenum target, size_t size, const void *data) {
+	ASSERT(size > 0, "Cannot stream an empty range");
+	
+	Ring &ring = getRing(target);
+	const size_t alignedSize = (size + GRANULARITY - 1) / GRANULARITY * GRANULARITY;
+	
+	BufferRange range;
+	
+	if (ring.head + alignedSize <= ring.capacity) {
+		range.handle = ring.handle;
+		range.offset = ring.head;
+		range.size = size;
+		ring.head += alignedSize;
+		backend->upload(target, range.handle, range.offset, size, data);
+	} else {
+		// The ring cannot start over in the middle of a frame, as draws
+		// later in the frame may still need what it holds. Spill into a
+		// dynamic page until the ring grows at the start of the next frame.
+		ring.overflow += alignedSize;
+		statistics.streamOverflows++;
+		
+		range = allocate(target, DYNAMIC_DRAW, size);
+		backend->upload(target, range.handle, range.offset, size, data);
+	}
+	
+	range.frame = frame;
+	bytesStreamed += size;
+	
+	return range;
+}
+
+void BufferPool::bind(GLenum target, const BufferRange &range) {
+	backend->bind(target, range.handle);
+}
+
+void BufferPool::beginFrame() {
+	frame++;
+	statistics.bytesStreamed = bytesStreamed;
+	bytesStreamed = 0;
+	
+	for (map<GLenum, Ring>::iterator i=rings.begin(); i!=rings.end(); ++i) {
+		const GLenum target = i->first;
+		Ring &ring = i->second;
+		
+		if (ring.overflow > 0) {
+			// Grow to hold everything streamed during the last frame
+			while (ring.capacity < ring.head + ring.overflow) {
+				ring.capacity *= 2;
+			}
+			
+			backend->destroy(ring.handle);
+			ring.handle = backend->create(target, ring.capacity, GL_STREAM_DRAW);
+		} else if (ring.head > 0) {
+			backend->orphan(target, ring.handle, ring.capacity, GL_STREAM_DRAW);
+		}
+		
+		ring.head = 0;
+		ring.overflow = 0;
+	}
+}
+
+void BufferPool::trim() {
+	for (PageSets::iterator i=pageSets.begin(); i!=pageSets.end(); ++i) {
+		Pages &pages = i->second;
+		Pages kept;
+		
+		for (Pages::const_iterator j=pages.begin(); j!=pages.end(); ++j) {
+			if (!(*j)->allocator.isEmpty()) {
+				kept.push_back(*j);
+			}
+		}
+		
+		pages.swap(kept);
+	}
+}
+
+BufferPoolStatistics BufferPool::getStatistics() const {
+	BufferPoolStatistics s = statistics;
+	s.pages = 0;
+	
+	for (PageSets::const_iterator i=pageSets.begin(); i!=pageSets.end(); ++i) {
+		const Pages &pages = i->second;
+		
+		for (Pages::const_iterator j=pages.begin(); j!=pages.end(); ++j) {
+			s.pages++;
+			s.ranges.add((*j)->allocator.getStatistics());
+		}
+	}
+	
+	return s;
+}
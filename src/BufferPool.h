@@ -0,0 +1,350 @@
+#ifndef _BUFFER_POOL_H_
+#define _BUFFER_POOL_H_
+
+#include "RangeAllocator.h"
+
+enum BUFFER_USAGE {
+	STREAM_DRAW,
+	STREAM_READ,
+	STREAM_COPY,
+	STATIC_DRAW,
+	STATIC_READ,
+	STATIC_COPY,
+	DYNAMIC_DRAW,
+	DYNAMIC_READ,
+	DYNAMIC_COPY
+};
+
+/**
+Creates, fills and destroys buffer objects on the graphics device. The
+buffer pool only reaches the device through this, so its bookkeeping can
+be driven by a mock backend without a GL context.
+*/
+class BufferBackend {
+public:
+	virtual ~BufferBackend() {}
+	
+	/**
+	Creates a buffer object with uninitialized storage
+	@param target Target to create the buffer for
+	@param size Size of the storage, in bytes
+	@param usage GL usage hint
+	@return name of the buffer object
+	*/
+	virtual GLuint create(GLenum target, size_t size, GLenum usage) = 0;
+	
+	/** Destroys a buffer object */
+	virtual void destroy(GLuint handle) = 0;
+	
+	/**
+	Writes to part of a buffer object
+	@param target Target to bind the buffer to
+	@param handle Name of the buffer object
+	@param offset Start of the part to write, in bytes
+	@param size Size of the part to write, in bytes
+	@param data Contents to write
+	*/
+	virtual void upload(GLenum target,
+	                    GLuint handle,
+	                    size_t offset,
+	                    size_t size,
+	                    const void *data) = 0;
+	
+	/**
+	Gives a buffer object fresh storage, so that writing to it does not wait
+	for draws still reading the old contents
+	@param target Target to bind the buffer to
+	@param handle Name of the buffer object
+	@param size Size of the storage, in bytes
+	@param usage GL usage hint
+	*/
+	virtual void orphan(GLenum target,
+	                    GLuint handle,
+	                    size_t size,
+	                    GLenum usage) = 0;
+	                    
+	/**
+	Binds a buffer object, so that draws read from it
+	@param target Target to bind the buffer to
+	@param handle Name of the buffer object
+	*/
+	virtual void bind(GLenum target, GLuint handle) = 0;
+};
+
+/**
+Backend that hands out names but keeps no buffer objects, for tools that
+build meshes without a graphics device, such as the data cooker
+*/
+class BufferBackendNull : public BufferBackend {
+public:
+	BufferBackendNull();
+	
+	virtual GLuint create(GLenum target, size_t size, GLenum usage);
+	
+	virtual void destroy(GLuint handle);
+	
+	virtual void upload(GLenum target,
+	                    GLuint handle,
+	                    size_t offset,
+	                    size_t size,
+	                    const void *data);
+	                    
+	virtual void orphan(GLenum target,
+	                    GLuint handle,
+	                    size_t size,
+	                    GLenum usage);
+	                    
+	virtual void bind(GLenum target, GLuint handle);
+	
+private:
+	/** Name of the next buffer object */
+	GLuint nextHandle;
+};
+
+/** Buffer object on the graphics device, split into ranges */
+class BufferPage {
+public:
+	/** Destroys the buffer object */
+	~BufferPage();
+	
+	/**
+	Constructor creates the buffer object
+	@param backend Backend creating the buffer object
+	@param target Target of the buffer object
+	@param usage GL usage hint
+	@param capacity Size of the buffer object, in bytes
+	*/
+	BufferPage(const shared_ptr<BufferBackend> &backend,
+	           GLenum target,
+	           GLenum usage,
+	           size_t capacity);
+	
+	/** Gets the name of the buffer object */
+	inline GLuint getHandle() const {
+		return handle;
+	}
+	
+	/** Hands out the ranges of the buffer object */
+	RangeAllocator allocator;
+	
+private:
+	BufferPage(const BufferPage&);
+	BufferPage& operator=(const BufferPage&);
+	
+	shared_ptr<BufferBackend> backend;
+	
+	/** Name of the buffer object */
+	GLuint handle;
+};
+
+/** Range of a buffer object, holding the contents of one ResourceBuffer */
+struct BufferRange {
+	/**
+	Page the range was allocated from. Null for ranges streamed through the
+	per-frame ring buffer, which remain valid only for the frame in which
+	they were written.
+	*/
+	shared_ptr<BufferPage> page;
+	
+	/** ID of the range within the page */
+	size_t block;
+	
+	/** Name of the buffer object, or zero if there is no range */
+	GLuint handle;
+	
+	/** Start of the range within the buffer object, in bytes */
+	size_t offset;
+	
+	/** Size of the range, in bytes */
+	size_t size;
+	
+	/** Frame in which a streamed range was written */
+	unsigned int frame;
+	
+	/** Constructor creates an empty range */
+	BufferRange();
+};
+
+/** Counters describing the buffer pool */
+struct BufferPoolStatistics {
+	/** Buffer objects created for pages, ever */
+	size_t pagesCreated;
+	
+	/** Pages currently held by the pool */
+	size_t pages;
+	
+	/** Requests too large for a page, given buffer objects of their own */
+	size_t dedicated;
+	
+	/** Writes made to buffer objects, not counting streamed data */
+	size_t uploads;
+	
+	/** Bytes written to buffer objects, not counting streamed data */
+	size_t bytesUploaded;
+	
+	/** Bytes streamed through the ring buffers during the last frame */
+	size_t bytesStreamed;
+	
+	/** Streamed writes that did not fit into the ring buffers, ever */
+	size_t streamOverflows;
+	
+	/** Ranges of the pages held by the pool */
+	RangeAllocatorStatistics ranges;
+	
+	/** Constructor */
+	BufferPoolStatistics();
+	
+	/** Gets a readable summary of the counters */
+	string toString() const;
+};
+
+/**
+Hands out ranges of large buffer objects, so that meshes and particle
+batches do not each create a few small buffer objects of their own.
+Long-lived data is sub-allocated from pages of static or dynamic buffer
+objects. Data rewritten every frame is streamed through a ring buffer
+that starts over, with fresh storage, at the start of each frame.
+*/
+class BufferPool {
+public:
+	/** Default size of a page */
+	static const size_t DEFAULT_PAGE_SIZE = 4 * 1024 * 1024;
+	
+	/** Default size of a ring buffer */
+	static const size_t DEFAULT_RING_SIZE = 1024 * 1024;
+	
+	/** Ranges start at multiples of this many bytes */
+	static const size_t GRANULARITY = 16;
+	
+	/** Releases the ring buffers. Pages live on until their ranges are freed. */
+	~BufferPool();
+	
+	/**
+	Constructor
+	@param backend Backend that reaches the graphics device
+	@param pageSize Size of each page, in bytes
+	@param ringSize Initial size of each ring buffer, in bytes
+	*/
+	BufferPool(const shared_ptr<BufferBackend> &backend,
+	           size_t pageSize = DEFAULT_PAGE_SIZE,
+	           size_t ringSize = DEFAULT_RING_SIZE);
+	
+	/**
+	Allocates a range of a page
+	@param target Target the range is used with
+	@param usage Describes how the range will be used
+	@param size Size of the range, in bytes
+	@return range
+	*/
+	BufferRange allocate(GLenum target, BUFFER_USAGE usage, size_t size);
+	
+	/**
+	Releases a range, whether allocated or streamed, and empties it
+	@param range Range to release
+	*/
+	void free(BufferRange &range);
+	
+	/**
+	Writes to an allocated range
+	@param target Target the range is used with
+	@param range Range to write to
+	@param offset Start of the part to write, relative to the range
+	@param size Size of the part to write, in bytes
+	@param data Contents to write
+	*/
+	void upload(GLenum target,
+	            const BufferRange &range,
+	            size_t offset,
+	            size_t size,
+	            const void *data);
+	
+	/**
+	Writes data that is only needed for the current frame
+	@param target Target the data is used with
+	@param size Size of the data, in bytes
+	@param data Contents to write
+	@return range holding the data until the end of the frame
+	*/
+	BufferRange stream(GLenum target, size_t size, const void *data);
+	
+	/**
+	Binds the buffer object holding a range, so that draws read from it
+	@param target Target the range is used with
+	@param range Range to bind
+	*/
+	void bind(GLenum target, const BufferRange &range);
+	
+	/**
+	Determines whether a streamed range was written during this frame
+	@param range Streamed range
+	@return true if the range still holds its data
+	*/
+	inline bool isCurrent(const BufferRange &range) const {
+		return range.handle != 0 && range.frame == frame;
+	}
+	
+	/** Starts a new frame, reusing the ring buffers from the start */
+	void beginFrame();
+	
+	/** Releases the pages that no longer hold any ranges */
+	void trim();
+	
+	/** Gets the counters describing the buffer pool */
+	BufferPoolStatistics getStatistics() const;
+	
+private:
+	BufferPool(const BufferPool&);
+	BufferPool& operator=(const BufferPool&);
+	
+	/** Buffer object that streamed data is written through, front to back */
+	struct Ring {
+		/** Name of the buffer object */
+		GLuint handle;
+		
+		/** Size of the buffer object, in bytes */
+		size_t capacity;
+		
+		/** Start of the free part of the buffer object, in bytes */
+		size_t head;
+		
+		/** Bytes that did not fit during this frame */
+		size_t overflow;
+	};
+	
+	typedef vector<shared_ptr<BufferPage> > Pages;
+	
+	/** Pages by target, and then by whether they are static */
+	typedef map<pair<GLenum, bool>, Pages> PageSets;
+	
+	/** Determines whether a usage is served by static pages */
+	static bool isStatic(BUFFER_USAGE usage);
+	
+	/** Gets the ring buffer for a target, creating it if needed */
+	Ring& getRing(GLenum target);
+	
+	/** Reaches the graphics device */
+	shared_ptr<BufferBackend> backend;
+	
+	/** Size of each page, in bytes */
+	size_t pageSize;
+	
+	/** Initial size of each ring buffer, in bytes */
+	size_t ringSize;
+	
+	/** Pages held by the pool */
+	PageSets pageSets;
+	
+	/** Ring buffers, by target */
+	map<GLenum, Ring> rings;
+	
+	/** Counts the frames begun */
+	unsigned int frame;
+	
+	/** Bytes streamed during this frame */
+	size_t bytesStreamed;
+	
+	/** Counters, apart from those gathered from the pages */
+	BufferPoolStatistics statistics;
+};
+
+#endif
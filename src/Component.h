@@ -5,6 +5,8 @@
 #include "ScopedEventHandler.h"
 #include "ActionDebugEnable.h"
 #include "ActionDebugDisable.h"
+#include "ComponentFactory.h"
+#include "ComponentSchema.h"
 
 class Actor;
 
@@ -26,8 +28,19 @@ public:
 	/** Resets all object members to defaults */
 	virtual void resetMembers();
 	
-	/** Loads component data from the pool of all object data */
-	virtual void load(const PropertyBag &data) = 0;
+	/**
+	Loads component data from the pool of all object data.
+	By default, the data is compiled with the schema registered for the
+	component type and then loaded from the compiled data, so components
+	with a schema need only implement load(const ComponentData&).
+	*/
+	virtual void load(const PropertyBag &data);
+	
+	/**
+	Loads component data that was compiled ahead of time by the schema
+	registered for the component type
+	*/
+	virtual void load(const ComponentData &data);
 	
 	/**
 	Updates component each tick
@@ -35,6 +48,13 @@ public:
 	*/
 	virtual void update(float milliseconds) = 0;
 	
+	/**
+	Updates component each tick while the actor is asleep.
+	Most components do nothing at all while asleep.
+	@param milliseconds Time since the last tick
+	*/
+	virtual void updateAsleep(float) { /* Do Nothing */ }
+	
 	/** Creates a component given the component name */
 	static shared_ptr<Component> createComponent(const string &name,
 	  UID uid,
@@ -54,14 +74,7 @@ private:
 	void handleActionDebugDisable(const ActionDebugDisable *message);
 	void handleActionDebugEnable(const ActionDebugEnable *message);
 	
-	template<typename COMPONENT> static inline
-	shared_ptr<Component> newComponent(UID uid, ScopedEventHandler *bb) {
-		return shared_ptr<Component>(new COMPONENT(uid, bb));
-	}
-	
 private:
-	typedef map<string, function<shared_ptr<Component> (UID, ScopedEventHandler*)> > AllocMap;
-	
 	/** Indicates that any debug data should be displayed by the component */
 	bool displayDebugData;
 };
@@ -3,6 +3,8 @@
 #include "ComponentPhysics.h"
 #include "ComponentAttachParticleSystem.h"
 
+REGISTER_COMPONENT("AttachParticleSystem", ComponentAttachParticleSystem)
+
 ComponentAttachParticleSystem::
 ComponentAttachParticleSystem(UID uid, ScopedEventHandler *blackBoard)
 		: Component(uid, blackBoard),
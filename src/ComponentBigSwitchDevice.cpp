@@ -7,6 +7,9 @@
 #include "ActionPlaySound.h"
 #include "EventSwitchToggled.h"
 
+REGISTER_COMPONENT("BigSwitchDevice", ComponentBigSwitchDevice)
+REGISTER_COMPONENT_SCHEMA("BigSwitchDevice", ComponentBigSwitchDevice)
+
 ComponentBigSwitchDevice::
 ComponentBigSwitchDevice(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
@@ -152,11 +155,18 @@ void ComponentBigSwitchDevice::drawCircle(float radius, float z) const {
 	CHECK_GL_ERROR();
 }
 
-void ComponentBigSwitchDevice::load(const PropertyBag &data) {
+void ComponentBigSwitchDevice::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("categoryID", &Data::categoryID)
+	      .field("timeToTransition", &Data::timeToTransition);
+}
+
+void ComponentBigSwitchDevice::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
 	
-	categoryID = data.getInt("categoryID");
-	timeToTransition = data.getFloat("timeToTransition");
+	categoryID = data.categoryID;
+	timeToTransition = data.timeToTransition;
 	
 	enterState(STATE_A);
 }
@@ -6,6 +6,9 @@
 #include "EventDamageReceived.h"
 #include "MessagePassWorld.h"
 
+REGISTER_COMPONENT("DamageOnCollision", ComponentDamageOnCollision)
+REGISTER_COMPONENT_SCHEMA("DamageOnCollision", ComponentDamageOnCollision)
+
 ComponentDamageOnCollision::
 ComponentDamageOnCollision(UID uid, ScopedEventHandler *blackBoard)
 		: Component(uid, blackBoard),
@@ -16,10 +19,17 @@ ComponentDamageOnCollision(UID uid, ScopedEventHandler *blackBoard)
 	REGISTER_HANDLER(ComponentDamageOnCollision::handleMessagePassWorld);
 }
 
-void ComponentDamageOnCollision::load(const PropertyBag &data) {
+void ComponentDamageOnCollision::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("onlyPlayers", &Data::onlyPlayers)
+	      .field("damage", &Data::damage);
+}
+
+void ComponentDamageOnCollision::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
-	onlyPlayers = data.getBool("onlyPlayers");
-	damage = data.getInt("damage");
+	onlyPlayers = data.onlyPlayers;
+	damage = data.damage;
 }
 
 void ComponentDamageOnCollision::resetMembers() {
@@ -21,7 +21,21 @@ public:
 	
 	virtual void update(float) {}
 	
-	virtual void load(const PropertyBag &data);
+	/** Fields of the component in actor templates */
+	struct Data {
+		Data()
+				: onlyPlayers(false),
+				damage(100) {}
+		
+		bool onlyPlayers;
+		int damage;
+	};
+	
+	/** Declares the fields of the component in actor templates */
+	static void declareSchema(ComponentSchemaOf<Data> &schema);
+	
+	/** Loads component data compiled from the actor template */
+	virtual void load(const ComponentData &compiled);
 	
 	virtual void resetMembers();
 	
@@ -2,19 +2,34 @@
 #define COMPONENT_DATA_SET_H
 
 #include "PropertyBag.h"
+#include "ComponentSchema.h"
 
 /**
 Structure used to create a particular actor instance.
 Lists the components used by the actor and the data that is to be parsed
-and loaded by each component.
+and loaded by each component. Data for components that have a schema may
+also be compiled once, ahead of time, so that spawning an actor copies the
+compiled fields instead of looking up each tag.
 */
 class ComponentDataSet {
 public:
-	typedef vector<pair<string, PropertyBag> >::const_iterator const_iterator;
-	typedef vector<pair<string, PropertyBag> >::iterator iterator;
+	/** Data for a single component */
+	struct Entry {
+		/** Name of the component type */
+		string name;
+		
+		/** Component data from the actor template */
+		PropertyBag data;
+		
+		/** Compiled component data, or null if not compiled */
+		shared_ptr<const ComponentData> compiled;
+	};
+	
+	typedef vector<Entry>::const_iterator const_iterator;
+	typedef vector<Entry>::iterator iterator;
 	
 private:
-	vector<pair<string, PropertyBag> > data;
+	vector<Entry> data;
 	
 public:
 	/** Default Constructor */
@@ -39,20 +54,37 @@ public:
 		return data.end();
 	}
 	
+	/** Gets the number of components */
+	size_t size() const {
+		return data.size();
+	}
+	
 	/**
-	Finds data for the component, given a particular component name
+	Finds data for the component, given a particular component name.
+	As the data may be modified, it is no longer considered compiled.
 	@param name Component name
 	@return access to the specified component data
 	*/
 	PropertyBag& get(const string &name) {
 		for (ComponentDataSet::iterator i=begin(); i!=end(); ++i) {
-			if (i->first == name) {
-				return i->second;
+			if (i->name == name) {
+				i->compiled.reset();
+				return i->data;
 			}
 		}
 		
 		FAIL("Failed to find component: " + name);
-		return end()->second;
+		return end()->data;
+	}
+	
+	/**
+	Compiles the data of each component that has a schema
+	@param errors Receives a description of each schema error
+	*/
+	void compile(vector<string> &errors) {
+		for (ComponentDataSet::iterator i=begin(); i!=end(); ++i) {
+			compile(*i, errors);
+		}
 	}
 	
 	/** Parses out component data from an object template */
@@ -80,9 +112,9 @@ public:
 	                         const string &name) {
 		for (ComponentDataSet::const_iterator i=specializaions.begin();
 		     i!=specializaions.end(); ++i) {
-			if (i->first == name) {
+			if (i->name == name) {
 				PropertyBag mergedData = baseData;
-				mergedData.merge(i->second, true);
+				mergedData.merge(i->data, true);
 				return mergedData;
 			}
 		}
@@ -97,7 +129,10 @@ public:
 	the base data set.  Components that are specified
 	here, and are not also specified in the base, are
 	ignored.
-	@return Merged data set
+	@return Merged data set. Compiled data is kept for
+	components that were not specialized. The data of
+	specialized components is merged, and compiled again
+	if the component has a schema.
 	*/
 	static ComponentDataSet merge(const ComponentDataSet &base,
 	                              const ComponentDataSet &sp) {
@@ -105,9 +140,23 @@ public:
 		
 		for (ComponentDataSet::const_iterator i=base.begin();
 		     i!=base.end();++i) {
-			const string &name = i->first;
-			const PropertyBag &baseData = i->second;
-			mergedSet.add(name, merge(baseData, sp, name));
+			if (!sp.contains(i->name)) {
+				mergedSet.data.push_back(*i);
+				continue;
+			}
+			
+			Entry entry;
+			entry.name = i->name;
+			entry.data = merge(i->data, sp, i->name);
+			
+			vector<string> errors;
+			compile(entry, errors);
+			
+			for (size_t j=0; j<errors.size(); ++j) {
+				ERR(errors[j]);
+			}
+			
+			mergedSet.data.push_back(entry);
 		}
 		
 		return mergedSet;
@@ -115,7 +164,35 @@ public:
 	
 private:
 	void add(const string &name, const PropertyBag &componentData) {
-		data.push_back(make_pair(name, componentData));
+		Entry entry;
+		entry.name = name;
+		entry.data = componentData;
+		data.push_back(entry);
+	}
+	
+	/** Determines whether the set holds data for a component */
+	bool contains(const string &name) const {
+		for (ComponentDataSet::const_iterator i=begin(); i!=end(); ++i) {
+			if (i->name == name) {
+				return true;
+			}
+		}
+		
+		return false;
+	}
+	
+	/** Compiles the data of a component, if the component has a schema */
+	static void compile(Entry &entry, vector<string> &errors) {
+		const ComponentSchema *schema = ComponentSchema::find(entry.name);
+		
+		if (schema) {
+			vector<string> componentErrors;
+			entry.compiled = schema->compile(entry.data, componentErrors);
+			
+			for (size_t i=0; i<componentErrors.size(); ++i) {
+				errors.push_back(entry.name + ": " + componentErrors[i]);
+			}
+		}
 	}
 };
 
@@ -6,6 +6,8 @@
 #include "ActionPhysicsEnable.h"
 #include "ActionPhysicsDisable.h"
 
+REGISTER_COMPONENT("DeathBehavior", ComponentDeathBehavior)
+
 ComponentDeathBehavior::
 ComponentDeathBehavior(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
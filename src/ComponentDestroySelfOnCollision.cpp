@@ -7,6 +7,9 @@
 #include "EventUsesObject.h"
 #include "ActionDeleteActor.h"
 
+REGISTER_COMPONENT("DestroySelfOnCollision", ComponentDestroySelfOnCollision)
+REGISTER_COMPONENT_SCHEMA("DestroySelfOnCollision", ComponentDestroySelfOnCollision)
+
 ComponentDestroySelfOnCollision::
 ComponentDestroySelfOnCollision(UID uid, ScopedEventHandler *blackBoard)
 		: Component(uid, blackBoard),
@@ -17,9 +20,15 @@ ComponentDestroySelfOnCollision(UID uid, ScopedEventHandler *blackBoard)
 	REGISTER_HANDLER(ComponentDestroySelfOnCollision::handleMessagePassWorld);
 }
 
-void ComponentDestroySelfOnCollision::load(const PropertyBag &data) {
+void ComponentDestroySelfOnCollision::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.optional("onlyPlayers", &Data::onlyPlayers);
+}
+
+void ComponentDestroySelfOnCollision::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
-	data.get("onlyPlayers", onlyPlayers); // optional tag
+	onlyPlayers = data.onlyPlayers;
 }
 
 void ComponentDestroySelfOnCollision::resetMembers() {
@@ -2,6 +2,9 @@
 #include "World.h"
 #include "ComponentPhysics.h"
 #include "ComponentDropsLoot.h"
+#include "ActorPrototypes.h"
+
+REGISTER_COMPONENT("DropsLoot", ComponentDropsLoot)
 
 ComponentDropsLoot::ComponentDropsLoot(UID uid,
                                        ScopedEventHandler *blackBoard)
@@ -53,9 +56,7 @@ void ComponentDropsLoot::spawnLoot(const FileName & lootFilename,
                                    const vec3 &position,
                                    const vec3 &velocity) {
 	ASSERT(world, "Null pointer: world");
-	const PropertyBag data = PropertyBag::fromFile(lootFilename);
-	const PropertyBag base = data.getBag("components");
-	ComponentDataSet s = ComponentDataSet::parse(base);
+	ComponentDataSet s = ActorPrototypes::instantiate(lootFilename);
 	
 #if 1
 	// Specifically enable physics for loot
@@ -66,7 +67,7 @@ void ComponentDropsLoot::spawnLoot(const FileName & lootFilename,
 	}
 #endif
 	
-	world->getObjects().spawn(s, position, velocity);
+	world->getObjects().spawn(lootFilename, s, position, velocity);
 }
 
 void ComponentDropsLoot::handleEventPositionUpdate( const EventPositionUpdate *message ) {
@@ -4,6 +4,9 @@
 #include "ActionChangeMap.h"
 #include "ActionPlaySound.h"
 
+REGISTER_COMPONENT("ExitMapOnUse", ComponentExitMapOnUse)
+REGISTER_COMPONENT_SCHEMA("ExitMapOnUse", ComponentExitMapOnUse)
+
 ComponentExitMapOnUse::
 ComponentExitMapOnUse(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope),
@@ -18,10 +21,17 @@ void ComponentExitMapOnUse::resetMembers() {
 	sfxOnFail = FileName("data/sounds/default.wav");
 }
 
-void ComponentExitMapOnUse::load(const PropertyBag &data) {
+void ComponentExitMapOnUse::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("nextMap", &Data::nextMap)
+	      .field("sfxOnFailed", &Data::sfxOnFail);
+}
+
+void ComponentExitMapOnUse::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
-	nextMap = data.getFileName("nextMap");
-	sfxOnFail = data.getFileName("sfxOnFailed");
+	nextMap = data.nextMap;
+	sfxOnFail = data.sfxOnFail;
 }
 
 void ComponentExitMapOnUse::update(float) {
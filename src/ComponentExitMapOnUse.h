@@ -24,8 +24,19 @@ public:
 	/** Resets all object members to defaults */
 	virtual void resetMembers();
 	
-	/** Loads component data from the pool of all object data */
-	virtual void load(const PropertyBag &data);
+	/** Fields of the component in actor templates */
+	struct Data {
+		Data() {}
+		
+		FileName nextMap;
+		FileName sfxOnFail;
+	};
+	
+	/** Declares the fields of the component in actor templates */
+	static void declareSchema(ComponentSchemaOf<Data> &schema);
+	
+	/** Loads component data compiled from the actor template */
+	virtual void load(const ComponentData &compiled);
 	
 	/**
 	Updates component each tick
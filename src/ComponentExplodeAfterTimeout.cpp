@@ -3,6 +3,9 @@
 #include "ActionDeleteActor.h"
 #include "ComponentExplodeAfterTimeout.h"
 
+REGISTER_COMPONENT("ExplodeAfterTimeout", ComponentExplodeAfterTimeout)
+REGISTER_COMPONENT_SCHEMA("ExplodeAfterTimeout", ComponentExplodeAfterTimeout)
+
 ComponentExplodeAfterTimeout::
 ComponentExplodeAfterTimeout(UID uid, ScopedEventHandler *blackBoard)
 		: Component(uid, blackBoard) {
@@ -18,13 +21,22 @@ void ComponentExplodeAfterTimeout::resetMembers() {
 	particlesFileName = FileName("(nil)");
 }
 
-void ComponentExplodeAfterTimeout::load(const PropertyBag &data) {
+void ComponentExplodeAfterTimeout::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("timeout", &Data::timeout)
+	      .field("baseDamage", &Data::baseDamage)
+	      .field("soundFileName", &Data::soundFileName)
+	      .field("particlesFileName", &Data::particlesFileName);
+}
+
+void ComponentExplodeAfterTimeout::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
 	
-	timeleft = data.getFloat("timeout");
-	baseDamage = data.getInt("baseDamage");
-	soundFileName = data.getFileName("soundFileName");
-	particlesFileName = data.getFileName("particlesFileName");
+	timeleft = data.timeout;
+	baseDamage = data.baseDamage;
+	soundFileName = data.soundFileName;
+	particlesFileName = data.particlesFileName;
 }
 
 void ComponentExplodeAfterTimeout::handleMessagePassWorld( const MessagePassWorld *message ) {
@@ -2,6 +2,9 @@
 #include "World.h"
 #include "ComponentExplodeOnDeath.h"
 
+REGISTER_COMPONENT("ExplodeOnDeath", ComponentExplodeOnDeath)
+REGISTER_COMPONENT_SCHEMA("ExplodeOnDeath", ComponentExplodeOnDeath)
+
 ComponentExplodeOnDeath::
 ComponentExplodeOnDeath(UID uid, ScopedEventHandler *blackBoard)
 		: Component(uid, blackBoard) {
@@ -17,12 +20,20 @@ void ComponentExplodeOnDeath::resetMembers() {
 	particlesFileName = FileName("(nil)");
 }
 
-void ComponentExplodeOnDeath::load(const PropertyBag &data) {
+void ComponentExplodeOnDeath::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("baseDamage", &Data::baseDamage)
+	      .field("soundFileName", &Data::soundFileName)
+	      .field("particlesFileName", &Data::particlesFileName);
+}
+
+void ComponentExplodeOnDeath::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
 	
-	baseDamage = data.getInt("baseDamage");
-	soundFileName = data.getFileName("soundFileName");
-	particlesFileName = data.getFileName("particlesFileName");
+	baseDamage = data.baseDamage;
+	soundFileName = data.soundFileName;
+	particlesFileName = data.particlesFileName;
 }
 
 void ComponentExplodeOnDeath::handleMessagePassWorld( const MessagePassWorld *event ) {
@@ -0,0 +1,100 @@
+#include "stdafx.h"
+#include "Component.h"
+#include "ComponentFactory.h"
+
+vector<size_t> ComponentFactory::hashTable;
+size_t ComponentFactory::hashTableTypes = 0;
+
+vector<ComponentFactory::Entry>& ComponentFactory::getTypes() {
+	// Constructed on first use so that registration does not depend on the
+	// order of static initialization across translation units
+	static vector<Entry> types;
+	return types;
+}
+
+ComponentTypeID ComponentFactory::registerType(const string &name,
+  Allocator allocator) {
+	ASSERT(allocator, "Null parameter: allocator");
+	
+	vector<Entry> &types = getTypes();
+	
+	for (size_t i=0; i<types.size(); ++i) {
+		ASSERT(types[i].name != name,
+		       "Component registered more than once: " + name);
+	}
+	
+	Entry entry;
+	entry.name = name;
+	entry.allocator = allocator;
+	types.push_back(entry);
+	
+	return types.size() - 1;
+}
+
+size_t ComponentFactory::hash(const string &name) {
+	// FNV-1a
+	size_t h = 2166136261U;
+	
+	for (size_t i=0; i<name.length(); ++i) {
+		h ^= (unsigned char)name[i];
+		h *= 16777619U;
+	}
+	
+	return h;
+}
+
+void ComponentFactory::buildHashTable() {
+	const vector<Entry> &types = getTypes();
+	size_t size = 8;
+	
+	while (size < types.size() * 2) {
+		size *= 2;
+	}
+	
+	for (;;) {
+		bool collision = false;
+		hashTable.assign(size, 0);
+		
+		for (size_t i=0; i<types.size() && !collision; ++i) {
+			size_t &slot = hashTable[hash(types[i].name) & (size-1)];
+			
+			if (slot) {
+				collision = true;
+			} else {
+				slot = i+1;
+			}
+		}
+		
+		if (!collision) {
+			break;
+		}
+		
+		size *= 2;
+	}
+	
+	hashTableTypes = types.size();
+}
+
+ComponentTypeID ComponentFactory::getTypeID(const string &name) {
+	const vector<Entry> &types = getTypes();
+	
+	if (hashTableTypes != types.size()) {
+		buildHashTable();
+	}
+	
+	size_t slot = hashTable[hash(name) & (hashTable.size()-1)];
+	
+	if (slot==0 || types[slot-1].name != name) {
+		FAIL("Could not create component \"" + name + "\"");
+	}
+	
+	return slot-1;
+}
+
+shared_ptr<Component> ComponentFactory::create(ComponentTypeID type,
+  UID uid,
+  ScopedEventHandler *scope) {
+	const vector<Entry> &types = getTypes();
+	ASSERT(type < types.size(), "Invalid component type: " + sizet_to_string(type));
+	return types[type].allocator(uid, scope);
+}
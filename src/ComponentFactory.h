@@ -0,0 +1,161 @@
+#ifndef COMPONENT_FACTORY_H
+#define COMPONENT_FACTORY_H
+
+#include <new>
+
+class Component;
+class ScopedEventHandler;
+
+/** Dense, zero-based index of a registered component type */
+typedef size_t ComponentTypeID;
+
+/**
+Memory pool for a single component type.
+Storage for destroyed components is kept on an intrusive free list and
+reused by the next component of the same type.
+*/
+template<typename COMPONENT>
+class ComponentPool {
+private:
+	/** Free blocks are linked through their first bytes */
+	union Block {
+		Block *next;
+		char storage[sizeof(COMPONENT)];
+	};
+	
+	static Block *freeList;
+	
+public:
+	/** Gets uninitialized storage for one component */
+	static void* acquire() {
+		if (freeList) {
+			Block *block = freeList;
+			freeList = block->next;
+			return block;
+		} else {
+			return ::operator new(sizeof(Block));
+		}
+	}
+	
+	/** Returns storage to the pool without destroying an object in it */
+	static void recycle(void *memory) {
+		Block *block = reinterpret_cast<Block*>(memory);
+		block->next = freeList;
+		freeList = block;
+	}
+	
+	/** Destroys the component and returns its storage to the pool */
+	static void release(COMPONENT *component) {
+		if (component) {
+			component->~COMPONENT();
+			recycle(component);
+		}
+	}
+};
+
+template<typename COMPONENT>
+typename ComponentPool<COMPONENT>::Block *ComponentPool<COMPONENT>::freeList = 0;
+
+/**
+Creates components by name.
+Each component type registers itself once, at static initialization time,
+with the REGISTER_COMPONENT macro. Types are assigned dense IDs and
+allocators are stored in a table indexed by that ID. Names are resolved to
+IDs through a collision-free hash table that is built once, when the first
+component is created.
+*/
+class ComponentFactory {
+public:
+	typedef shared_ptr<Component> (*Allocator)(UID uid, ScopedEventHandler *scope);
+	
+	/**
+	Registers a component type with the factory
+	@param name Name of the component type, as used in actor definitions
+	@param allocator Allocates instances of the component
+	@return ID of the component type
+	*/
+	static ComponentTypeID registerType(const string &name,
+	                                    Allocator allocator);
+	
+	/**
+	Resolves a component name to the ID of the component type
+	@param name Name of the component type
+	@return ID of the component type (fails if the name is unknown)
+	*/
+	static ComponentTypeID getTypeID(const string &name);
+	
+	/** Creates a component given the ID of its type */
+	static shared_ptr<Component> create(ComponentTypeID type,
+	                                    UID uid,
+	                                    ScopedEventHandler *scope);
+	
+	/** Creates a component given the component name */
+	static shared_ptr<Component> create(const string &name,
+	                                    UID uid,
+	                                    ScopedEventHandler *scope) {
+		return create(getTypeID(name), uid, scope);
+	}
+	
+	/** Allocates a component of a particular type from its pool */
+	template<typename COMPONENT> static
+	shared_ptr<Component> allocate(UID uid, ScopedEventHandler *scope) {
+		void *memory = ComponentPool<COMPONENT>::acquire();
+		COMPONENT *component = 0;
+		
+		try {
+			component = new(memory) COMPONENT(uid, scope);
+		} catch(...) {
+			ComponentPool<COMPONENT>::recycle(memory);
+			throw;
+		}
+		
+		return shared_ptr<Component>(component,
+		                             &ComponentPool<COMPONENT>::release);
+	}
+	
+private:
+	struct Entry {
+		string name;
+		Allocator allocator;
+	};
+	
+	/** Registered component types, indexed by ComponentTypeID */
+	static vector<Entry>& getTypes();
+	
+	/**
+	Slots of the name hash table, each holding a ComponentTypeID+1 or zero
+	for an empty slot
+	*/
+	static vector<size_t> hashTable;
+	
+	/** Number of component types that were registered when the table was built */
+	static size_t hashTableTypes;
+	
+	/** Hashes a component name */
+	static size_t hash(const string &name);
+	
+	/**
+	Rebuilds the name hash table, growing it until no two registered names
+	share a slot
+	*/
+	static void buildHashTable();
+};
+
+/** Registers a component type with the ComponentFactory when constructed */
+template<typename COMPONENT>
+class ComponentRegistrar {
+public:
+	ComponentRegistrar(const string &name) {
+		ComponentFactory::registerType(name,
+		                               &ComponentFactory::allocate<COMPONENT>);
+	}
+};
+
+/**
+Registers a component type with the factory at static initialization time.
+Place this in the component's source file.
+*/
+#define REGISTER_COMPONENT(name, COMPONENT) \
+static ComponentRegistrar<COMPONENT> _component_registrar_(name);
+
+#endif
@@ -5,6 +5,9 @@
 #include "ActionSetPosition.h"
 #include "ComponentGate.h"
 
+REGISTER_COMPONENT("Gate", ComponentGate)
+REGISTER_COMPONENT_SCHEMA("Gate", ComponentGate)
+
 ComponentGate::ComponentGate(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
 	REGISTER_HANDLER(ComponentGate::handleEventUsesObject);
@@ -41,17 +44,27 @@ void ComponentGate::resetMembers() {
 
 void ComponentGate::draw() const {}
 
-void ComponentGate::load(const PropertyBag &data) {
+void ComponentGate::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("initialState", &Data::initialState)
+	      .field("positionA", &Data::positionA)
+	      .field("positionB", &Data::positionB)
+	      .field("timeToTransitionAB", &Data::timeToTransitionAB)
+	      .field("timeToTransitionBA", &Data::timeToTransitionBA);
+}
+
+void ComponentGate::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
 	
-	state = ("a" == toLowerCase(data.getString("initialState")))
+	state = ("a" == toLowerCase(data.initialState))
 	        ? STATE_A
 	        : STATE_B;
 	        
-	positionA = data.getVec3("positionA");
-	positionB = data.getVec3("positionB");
-	timeToTransitionAB = data.getFloat("timeToTransitionAB");
-	timeToTransitionBA = data.getFloat("timeToTransitionBA");
+	positionA = data.positionA;
+	positionB = data.positionB;
+	timeToTransitionAB = data.timeToTransitionAB;
+	timeToTransitionBA = data.timeToTransitionBA;
 }
 
 void ComponentGate::update(float milliseconds) {
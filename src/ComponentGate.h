@@ -20,8 +20,27 @@ public:
 	/** Resets all object members to defaults */
 	virtual void resetMembers();
 	
-	/** Loads component data from the pool of all object data */
-	virtual void load(const PropertyBag &data);
+	/** Fields of the component in actor templates */
+	struct Data {
+		Data()
+				: initialState("a"),
+				positionA(0.0f, 0.0f, 0.5f),
+				positionB(0.0f, 0.0f, 5.0f),
+				timeToTransitionAB(1000.0f),
+				timeToTransitionBA(1000.0f) {}
+		
+		string initialState;
+		vec3 positionA;
+		vec3 positionB;
+		float timeToTransitionAB;
+		float timeToTransitionBA;
+	};
+	
+	/** Declares the fields of the component in actor templates */
+	static void declareSchema(ComponentSchemaOf<Data> &schema);
+	
+	/** Loads component data compiled from the actor template */
+	virtual void load(const ComponentData &compiled);
 	
 	/** Draws the object */
 	virtual void draw() const;
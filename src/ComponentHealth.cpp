@@ -14,6 +14,9 @@
 #include "ActionEnableModelHighlight.h"
 #include "ActionDisableModelHighlight.h"
 
+REGISTER_COMPONENT("Health", ComponentHealth)
+REGISTER_COMPONENT_SCHEMA("Health", ComponentHealth)
+
 ComponentHealth::ComponentHealth(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope),
 		world(0) {
@@ -97,12 +100,21 @@ void ComponentHealth::handleEventHeightUpdate( const EventHeightUpdate *event )
 	lastReportedHeight = event->height;
 }
 
-void ComponentHealth::load(const PropertyBag &data) {
+void ComponentHealth::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("health", &Data::health)
+	      .field("maxHealth", &Data::maxHealth)
+	      .field("willResurrectAfterCountDown", &Data::willResurrectAfterCountDown)
+	      .field("timeUntilResurrection", &Data::timeUntilResurrection);
+}
+
+void ComponentHealth::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
-	health = data.getInt("health");
-	maxHealth = data.getInt("maxHealth");
-	willResurrectAfterCountDown = data.getBool("willResurrectAfterCountDown");
-	timeUntilResurrection = data.getFloat("timeUntilResurrection");
+	health = data.health;
+	maxHealth = data.maxHealth;
+	willResurrectAfterCountDown = data.willResurrectAfterCountDown;
+	timeUntilResurrection = data.timeUntilResurrection;
 }
 
 void ComponentHealth::handleEventExplosionOccurred(const EventExplosionOccurred *event) {
@@ -34,8 +34,25 @@ public:
 	/** Resets all object members to defaults */
 	virtual void resetMembers();
 	
-	/** Loads component data from the pool of all object data */
-	virtual void load(const PropertyBag &data);
+	/** Fields of the component in actor templates */
+	struct Data {
+		Data()
+				: health(100),
+				maxHealth(100),
+				willResurrectAfterCountDown(false),
+				timeUntilResurrection(0.0f) {}
+		
+		int health;
+		int maxHealth;
+		bool willResurrectAfterCountDown;
+		float timeUntilResurrection;
+	};
+	
+	/** Declares the fields of the component in actor templates */
+	static void declareSchema(ComponentSchemaOf<Data> &schema);
+	
+	/** Loads component data compiled from the actor template */
+	virtual void load(const ComponentData &compiled);
 	
 	/** Updates the object */
 	virtual void update(float milliseconds);
@@ -6,6 +6,8 @@
 #include "ActionEnableModelHighlight.h"
 #include "ActionDisableModelHighlight.h"
 
+REGISTER_COMPONENT("HighlightOnApproach", ComponentHighlightOnApproach)
+
 ComponentHighlightOnApproach::
 ComponentHighlightOnApproach(UID uid, ScopedEventHandler *blackBoard)
 		: Component(uid, blackBoard) {
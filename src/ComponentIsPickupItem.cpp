@@ -6,6 +6,8 @@
 #include "EventPicksUpItem.h"
 #include "ActionDeleteActor.h"
 
+REGISTER_COMPONENT("IsPickupItem", ComponentIsPickupItem)
+
 ComponentIsPickupItem::~ComponentIsPickupItem() {
 	delete effects;
 }
@@ -5,6 +5,9 @@
 #include "ComponentIsSwitch.h"
 #include "EventSwitchToggled.h"
 
+REGISTER_COMPONENT("IsSwitch", ComponentIsSwitch)
+REGISTER_COMPONENT_SCHEMA("IsSwitch", ComponentIsSwitch)
+
 ComponentIsSwitch::ComponentIsSwitch(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
 	REGISTER_HANDLER(ComponentIsSwitch::handleEventUsesObject);
@@ -19,9 +22,15 @@ void ComponentIsSwitch::resetMembers() {
 	categoryID = 0;
 }
 
-void ComponentIsSwitch::load(const PropertyBag &data) {
+void ComponentIsSwitch::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("categoryID", &Data::categoryID);
+}
+
+void ComponentIsSwitch::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
-	categoryID = data.getInt("categoryID");
+	categoryID = data.categoryID;
 }
 
 void ComponentIsSwitch::update(float) {
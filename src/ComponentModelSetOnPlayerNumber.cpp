@@ -5,6 +5,8 @@
 
 #include "ActionSetModel.h"
 
+REGISTER_COMPONENT("ModelSetOnPlayerNumber", ComponentModelSetOnPlayerNumber)
+
 ComponentModelSetOnPlayerNumber::
 ComponentModelSetOnPlayerNumber(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
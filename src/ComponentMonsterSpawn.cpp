@@ -5,6 +5,10 @@
 #include "ComponentHealth.h"
 #include "ComponentPhysics.h"
 #include "ComponentMonsterSpawn.h"
+#include "ActorPrototypes.h"
+
+REGISTER_COMPONENT("MonsterSpawn", ComponentMonsterSpawn)
+REGISTER_COMPONENT_SCHEMA("MonsterSpawn", ComponentMonsterSpawn)
 
 ComponentMonsterSpawn::
 ComponentMonsterSpawn(UID uid, ScopedEventHandler *parentScope)
@@ -43,19 +47,31 @@ void ComponentMonsterSpawn::draw() const {
 	/* Does nothing */
 }
 
-void ComponentMonsterSpawn::load(const PropertyBag &data) {
+void ComponentMonsterSpawn::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("spawnRate", &Data::spawnRate)
+	      .field("maxSpawnNum", &Data::maxSpawnNum)
+	      .field("maxSimulNum", &Data::maxSimulNum)
+	      .field("bKillChildrenOnDeath", &Data::bKillChildrenOnDeath)
+	      .field("bSpawnProximityOnly", &Data::bSpawnProximityOnly)
+	      .field("bIsOn", &Data::bIsOn)
+	      .field("monsterTemplateFile", &Data::monsterTemplateFile);
+}
+
+void ComponentMonsterSpawn::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	//clear data before loading
 	resetMembers();
 	
 	//load appropriate data
-	spawnRate = data.getFloat("spawnRate");
+	spawnRate = data.spawnRate;
 	//typeToSpawn = getMonsterTypeFromString(data.getString("typeToSpawn"));
-	maxSpawnNum = data.getInt("maxSpawnNum");
-	maxSimulNum = data.getInt("maxSimulNum");
-	bKillChildrenOnDeath = data.getBool("bKillChildrenOnDeath");
-	bSpawnProximityOnly = data.getBool("bSpawnProximityOnly");
-	bIsOn = data.getBool("bIsOn");
-	templateFile = data.getFileName("monsterTemplateFile");
+	maxSpawnNum = data.maxSpawnNum;
+	maxSimulNum = data.maxSimulNum;
+	bKillChildrenOnDeath = data.bKillChildrenOnDeath;
+	bSpawnProximityOnly = data.bSpawnProximityOnly;
+	bIsOn = data.bIsOn;
+	templateFile = data.monsterTemplateFile;
 	
 	//calculate spawn interval (in milliseconds) and set time
 	spawnInterval = (60000.0f) / spawnRate;
@@ -88,17 +104,18 @@ bool ComponentMonsterSpawn::spawnOK() {
 }
 
 ActorPtr ComponentMonsterSpawn::spawnMonster() {
-	return spawnMonster(loadActorDefinition(templateFile),
+	return spawnMonster(ActorPrototypes::get(templateFile),
 	                    generateSpawnLocation());
 }
 
 ActorPtr ComponentMonsterSpawn::spawnMonster(const ComponentDataSet &s,
   const vec3 &spawnLoc) {
 	ASSERT(world, "world has not been set yet");
-	const tuple<ActorID, ActorPtr> t = world->getObjects().create();
-	ActorPtr newMonster = t.get<1>();
+	ActorPtr newMonster = world->getObjects().spawnImmediately(templateFile,
+	                      s,
+	                      spawnLoc,
+	                      vec3(0.0, 0.0, 0.0));
 	ASSERT(newMonster, "Failed to create monster actor");
-	newMonster->load(s, spawnLoc, vec3(0.0, 0.0, 0.0), world);
 	
 	if (isDebugDisplayEnabled()) {
 		ActionDebugEnable m;
@@ -156,12 +173,6 @@ void ComponentMonsterSpawn::removeDeadChildren() {
 	*/
 }
 
-ComponentDataSet ComponentMonsterSpawn::loadActorDefinition( const FileName &file ) {
-	const PropertyBag templateData = PropertyBag::fromFile(file);
-	const PropertyBag base = templateData.getBag("components");
-	return ComponentDataSet::parse(base);
-}
-
 vec3 ComponentMonsterSpawn::generateSpawnLocation() const {
 	float height = 0.0f;
 	
@@ -36,8 +36,30 @@ public:
 	/** Resets all object members to defaults */
 	virtual void resetMembers();
 	
-	/** Loads component data from the pool of all object data */
-	virtual void load(const PropertyBag &data);
+	/** Fields of the component in actor templates */
+	struct Data {
+		Data()
+				: spawnRate(0.0f),
+				maxSpawnNum(0),
+				maxSimulNum(0),
+				bKillChildrenOnDeath(false),
+				bSpawnProximityOnly(false),
+				bIsOn(false) {}
+		
+		float spawnRate;
+		int maxSpawnNum;
+		int maxSimulNum;
+		bool bKillChildrenOnDeath;
+		bool bSpawnProximityOnly;
+		bool bIsOn;
+		FileName monsterTemplateFile;
+	};
+	
+	/** Declares the fields of the component in actor templates */
+	static void declareSchema(ComponentSchemaOf<Data> &schema);
+	
+	/** Loads component data compiled from the actor template */
+	virtual void load(const ComponentData &compiled);
 	
 	/** Draws the object */
 	virtual void draw() const;
@@ -77,13 +99,6 @@ private:
 	*/
 	vec3 generateSpawnLocation() const;
 	
-	/**
-	Loads the actor definition from file
-	@param file File that contains the actor definition
-	@return actor data definition
-	*/
-	static ComponentDataSet loadActorDefinition(const FileName &file);
-	
 	/** Determines if monster is allowed to be spawned */
 	bool spawnOK();
 	
@@ -12,6 +12,9 @@
 #include "ActionSetPosition.h"
 #include "ActionLookAt.h"
 
+REGISTER_COMPONENT("Movement", ComponentMovement)
+REGISTER_COMPONENT_SCHEMA("Movement", ComponentMovement)
+
 ComponentMovement::ComponentMovement(UID uid,  ScopedEventHandler *s)
 		: Component(uid, s),
 		amotor(0),
@@ -44,9 +47,16 @@ void ComponentMovement::resetMembers() {
 	if (lmotor) dJointDestroy(lmotor);
 }
 
-void ComponentMovement::load(const PropertyBag &data) {
-	topSpeed = data.getFloat("topSpeed");
-	maxForce = (dReal)data.getFloat("maxForce");
+void ComponentMovement::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("topSpeed", &Data::topSpeed)
+	      .field("maxForce", &Data::maxForce);
+}
+
+void ComponentMovement::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
+	topSpeed = data.topSpeed;
+	maxForce = (dReal)data.maxForce;
 	createMotorJoints();
 }
 
@@ -252,6 +262,9 @@ void ComponentMovement::createMotorJoints() {
 	dBodyID body = getBodyID();
 	ASSERT(body, "Cannot create motor joints: No physics body available");
 	
+	// Motors do not re-enable a body that ODE has auto-disabled
+	dBodySetAutoDisableFlag(body, 0);
+	
 	amotor = dJointCreateAMotor(physicsEngine->getWorld(), 0);
 	dJointAttach(amotor, body, 0);
 	dJointSetAMotorNumAxes(amotor, 3);
@@ -34,8 +34,21 @@ public:
 	
 	ComponentMovement(UID _uid, ScopedEventHandler *_blackBoard);
 	
-	/** Loads component data from the pool of all object data */
-	virtual void load(const PropertyBag &data);
+	/** Fields of the component in actor templates */
+	struct Data {
+		Data()
+				: topSpeed(0.0f),
+				maxForce(5000.0f) {}
+		
+		float topSpeed;
+		float maxForce;
+	};
+	
+	/** Declares the fields of the component in actor templates */
+	static void declareSchema(ComponentSchemaOf<Data> &schema);
+	
+	/** Loads component data compiled from the actor template */
+	virtual void load(const ComponentData &compiled);
 	
 	/** Declares the position and orientation for the frame */
 	virtual void update(float milliseconds);
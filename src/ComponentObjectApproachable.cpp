@@ -1,11 +1,12 @@
 #include "stdafx.h"
 #include "World.h"
-#include "ComponentPhysics.h"
 #include "ComponentObjectApproachable.h"
 
 #include "EventApproachActor.h"
 #include "EventRecedesFromActor.h"
 
+REGISTER_COMPONENT("ObjectApproachable", ComponentObjectApproachable)
+
 ComponentObjectApproachable::ComponentObjectApproachable( UID uid, ScopedEventHandler *parentScope )
 		: Component(uid, parentScope),
 		world(0),
@@ -33,30 +34,41 @@ void ComponentObjectApproachable::load( const PropertyBag &data ) {
 void ComponentObjectApproachable::update(float) {
 	ASSERT(world, "World has not been set yet");
 	
-	const ActorSet &players = world->players;
+	// Only actors within the release distance can change state to "near"
+	nearby.clear();
+	world->getSpatialIndex().queryRadius(lastReportedPosition,
+	                                     max(thresholdTrigger, thresholdRelease),
+	                                     nearby);
+	                                     
+	playersInRange.clear();
 	
-	for (ActorSet::const_iterator i=players.begin(); i!=players.end(); ++i) {
-		ActorPtr player = i->second;
+	for (SpatialIndex::ActorIDList::const_iterator i = nearby.begin();
+	     i != nearby.end(); ++i) {
+		const ActorID id = *i;
+		vec3 position;
 		
-		if (player->hasComponent("Physics")) {
-			shared_ptr<Component> component;
-			shared_ptr<ComponentPhysics> physics;
+		if (world->isAPlayer(id) &&
+		    world->getSpatialIndex().getPosition(id, position)) {
+			const float distance = vec3(position-lastReportedPosition).getMagnitude();
 			
-			component = player->getComponent("Physics");
-			physics = dynamic_pointer_cast<ComponentPhysics>(component);
+			if (distance <= thresholdTrigger) {
+				playerApproaches(id);
+			}
 			
-			if (physics) {
-				const float distance = vec3((physics->getPosition())-lastReportedPosition).getMagnitude();
-				const ActorID id = player->getUID();
-				
-				if (distance <= thresholdTrigger) {
-					playerApproaches(id);
-				} else if (distance > thresholdRelease) {
-					playerRecedes(id);
-				}
+			if (distance <= thresholdRelease) {
+				playersInRange.push_back(id);
 			}
 		}
 	}
+	
+	// Any player that was near and is no longer in range has receded
+	for (map<ActorID, State>::const_iterator i = playerState.begin();
+	     i != playerState.end(); ++i) {
+		if (i->second == OBJECT_NEAR &&
+		    find(playersInRange.begin(), playersInRange.end(), i->first) == playersInRange.end()) {
+			playerRecedes(i->first);
+		}
+	}
 }
 
 void ComponentObjectApproachable::handleEventPositionUpdate( const EventPositionUpdate *event ) {
@@ -68,15 +80,19 @@ void ComponentObjectApproachable::handleMessagePassWorld( const MessagePassWorld
 }
 
 void ComponentObjectApproachable::playerRecedes(ActorID id) {
-	if (playerState[id] == OBJECT_NEAR) {
-		playerState[id] = OBJECT_FAR;
+	map<ActorID, State>::iterator iter = playerState.find(id);
+	
+	if (iter != playerState.end() && iter->second == OBJECT_NEAR) {
+		iter->second = OBJECT_FAR;
 		EventRecedesFromActor m(id);
 		sendEvent(&m);
 	}
 }
 
 void ComponentObjectApproachable::playerApproaches(ActorID id) {
-	if (playerState[id] == OBJECT_FAR) {
+	map<ActorID, State>::iterator iter = playerState.find(id);
+	
+	if (iter == playerState.end() || iter->second == OBJECT_FAR) {
 		playerState[id] = OBJECT_NEAR;
 		EventApproachActor m(id);
 		sendEvent(&m);
@@ -3,6 +3,7 @@
 
 #include "PropertyBag.h"
 #include "Component.h"
+#include "SpatialIndex.h"
 
 #include "EventPositionUpdate.h"
 #include "MessagePassWorld.h"
@@ -56,6 +57,13 @@ private:
 	enum State { OBJECT_NEAR, OBJECT_FAR };
 	
 	map<ActorID, State> playerState;
+	
+	/**
+	Scratch lists for update(), kept as members so that their storage is
+	reused from frame to frame
+	*/
+	SpatialIndex::ActorIDList nearby;
+	SpatialIndex::ActorIDList playersInRange;
 };
 
 #endif
@@ -4,6 +4,8 @@
 #include "ComponentObjectCanBeUsed.h"
 #include "EventUsesObject.h"
 
+REGISTER_COMPONENT("ObjectCanBeUsed", ComponentObjectCanBeUsed)
+
 ComponentObjectCanBeUsed::
 ComponentObjectCanBeUsed(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
@@ -8,8 +8,13 @@
 #include "EventOrientationUpdate.h"
 #include "EventHeightUpdate.h"
 
+REGISTER_COMPONENT("PhysicsBody", ComponentPhysicsBody)
+
 ComponentPhysicsBody::ComponentPhysicsBody(UID uid, ScopedEventHandler *parentScope)
-		: ComponentPhysics(uid, parentScope) {
+		: ComponentPhysics(uid, parentScope),
+		body(0),
+		geom(0),
+		mesh(0) {
 	resetMembers();
 	
 	REGISTER_HANDLER(ComponentPhysicsBody::handleMessagePassWorld);
@@ -20,13 +25,24 @@ ComponentPhysicsBody::ComponentPhysicsBody(UID uid, ScopedEventHandler *parentSc
 	REGISTER_HANDLER(ComponentPhysicsBody::handleActionDeleteActor);
 	REGISTER_HANDLER(ComponentPhysicsBody::handleActionPhysicsDisable);
 	REGISTER_HANDLER(ComponentPhysicsBody::handleActionPhysicsEnable);
+	REGISTER_HANDLER(ComponentPhysicsBody::handleActionSleep);
+	REGISTER_HANDLER(ComponentPhysicsBody::handleActionWake);
+}
+
+ComponentPhysicsBody::~ComponentPhysicsBody() {
+	destroyPhysicsResources();
 }
 
 void ComponentPhysicsBody::handleActionDeleteActor( const ActionDeleteActor *action ) {
 	const ActorID myID = getParentScopePtr()->getUID();
 	
 	if (myID == action->id) {
-		destroyPhysicsResources();
+		/*
+		The actor may be recycled through the actor pool, so keep the body
+		and geom but take them out of the simulation. They are destroyed
+		with the component if the actor is not recycled.
+		*/
+		disablePhysicsResources();
 		resetMembers();
 	}
 }
@@ -85,8 +101,6 @@ void ComponentPhysicsBody::handleEventDeclareInitialPosition( const EventDeclare
 
 void ComponentPhysicsBody::resetMembers() {
 	modelScale = 1.0f;
-	body=0;
-	geom=0;
 	disableCollisions=false;
 	
 	collisionRadius = 1.0f;
@@ -107,6 +121,21 @@ void ComponentPhysicsBody::update(float) {
 		// Declare the final position and orientation for this frame
 		broadcastPositionUpdate();
 		broadcastOrientationUpdate();
+		
+		keepActorAwakeWhileMoving();
+	}
+}
+
+void ComponentPhysicsBody::keepActorAwakeWhileMoving() {
+	// Bodies driven by motors are never auto-disabled, so check velocity too
+	if (body && dBodyIsEnabled(body)) {
+		const dReal *v = dBodyGetLinearVel(body);
+		const dReal speedSquared = v[0]*v[0] + v[1]*v[1] + v[2]*v[2];
+		
+		if (speedSquared > SQR(0.01f)) {
+			ActionWake m;
+			sendAction(&m);
+		}
 	}
 }
 
@@ -133,14 +162,19 @@ void ComponentPhysicsBody::load(const PropertyBag &data) {
 	ASSERT(physicsEngine, "physics engine is null");
 	
 	resetMembers();
-	
-	// Destroy any previous rigid body
-	destroyAllJoints();
-	destroyPhysicsResources();
-	
-	// Create the rigid body
 	loadRigidBodyData(data);
-	createBodyRigidBodyData();
+	
+	if (canReuseRigidBody()) {
+		// A recycled actor keeps the body it had when it was deleted
+		enablePhysicsResources();
+	} else {
+		// Destroy any previous rigid body
+		destroyAllJoints();
+		destroyPhysicsResources();
+		
+		// Create the rigid body
+		createBodyRigidBodyData();
+	}
 	
 	// Load initial position from data, if available
 	loadPosition(data);
@@ -178,6 +212,12 @@ void ComponentPhysicsBody::setPosition(const vec3 &position) {
 void ComponentPhysicsBody::setVelocity(const vec3 &velocity) {
 	if (!disableCollisions) {
 		ASSERT(body, "Physics body is nil");
+		
+		// A body that ODE disabled at rest will not move until re-enabled
+		if (!dBodyIsEnabled(body)) {
+			dBodyEnable(body);
+		}
+		
 		dBodySetLinearVel(body, velocity.x, velocity.y, velocity.z);
 	}
 }
@@ -372,6 +412,19 @@ void ComponentPhysicsBody::handleActionPhysicsEnable(const ActionPhysicsEnable *
 	}
 }
 
+void ComponentPhysicsBody::handleActionSleep(const ActionSleep *) {
+	if (body) {
+		dBodyDisable(body);
+	}
+}
+
+void ComponentPhysicsBody::handleActionWake(const ActionWake *) {
+	// Enabling an enabled body would restart ODE's auto-disable countdown
+	if (body && !dBodyIsEnabled(body)) {
+		dBodyEnable(body);
+	}
+}
+
 void ComponentPhysicsBody::destroyAllJoints() {
 	if (!body) {
 		return;
@@ -398,6 +451,41 @@ void ComponentPhysicsBody::resetBodyParameters( dBodyID body ) {
 	dBodySetAngularVel(body, 0, 0, 0);
 }
 
+bool ComponentPhysicsBody::canReuseRigidBody() const {
+	return body && geom &&
+	       physicsGeometryType == bodyGeometryType &&
+	       collisionRadius == bodyRadius &&
+	       desiredHeight == bodyHeight &&
+	       kilograms == bodyKilograms;
+}
+
+void ComponentPhysicsBody::disablePhysicsResources() {
+	if (body) {
+		destroyAllJoints();
+		resetBodyParameters(body);
+		dBodyDisable(body);
+	}
+	
+	if (geom) {
+		dGeomDisable(geom);
+	}
+}
+
+void ComponentPhysicsBody::enablePhysicsResources() {
+	ASSERT(body && geom, "Physics resources have not been created");
+	
+	dMatrix3 r;
+	dRSetIdentity(r);
+	
+	destroyAllJoints();
+	resetBodyParameters(body);
+	dBodySetPosition(body, 0, 0, 0);
+	dBodySetRotation(body, r);
+	dBodySetGravityMode(body, influencedByGravity ? 1 : 0);
+	dBodyEnable(body);
+	dGeomEnable(geom);
+}
+
 void ComponentPhysicsBody::destroyPhysicsResources() {
 	if (body) {
 		dBodyDestroy(body);
@@ -437,6 +525,11 @@ void ComponentPhysicsBody::createBodyRigidBodyData() {
 	createGeom(physicsGeometryType, kilograms);
 	dBodySetGravityMode(body, influencedByGravity ? 1 : 0);
 	resetBodyParameters(body);
+	
+	bodyGeometryType = physicsGeometryType;
+	bodyRadius = collisionRadius;
+	bodyHeight = desiredHeight;
+	bodyKilograms = kilograms;
 }
 
 void ComponentPhysicsBody::loadPosition( const PropertyBag &data ) {
@@ -7,6 +7,8 @@
 #include "ActionDeleteActor.h"
 #include "ActionPhysicsDisable.h"
 #include "ActionPhysicsEnable.h"
+#include "ActionSleep.h"
+#include "ActionWake.h"
 #include "ActionSetPosition.h"
 #include "ActionLookAt.h"
 #include "ActionSetOrientation.h"
@@ -20,6 +22,9 @@ class ComponentPhysicsBody : public ComponentPhysics {
 public:
 	ComponentPhysicsBody(UID uid, ScopedEventHandler *parentScope);
 	
+	/** Destroys the rigid body, if there is one */
+	virtual ~ComponentPhysicsBody();
+	
 	/** Loads component data from the pool of all object data */
 	virtual void load(const PropertyBag &data);
 	
@@ -78,6 +83,8 @@ private:
 	void handleActionDeleteActor(const ActionDeleteActor *action);
 	void handleActionPhysicsDisable(const ActionPhysicsDisable *action);
 	void handleActionPhysicsEnable(const ActionPhysicsEnable *action);
+	void handleActionSleep(const ActionSleep *action);
+	void handleActionWake(const ActionWake *action);
 	void handleMessagePassWorld(const MessagePassWorld *message);
 	void handleActionSetPosition(const ActionSetPosition *action);
 	void handleActionLookAt(const ActionLookAt *action);
@@ -99,6 +106,21 @@ private:
 	/** Destroy physics resources */
 	void destroyPhysicsResources();
 	
+	/**
+	Removes the body and geom from the simulation without destroying them,
+	so that a recycled actor may use them again
+	*/
+	void disablePhysicsResources();
+	
+	/** Puts a disabled body and geom back into the simulation at rest */
+	void enablePhysicsResources();
+	
+	/**
+	Determines whether the existing body was created with the rigid body
+	parameters that were just loaded
+	*/
+	bool canReuseRigidBody() const;
+	
 	/**
 	Reset body parameters to remove all forces, torques, accelerations,
 	velocities, etc.
@@ -130,6 +152,13 @@ private:
 	
 	void broadcastHeightUpdate();
 	
+	/**
+	While the rigid body is in motion, the body keeps the actor awake.
+	Once the body comes to rest, ODE disables it and the actor is free to
+	fall asleep.
+	*/
+	void keepActorAwakeWhileMoving();
+	
 private:
 	dBodyID body;
 	dGeomID geom;
@@ -146,6 +175,12 @@ private:
 	bool influencedByGravity;
 	string physicsGeometryType;
 	float kilograms;
+	
+	/** Rigid body parameters that the current body was created with */
+	string bodyGeometryType;
+	float bodyRadius;
+	float bodyHeight;
+	float bodyKilograms;
 };
 
 #endif
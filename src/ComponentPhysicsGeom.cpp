@@ -7,9 +7,12 @@
 #include "EventOrientationUpdate.h"
 #include "EventHeightUpdate.h"
 
+REGISTER_COMPONENT("PhysicsGeom", ComponentPhysicsGeom)
+
 ComponentPhysicsGeom::
 ComponentPhysicsGeom(UID uid, ScopedEventHandler *parentScope)
-		: ComponentPhysics(uid, parentScope) {
+		: ComponentPhysics(uid, parentScope),
+		geom(0) {
 	resetMembers();
 	
 	REGISTER_HANDLER(ComponentPhysicsGeom::handleMessagePassWorld);
@@ -20,12 +23,16 @@ ComponentPhysicsGeom(UID uid, ScopedEventHandler *parentScope)
 	REGISTER_HANDLER(ComponentPhysicsGeom::handleActionDeleteActor);
 }
 
+ComponentPhysicsGeom::~ComponentPhysicsGeom() {
+	destroyGeom();
+}
+
 void ComponentPhysicsGeom::handleActionDeleteActor( const ActionDeleteActor *action ) {
-	if (action->id == getUID()) {
+	if (action->id == getActorID()) {
+		// Keep the geom out of the simulation in case the actor is recycled
 		if (geom) {
-			dGeomDestroy(geom);
+			dGeomDisable(geom);
 		}
-		geom=0;
 		resetMembers();
 	}
 }
@@ -71,7 +78,6 @@ void ComponentPhysicsGeom::handleActionLookAt( const ActionLookAt *action ) {
 void ComponentPhysicsGeom::resetMembers() {
 	collisionRadius = 1.0f;
 	desiredHeight = 1.0f;
-	geom=0;
 }
 
 void ComponentPhysicsGeom::update(float) {
@@ -107,12 +113,17 @@ void ComponentPhysicsGeom::load(const PropertyBag &data) {
 	desiredHeight = data.getFloat("height");
 	collisionRadius = data.getFloat("radius");
 	
-	// Create as physics geometry
-	if (geom) {
-		dGeomDestroy(geom);
+	const string type = data.getString("physicsGeometryType");
+	
+	if (geom && type == geomType &&
+	    collisionRadius == geomRadius && desiredHeight == geomHeight) {
+		// A recycled actor keeps the geom it had when it was deleted
+		dGeomEnable(geom);
+	} else {
+		// Create as physics geometry
+		destroyGeom();
+		createGeom(type);
 	}
-	geom=0;
-	createGeom(data.getString("physicsGeometryType"));
 	
 	// Set initial position
 	{
@@ -194,6 +205,17 @@ void ComponentPhysicsGeom::createGeom( const string &type ) {
 	ActorID *data = new ActorID;
 	*data = uid;
 	dGeomSetData(geom, data);
+	
+	geomType = type;
+	geomRadius = collisionRadius;
+	geomHeight = desiredHeight;
+}
+
+void ComponentPhysicsGeom::destroyGeom() {
+	if (geom) {
+		dGeomDestroy(geom);
+	}
+	geom=0;
 }
 
 void ComponentPhysicsGeom::createGeomSphere() {
@@ -24,6 +24,9 @@ class ComponentPhysicsGeom : public ComponentPhysics {
 public:
 	ComponentPhysicsGeom(UID _uid, ScopedEventHandler *_blackBoard);
 	
+	/** Destroys the geom, if there is one */
+	virtual ~ComponentPhysicsGeom();
+	
 	/** Loads component data from the pool of all object data */
 	virtual void load(const PropertyBag &data);
 	
@@ -70,6 +73,9 @@ private:
 	void createGeomCapsule();
 	void createGeomSphere();
 	
+	/** Destroys the geom, if there is one */
+	void destroyGeom();
+	
 	/** Draw local axes for this object */
 	void drawAxes() const;
 	
@@ -85,6 +91,11 @@ private:
 	
 	float collisionRadius;
 	float desiredHeight;
+	
+	/** Parameters that the current geom was created with */
+	string geomType;
+	float geomRadius;
+	float geomHeight;
 };
 
 #endif
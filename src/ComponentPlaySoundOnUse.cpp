@@ -2,6 +2,9 @@
 #include "ActionPlaySound.h"
 #include "ComponentPlaySoundOnUse.h"
 
+REGISTER_COMPONENT("PlaySoundOnUse", ComponentPlaySoundOnUse)
+REGISTER_COMPONENT_SCHEMA("PlaySoundOnUse", ComponentPlaySoundOnUse)
+
 ComponentPlaySoundOnUse::
 ComponentPlaySoundOnUse(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
@@ -12,9 +15,15 @@ void ComponentPlaySoundOnUse::resetMembers() {
 	sound = FileName("");
 }
 
-void ComponentPlaySoundOnUse::load(const PropertyBag &data) {
+void ComponentPlaySoundOnUse::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("sound", &Data::sound);
+}
+
+void ComponentPlaySoundOnUse::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
-	sound = data.getFileName("sound");
+	sound = data.sound;
 }
 
 void ComponentPlaySoundOnUse::update(float) {
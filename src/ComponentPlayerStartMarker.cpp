@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "ComponentPlayerStartMarker.h"
 
+REGISTER_COMPONENT("PlayerStartMarker", ComponentPlayerStartMarker)
+
 /** Constructor */
 ComponentPlayerStartMarker::ComponentPlayerStartMarker(UID uid,
   ScopedEventHandler *blackBoard)
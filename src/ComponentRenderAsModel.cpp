@@ -5,8 +5,12 @@
 #include "ComponentRenderAsModel.h"
 #include "RenderMethodTags.h"
 #include "EventRadiusUpdate.h"
+#include "AnimationLOD.h"
+
+REGISTER_COMPONENT("RenderAsModel", ComponentRenderAsModel)
 
 extern shared_ptr<AnimationControllerFactory> g_ModelFactory; // TODO: Remove global var?
+extern AnimationLOD g_AnimationLOD;
 
 ComponentRenderAsModel::
 ComponentRenderAsModel(UID _uid, ScopedEventHandler *_parentScope)
@@ -30,6 +34,10 @@ ComponentRenderAsModel(UID _uid, ScopedEventHandler *_parentScope)
 	REGISTER_HANDLER(ComponentRenderAsModel::handleActionDisableModelHighlight);
 }
 
+ComponentRenderAsModel::~ComponentRenderAsModel() {
+	delete model;
+}
+
 void ComponentRenderAsModel::resetMembers() {
 	// defaults
 	dead = false;
@@ -46,20 +54,29 @@ void ComponentRenderAsModel::resetMembers() {
 	highlightTimeRemaining = 0.0f;
 	colora = yellow;
 	colorb = white;
+	
+	// A recycled actor keeps its model, which may still be playing an
+	// animation, such as dying, that would refuse to change to idle
+	if (model) {
+		model->resetPlayback();
+	}
 }
 
 void ComponentRenderAsModel::loadModel(const FileName &fileName) {
 	ASSERT(g_ModelFactory, "modelFactory is null");
-	model = g_ModelFactory->createFromFile(fileName);
 	
-	changeAnimation("idle"); // default animation
-	modelHeight = model->calculateHeight(); // Calculate height of unscaled model
+	// A recycled actor may already hold its own copy of this model
+	if (!model || modelFileName != fileName) {
+		delete model;
+		model = g_ModelFactory->createFromFile(fileName);
+		modelFileName = fileName;
+	}
 	
-	// rescale the vertices directly
-	model->uniformScale(lastReportedHeight / modelHeight);
+	changeAnimation("idle"); // default animation
 	
-	modelHeight = model->calculateHeight(); // Calculate height of properly scaled model
-	ASSERT(fabsf(lastReportedHeight-modelHeight)<0.01f, "Model height is wrong");
+	// The key frames are shared by every instance of the model, so it is
+	// scaled to the height of the actor by its transformation instead
+	modelHeight = model->getHeight(); // Height of unscaled model
 	
 	broadcastModelRadius();
 }
@@ -69,13 +86,7 @@ void ComponentRenderAsModel::update(float milliseconds) {
 	
 	model->update(milliseconds);
 	
-	// Pass mesh to the renderer
-	vector<RenderInstance> m;
-	emitGeometry(m);
-	for (vector<RenderInstance>::iterator i=m.begin(); i!=m.end(); ++i) {
-		ActionQueueRenderInstance action(*i);
-		getParentScope().sendGlobalAction(&action);
-	}
+	queueForRender();
 	
 	if (highlightMode != HighlightDisable) {
 		// update highlighting intensity
@@ -93,6 +104,40 @@ void ComponentRenderAsModel::update(float milliseconds) {
 	}
 }
 
+void ComponentRenderAsModel::updateAsleep(float) {
+	ASSERT(model, "Null pointer: model");
+	queueForRender();
+}
+
+void ComponentRenderAsModel::queueForRender() {
+	const float modelScale = lastReportedHeight / modelHeight;
+	
+	// The bounds of the current animation enclose every frame of it, so
+	// their sphere, placed by the actor's transformation, holds the model
+	// wherever it is in the animation
+	const BoundingVolume &bounds = model->getBounds();
+	const vec3 center = getTransformation().transformVector(bounds.getSphereCenter());
+	const float radius = bounds.getSphereRadius() * modelScale;
+	
+	// Models out of view keep advancing in time, but are not blended
+	float quantum = 0.0f;
+	
+	if (!g_AnimationLOD.choose(center,
+	                           radius,
+	                           model->getNumVertices(),
+	                           quantum)) {
+		return;
+	}
+	
+	// Pass mesh to the renderer
+	vector<RenderInstance> m;
+	emitGeometry(m, quantum);
+	for (vector<RenderInstance>::iterator i=m.begin(); i!=m.end(); ++i) {
+		ActionQueueRenderInstance action(*i);
+		getParentScope().sendGlobalAction(&action);
+	}
+}
+
 bool ComponentRenderAsModel::changeAnimation(const string &name) {
 	ASSERT(model, "Null pointer: model");
 	return model->requestAnimationChange(name);
@@ -105,11 +150,6 @@ void ComponentRenderAsModel::handleActionSetModel(const ActionSetModel *message
 void ComponentRenderAsModel::handleEventHeightUpdate( const EventHeightUpdate *event ) {
 	if (event->height != lastReportedHeight) {
 		lastReportedHeight = event->height;
-		
-		// rescale the vertices directly
-		model->uniformScale(lastReportedHeight / modelHeight);
-		
-		modelHeight = model->calculateHeight(); // Recalculate height of unscaled model
 		broadcastModelRadius();
 	}
 }
@@ -170,13 +210,13 @@ void ComponentRenderAsModel::handleActionDisableModelHighlight(const ActionDisab
 
 void ComponentRenderAsModel::broadcastModelRadius() {
 	const float modelScale = lastReportedHeight / modelHeight;
-	float modelRadius = model->calculateCylindricalRadius();
+	const float modelRadius = model->getBounds().getCylindricalRadius();
 	EventRadiusUpdate m(modelRadius * modelScale);
 	sendEvent(&m);
 }
 
 mat4 ComponentRenderAsModel::getTransformation() const {
-	float modelScale = 1.0f; // lastReportedHeight / modelHeight;
+	const float modelScale = lastReportedHeight / modelHeight;
 	
 	vec3 pos = lastReportedPosition - vec3(0, 0, lastReportedHeight/2.0f);
 	
@@ -213,11 +253,12 @@ mat4 ComponentRenderAsModel::getTransformation() const {
 	return transformation;
 }
 
-void ComponentRenderAsModel::emitGeometry(vector<RenderInstance> &m) const {
+void ComponentRenderAsModel::emitGeometry(vector<RenderInstance> &m,
+                                          float quantum) const {
 	const mat4 transformation = getTransformation();
 	
 	vector<GeometryChunk> chunks;
-	model->getGeometryChunks(chunks);
+	model->getGeometryChunks(chunks, quantum);
 	
 	for (vector<GeometryChunk>::iterator i=chunks.begin(); i!=chunks.end();++i) {
 		RenderInstance instance;
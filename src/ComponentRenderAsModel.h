@@ -27,12 +27,18 @@ public:
 	
 	ComponentRenderAsModel(UID _uid, ScopedEventHandler *_blackBoard);
 	
+	/** Destructor */
+	virtual ~ComponentRenderAsModel();
+	
 	/** Loads component data from the pool of all object data */
 	virtual void load(const PropertyBag &data);
 	
 	/** Updates the object */
 	virtual void update(float milliseconds);
 	
+	/** Keeps drawing the model, without animating it, while asleep */
+	virtual void updateAsleep(float milliseconds);
+	
 	/** Resets all object members to defaults */
 	virtual void resetMembers();
 	
@@ -76,14 +82,26 @@ private:
 	/** Gets the death behavior of the character */
 	DeathBehavior getDeathBehavior() const;
 	
-	/** Get all the static meshes for this tick */
-	void emitGeometry(vector<RenderInstance> &m) const;
+	/**
+	Get all the static meshes for this tick
+	@param m Returns the render instances
+	@param quantum Step, in key frames, that the position between key
+	       frames is rounded to (see AnimationLOD)
+	*/
+	void emitGeometry(vector<RenderInstance> &m, float quantum) const;
+	
+	/**
+	Passes the model's current geometry to the renderer, at the detail
+	chosen by the animation LOD, unless the model is out of view
+	*/
+	void queueForRender();
 	
 	/** Gets the transformation of the actor */
 	mat4 getTransformation() const;
 	
 private:
 	AnimationController *model;
+	FileName modelFileName;
 	vec3 lastReportedPosition;
 	mat3 lastReportedOrientation;
 	float lastReportedHeight;
@@ -0,0 +1,98 @@
+#include "Core.h"
+#include "ComponentSchema.h"
+
+/** Determines whether nothing but whitespace follows in a string */
+static bool isBlank(const char *s) {
+	while (*s && isspace((unsigned char)*s)) {
+		++s;
+	}
+	
+	return *s == 0;
+}
+
+bool ComponentFieldTraits<int>::check(const string &text) {
+	char *end = 0;
+	strtol(text.c_str(), &end, 10);
+	return end != text.c_str() && isBlank(end);
+}
+
+bool ComponentFieldTraits<float>::check(const string &text) {
+	char *end = 0;
+	strtod(text.c_str(), &end);
+	
+	if (end == text.c_str()) {
+		return false;
+	}
+	
+	// Templates often carry a C-style suffix, e.g. "2000.0f"
+	if (*end == 'f' || *end == 'F') {
+		++end;
+	}
+	
+	return isBlank(end);
+}
+
+bool ComponentFieldTraits<bool>::check(const string &text) {
+	const string value = toLowerCase(text);
+	return value == "true" || value == "false";
+}
+
+bool ComponentField::bind(const PropertyBag &bag,
+                          void *data,
+                          vector<string> &errors) const {
+	string text;
+	
+	if (!bag.get(name, text)) {
+		if (required) {
+			errors.push_back("missing tag \"" + name + "\"");
+			return false;
+		}
+		
+		return true;
+	}
+	
+	if (!check(text) || !convert(bag, data)) {
+		errors.push_back("tag \"" + name + "\" is not a valid " +
+		                 getTypeName() + ": \"" + text + "\"");
+		return false;
+	}
+	
+	return true;
+}
+
+shared_ptr<const ComponentData>
+ComponentSchema::compile(const PropertyBag &bag, vector<string> &errors) const {
+	shared_ptr<ComponentData> compiled = create();
+	void *data = getStruct(*compiled);
+	
+	for (vector<shared_ptr<ComponentField> >::const_iterator i = fields.begin();
+	     i != fields.end(); ++i) {
+		(*i)->bind(bag, data, errors);
+	}
+	
+	return compiled;
+}
+
+ComponentSchema::Registry& ComponentSchema::getRegistry() {
+	// Constructed on first use so that registration does not depend on the
+	// order of static initialization across translation units
+	static Registry registry;
+	return registry;
+}
+
+void ComponentSchema::registerSchema(const shared_ptr<ComponentSchema> &schema) {
+	ASSERT(schema, "Null parameter: schema");
+	
+	Registry &registry = getRegistry();
+	
+	ASSERT(registry.find(schema->getName()) == registry.end(),
+	       "Component schema registered more than once: " + schema->getName());
+	
+	registry.insert(make_pair(schema->getName(), schema));
+}
+
+const ComponentSchema* ComponentSchema::find(const string &name) {
+	const Registry &registry = getRegistry();
+	Registry::const_iterator i = registry.find(name);
+	return (i == registry.end()) ? 0 : i->second.get();
+}
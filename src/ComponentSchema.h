@@ -0,0 +1,302 @@
+#ifndef COMPONENT_SCHEMA_H
+#define COMPONENT_SCHEMA_H
+
+#include "PropertyBag.h"
+
+/**
+Component data compiled ahead of time from an actor template.
+Holds a plain struct, declared by the component, whose fields were read
+out of the template and checked once, when the template was loaded.
+*/
+class ComponentData {
+public:
+	virtual ~ComponentData() {}
+	
+	/**
+	Gets the compiled fields
+	@return struct declared by the component as its data
+	*/
+	template<typename DATA> const DATA& get() const;
+};
+
+/** Compiled component data holding a particular struct */
+template<typename DATA>
+class ComponentDataBlock : public ComponentData {
+public:
+	/** Fields of the component, initialized to their defaults */
+	DATA data;
+};
+
+template<typename DATA>
+const DATA& ComponentData::get() const {
+	ASSERT(dynamic_cast<const ComponentDataBlock<DATA>*>(this),
+	       "Compiled component data does not have the requested type");
+	return static_cast<const ComponentDataBlock<DATA>*>(this)->data;
+}
+
+/**
+Checks the text of a tag before it is converted to the type of a field.
+Types without a specialization accept any value that PropertyBag::get
+accepts.
+*/
+template<typename TYPE>
+struct ComponentFieldTraits {
+	static const char* getTypeName() {
+		return "value";
+	}
+	
+	static bool check(const string &) {
+		return true;
+	}
+};
+
+template<> struct ComponentFieldTraits<int> {
+	static const char* getTypeName() {
+		return "integer";
+	}
+	
+	static bool check(const string &text);
+};
+
+template<> struct ComponentFieldTraits<float> {
+	static const char* getTypeName() {
+		return "number";
+	}
+	
+	static bool check(const string &text);
+};
+
+template<> struct ComponentFieldTraits<bool> {
+	static const char* getTypeName() {
+		return "boolean";
+	}
+	
+	static bool check(const string &text);
+};
+
+/** Field of a component's data, bound to a tag in the actor template */
+class ComponentField {
+public:
+	virtual ~ComponentField() {}
+	
+	/**
+	Constructor
+	@param _name Name of the tag
+	@param _required If false, the field keeps its default when the tag is
+	       missing
+	*/
+	ComponentField(const string &_name, bool _required)
+			: name(_name),
+			required(_required) {}
+	
+	/** Gets the name of the tag */
+	inline const string& getName() const {
+		return name;
+	}
+	
+	/**
+	Reads the field out of component data
+	@param bag Component data from the actor template
+	@param data Struct receiving the field
+	@param errors Receives a description of the problem, if any
+	@return true if successful
+	*/
+	bool bind(const PropertyBag &bag, void *data, vector<string> &errors) const;
+	
+protected:
+	/** Gets the name of the type of the field, for error messages */
+	virtual const char* getTypeName() const = 0;
+	
+	/** Checks the text of the tag before it is converted */
+	virtual bool check(const string &text) const = 0;
+	
+	/**
+	Converts the tag and stores it in the struct
+	@return true if successful
+	*/
+	virtual bool convert(const PropertyBag &bag, void *data) const = 0;
+	
+private:
+	/** Name of the tag */
+	string name;
+	
+	/** Indicates that the tag must be present */
+	bool required;
+};
+
+/** Field stored in a particular member of the component's data struct */
+template<typename DATA, typename TYPE>
+class ComponentFieldMember : public ComponentField {
+public:
+	/**
+	Constructor
+	@param name Name of the tag
+	@param required If false, the field keeps its default when the tag is
+	       missing
+	@param _member Member of the struct that receives the field
+	*/
+	ComponentFieldMember(const string &name,
+	                     bool required,
+	                     TYPE DATA::*_member)
+			: ComponentField(name, required),
+			member(_member) {}
+			
+protected:
+	virtual const char* getTypeName() const {
+		return ComponentFieldTraits<TYPE>::getTypeName();
+	}
+	
+	virtual bool check(const string &text) const {
+		return ComponentFieldTraits<TYPE>::check(text);
+	}
+	
+	virtual bool convert(const PropertyBag &bag, void *data) const {
+		return bag.get(getName(), static_cast<DATA*>(data)->*member);
+	}
+	
+private:
+	TYPE DATA::*member;
+};
+
+/**
+Declares the fields of a component type and compiles its data.
+Each component type that has a schema is registered by name, so that
+actor templates can be checked and compiled when they are loaded instead
+of looking up every tag each time an actor is spawned.
+*/
+class ComponentSchema {
+public:
+	virtual ~ComponentSchema() {}
+	
+	/**
+	Constructor
+	@param _name Name of the component type
+	*/
+	ComponentSchema(const string &_name) : name(_name) {}
+	
+	/** Gets the name of the component type */
+	inline const string& getName() const {
+		return name;
+	}
+	
+	/**
+	Compiles component data. Fields that are missing or malformed keep
+	their defaults and are described in the list of errors.
+	@param bag Component data from the actor template
+	@param errors Receives a description of each problem
+	@return compiled data
+	*/
+	shared_ptr<const ComponentData> compile(const PropertyBag &bag,
+	                                        vector<string> &errors) const;
+	
+	/**
+	Registers the schema of a component type
+	@param schema Schema to register
+	*/
+	static void registerSchema(const shared_ptr<ComponentSchema> &schema);
+	
+	/**
+	Finds the schema of a component type
+	@param name Name of the component type
+	@return schema, or null if the component type has none
+	*/
+	static const ComponentSchema* find(const string &name);
+	
+protected:
+	/** Creates the struct receiving the fields, filled with defaults */
+	virtual shared_ptr<ComponentData> create() const = 0;
+	
+	/** Gets the struct of compiled data */
+	virtual void* getStruct(ComponentData &data) const = 0;
+	
+	/** Fields of the component type */
+	vector<shared_ptr<ComponentField> > fields;
+	
+private:
+	typedef map<string, shared_ptr<ComponentSchema> > Registry;
+	
+	/** Gets the registered schemas, by component type name */
+	static Registry& getRegistry();
+	
+	/** Name of the component type */
+	string name;
+};
+
+/**
+Schema of a component whose data is held in a particular struct.
+The struct's default constructor supplies the defaults of optional fields.
+*/
+template<typename DATA>
+class ComponentSchemaOf : public ComponentSchema {
+public:
+	/**
+	Constructor
+	@param name Name of the component type
+	*/
+	ComponentSchemaOf(const string &name) : ComponentSchema(name) {}
+	
+	/**
+	Declares a field that must be present in every actor template
+	@param name Name of the tag
+	@param member Member of the struct that receives the field
+	*/
+	template<typename TYPE>
+	ComponentSchemaOf& field(const string &name, TYPE DATA::*member) {
+		add(name, true, member);
+		return *this;
+	}
+	
+	/**
+	Declares a field that keeps its default when missing from a template
+	@param name Name of the tag
+	@param member Member of the struct that receives the field
+	*/
+	template<typename TYPE>
+	ComponentSchemaOf& optional(const string &name, TYPE DATA::*member) {
+		add(name, false, member);
+		return *this;
+	}
+	
+protected:
+	virtual shared_ptr<ComponentData> create() const {
+		return shared_ptr<ComponentData>(new ComponentDataBlock<DATA>);
+	}
+	
+	virtual void* getStruct(ComponentData &data) const {
+		return &static_cast<ComponentDataBlock<DATA>&>(data).data;
+	}
+	
+private:
+	template<typename TYPE>
+	void add(const string &name, bool required, TYPE DATA::*member) {
+		fields.push_back(shared_ptr<ComponentField>(
+		                   new ComponentFieldMember<DATA, TYPE>(name,
+		                                                        required,
+		                                                        member)));
+	}
+};
+
+/**
+Registers the schema of a component type when constructed.
+The component declares its data as a struct named Data and declares the
+fields of that struct in a static function, declareSchema.
+*/
+template<typename COMPONENT>
+class ComponentSchemaRegistrar {
+public:
+	ComponentSchemaRegistrar(const string &name) {
+		typedef ComponentSchemaOf<typename COMPONENT::Data> Schema;
+		shared_ptr<Schema> schema(new Schema(name));
+		COMPONENT::declareSchema(*schema);
+		ComponentSchema::registerSchema(schema);
+	}
+};
+
+/**
+Registers the schema of a component type at static initialization time.
+Place this in the component's source file, next to REGISTER_COMPONENT.
+*/
+#define REGISTER_COMPONENT_SCHEMA(name, COMPONENT) \
+static ComponentSchemaRegistrar<COMPONENT> _component_schema_registrar_(name);
+
+#endif
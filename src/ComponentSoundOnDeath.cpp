@@ -2,6 +2,8 @@
 #include "ActionPlaySound.h"
 #include "ComponentSoundOnDeath.h"
 
+REGISTER_COMPONENT("SoundOnDeath", ComponentSoundOnDeath)
+
 ComponentSoundOnDeath::
 ComponentSoundOnDeath(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
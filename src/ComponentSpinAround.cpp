@@ -3,6 +3,9 @@
 #include "ActionSetPosition.h"
 #include "ActionSetOrientation.h"
 
+REGISTER_COMPONENT("SpinAround", ComponentSpinAround)
+REGISTER_COMPONENT_SCHEMA("SpinAround", ComponentSpinAround)
+
 ComponentSpinAround::
 ComponentSpinAround(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
@@ -18,11 +21,19 @@ void ComponentSpinAround::resetMembers() {
 	bounceSpeed = (float)(2.0 * M_PI) / 1000.0f;
 }
 
-void ComponentSpinAround::load(const PropertyBag &data) {
+void ComponentSpinAround::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("rotationSpeed", &Data::rotationSpeed)
+	      .field("bounceHeight", &Data::bounceHeight)
+	      .field("bounceSpeed", &Data::bounceSpeed);
+}
+
+void ComponentSpinAround::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
-	rotationSpeed = data.getFloat("rotationSpeed");
-	bounceHeight = data.getFloat("bounceHeight");
-	bounceSpeed = data.getFloat("bounceSpeed");
+	rotationSpeed = data.rotationSpeed;
+	bounceHeight = data.bounceHeight;
+	bounceSpeed = data.bounceSpeed;
 }
 
 void ComponentSpinAround::update(float milliseconds) {
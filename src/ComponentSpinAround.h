@@ -17,8 +17,23 @@ public:
 	/** Resets all object members to defaults */
 	virtual void resetMembers();
 	
-	/** Loads component data from the pool of all object data */
-	virtual void load(const PropertyBag &data);
+	/** Fields of the component in actor templates */
+	struct Data {
+		Data()
+				: rotationSpeed((float)(2.0 * M_PI) / 1000.0f),
+				bounceHeight(0.5f),
+				bounceSpeed((float)(2.0 * M_PI) / 1000.0f) {}
+		
+		float rotationSpeed;
+		float bounceHeight;
+		float bounceSpeed;
+	};
+	
+	/** Declares the fields of the component in actor templates */
+	static void declareSchema(ComponentSchemaOf<Data> &schema);
+	
+	/** Loads component data compiled from the actor template */
+	virtual void load(const ComponentData &compiled);
 	
 	/**
 	Updates component each tick
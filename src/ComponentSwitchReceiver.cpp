@@ -3,6 +3,8 @@
 #include "ComponentSwitchReceiver.h"
 #include "EventUsesObject.h"
 
+REGISTER_COMPONENT("SwitchReceiver", ComponentSwitchReceiver)
+
 ComponentSwitchReceiver::
 ComponentSwitchReceiver(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
@@ -4,6 +4,9 @@
 #include "ComponentUseOnCollision.h"
 #include "EventUsesObject.h"
 
+REGISTER_COMPONENT("UseOnCollision", ComponentUseOnCollision)
+REGISTER_COMPONENT_SCHEMA("UseOnCollision", ComponentUseOnCollision)
+
 ComponentUseOnCollision::
 ComponentUseOnCollision(UID uid, ScopedEventHandler *parentScope)
 		: world(0),
@@ -13,9 +16,15 @@ ComponentUseOnCollision(UID uid, ScopedEventHandler *parentScope)
 	REGISTER_HANDLER(ComponentUseOnCollision::handleMessagePassWorld);
 }
 
-void ComponentUseOnCollision::load(const PropertyBag &data) {
+void ComponentUseOnCollision::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("onlyPlayers", &Data::onlyPlayers);
+}
+
+void ComponentUseOnCollision::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
 	resetMembers();
-	onlyPlayers = data.getBool("onlyPlayers");
+	onlyPlayers = data.onlyPlayers;
 }
 
 void ComponentUseOnCollision::resetMembers() {
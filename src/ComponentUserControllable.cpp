@@ -9,6 +9,9 @@
 #include "SDLinput.h"
 #include "EventPlayerNumberSet.h"
 
+REGISTER_COMPONENT("UserControllable", ComponentUserControllable)
+REGISTER_COMPONENT_SCHEMA("UserControllable", ComponentUserControllable)
+
 ComponentUserControllable::
 ComponentUserControllable(UID uid, ScopedEventHandler *parentScope)
 		: Component(uid, parentScope) {
@@ -72,8 +75,14 @@ void ComponentUserControllable::handleEventPositionUpdate( const EventPositionUp
 	lastReportedPosition = event->position;
 }
 
-void ComponentUserControllable::load(const PropertyBag &data) {
-	mouseSensitivity = data.getFloat("mouseSensitivity");
+void ComponentUserControllable::declareSchema(ComponentSchemaOf<Data> &schema) {
+	schema.field("mouseSensitivity", &Data::mouseSensitivity);
+}
+
+void ComponentUserControllable::load(const ComponentData &compiled) {
+	const Data &data = compiled.get<Data>();
+	
+	mouseSensitivity = data.mouseSensitivity;
 }
 
 void ComponentUserControllable::onKeyPressSuicide() {
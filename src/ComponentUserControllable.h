@@ -27,8 +27,19 @@ public:
 	
 	ComponentUserControllable(UID _uid, ScopedEventHandler *_blackBoard);
 	
-	/** Does nothing */
-	virtual void load(const PropertyBag &data);
+	/** Fields of the component in actor templates */
+	struct Data {
+		Data()
+				: mouseSensitivity(100.0f) {}
+		
+		float mouseSensitivity;
+	};
+	
+	/** Declares the fields of the component in actor templates */
+	static void declareSchema(ComponentSchemaOf<Data> &schema);
+	
+	/** Loads component data compiled from the actor template */
+	virtual void load(const ComponentData &compiled);
 	
 	/** Updates component each tick */
 	virtual void update(float milliseconds);
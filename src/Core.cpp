@@ -74,6 +74,30 @@ float SampleLogNormal(float mean, float sigma) {
 	// that is seeded once with #seconds since 1970
 	static mt19937 rng(static_cast<unsigned> (std::time(0)));
 	
+	return SampleLogNormal(rng, mean, sigma);
+}
+
+float SampleNormal(float mean, float sigma) {
+	// Create a Mersenne twister random number generator
+	// that is seeded once with #seconds since 1970
+	static mt19937 rng(static_cast<unsigned> (std::time(0)));
+	
+	return SampleNormal(rng, mean, sigma);
+}
+
+float SampleUniform(mt19937 &rng, float low, float high) {
+	uniform_real<float> dist(low, high);
+	variate_generator<mt19937&, uniform_real<float> > sampler(rng, dist);
+	return sampler();
+}
+
+int SampleUniformInt(mt19937 &rng, int low, int high) {
+	uniform_int<int> dist(low, high);
+	variate_generator<mt19937&, uniform_int<int> > sampler(rng, dist);
+	return sampler();
+}
+
+float SampleLogNormal(mt19937 &rng, float mean, float sigma) {
 	// select gamma probability distribution
 	lognormal_distribution<float> dist(mean, sigma);
 	
@@ -84,11 +108,7 @@ float SampleLogNormal(float mean, float sigma) {
 	return sampler();
 }
 
-float SampleNormal(float mean, float sigma) {
-	// Create a Mersenne twister random number generator
-	// that is seeded once with #seconds since 1970
-	static mt19937 rng(static_cast<unsigned> (std::time(0)));
-	
+float SampleNormal(mt19937 &rng, float mean, float sigma) {
 	// select Gaussian probability distribution
 	normal_distribution<float> norm_dist(mean, sigma);
 	
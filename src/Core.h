@@ -25,6 +25,7 @@
 #include <cstring>
 #include <cfloat>
 #include <cerrno>
+#include <ctime>
 #include <fstream>
 #include <iostream>
 
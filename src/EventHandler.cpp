@@ -1,6 +1,23 @@
 #include "stdafx.h"
 #include "EventHandler.h"
 
+typedef std::map<TypeInfo, MessageTypeID> MessageTypeIDs;
+
+/** IDs of every type of message seen so far */
+static MessageTypeIDs messageTypeIDs;
+
+MessageTypeID getMessageTypeID(const type_info &type) {
+	MessageTypeIDs::const_iterator i = messageTypeIDs.find(TypeInfo(type));
+	
+	if (i != messageTypeIDs.end()) {
+		return i->second;
+	}
+	
+	const MessageTypeID id = messageTypeIDs.size();
+	messageTypeIDs.insert(make_pair(TypeInfo(type), id));
+	return id;
+}
+
 MessageHandler::~MessageHandler() {
 	Handlers::iterator it = handlers.begin();
 	while (it != handlers.end()) {
@@ -13,8 +30,18 @@ MessageHandler::~MessageHandler() {
 void MessageHandler::recvMessage(const Message *message) {
 	ASSERT(message, "Null parameter: message");
 	
-	Handlers::iterator it = handlers.find(TypeInfo(typeid(*message)));
+	Handlers::iterator it = handlers.find(message->getTypeID());
 	if (it != handlers.end()) {
 		(it->second)->exec(message);
 	}
 }
+
+bool MessageHandler::hasHandler(MessageTypeID type) const {
+	return handlers.find(type) != handlers.end();
+}
+
+void MessageHandler::getHandledTypes(std::vector<MessageTypeID> &types) const {
+	for (Handlers::const_iterator i = handlers.begin(); i != handlers.end(); ++i) {
+		types.push_back(i->first);
+	}
+}
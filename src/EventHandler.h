@@ -2,11 +2,48 @@
 #define EVENTHANDLER_H
 
 #include <map>
+#include <vector>
 #include "TypeInfo.h"
 
+/** Small integer that identifies a type of message */
+typedef size_t MessageTypeID;
+
+/**
+Gets the ID of a type of message. The first type seen is assigned zero and
+each new type the next unused ID, so IDs may be used to index a table.
+@param type Type of message
+@return ID of the type of message
+*/
+MessageTypeID getMessageTypeID(const type_info &type);
+
 class Message {
 public:
+	Message() : typeID(INVALID_TYPE_ID) { /* Do nothing */ }
+	
+	Message(const Message &) : typeID(INVALID_TYPE_ID) { /* Do nothing */ }
+	
 	virtual ~Message() { /* Do nothing */ }
+	
+	Message& operator=(const Message &) {
+		return *this;
+	}
+	
+	/**
+	Gets the ID of the type of this message.
+	The ID is looked up the first time and remembered after that, so a
+	message relayed to many handlers is only looked up once.
+	*/
+	MessageTypeID getTypeID() const {
+		if (typeID == INVALID_TYPE_ID) {
+			typeID = getMessageTypeID(typeid(*this));
+		}
+		return typeID;
+	}
+	
+private:
+	static const MessageTypeID INVALID_TYPE_ID = ~(MessageTypeID)0;
+	
+	mutable MessageTypeID typeID;
 };
 
 class Event : public Message {
@@ -54,6 +91,12 @@ public:
 	
 	virtual void recvMessage(const Message *message);
 	
+	/** Determines whether a handler is registered for the type of message */
+	bool hasHandler(MessageTypeID type) const;
+	
+	/** Gets every type of message that has a registered handler */
+	void getHandledTypes(std::vector<MessageTypeID> &types) const;
+	
 	inline void recvEvent(const Event *event) {
 		recvMessage(event);
 	}
@@ -64,11 +107,11 @@ public:
 	
 	template <class T, class MessageT> inline
 	void registerHandler(T *obj, void (T::*memFn)(MessageT*)) {
-		handlers[TypeInfo(typeid(MessageT))]= new MemberFunctionHandler<T, MessageT>(obj, memFn);
+		handlers[getMessageTypeID(typeid(MessageT))]= new MemberFunctionHandler<T, MessageT>(obj, memFn);
 	}
 	
 private:
-	typedef std::map<TypeInfo, HandlerFunctionBase*> Handlers;
+	typedef std::map<MessageTypeID, HandlerFunctionBase*> Handlers;
 	Handlers handlers;
 };
 
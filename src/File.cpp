@@ -1,7 +1,50 @@
 #include "Core.h"
 #include "File.h"
+#include "FileMapping.h"
+#include "Thread.h"
+
+FileStatistics::FileStatistics()
+		: filesRead(0),
+		filesMapped(0),
+		filesPacked(0),
+		bytesRead(0),
+		filesWritten(0),
+		bytesWritten(0),
+		flushes(0) {}
+
+string FileStatistics::toString() const {
+	return sizet_to_string(filesRead) + " files read (" +
+	       sizet_to_string(filesMapped) + " mapped), " +
+	       sizet_to_string(filesPacked) + " files from packs, " +
+	       sizet_to_string(bytesRead) + " bytes read, " +
+	       sizet_to_string(filesWritten) + " files written, " +
+	       sizet_to_string(bytesWritten) + " bytes written, " +
+	       sizet_to_string(flushes) + " flushes";
+}
+
+Mutex& File::getStatisticsMutex() {
+	static Mutex mutex;
+	return mutex;
+}
+
+FileStatistics& File::getMutableStatistics() {
+	static FileStatistics statistics;
+	return statistics;
+}
+
+FileStatistics File::getStatistics() {
+	MutexLock lock(getStatisticsMutex());
+	return getMutableStatistics();
+}
+
+void File::count(size_t FileStatistics::*counter, size_t amount) {
+	MutexLock lock(getStatisticsMutex());
+	getMutableStatistics().*counter += amount;
+}
 
 bool File::openStream(const FileName &fileName, FILE_MODE mode) {
+	closeStream();
+	
 	this->fileName = fileName;
 	
 	const char *pszMode = getModeString(mode);
@@ -13,6 +56,16 @@ bool File::openStream(const FileName &fileName, FILE_MODE mode) {
 		return false;
 	}
 	
+	writing = (mode == FILE_MODE_WRITE);
+	
+	if (writing) {
+		// Collect small writes, rather than going to disk for each one
+		setvbuf(stream, 0, _IOFBF, WRITE_BUFFER_SIZE);
+		count(&FileStatistics::filesWritten);
+	} else {
+		count(&FileStatistics::filesRead);
+	}
+	
 	return true;
 }
 
@@ -21,7 +74,22 @@ long File::tell() const {
 }
 
 void File::closeStream() {
-	fclose(stream);
+	if (stream) {
+		if (writing) {
+			count(&FileStatistics::flushes);
+		}
+		
+		fclose(stream);
+		stream = 0;
+		writing = false;
+	}
+}
+
+void File::flush() {
+	if (stream && writing) {
+		fflush(stream);
+		count(&FileStatistics::flushes);
+	}
 }
 
 bool File::streamOk() const {
@@ -53,22 +121,13 @@ long File::seek(long offset, FILE_SEEK fileSeekOrigin) {
 }
 
 U8* File::readBinaryFile(const FileName &fileName) {
-	FILE *stream = fopen(fileName.c_str(), "rb");
-	
-	VERIFY(stream && !ferror(stream),
-	       "File operation failed: " + fileName.str());
-	       
-	fseek(stream, 0, SEEK_END);
-	
-	const long fileSize = ftell(stream);
-	
-	fseek(stream, 0, SEEK_SET);
+	const FileMapping file(fileName);
 	
-	U8 *buffer = new U8[fileSize];
+	VERIFY(file.isOpen(), "File operation failed: " + fileName.str());
 	
-	fread(buffer, fileSize, sizeof(U8), stream);
+	U8 *buffer = new U8[file.getSize()];
 	
-	fclose(stream);
+	file.read(0, buffer, file.getSize());
 	
 	return buffer;
 }
@@ -3,12 +3,47 @@
 
 #include "FileName.h"
 
+class Mutex;
+
+/** Running totals of the file I/O performed by the engine */
+struct FileStatistics {
+	/** Files opened for reading from disk */
+	size_t filesRead;
+	
+	/** Files that were memory mapped, rather than read into a buffer */
+	size_t filesMapped;
+	
+	/** Files read from mounted pack files, rather than from disk */
+	size_t filesPacked;
+	
+	/** Bytes of file contents made available to readers */
+	size_t bytesRead;
+	
+	/** Files opened for writing */
+	size_t filesWritten;
+	
+	/** Bytes written to files */
+	size_t bytesWritten;
+	
+	/** Times that buffered writes were flushed to their files */
+	size_t flushes;
+	
+	/** Constructor */
+	FileStatistics();
+	
+	/** Gets a readable summary of the counters */
+	string toString() const;
+};
+
 class File {
 protected:
 	FileName fileName;
 	
 	FILE *stream;
 	
+	/** Indicates that the stream was opened for writing */
+	bool writing;
+	
 public:
 
 	/** Seek origin marker */
@@ -25,7 +60,7 @@ public:
 	};
 	
 	/** Constructor */
-	File() {}
+	File() : stream(0), writing(false) {}
 	
 	/**
 	Opens a file and reads its contents into the buffer
@@ -33,7 +68,7 @@ public:
 	@param mode File operation mode
 	@return true if the operation succeeded
 	*/
-	File(const FileName &fileName, FILE_MODE mode) {
+	File(const FileName &fileName, FILE_MODE mode) : stream(0), writing(false) {
 		openStream(fileName, mode);
 	}
 	
@@ -46,9 +81,12 @@ public:
 		return fileName;
 	}
 	
-	/** Closes the file stream */
+	/** Closes the file stream, flushing any buffered writes */
 	void closeStream();
 	
+	/** Writes any buffered data to the file */
+	void flush();
+	
 	/**
 	Opens a file and reads its contents into the buffer
 	@param fileName The file to open
@@ -96,7 +134,28 @@ public:
 	*/
 	static U8* readBinaryFile(const FileName &fileName);
 	
+	/** Gets the counters of all file I/O performed so far */
+	static FileStatistics getStatistics();
+	
+	/**
+	Adds to one of the file I/O counters. Files are read from loader threads
+	too, so the counters are only changed through this.
+	@param counter Counter to add to
+	@param amount Amount to add
+	*/
+	static void count(size_t FileStatistics::*counter, size_t amount = 1);
+	
+private:
+	/** Guards the counters */
+	static Mutex& getStatisticsMutex();
+	
+	/** Counters of all file I/O performed so far */
+	static FileStatistics& getMutableStatistics();
+	
 protected:
+	/** Size of the buffer that collects writes before they go to disk */
+	static const size_t WRITE_BUFFER_SIZE = 64 * 1024;
+	
 	/**
 	Gets the string to enter the file operation mode
 	@param mode File operation mode
@@ -20,6 +20,7 @@
 #	define getcwd _getcwd
 #else
 #	include <unistd.h>
+#	include <dirent.h>
 #	include <cstdio>
 #endif
 
@@ -101,3 +102,121 @@ bool isFileOnDisk(const FileName &fileName) {
 	// if we can stat the file, then it does exist
 	return (stat(fileName.c_str(), &info) == 0);
 }
+
+time_t getFileModificationTime(const FileName &fileName) {
+	struct stat info;
+	
+	if (stat(fileName.c_str(), &info) == 0) {
+		return info.st_mtime;
+	} else {
+		return 0;
+	}
+}
+
+void listFilesOnDisk(const FileName &directory, vector<string> &files) {
+#ifdef _WIN32
+	WIN32_FIND_DATA data;
+	const string pattern = FileName::append(directory.str(), "*");
+	HANDLE search = FindFirstFile(pattern.c_str(), &data);
+	
+	if (search == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	
+	do {
+		if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+			files.push_back(data.cFileName);
+		}
+	} while (FindNextFile(search, &data));
+	
+	FindClose(search);
+#else
+	DIR *dir = opendir(directory.c_str());
+	
+	if (!dir) {
+		return;
+	}
+	
+	struct dirent *entry = 0;
+	
+	while ((entry = readdir(dir)) != 0) {
+		const string name = entry->d_name;
+		const string path = FileName::append(directory.str(), name);
+		struct stat info;
+		
+		if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+			files.push_back(name);
+		}
+	}
+	
+	closedir(dir);
+#endif
+}
+
+/**
+Recursively finds the files in a directory on disk
+@param directory Directory to search
+@param prefix Path of the directory relative to the root of the search
+@param files Receives the path of each file relative to the root (appended)
+*/
+static void findFilesOnDisk(const string &directory,
+                            const string &prefix,
+                            vector<string> &files) {
+#ifdef _WIN32
+	WIN32_FIND_DATA data;
+	const string pattern = FileName::append(directory, "*");
+	HANDLE search = FindFirstFile(pattern.c_str(), &data);
+	
+	if (search == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	
+	do {
+		const string name = data.cFileName;
+		
+		if (name == "." || name == "..") {
+			continue;
+		}
+		
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			findFilesOnDisk(FileName::append(directory, name),
+			                prefix + name + "/",
+			                files);
+		} else {
+			files.push_back(prefix + name);
+		}
+	} while (FindNextFile(search, &data));
+	
+	FindClose(search);
+#else
+	DIR *dir = opendir(directory.c_str());
+	
+	if (!dir) {
+		return;
+	}
+	
+	struct dirent *entry = 0;
+	
+	while ((entry = readdir(dir)) != 0) {
+		const string name = entry->d_name;
+		const string path = FileName::append(directory, name);
+		struct stat info;
+		
+		if (name == "." || name == ".." || stat(path.c_str(), &info) != 0) {
+			continue;
+		}
+		
+		if (S_ISDIR(info.st_mode)) {
+			findFilesOnDisk(path, prefix + name + "/", files);
+		} else if (S_ISREG(info.st_mode)) {
+			files.push_back(prefix + name);
+		}
+	}
+	
+	closedir(dir);
+#endif
+}
+
+void findFilesOnDisk(const FileName &directory, vector<string> &files) {
+	findFilesOnDisk(directory.str(), "", files);
+}
@@ -39,4 +39,26 @@ Determine if a file exists on disk
 */
 bool isFileOnDisk(const FileName &fileName);
 
+/**
+Gets the time that the file was last modified
+@param fileName Name of the file to check
+@return modification time of the file, or zero if the file cannot be stat'd
+*/
+time_t getFileModificationTime(const FileName &fileName);
+
+/**
+Lists the files in a directory on disk, not including subdirectories
+@param directory Directory to list
+@param files Receives the name of each file, relative to the directory
+*/
+void listFilesOnDisk(const FileName &directory, vector<string> &files);
+
+/**
+Finds the files in a directory on disk and in all of its subdirectories
+@param directory Directory to search
+@param files Receives the path of each file, relative to the directory and
+             separated by '/'
+*/
+void findFilesOnDisk(const FileName &directory, vector<string> &files);
+
 #endif
@@ -0,0 +1,183 @@
+#include "Core.h"
+#include "File.h"
+#include "FileMapping.h"
+#include "VirtualFileSystem.h"
+
+#ifndef _WIN32
+#	include <sys/types.h>
+#	include <sys/stat.h>
+#	include <sys/mman.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+FileMapping::~FileMapping() {
+	close();
+}
+
+FileMapping::FileMapping()
+		: opened(false),
+		mapped(false),
+		data(0),
+		size(0) {}
+
+FileMapping::FileMapping(const FileName &fileName)
+		: opened(false),
+		mapped(false),
+		data(0),
+		size(0) {
+	open(fileName);
+}
+
+bool FileMapping::open(const FileName &_fileName) {
+	close();
+	
+	fileName = _fileName;
+	
+	if (VirtualFileSystem::find(fileName, pack, data, size)) {
+		opened = true;
+		File::count(&FileStatistics::filesPacked);
+		File::count(&FileStatistics::bytesRead, size);
+		return true;
+	}
+	
+	opened = map() || readIntoBuffer();
+	
+	if (opened) {
+		File::count(&FileStatistics::filesRead);
+		File::count(&FileStatistics::bytesRead, size);
+		
+		if (mapped) {
+			File::count(&FileStatistics::filesMapped);
+		}
+	}
+	
+	return opened;
+}
+
+void FileMapping::close() {
+	if (mapped) {
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+#else
+		munmap(const_cast<U8*>(data), size);
+#endif
+	}
+	
+	vector<U8>().swap(buffer);
+	pack.reset();
+	opened = false;
+	mapped = false;
+	data = 0;
+	size = 0;
+}
+
+bool FileMapping::read(size_t offset, void *dest, size_t count) const {
+	if (offset > size || count > size - offset) {
+		return false;
+	}
+	
+	if (count > 0) {
+		memcpy(dest, data + offset, count);
+	}
+	
+	return true;
+}
+
+bool FileMapping::map() {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(),
+	                          GENERIC_READ,
+	                          FILE_SHARE_READ,
+	                          NULL,
+	                          OPEN_EXISTING,
+	                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+	                          NULL);
+	
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	
+	DWORD sizeHigh = 0;
+	const DWORD sizeLow = GetFileSize(file, &sizeHigh);
+	
+	if (sizeLow == INVALID_FILE_SIZE || sizeHigh != 0 || sizeLow < MIN_MAPPED_SIZE) {
+		CloseHandle(file);
+		return false;
+	}
+	
+	// The view keeps the mapping alive once the handles are closed
+	HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+	
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+	
+	CloseHandle(file);
+	
+	if (!view) {
+		return false;
+	}
+	
+	data = static_cast<const U8*>(view);
+	size = sizeLow;
+#else
+	const int file = ::open(fileName.c_str(), O_RDONLY);
+	
+	if (file < 0) {
+		return false;
+	}
+	
+	struct stat info;
+	
+	if (fstat(file, &info) != 0 || info.st_size < (off_t)MIN_MAPPED_SIZE) {
+		::close(file);
+		return false;
+	}
+	
+	// The mapping remains valid once the descriptor is closed
+	void *view = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	
+	data = static_cast<const U8*>(view);
+	size = info.st_size;
+#endif
+	
+	mapped = true;
+	return true;
+}
+
+bool FileMapping::readIntoBuffer() {
+	FILE *stream = fopen(fileName.c_str(), "rb");
+	
+	if (!stream) {
+		return false;
+	}
+	
+	fseek(stream, 0, SEEK_END);
+	const long fileSize = ftell(stream);
+	fseek(stream, 0, SEEK_SET);
+	
+	bool ok = fileSize >= 0;
+	
+	if (ok && fileSize > 0) {
+		buffer.resize(fileSize);
+		ok = fread(&buffer[0], 1, fileSize, stream) == (size_t)fileSize;
+	}
+	
+	fclose(stream);
+	
+	if (!ok) {
+		vector<U8>().swap(buffer);
+		return false;
+	}
+	
+	data = buffer.empty() ? 0 : &buffer[0];
+	size = buffer.size();
+	return true;
+}
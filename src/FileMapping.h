@@ -0,0 +1,137 @@
+#ifndef _FILE_MAPPING_H_
+#define _FILE_MAPPING_H_
+
+#include "FileName.h"
+
+class PackFile;
+
+/**
+Read-only view of the entire contents of a file.
+
+Large files are memory mapped, so their pages are read on demand straight
+from the operating system's file cache. Small files, for which setting up a
+mapping costs more than copying, and files that cannot be mapped, are read
+into a buffer of the right size with a single read. Either way, parsers see
+one contiguous span of bytes and never issue reads or seeks of their own.
+
+Files in pack files mounted with VirtualFileSystem are found before files
+on disk, and are viewed in place within the mapping of the archive.
+*/
+class FileMapping {
+public:
+	/** Destructor */
+	~FileMapping();
+	
+	/** Constructor */
+	FileMapping();
+	
+	/**
+	Constructor
+	@param fileName The file to open
+	*/
+	FileMapping(const FileName &fileName);
+	
+	/**
+	Opens a file, closing any file that was already open
+	@param fileName The file to open
+	@return true if the file was opened
+	*/
+	bool open(const FileName &fileName);
+	
+	/** Releases the contents of the file */
+	void close();
+	
+	/** Determines whether a file is open */
+	inline bool isOpen() const {
+		return opened;
+	}
+	
+	/** Gets the name of the open file */
+	inline const FileName& getFileName() const {
+		return fileName;
+	}
+	
+	/** Gets the contents of the file */
+	inline const U8* getData() const {
+		return data;
+	}
+	
+	/** Gets the size of the file, in bytes */
+	inline size_t getSize() const {
+		return size;
+	}
+	
+	/** Gets the contents of the file as text */
+	inline const char* begin() const {
+		return reinterpret_cast<const char*>(data);
+	}
+	
+	/** Gets the end of the contents of the file as text */
+	inline const char* end() const {
+		return reinterpret_cast<const char*>(data) + size;
+	}
+	
+	/**
+	Copies bytes from the file
+	@param offset Offset of the first byte from the start of the file
+	@param dest Receives the bytes
+	@param count Number of bytes
+	@return true if successful, false if the range is outside of the file
+	*/
+	bool read(size_t offset, void *dest, size_t count) const;
+	
+	/**
+	Copies an array of structures from the file
+	@param offset Offset of the first element from the start of the file
+	@param dest Receives the elements
+	@param count Number of elements
+	@return true if successful, false if the range is outside of the file
+	*/
+	template<typename T>
+	bool readArray(size_t offset, T *dest, size_t count) const {
+		return count <= (size_t)-1 / sizeof(T) &&
+		       read(offset, dest, sizeof(T) * count);
+	}
+	
+private:
+	FileMapping(const FileMapping&);
+	FileMapping& operator=(const FileMapping&);
+	
+	/** Files smaller than this are read into a buffer, not mapped */
+	static const size_t MIN_MAPPED_SIZE = 64 * 1024;
+	
+	/**
+	Maps the file into memory
+	@return true if successful
+	*/
+	bool map();
+	
+	/**
+	Reads the file into the buffer
+	@return true if successful
+	*/
+	bool readIntoBuffer();
+	
+	/** Name of the open file */
+	FileName fileName;
+	
+	/** Indicates that a file is open */
+	bool opened;
+	
+	/** Indicates that the data is a memory mapping */
+	bool mapped;
+	
+	/** Contents of the file */
+	const U8 *data;
+	
+	/** Size of the file */
+	size_t size;
+	
+	/** Contents of a small file, or of a file that could not be mapped */
+	vector<U8> buffer;
+	
+	/** Archive holding the file, if the file was found in a pack file */
+	shared_ptr<PackFile> pack;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "Core.h"
 #include "FileText.h"
+#include "FileMapping.h"
 
 const char* FileText::getModeString(FILE_MODE mode) {
 	switch (mode) {
@@ -19,36 +20,66 @@ unsigned char FileText::getChar() {
 }
 
 void FileText::write(const string &s) {
-	fprintf(stream, "%s", s.c_str());
-	fflush(stream);
+	// Buffered; flushed when the buffer fills and when the file is closed
+	fwrite(s.data(), 1, s.length(), stream);
+	count(&FileStatistics::bytesWritten, s.length());
 }
 
 string FileText::getFullText() {
 	long pos = tell();
 	
+	const long size = seek(0, FILE_SEEK_END);
+	
 	seek(0, FILE_SEEK_BEGIN);
 	
 	string contents;
 	
-	const int maxLineLength = 1024;
-	
-	char line[maxLineLength];
-	
-	while (fgets(line, maxLineLength, stream) != 0) {
-		contents += line;
+	if (size > 0) {
+		// Text mode translation may shrink the contents, but never grows them
+		contents.resize(size);
+		contents.resize(fread(&contents[0], 1, size, stream));
 	}
 	
+	count(&FileStatistics::bytesRead, contents.length());
+	
 	seek(pos, FILE_SEEK_BEGIN); // restore file position
 	
 	return contents;
 }
 
 string FileText::readFile(const FileName &fileName) {
-	FileText file;
+	const FileMapping file(fileName);
 	
-	file.openStream(fileName, FILE_MODE_READ);
+	if (!file.isOpen()) {
+		ERR("Failed to read file: " + fileName.str());
+		return string();
+	}
 	
-	return file.getFullText();
+	// Translate line endings, as reading in text mode would on Windows
+	string contents;
+	contents.reserve(file.getSize());
+	
+	const char *p = file.begin();
+	const char *end = file.end();
+	
+	while (p < end) {
+		const char *cr = (const char *)memchr(p, '\r', end - p);
+		
+		if (!cr) {
+			contents.append(p, end);
+			break;
+		}
+		
+		contents.append(p, cr);
+		
+		if (cr+1 == end || cr[1] != '\n') {
+			contents += '\r';
+		}
+		
+		p = cr + 1;
+	}
+	
+	return contents;
 }
 
 FileText::LINES FileText::readLines(const FileName &fileName) {
@@ -14,29 +14,29 @@ public:
 	virtual unsigned char getChar();
 	
 	/**
-	Writes a string to file
+	Writes a string to file. Writes are buffered, and reach the disk when
+	the buffer fills, on flush(), or when the file is closed.
 	@param s The string to write
 	*/
 	virtual void write(const string &s);
 	
 	/**
 	Gets the full text of the file without modifying the file cursor position.
-	The getFullText method fails when there are lines that are over 1024 characters long!
 	@return full text of the file
 	*/
 	virtual string getFullText();
 	
 	/**
-	Reads the full contents of a text file, closing the file upon returning.
-	Fails when there are lines that are over 1024 characters long!
+	Reads the full contents of a text file, through a FileMapping.
+	Line endings are translated as they would be for a file opened in text
+	mode on Windows.
 	@param fileName The file to read
-	@return full text of the file
+	@return full text of the file, or an empty string if it cannot be read
 	*/
 	static string readFile(const FileName &fileName);
 	
 	/**
-	Reads the lines of text from a file, closing the file upon returning.
-	Fails when there are lines that are over 1024 characters long!
+	Reads the lines of text from a file
 	@return full text of the file
 	*/
 	static LINES readLines(const FileName &fileName);
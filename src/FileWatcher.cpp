@@ -0,0 +1,136 @@
+#include "Core.h"
+#include "FileWatcher.h"
+
+#ifdef __linux__
+#	include <sys/types.h>
+#	include <sys/stat.h>
+#	include <sys/inotify.h>
+#	include <dirent.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+
+/*
+Editors either write a file in place or write a copy and move it over the
+original, so both are watched. Creation is watched for new directories.
+*/
+static const U32 WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+#endif
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+	if (fd >= 0) {
+		::close(fd);
+	}
+#endif
+}
+
+FileWatcher::FileWatcher()
+		: fd(-1) {
+#ifdef __linux__
+	fd = inotify_init();
+	
+	if (fd < 0) {
+		ERR("Failed to start inotify: " + string(strerror(errno)));
+	} else {
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	}
+#endif
+}
+
+bool FileWatcher::watch(const FileName &directory) {
+	if (fd < 0) {
+		return false;
+	}
+	
+	if (!addWatch(directory)) {
+		ERR("Failed to watch directory: " + directory.str());
+		return false;
+	}
+	
+	TRACE("Watching " + directory.str() + " ("
+	      + sizet_to_string(directories.size()) + " directories)");
+	return true;
+}
+
+bool FileWatcher::addWatch(const FileName &directory) {
+#ifdef __linux__
+	const int wd = inotify_add_watch(fd, directory.c_str(), WATCH_MASK);
+	
+	if (wd < 0) {
+		return false;
+	}
+	
+	directories[wd] = directory;
+	
+	DIR *dir = opendir(directory.c_str());
+	
+	if (!dir) {
+		return true;
+	}
+	
+	struct dirent *entry = 0;
+	
+	while ((entry = readdir(dir)) != 0) {
+		const string name = entry->d_name;
+		const FileName path = directory.append(FileName(name));
+		struct stat info;
+		
+		if (name != "." && name != ".." &&
+		    stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+			addWatch(path);
+		}
+	}
+	
+	closedir(dir);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void FileWatcher::poll(set<FileName> &changed) {
+#ifdef __linux__
+	if (fd < 0) {
+		return;
+	}
+	
+	// Events are aligned for their headers, and names follow the headers
+	U32 buffer[4096];
+	ssize_t length = 0;
+	
+	while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+		const char *p = (const char *)buffer;
+		const char *end = p + length;
+		
+		while (p < end) {
+			const struct inotify_event *event = (const struct inotify_event *)p;
+			p += sizeof(struct inotify_event) + event->len;
+			
+			map<int, FileName>::iterator i = directories.find(event->wd);
+			
+			if (i == directories.end()) {
+				continue;
+			}
+			
+			if (event->mask & IN_IGNORED) {
+				directories.erase(i); // the directory was deleted
+				continue;
+			}
+			
+			if (event->len == 0) {
+				continue;
+			}
+			
+			const FileName path = i->second.append(FileName(event->name));
+			
+			if (event->mask & IN_ISDIR) {
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					addWatch(path);
+				}
+			} else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+				changed.insert(path);
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,52 @@
+#ifndef _FILE_WATCHER_H_
+#define _FILE_WATCHER_H_
+
+/**
+Reports changes to files under watched directories, so that assets loaded
+from them may be reloaded while the game runs.
+
+Changes are detected with inotify, so files are only watched on Linux;
+elsewhere, watch() fails and no change is ever reported.
+*/
+class FileWatcher {
+public:
+	/** Destructor */
+	~FileWatcher();
+	
+	/** Constructor */
+	FileWatcher();
+	
+	/**
+	Starts watching a directory and all of its subdirectories, including
+	those created later
+	@param directory Directory to watch
+	@return true if successful
+	*/
+	bool watch(const FileName &directory);
+	
+	/**
+	Collects the files that have been written, created or moved into place
+	since the last poll, without blocking
+	@param changed Receives the changed files, each listed once
+	*/
+	void poll(set<FileName> &changed);
+	
+private:
+	FileWatcher(const FileWatcher&);
+	FileWatcher& operator=(const FileWatcher&);
+	
+	/**
+	Watches a single directory, then each of its subdirectories
+	@param directory Directory to watch
+	@return true if the directory itself is watched
+	*/
+	bool addWatch(const FileName &directory);
+	
+	/** inotify instance, or -1 if there is none */
+	int fd;
+	
+	/** Watched directories, by watch descriptor */
+	map<int, FileName> directories;
+};
+
+#endif
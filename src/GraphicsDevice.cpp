@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Application.h"
 #include "GraphicsDevice.h"
+#include "VertexFormat.h"
 
 #ifdef _WIN32
 void GraphicsDevice::flushMessageQueue() {
@@ -162,6 +163,9 @@ void GraphicsDevice::initializeOpenGLState() {
 void GraphicsDevice::initializeOpenGLExtensions() {
 	GLenum err = glewInit();
 	VERIFY(GLEW_OK == err, (const char*)glewGetErrorString(err));
+	
+	// Tex-coords are packed into half floats only where they can be read
+	VertexFormat::setHalfFloatSupported(GLEW_ARB_half_float_vertex != 0);
 }
 
 void GraphicsDevice::resizeOpenGLViewport(const ivec2 &_dimensions,
@@ -15,6 +15,7 @@ GrassLayer::GrassLayer(shared_ptr<class Renderer> renderer,
                        TextureFactory &textureFactory) {
 	numCellColumns = 0;
 	numCellRows = 0;
+	cellSpacing = 0.0f;
 	cells = 0;
 	
 	useShader=false; // default
@@ -47,29 +48,57 @@ GrassLayer::GrassLayer(shared_ptr<class Renderer> renderer,
 
 void GrassLayer::generate(const vec2 &center,
                           float size,
+                          unsigned int seed,
                           function<tuple<float,vec3>(vec2)> elevationFunc) {
+	prepare(center, size);
+	
+	for (int col = 0; col < numCellColumns; ++col) {
+		generateColumn(col, seed + col, elevationFunc);
+	}
+	
+	upload();
+}
+
+void GrassLayer::prepare(const vec2 &, float size) {
 	int s = (int)ceilf(size / 8.0f);
 	numCellColumns = s;
 	numCellRows = s;
 	cells = new struct GrassCell[numCellRows * numCellColumns];
+	cellSpacing = size / s;
+}
+
+void GrassLayer::generateColumn(int col,
+                                unsigned int seed,
+                                function<tuple<float,vec3>(vec2)> elevationFunc) {
+	ASSERT(col >= 0 && col < numCellColumns, "Invalid column: " + itos(col));
 	
-	float cellSpacing = size / s;
+	mt19937 rng(seed);
 	float cellSize = cellSpacing / 2.0f;
 	
-	for (int col = 0; col < numCellColumns; ++col) {
-		for (int row = 0; row < numCellRows; ++row) {
-			GrassCell &cell = cells[numCellRows*col + row];
-			generateCell(cell,
-			             vec2(col + 0.5f, row + 0.5f) * cellSpacing,
-			             cellSize,
-			             elevationFunc);
-		}
+	for (int row = 0; row < numCellRows; ++row) {
+		GrassCell &cell = cells[numCellRows*col + row];
+		generateCell(cell,
+		             vec2(col + 0.5f, row + 0.5f) * cellSpacing,
+		             cellSize,
+		             rng,
+		             elevationFunc);
 	}
 }
 
+void GrassLayer::upload() {
+	VertexFootprint footprint;
+	
+	for (int i = 0; i < numCellColumns * numCellRows; ++i) {
+		footprint += uploadCell(cells[i]);
+	}
+	
+	TRACE("Grass layer: " + footprint.toString());
+}
+
 void GrassLayer::generateCell(struct GrassCell &cell,
                               const vec2 &center,
                               float size,
+                              mt19937 &rng,
                               function<tuple<float,vec3>(vec2)> elevationFunc) {
 	vec2 bounds_min = center - vec2(size, size);
 	vec2 bounds_max = center + vec2(size, size);
@@ -77,11 +106,28 @@ void GrassLayer::generateCell(struct GrassCell &cell,
 	cell.size = size;
 	cell.center = center;
 	
-	shared_ptr<Mesh> mesh = generateMesh(generateTufts(bounds_min,
-	                                     bounds_max,
-	                                     elevationFunc));
-	                                     
+	generateGeometry(cell,
+	                 generateTufts(bounds_min, bounds_max, rng, elevationFunc),
+	                 rng);
+}
+
+VertexFootprint GrassLayer::uploadCell(struct GrassCell &cell) {
+	shared_ptr<Mesh> mesh(new Mesh(cell.vertices,
+	                               cell.normals,
+	                               cell.texcoords,
+	                               cell.colors,
+	                               cell.faces,
+	                               true)); // completely static buffers
+	                               
+	// The geometry now lives in the mesh
+	vector<vec3>().swap(cell.vertices);
+	vector<vec3>().swap(cell.normals);
+	vector<vec2>().swap(cell.texcoords);
+	vector<color>().swap(cell.colors);
+	vector<Face>().swap(cell.faces);
+	
 	mesh->getGeometryChunk(cell.renderInstance.gc);
+	mesh->releaseClientCopies(); // never read back, only rendered
 	
 	// Use grass material generated earlier
 	cell.renderInstance.gc.material = grassMaterial;
@@ -94,14 +140,18 @@ void GrassLayer::generateCell(struct GrassCell &cell,
 		cell.renderInstance.specificRenderMethod = METHOD_GRASS_FFP;
 		cell.renderInstance.metaRenderMethod = TAG_UNSPECIFIED;
 	}
+	
+	return mesh->getFootprint();
 }
 
-shared_ptr<Mesh> GrassLayer::generateMesh( const vector<GrassTuft> &elements ) {
-	vector<vec3> verticesArray;
-	vector<vec3> normalsArray;
-	vector<vec2> texcoordsArray;
-	vector<color> colorsArray;
-	vector<Face> facesArray;
+void GrassLayer::generateGeometry(struct GrassCell &cell,
+                                  const vector<GrassTuft> &elements,
+                                  mt19937 &rng) {
+	vector<vec3> &verticesArray = cell.vertices;
+	vector<vec3> &normalsArray = cell.normals;
+	vector<vec2> &texcoordsArray = cell.texcoords;
+	vector<color> &colorsArray = cell.colors;
+	vector<Face> &facesArray = cell.faces;
 	
 	int idx=0;
 	
@@ -121,7 +171,7 @@ shared_ptr<Mesh> GrassLayer::generateMesh( const vector<GrassTuft> &elements ) {
 			        facesArray);
 		} else {
 			// Add several crossed quads to make a tuft
-			float baseRotation = FRAND_RANGE(0.0f, (float)(M_PI * 2.0));
+			float baseRotation = SampleUniform(rng, 0.0f, (float)(M_PI * 2.0));
 			for (int quad=0; quad<3; ++quad) {
 				addQuad(tuft,
 				        idx,
@@ -134,21 +184,12 @@ shared_ptr<Mesh> GrassLayer::generateMesh( const vector<GrassTuft> &elements ) {
 			}
 		}
 	}
-	
-	// Generate mesh object from this geometry
-	shared_ptr<Mesh> mesh;
-	mesh = shared_ptr<Mesh>(new Mesh(verticesArray,
-	                                 normalsArray,
-	                                 texcoordsArray,
-	                                 colorsArray,
-	                                 facesArray,
-	                                 true)); // completely static buffers
-	return mesh;
 }
 
 vector<GrassLayer::GrassTuft>
 GrassLayer::generateTufts(const vec2 &bounds_min,
                           const vec2 &bounds_max,
+                          mt19937 &rng,
                           function<tuple<float,vec3>(vec2)> elevationFunc) {
 	vector<GrassTuft> tufts;
 	vec2 pos;
@@ -157,12 +198,12 @@ GrassLayer::generateTufts(const vec2 &bounds_min,
 		for (pos.x = bounds_min.x; pos.x < bounds_max.x; pos.x += spacing.x) {
 			GrassTuft tuft;
 			
-			float angle = FRAND_RANGE(0.0f, (float)(M_PI * 2.0));
-			vec2 offset = vec2(cos(angle), sin(angle)) * SampleNormal(displacement, 0.0f);
+			float angle = SampleUniform(rng, 0.0f, (float)(M_PI * 2.0));
+			vec2 offset = vec2(cos(angle), sin(angle)) * SampleNormal(rng, displacement, 0.0f);
 			vec2 tuftPos =  pos + offset;
 			
-			tuft.size = generateTuftSize();
-			tuft.type = IRAND_RANGE(0,3);
+			tuft.size = generateTuftSize(rng);
+			tuft.type = SampleUniformInt(rng, 0, 2);
 			
 			tuple<float, vec3> zn = elevationFunc(tuftPos);
 			tuft.position = vec3(tuftPos, zn.get<0>());
@@ -250,9 +291,9 @@ void GrassLayer::addQuad(const GrassTuft &tuft,
 	idx+=4;
 }
 
-float GrassLayer::generateTuftSize() {
+float GrassLayer::generateTuftSize(mt19937 &rng) {
 	// http://en.wikipedia.org/wiki/Lognormal_distribution
-	return SampleLogNormal(size_mu, size_sigma)*size_multiplier
+	return SampleLogNormal(rng, size_mu, size_sigma)*size_multiplier
 	       + size_constant_offset;
 }
 
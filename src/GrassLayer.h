@@ -24,6 +24,13 @@ private:
 		
 		/** Geometry of the grass cell*/
 		RenderInstance renderInstance;
+		
+		/** Geometry generated for the cell, until it is uploaded */
+		vector<vec3> vertices;
+		vector<vec3> normals;
+		vector<vec2> texcoords;
+		vector<color> colors;
+		vector<Face> faces;
 	};
 	
 	/** Information pertaining to a single grass quad */
@@ -49,6 +56,7 @@ private:
 	
 	int numCellColumns;
 	int numCellRows;
+	float cellSpacing;
 	GrassCell *cells;
 	
 public:
@@ -67,14 +75,50 @@ public:
 	Generates grass elements and turns them into geometry.
 	@param center Position of the grass layer
 	@param size Length of the square grass layer on each side
+	@param seed Seeds the random placement of the grass
 	@param elevationFunc Given the coordinates (x,y) of a region within the
 	                     bounding rectangle, return the elevation (z) of that
 						 point and the normal at that point.
 	*/
 	void generate(const vec2 &center,
 	              float size,
+	              unsigned int seed,
 	              function<tuple<float,vec3>(vec2)> elevationFunc);
 	              
+	/**
+	Lays out the cells of the grass layer, before any column is generated
+	@param center Position of the grass layer
+	@param size Length of the square grass layer on each side
+	*/
+	void prepare(const vec2 &center, float size);
+	
+	/** Gets the number of columns of cells */
+	inline int getNumColumns() const {
+		return numCellColumns;
+	}
+	
+	/**
+	Generates grass elements and geometry for one column of cells.
+	Only the cells of that column are touched, so different columns may be
+	generated on different threads at the same time.
+	@param column Index of the column
+	@param seed Seeds the random number generator of this column alone, so
+	            that the column is the same whichever thread generates it
+	@param elevationFunc Given the coordinates (x,y) of a region within the
+	                     bounding rectangle, return the elevation (z) of that
+						 point and the normal at that point.
+	*/
+	void generateColumn(int column,
+	                    unsigned int seed,
+	                    function<tuple<float,vec3>(vec2)> elevationFunc);
+	                    
+	/**
+	Sends the generated geometry of every cell to the graphics device.
+	Must be called on the main thread, once every column is generated.
+	*/
+	void upload();
+	
+
 	/**
 	Generates batches for the grass layer.
 	Employs frustum culling to reduce batches
@@ -83,9 +127,10 @@ public:
 	
 private:
 	/**
-	Generates a single grass cell and associated geometry.
+	Generates the grass elements of a single cell and their geometry.
 	@param center Position of the center of the grass cell
 	@param size Length of the grass cell square on it side
+	@param rng Random number generator of the column
 	@param elevationFunc Given the coordinates (x,y) of a region within the
 	                     bounding rectangle, return the elevation (z) of that
 						 point and the normal at that point.
@@ -93,13 +138,24 @@ private:
 	void generateCell(struct GrassCell &cell,
 	                  const vec2 &center,
 	                  float size,
+	                  mt19937 &rng,
 	                  function<tuple<float,vec3>(vec2)> elevationFunc);
 	                  
 	/**
 	Generates geometry from grass elements.
+	@param cell Receives the geometry
 	@param elements Grass elements in the grass layer
+	@param rng Random number generator of the column
+	*/
+	void generateGeometry(struct GrassCell &cell,
+	                      const vector<GrassTuft> &elements,
+	                      mt19937 &rng);
+	                      
+	/**
+	Creates a mesh from the generated geometry of the cell
+	@return Memory used by the mesh on the GPU
 	*/
-	shared_ptr<Mesh> generateMesh(const vector<GrassTuft> &elements);
+	VertexFootprint uploadCell(struct GrassCell &cell);
 	
 	/**
 	Generates grass elements.
@@ -115,13 +171,15 @@ private:
 	                    random offset vector having a Gaussian distribution
 						in magnitude.  This is the standard deviation of that
 						offset.
+	@param rng Random number generator of the column
 	*/
 	vector<GrassTuft>
 	generateTufts(const vec2 &bounds_min,
 	              const vec2 &bounds_max,
+	              mt19937 &rng,
 	              function<tuple<float,vec3>(vec2)> zn);
 	              
-	float generateTuftSize();
+	float generateTuftSize(mt19937 &rng);
 	
 	void addQuad(const GrassTuft &tuft,
 	             int &idx,
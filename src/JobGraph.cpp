@@ -0,0 +1,129 @@
+#include "Core.h"
+#include "JobGraph.h"
+
+JobGraph::~JobGraph() {
+	if (started) {
+		wait();
+	}
+}
+
+JobGraph::JobGraph()
+		: pool(0),
+		started(false),
+		numRemaining(0),
+		totalJobTime(0.0) {}
+
+JobGraph::JobID JobGraph::add(const Job &job) {
+	return add(job, vector<JobID>());
+}
+
+JobGraph::JobID JobGraph::add(const Job &job, JobID dependency) {
+	return add(job, vector<JobID>(1, dependency));
+}
+
+JobGraph::JobID JobGraph::add(const Job &job,
+                              const vector<JobID> &dependencies) {
+	ASSERT(!started, "Cannot add jobs to a graph that has been started");
+	
+	const JobID id = jobs.size();
+	
+	Node node;
+	node.job = job;
+	node.numBlockers = dependencies.size();
+	jobs.push_back(node);
+	
+	for (vector<JobID>::const_iterator i = dependencies.begin();
+	     i != dependencies.end(); ++i) {
+		ASSERT(*i < id, "Jobs may only depend on jobs added before them");
+		jobs[*i].dependents.push_back(id);
+	}
+	
+	return id;
+}
+
+void JobGraph::start(ThreadPool *_pool) {
+	ASSERT(!started, "Job graph has already been started");
+	
+	pool = _pool;
+	started = true;
+	numRemaining = jobs.size();
+	
+	if (jobs.empty()) {
+		finished.post();
+		return;
+	}
+	
+	if (!pool) {
+		for (JobID id = 0; id < jobs.size(); ++id) {
+			run(id);
+		}
+		
+		return;
+	}
+	
+	// Collect the roots first, as they may unblock other jobs once queued
+	vector<JobID> roots;
+	
+	for (JobID id = 0; id < jobs.size(); ++id) {
+		if (jobs[id].numBlockers == 0) {
+			roots.push_back(id);
+		}
+	}
+	
+	for (vector<JobID>::const_iterator i = roots.begin();
+	     i != roots.end(); ++i) {
+		pool->add(bind(&JobGraph::run, this, *i));
+	}
+}
+
+void JobGraph::wait() {
+	ASSERT(started, "Job graph has not been started");
+	
+	finished.wait();
+	
+	// Let later calls return at once
+	finished.post();
+}
+
+void JobGraph::run(JobID id) {
+	const double begin = Thread::getMilliseconds();
+	jobs[id].job();
+	const double elapsed = Thread::getMilliseconds() - begin;
+	
+	vector<JobID> unblocked;
+	bool last = false;
+	
+	{
+		MutexLock lock(mutex);
+		
+		const vector<JobID> &dependents = jobs[id].dependents;
+		
+		for (vector<JobID>::const_iterator i = dependents.begin();
+		     i != dependents.end(); ++i) {
+			if (--jobs[*i].numBlockers == 0) {
+				unblocked.push_back(*i);
+			}
+		}
+		
+		totalJobTime += elapsed;
+		last = (--numRemaining == 0);
+	}
+	
+	// Without a pool, jobs are already being run in an order that respects
+	// their dependencies
+	if (pool) {
+		for (vector<JobID>::const_iterator i = unblocked.begin();
+		     i != unblocked.end(); ++i) {
+			pool->add(bind(&JobGraph::run, this, *i));
+		}
+	}
+	
+	if (last) {
+		finished.post();
+	}
+}
+
+double JobGraph::getTotalJobTime() const {
+	MutexLock lock(mutex);
+	return totalJobTime;
+}
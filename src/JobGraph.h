@@ -0,0 +1,115 @@
+#ifndef _JOB_GRAPH_H_
+#define _JOB_GRAPH_H_
+
+#include "ThreadPool.h"
+
+/**
+Set of jobs with dependencies between them.
+
+A job is queued on a thread pool as soon as every job it depends on has
+finished, so independent jobs run in parallel while dependent ones run in
+order. Jobs may only depend on jobs added before them, which keeps the
+graph free of cycles; run without a pool, the jobs simply run in the order
+in which they were added.
+*/
+class JobGraph {
+public:
+	typedef ThreadPool::Job Job;
+	
+	/** Identifies a job within the graph */
+	typedef size_t JobID;
+	
+	/** Waits for any jobs that are still running */
+	~JobGraph();
+	
+	/** Constructor */
+	JobGraph();
+	
+	/**
+	Adds a job that may run at any time
+	@param job Job to run
+	@return ID of the job
+	*/
+	JobID add(const Job &job);
+	
+	/**
+	Adds a job that runs once another job has finished
+	@param job Job to run
+	@param dependency Job that must finish first
+	@return ID of the job
+	*/
+	JobID add(const Job &job, JobID dependency);
+	
+	/**
+	Adds a job that runs once several jobs have finished
+	@param job Job to run
+	@param dependencies Jobs that must finish first
+	@return ID of the job
+	*/
+	JobID add(const Job &job, const vector<JobID> &dependencies);
+	
+	/**
+	Starts running the jobs. No jobs may be added once started.
+	@param pool Threads on which to run the jobs. If null, every job is run
+	       on the calling thread before returning.
+	*/
+	void start(ThreadPool *pool);
+	
+	/** Blocks until every job has finished */
+	void wait();
+	
+	/** Gets the number of jobs in the graph */
+	inline size_t getNumJobs() const {
+		return jobs.size();
+	}
+	
+	/**
+	Gets the time spent running jobs, summed over all threads. Compared
+	with the wall clock time of the whole graph, this gives the speedup won
+	by running the jobs in parallel.
+	@return time in milliseconds
+	*/
+	double getTotalJobTime() const;
+	
+private:
+	JobGraph(const JobGraph&);
+	JobGraph& operator=(const JobGraph&);
+	
+	/** Job and its place in the graph */
+	struct Node {
+		/** Job to run */
+		Job job;
+		
+		/** Jobs that depend on this one */
+		vector<JobID> dependents;
+		
+		/** Number of unfinished jobs that this one depends on */
+		size_t numBlockers;
+	};
+	
+	/** Runs a job, then queues any dependents that it unblocked */
+	void run(JobID id);
+	
+	/** Jobs in the order in which they were added */
+	vector<Node> jobs;
+	
+	/** Threads running the jobs, or null if they run on the caller */
+	ThreadPool *pool;
+	
+	/** Indicates that the jobs have been started */
+	bool started;
+	
+	/** Guards the members below */
+	mutable Mutex mutex;
+	
+	/** Number of jobs that have not finished */
+	size_t numRemaining;
+	
+	/** Time spent running jobs, in milliseconds */
+	double totalJobTime;
+	
+	/** Signalled when the last job finishes */
+	Semaphore finished;
+};
+
+#endif
@@ -1,25 +1,19 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
 #include "KeyFrame.h"
 
 KeyFrame::KeyFrame(Mesh* mesh) {
-	meshes.push_back(mesh);
+	meshes.push_back(shared_ptr<Mesh>(mesh));
 }
 
-KeyFrame::KeyFrame(vector<Mesh*> Meshes)
-		: meshes(Meshes) {}
-
-KeyFrame::KeyFrame(const KeyFrame &keyframe) {
-	const vector<Mesh*> &m = keyframe.getMeshes();
-	for (vector<Mesh*>::const_iterator i = m.begin(); i != m.end(); ++i) {
-		Mesh *mesh = new Mesh(*i);
-		meshes.push_back(mesh);
+KeyFrame::KeyFrame(vector<Mesh*> model) {
+	for (vector<Mesh*>::const_iterator i = model.begin(); i != model.end(); ++i) {
+		meshes.push_back(shared_ptr<Mesh>(*i));
 	}
 }
 
-KeyFrame& KeyFrame::operator=(const KeyFrame &keyframe) {
-	meshes = keyframe.meshes;
-	return(*this);
-}
+KeyFrame::KeyFrame(const MeshSet &_meshes)
+		: meshes(_meshes) {}
 
 bool KeyFrame::merge(const KeyFrame &o) {
 	if (getMeshes().size() == 0) {
@@ -28,7 +22,7 @@ bool KeyFrame::merge(const KeyFrame &o) {
 		if (getMeshes().size() != o.getMeshes().size())
 			return false;
 			
-		for (vector<Mesh*>::const_iterator iter=o.getMeshes().begin();
+		for (MeshSet::const_iterator iter=o.getMeshes().begin();
 		     iter != o.getMeshes().end();
 		     ++iter) {
 			meshes.push_back(*iter);
@@ -38,8 +32,52 @@ bool KeyFrame::merge(const KeyFrame &o) {
 	return true;
 }
 
-void KeyFrame::applySkinToModel(vector<Mesh*> &model, const Material &mat) {
-	for_each(model.begin(), model.end(), bind(&Mesh::setMaterial, _1, mat));
+bool KeyFrame::append(const vector<const KeyFrame*> &keyFrames) {
+	vector<const KeyFrame*>::const_iterator next = keyFrames.begin();
+	
+	if (getMeshes().size() == 0 && next != keyFrames.end()) {
+		meshes = (*next)->getMeshes();
+		++next;
+	}
+	
+	for (vector<const KeyFrame*>::const_iterator i=next; i!=keyFrames.end(); ++i) {
+		if ((*i)->getMeshes().size() != meshes.size()) {
+			return false;
+		}
+	}
+	
+	if (next == keyFrames.end()) {
+		return true;
+	}
+	
+	// Each mesh gathers its counterparts and is built anew only once
+	for (size_t i=0; i<meshes.size(); ++i) {
+		vector<const Mesh*> others;
+		
+		for (vector<const KeyFrame*>::const_iterator j=next; j!=keyFrames.end(); ++j) {
+			others.push_back((*j)->getMeshes()[i].get());
+		}
+		
+		meshes[i]->append(others);
+	}
+	
+	return true;
+}
+
+BoundingVolume KeyFrame::getBounds() const {
+	BoundingVolume bounds;
+	
+	for (MeshSet::const_iterator i=meshes.begin(); i!=meshes.end(); ++i) {
+		bounds.merge((*i)->getBounds());
+	}
+	
+	return bounds;
+}
+
+void KeyFrame::applySkinToModel(MeshSet &model, const Material &mat) {
+	for (MeshSet::iterator i=model.begin(); i!=model.end(); ++i) {
+		(*i)->setMaterial(mat);
+	}
 }
 
 void KeyFrame::applySkin(const Material &material) {
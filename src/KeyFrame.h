@@ -4,37 +4,40 @@
 #ifndef _KEYFRAME_H_
 #define _KEYFRAME_H_
 
-/** Stores all data related to a particular key frame in an animation */
+/** Meshes that together make up a model at one moment */
+typedef vector< shared_ptr<Mesh> > MeshSet;
+
+/**
+Stores all data related to a particular key frame in an animation. Key
+frames refer to their meshes: copies of a key frame share the same meshes,
+which are deleted along with the last key frame referring to them.
+*/
 class KeyFrame {
 private:
 	/** Reference to the meshes involved in the keyframe */
-	vector<Mesh*> meshes;
+	MeshSet meshes;
 	
 public:
 	/**
 	Constructs the keyframe from a single mesh
-	@param model The mesh to use for this keyframe
+	@param model The mesh to use for this keyframe, which the key frame
+	             takes ownership of
 	*/
 	KeyFrame(Mesh* mesh);
 	
 	/**
 	Constructs the keyframe from a model
-	@param model The mesh to use for this keyframe
+	@param model The mesh to use for this keyframe, which the key frame
+	             takes ownership of
 	*/
 	KeyFrame(vector<Mesh*> model);
 	
 	/**
-	Copy costructor
-	@param keyframe The key frame to copy
+	Constructs the keyframe from meshes that may be shared with other key
+	frames
+	@param meshes The meshes to use for this keyframe
 	*/
-	KeyFrame(const KeyFrame &keyframe);
-	
-	/**
-	Assignment operator
-	@param keyframe The keyframe to copy
-	@return The new value of this keyframe
-	*/
-	KeyFrame &operator=(const KeyFrame &keyframe);
+	KeyFrame(const MeshSet &meshes);
 	
 	/**
 	Gets the model associated with the key frame
@@ -42,14 +45,14 @@ public:
 	@return a pointer to the model associated with this key frame
 	*/
 	Mesh* getMesh(size_t i) const {
-		return meshes[i];
+		return meshes[i].get();
 	}
 	
 	/**
 	Gets the models associated with the key frame
 	@return a pointer to the model associated with this key frame
 	*/
-	vector<Mesh*> & getMeshes() {
+	MeshSet & getMeshes() {
 		return meshes;
 	}
 	
@@ -57,7 +60,7 @@ public:
 	Gets the models associated with the key frame
 	@return a pointer to the model associated with this key frame
 	*/
-	const vector<Mesh*> & getMeshes() const {
+	const MeshSet & getMeshes() const {
 		return meshes;
 	}
 	
@@ -70,12 +73,28 @@ public:
 	*/
 	bool merge(const KeyFrame &o);
 	
+	/**
+	Appends the geometry of other key frames' meshes to this key frame's
+	meshes, one for one, so that each mesh draws all of them as material
+	ranges. If this object is empty, then the meshes of the first are
+	copied over.
+	@param keyFrames Key frames whose meshes are appended, in order
+	@return true if the key frames have the same number of meshes
+	*/
+	bool append(const vector<const KeyFrame*> &keyFrames);
+	
+	/**
+	Gets the bounds of the key frame, merged from the bounds that its
+	meshes computed when they were built
+	*/
+	BoundingVolume getBounds() const;
+	
 	/**
 	Applies the skin to the specified model
 	@param model The model to which the skin should be applied.
 	@param material The skin
 	*/
-	static void applySkinToModel(vector<Mesh*> &model, const Material &material);
+	static void applySkinToModel(MeshSet &model, const Material &material);
 	
 	/**
 	Applies the skin to the specified model
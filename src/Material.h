@@ -17,7 +17,7 @@ public:
 	Sets a texture for the material and leaves all else at default values.
 	@param fileName Texture file name
 	*/
-	Material(TextureFactory::Handle *texture);
+	Material(const TextureFactory::HandlePtr &texture);
 	
 	/** Clears the state of the Material and resets it */
 	void clear();
@@ -26,7 +26,7 @@ public:
 	Adds a texture to the list of textures to apply during multitexturing
 	@param textureHandle A handle to the texture
 	*/
-	void setTexture(TextureFactory::Handle *textureHandle);
+	void setTexture(const TextureFactory::HandlePtr &textureHandle);
 	
 	/**	Passes Material information to the currently bound Effect. */
 	void bind() const;
@@ -55,9 +55,10 @@ public:
 	
 	/**
 	Handle to the texture resource.  Texture resource may be reloaded or
-	altered behind the scenes by the texture manager.
+	altered behind the scenes by the texture manager.  The texture stays
+	resident for as long as any material references it.
 	*/
-	TextureFactory::Handle *texture;
+	TextureFactory::HandlePtr texture;
 };
 
 #endif
@@ -0,0 +1,28 @@
+#include "stdafx.h"
+#include "Material.h"
+
+void Material::bind() const {
+	CHECK_GL_ERROR();
+	
+	if (texture) {
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture->getID());
+		setTextureFilters();
+		glEnable(GL_TEXTURE_2D);
+	}
+	
+	glMaterialfv(GL_FRONT, GL_AMBIENT,   Ka);
+	glMaterialfv(GL_FRONT, GL_DIFFUSE,   Kd);
+	glMaterialfv(GL_FRONT, GL_SPECULAR,  Ks);
+	glMaterialfv(GL_FRONT, GL_EMISSION,  color(0.0f, 0.0f, 0.0f, 1.0f));
+	glMaterialf(GL_FRONT,  GL_SHININESS, shininess);
+	glColorMaterial(GL_FRONT, GL_AMBIENT_AND_DIFFUSE);
+	
+	CHECK_GL_ERROR();
+}
+
+void Material::setTextureFilters() {
+	// trilinear filtering
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+}
@@ -1,5 +1,8 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
 #include "Mesh.h"
+#include "MeshBuilder.h"
+#include "VertexBlend.h"
 
 Mesh::~Mesh() {
 	// Do Nothing
@@ -45,50 +48,12 @@ Mesh::Mesh(const vector<vec3> &verticesArray,
 	ASSERT(texcoordsArray.size()>0, "Too few tex-coords");
 	ASSERT(facesArray.size()>0,     "Too few faces");
 	
-	const index_t numOfIndices = facesArray.size()*3;
-	index_t el = 0;
-	
-	index_t *indices = new index_t[numOfIndices];
-	vec3 *vertices = new vec3[numOfIndices];
-	vec2 *texCoords = new vec2[numOfIndices];
-	vec3 *normals = new vec3[numOfIndices];
-	
-	for (vector<Face>::const_iterator i=facesArray.begin();
-	     i!=facesArray.end();
-	     ++i) {
-		const Face &face = *i;
-		
-		for (int j=0; j<3; ++j) {
-			indices[el] = el;
-			
-			ASSERT(face.vertIndex[j] >= 0   && (size_t)face.vertIndex[j] < verticesArray.size(),   "Invalid vertex index: " + itos(face.vertIndex[j]));
-			ASSERT(face.coordIndex[j] >= 0  && (size_t)face.coordIndex[j] < texcoordsArray.size(), "Invalid tex-coord index: " + itos(face.coordIndex[j]));
-			ASSERT(face.normalIndex[j] >= 0 && (size_t)face.normalIndex[j] < normalsArray.size(),  "Invalid normal index: " + itos(face.normalIndex[j]));
-			
-			vertices[el] = verticesArray[face.vertIndex[j]];
-			texCoords[el] = texcoordsArray[face.coordIndex[j]];
-			normals[el] = normalsArray[face.normalIndex[j]];
-			
-			el++;
-		}
-	}
-	
-	if (completelyStatic) {
-		vertexArray   -> recreate(numOfIndices, vertices,  STATIC_DRAW);
-		normalArray   -> recreate(numOfIndices, normals,   STATIC_DRAW);
-		texCoordArray -> recreate(numOfIndices, texCoords, STATIC_DRAW);
-		indexArray    -> recreate(numOfIndices, indices,   STATIC_DRAW);
-	} else {
-		vertexArray   -> recreate(numOfIndices, vertices,  DYNAMIC_DRAW); // will be modified often in as mesh is animated
-		normalArray   -> recreate(numOfIndices, normals,   DYNAMIC_DRAW); // will be modified often in as mesh is animated
-		texCoordArray -> recreate(numOfIndices, texCoords, STATIC_DRAW);  // do not change as the mesh is animated
-		indexArray    -> recreate(numOfIndices, indices,   STATIC_DRAW);  // do not change as the mesh is animated
-	}
-	
-	delete [] indices;
-	delete [] vertices;
-	delete [] texCoords;
-	delete [] normals;
+	build(verticesArray,
+	      normalsArray,
+	      texcoordsArray,
+	      vector<color>(),
+	      facesArray,
+	      completelyStatic);
 }
 
 Mesh::Mesh(const vector<vec3> &verticesArray,
@@ -109,55 +74,63 @@ Mesh::Mesh(const vector<vec3> &verticesArray,
 	ASSERT(colorsVector.size()>0,   "Too few colors");
 	ASSERT(facesArray.size()>0,     "Too few faces");
 	
-	const index_t numOfIndices = facesArray.size()*3;
-	index_t el = 0;
-	
-	index_t *indices = new index_t[numOfIndices];
-	vec3 *vertices = new vec3[numOfIndices];
-	vec2 *texCoords = new vec2[numOfIndices];
-	color *colors = new color[numOfIndices];
-	vec3 *normals = new vec3[numOfIndices];
-	
-	for (vector<Face>::const_iterator i=facesArray.begin();
-	     i!=facesArray.end();
-	     ++i) {
-		const Face &face = *i;
-		
-		for (int j=0; j<3; ++j) {
-			indices[el] = el;
-			
-			ASSERT(face.vertIndex[j] >= 0   && (size_t)face.vertIndex[j] < verticesArray.size(),   "Invalid vertex index: " + itos(face.vertIndex[j]));
-			ASSERT(face.coordIndex[j] >= 0  && (size_t)face.coordIndex[j] < texcoordsArray.size(), "Invalid tex-coord index: " + itos(face.coordIndex[j]));
-			ASSERT(face.normalIndex[j] >= 0 && (size_t)face.normalIndex[j] < normalsArray.size(),  "Invalid normal index: " + itos(face.normalIndex[j]));
-			
-			vertices[el] = verticesArray[face.vertIndex[j]];
-			texCoords[el] = texcoordsArray[face.coordIndex[j]];
-			normals[el] = normalsArray[face.normalIndex[j]];
-			colors[el] = colorsVector[face.vertIndex[j]];
-			
-			el++;
-		}
-	}
+	build(verticesArray,
+	      normalsArray,
+	      texcoordsArray,
+	      colorsVector,
+	      facesArray,
+	      completelyStatic);
+}
+
+void Mesh::build(const vector<vec3> &verticesArray,
+                 const vector<vec3> &normalsArray,
+                 const vector<vec2> &texcoordsArray,
+                 const vector<color> &colorsVector,
+                 const vector<Face> &facesArray,
+                 bool completelyStatic) {
+	/*
+	Key frames of an animated mesh are interpolated vertex by vertex, so they
+	must all be laid out alike. Welding by index, rather than by value, lays
+	out every frame with the same faces in the same way.
+	*/
+	MeshBuilder builder(verticesArray,
+	                    normalsArray,
+	                    texcoordsArray,
+	                    colorsVector,
+	                    facesArray,
+	                    completelyStatic ? MeshBuilder::WELD_VALUES
+	                    : MeshBuilder::WELD_INDICES);
+	builder.optimize();
+	builder.count();
+	
+	const vector<vec3> &vertices = builder.getVertices();
+	const vector<vec3> &normals = builder.getNormals();
+	const vector<vec2> &texCoords = builder.getTexCoords();
+	const vector<color> &colors = builder.getColors();
+	const vector<index_t> &indices = builder.getIndices();
+	
+	const int numOfVertices = (int)vertices.size();
+	const int numOfIndices = (int)indices.size();
+	
+	pack();
 	
 	if (completelyStatic) {
-		vertexArray   -> recreate(numOfIndices, vertices,  STATIC_DRAW);
-		normalArray   -> recreate(numOfIndices, normals,   STATIC_DRAW);
-		texCoordArray -> recreate(numOfIndices, texCoords, STATIC_DRAW);
-		colorsArray   -> recreate(numOfIndices, colors,    STATIC_DRAW);
-		indexArray    -> recreate(numOfIndices, indices,   STATIC_DRAW);
+		vertexArray   -> recreate(numOfVertices, &vertices[0],  STATIC_DRAW);
+		normalArray   -> recreate(numOfVertices, &normals[0],   STATIC_DRAW);
+		texCoordArray -> recreate(numOfVertices, &texCoords[0], STATIC_DRAW);
+		indexArray    -> recreate(numOfIndices,  &indices[0],   STATIC_DRAW);
 	} else {
-		vertexArray   -> recreate(numOfIndices, vertices,  DYNAMIC_DRAW); // will be modified often in as mesh is animated
-		normalArray   -> recreate(numOfIndices, normals,   DYNAMIC_DRAW); // will be modified often in as mesh is animated
-		texCoordArray -> recreate(numOfIndices, texCoords, STATIC_DRAW);  // do not change as the mesh is animated
-		colorsArray   -> recreate(numOfIndices, colors,    STATIC_DRAW);  // do not change as the mesh is animated
-		indexArray    -> recreate(numOfIndices, indices,   STATIC_DRAW);  // do not change as the mesh is animated
+		vertexArray   -> recreate(numOfVertices, &vertices[0],  DYNAMIC_DRAW); // will be modified often in as mesh is animated
+		normalArray   -> recreate(numOfVertices, &normals[0],   DYNAMIC_DRAW); // will be modified often in as mesh is animated
+		texCoordArray -> recreate(numOfVertices, &texCoords[0], STATIC_DRAW);  // do not change as the mesh is animated
+		indexArray    -> recreate(numOfIndices,  &indices[0],   STATIC_DRAW);  // do not change as the mesh is animated
+	}
+	
+	if (!colors.empty()) {
+		colorsArray->recreate(numOfVertices, &colors[0], STATIC_DRAW);
 	}
 	
-	delete [] indices;
-	delete [] vertices;
-	delete [] texCoords;
-	delete [] colors;
-	delete [] normals;
+	bounds = BoundingVolume(&vertices[0], numOfVertices);
 }
 
 Mesh& Mesh::operator=(const Mesh &obj) {
@@ -173,157 +146,247 @@ void Mesh::copy(const Mesh &mesh) {
 	colorsArray = mesh.colorsArray->clone();
 	indexArray = mesh.indexArray->clone();
 	polygonWinding = mesh.polygonWinding;
+	materialRanges = mesh.materialRanges;
+	bounds = mesh.bounds;
 }
 
-float Mesh::calculateRadius(RadiusCalculator radius) const {
-	const index_t numOfVerts = vertexArray->getNumber();
+void Mesh::calculateBounds() {
 	const vec3 *vertices = (const vec3*)vertexArray->read_lock();
-	
-	vec3 a(0,0,0);
-	for (index_t i=0; i<numOfVerts; ++i) {
-		vec3 b = vertices[i];
-		a = (radius(a) > radius(b)) ? a : b;
-	}
-	
+	bounds = BoundingVolume(vertices, vertexArray->getNumber());
 	vertexArray->unlock();
-	
-	return radius(a);
 }
 
-float Mesh::calculateHeight() const {
-	const index_t numOfVerts = vertexArray->getNumber();
-	const vec3 *vertices = (const vec3*)vertexArray->read_lock();
-	
-	float maxZ=0, minZ=0;
-	
-	for (index_t i=0; i<numOfVerts; ++i) {
-		const float &z = vertices[i].z;
-		maxZ = max(maxZ, z);
-		minZ = min(minZ, z);
-	}
-	
-	vertexArray->unlock();
-	
-	return maxZ - minZ;
+/** Gets the size of a buffer on the GPU, which may be null */
+template<typename ELEMENT>
+static size_t getBufferSize(const shared_ptr< ResourceBuffer<ELEMENT> > &buffer) {
+	return buffer ? buffer->getSize() : 0;
 }
 
-float Mesh::calculateHeightBelowGround() const {
-	const index_t numOfVerts = vertexArray->getNumber();
-	const vec3 *vertices = (const vec3*)vertexArray->read_lock();
-	
-	float minZ=0;
-	
-	for (index_t i=0; i<numOfVerts; ++i) {
-		minZ = min(minZ, vertices[i].z);
+/** Gets the size that a buffer would have without packing */
+template<typename ELEMENT>
+static size_t getUnpackedBufferSize(const shared_ptr< ResourceBuffer<ELEMENT> > &buffer) {
+	return buffer ? buffer->getUnpackedSize() : 0;
+}
+
+/** Releases the client-side copy of a buffer, which may be null */
+template<typename ELEMENT>
+static void releaseClientCopy(const shared_ptr< ResourceBuffer<ELEMENT> > &buffer) {
+	if (buffer) {
+		buffer->releaseClientCopy();
 	}
-	
-	vertexArray->unlock();
-	
-	return min(minZ, 0.0f); // Clamp pos values to 0, pass through neg values
+}
+
+size_t Mesh::getMemoryUsage() const {
+	return getBufferSize(vertexArray)
+	       + getBufferSize(normalArray)
+	       + getBufferSize(texCoordArray)
+	       + getBufferSize(colorsArray)
+	       + getBufferSize(indexArray);
+}
+
+VertexFootprint Mesh::getFootprint() const {
+	VertexFootprint footprint;
+	footprint.packed = getMemoryUsage();
+	footprint.unpacked = getUnpackedBufferSize(vertexArray)
+	                     + getUnpackedBufferSize(normalArray)
+	                     + getUnpackedBufferSize(texCoordArray)
+	                     + getUnpackedBufferSize(colorsArray)
+	                     + getUnpackedBufferSize(indexArray);
+	return footprint;
 }
 
 void Mesh::interpolate(float bias, const Mesh &a, const Mesh &b) {
-	const index_t numOfElements = a.indexArray->getNumber();
-	
-	const index_t *elA = (const index_t *)a.indexArray->read_lock();
+	// Key frames that share their faces share the layout of their vertices
+	// (see build) so they are interpolated vertex by vertex
+	const index_t numOfVertices = a.vertexArray->getNumber();
+	
+	ASSERT(b.vertexArray->getNumber() == (int)numOfVertices &&
+	       vertexArray->getNumber() == (int)numOfVertices,
+	       "Key frames have different numbers of vertices");
+	       
 	const vec3 *vertsA = (const vec3 *)a.vertexArray->read_lock();
 	const vec3 *normsA = (const vec3 *)a.normalArray->read_lock();
 	
-	const index_t *elB = (const index_t *)b.indexArray->read_lock();
 	const vec3 *vertsB = (const vec3 *)b.vertexArray->read_lock();
 	const vec3 *normsB = (const vec3 *)b.normalArray->read_lock();
 	
-	index_t *elements = (index_t *)indexArray->lock();
 	vec3 *vertices = (vec3 *)vertexArray->lock();
 	vec3 *normals = (vec3 *)normalArray->lock();
 	
-	for (index_t i=0; i<numOfElements; ++i) {
-		const index_t &a = elA[i];
-		const index_t &b = elB[i];
-		
-		// Make sure connectivity is the same as one of the key frames
-		const index_t &x = elements[i] = a;
-		
-		const vec3 &vertexA = vertsA[a];
-		const vec3 &normalA = normsA[a];
-		
-		const vec3 &vertexB = vertsB[b];
-		const vec3 &normalB = normsB[b];
-		
-		vertices[x] = vertexA + (vertexB - vertexA)*bias;
-		normals[x] = normalA + (normalB - normalA)*bias;
-	}
+	VertexBlend::blend(vertices, vertsA, vertsB, numOfVertices, bias);
+	VertexBlend::blend(normals, normsA, normsB, numOfVertices, bias);
+	
+	// Blended normals are shorter than the key frames' normals
+	VertexBlend::normalize(normals, numOfVertices);
 	
-	indexArray->unlock();
 	vertexArray->unlock();
 	normalArray->unlock();
 	
-	b.indexArray->unlock();
 	b.vertexArray->unlock();
 	b.normalArray->unlock();
 	
-	a.indexArray->unlock();
 	a.vertexArray->unlock();
 	a.normalArray->unlock();
+	
+	bounds = a.bounds;
+	bounds.merge(b.bounds);
 }
 
-tuple<dGeomID,dTriMeshDataID> Mesh::createGeom(dSpaceID physicsSpace)const {
-	dVector3 *triVert = new dVector3[vertexArray->getNumber()];
-	
-	// Convert vertices to a format that ODE can accept
-	{
-		const vec3 *vertices = (const vec3 *)vertexArray->lock();
-		for (index_t i=0; i < (index_t)vertexArray->getNumber(); ++i) {
-			triVert[i][0] = vertices[i].x;
-			triVert[i][1] = vertices[i].y;
-			triVert[i][2] = vertices[i].z;
+void Mesh::getGeometryChunk(GeometryChunk &gc) const {
+	gc.vertexArray = vertexArray;
+	gc.normalArray = normalArray;
+	gc.texCoordArray = texCoordArray;
+	gc.indexArray = indexArray;
+	gc.colorsArray = colorsArray;
+	gc.material = material;
+	gc.polygonWinding = polygonWinding;
+	gc.primitiveMode = GL_TRIANGLES;
+}
+
+void Mesh::getGeometryChunks(vector<GeometryChunk> &chunks) const {
+	GeometryChunk gc;
+	getGeometryChunk(gc);
+	
+	if (materialRanges.empty()) {
+		chunks.push_back(gc);
+		return;
+	}
+	
+	for (vector<MaterialRange>::const_iterator i=materialRanges.begin();
+	     i!=materialRanges.end(); ++i) {
+		gc.material = i->material;
+		gc.firstIndex = i->firstIndex;
+		gc.numIndices = i->numIndices;
+		chunks.push_back(gc);
+	}
+}
+
+/**
+Creates a buffer holding the elements of the same buffer of several meshes,
+one after another. Where only some of the meshes have elements, the share
+of the others is filled in.
+@param meshes Meshes whose buffers are concatenated
+@param member Buffer of each mesh that is concatenated
+@param counts Number of vertices of each mesh
+@param numVertices Total number of vertices of the meshes
+@param fill Element standing in for those a mesh does not have
+*/
+template<typename ELEMENT>
+static shared_ptr< ResourceBuffer<ELEMENT> >
+concatenate(const vector<const Mesh*> &meshes,
+            shared_ptr< ResourceBuffer<ELEMENT> > Mesh::*member,
+            const vector<int> &counts,
+            int numVertices,
+            const ELEMENT &fill) {
+	const ResourceBuffer<ELEMENT> *first = 0;
+	
+	for (vector<const Mesh*>::const_iterator i=meshes.begin(); i!=meshes.end() && !first; ++i) {
+		if (((*i)->*member)->getNumber() > 0) {
+			first = ((*i)->*member).get();
 		}
-		vertexArray->unlock();
 	}
 	
-	int *indexes = new int[indexArray->getNumber()];
+	if (!first) {
+		return meshes.front()->*member;
+	}
+	
+	vector<ELEMENT> elements;
+	elements.reserve(numVertices);
 	
-	// Convert indices to a format that ODE can accept
-	{
-		const index_t *indices = (const index_t*)indexArray->lock();
-		for (int i=0; i<indexArray->getNumber(); ++i) {
-			indexes[i] = (int)indices[i];
+	for (size_t i=0; i<meshes.size(); ++i) {
+		ResourceBuffer<ELEMENT> &buffer = *(meshes[i]->*member);
+		const int count = counts[i];
+		
+		if (buffer.getNumber() > 0) {
+			const ELEMENT *e = (const ELEMENT*)buffer.read_lock();
+			elements.insert(elements.end(), e, e + count);
+			buffer.unlock();
+		} else {
+			elements.resize(elements.size() + count, fill);
 		}
-		indexArray->unlock();
 	}
 	
-	return createGeom(physicsSpace,
-	                  (const dVector3*)triVert,
-	                  vertexArray->getNumber(),
-	                  (const int*)indexes,
-	                  indexArray->getNumber());
+	// The buffers may be shared with other meshes, so they are left alone
+	shared_ptr< ResourceBuffer<ELEMENT> > buffer(new ResourceBuffer<ELEMENT>());
+	buffer->setPacking(first->getPacking());
+	buffer->recreate((int)elements.size(), &elements[0], first->getUsage());
+	return buffer;
 }
 
-tuple<dGeomID,dTriMeshDataID> Mesh::createGeom(dSpaceID physicsSpace,
-  const dVector3 *vertices,
-  int numVertices,
-  const int *indices, // in ODE format
-  int numIndices) {
-	dTriMeshDataID meshID = dGeomTriMeshDataCreate();
-	dGeomTriMeshDataBuildSimple(meshID,
-	                            (const dReal*)vertices,
-	                            numVertices,
-	                            indices,
-	                            numIndices);
-	dGeomID geom = dCreateTriMesh(physicsSpace, meshID, 0, 0, 0);
-	dGeomSetPosition(geom, 0.0, 0.0, 0.0);
-	return make_tuple(geom, meshID);
+void Mesh::append(const vector<const Mesh*> &meshes) {
+	vector<const Mesh*>::const_iterator next = meshes.begin();
+	
+	// An empty mesh becomes a copy of the first of the others
+	if (indexArray->getNumber() == 0 && next != meshes.end()) {
+		copy(**next);
+		++next;
+	}
+	
+	vector<const Mesh*> parts(1, this);
+	parts.insert(parts.end(), next, meshes.end());
+	
+	if (parts.size() == 1) {
+		return;
+	}
+	
+	// Every mesh keeps its materials, and its indices refer to its vertices
+	// within the combined buffers
+	vector<MaterialRange> ranges;
+	vector<index_t> indices;
+	vector<int> counts;
+	int numVertices = 0;
+	
+	for (vector<const Mesh*>::const_iterator i=parts.begin(); i!=parts.end(); ++i) {
+		const Mesh &mesh = **i;
+		const int numMeshVertices = mesh.vertexArray->getNumber();
+		const int numMeshIndices = mesh.indexArray->getNumber();
+		const int firstIndex = (int)indices.size();
+		
+		ASSERT(mesh.normalArray->getNumber() == numMeshVertices,
+		       "Meshes must have a normal for each vertex");
+		ASSERT(mesh.texCoordArray->getNumber() == numMeshVertices,
+		       "Meshes must have tex-coords for each vertex");
+		       
+		if (mesh.materialRanges.empty()) {
+			ranges.push_back(MaterialRange(mesh.material, firstIndex, numMeshIndices));
+		} else {
+			for (vector<MaterialRange>::const_iterator j=mesh.materialRanges.begin();
+			     j!=mesh.materialRanges.end(); ++j) {
+				ranges.push_back(MaterialRange(j->material,
+				                               firstIndex + j->firstIndex,
+				                               j->numIndices));
+			}
+		}
+		
+		const index_t *meshIndices = (const index_t*)mesh.indexArray->read_lock();
+		for (int j=0; j<numMeshIndices; ++j) {
+			indices.push_back(meshIndices[j] + (index_t)numVertices);
+		}
+		mesh.indexArray->unlock();
+		
+		counts.push_back(numMeshVertices);
+		numVertices += numMeshVertices;
+	}
+	
+	vertexArray = concatenate(parts, &Mesh::vertexArray, counts, numVertices, vec3(0,0,0));
+	normalArray = concatenate(parts, &Mesh::normalArray, counts, numVertices, vec3(0,0,1));
+	texCoordArray = concatenate(parts, &Mesh::texCoordArray, counts, numVertices, vec2(0,0));
+	colorsArray = concatenate(parts, &Mesh::colorsArray, counts, numVertices, white);
+	
+	ResourceBufferIndicesPtr combinedIndices(new ResourceBufferIndices());
+	combinedIndices->recreate((int)indices.size(), &indices[0], indexArray->getUsage());
+	indexArray = combinedIndices;
+	materialRanges = ranges;
+	
+	// Bounds computed from the vertices have a tighter sphere than merging
+	calculateBounds();
 }
 
-void Mesh::getGeometryChunk(GeometryChunk &gc) const {
-	gc.vertexArray = vertexArray;
-	gc.normalArray = normalArray;
-	gc.texCoordArray = texCoordArray;
-	gc.indexArray = indexArray;
-	gc.colorsArray = colorsArray;
-	gc.material = material;
-	gc.polygonWinding = polygonWinding;
-	gc.primitiveMode = GL_TRIANGLES;
+void Mesh::pack() {
+	vertexArray->setPacking(PACK_POSITIONS);
+	normalArray->setPacking(PACK_NORMALS);
+	texCoordArray->setPacking(PACK_TEXCOORDS);
+	colorsArray->setPacking(PACK_COLORS);
 }
 
 void Mesh::uniformScale( float scale ) {
@@ -334,5 +397,46 @@ void Mesh::uniformScale( float scale ) {
 		vertices[i] = vertices[i] * scale;
 	}
 	
+	bounds = BoundingVolume(vertices, (int)numOfVerts);
+	
 	vertexArray->unlock();
 }
+
+void Mesh::translate(const vec3 &offset) {
+	const index_t numOfVerts = vertexArray->getNumber();
+	vec3 *vertices = (vec3*)vertexArray->lock();
+	
+	for (index_t i=0; i<numOfVerts; ++i) {
+		vertices[i] = vertices[i] + offset;
+	}
+	
+	bounds = BoundingVolume(vertices, (int)numOfVerts);
+	
+	vertexArray->unlock();
+}
+
+void Mesh::releaseClientCopies() {
+	releaseClientCopy(vertexArray);
+	releaseClientCopy(normalArray);
+	releaseClientCopy(texCoordArray);
+	releaseClientCopy(colorsArray);
+	releaseClientCopy(indexArray);
+}
+
+shared_ptr<Mesh> Mesh::createWorkingCopy() const {
+	shared_ptr<Mesh> mesh(new Mesh());
+	mesh->vertexArray = vertexArray->clone();
+	mesh->normalArray = normalArray->clone();
+	mesh->bounds = bounds;
+	mesh->shareStaticBuffers(*this);
+	return mesh;
+}
+
+void Mesh::shareStaticBuffers(const Mesh &mesh) {
+	material = mesh.material;
+	texCoordArray = mesh.texCoordArray;
+	colorsArray = mesh.colorsArray;
+	indexArray = mesh.indexArray;
+	polygonWinding = mesh.polygonWinding;
+	materialRanges = mesh.materialRanges;
+}
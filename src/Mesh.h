@@ -7,10 +7,28 @@
 #include "PropertyBag.h"
 #include "ResourceBuffer.h"
 #include "RenderInstance.h"
+#include "BoundingVolume.h"
 
 /** Holds mesh data and can render that data */
 class Mesh {
 public:
+	/** Run of a mesh's indices that is drawn with a material of its own */
+	struct MaterialRange {
+		/** Material of the triangles in the range */
+		Material material;
+		
+		/** First index of the range */
+		int firstIndex;
+		
+		/** Number of indices in the range */
+		int numIndices;
+		
+		MaterialRange(const Material &_material, int _firstIndex, int _numIndices)
+				: material(_material),
+				firstIndex(_firstIndex),
+				numIndices(_numIndices) {}
+	};
+	
 	/** Destructor */
 	~Mesh();
 	
@@ -69,37 +87,68 @@ public:
 	void getGeometryChunk(GeometryChunk &gc) const;
 	
 	/**
-	Calculates the radius of the smallest sphere that encloses the object.
-	@return radius
+	Gets the geometry chunks that draw the mesh, one for each of its
+	material ranges. The chunks share the mesh's buffers.
+	@param chunks Receives the chunks after any it already holds
+	*/
+	void getGeometryChunks(vector<GeometryChunk> &chunks) const;
+	
+	/**
+	Appends the geometry of other meshes to this one, so that all are held
+	by the same buffers and drawn with one set of array bindings. Each of the
+	other meshes keeps its material as a material range of this mesh. The
+	combined arrays are gathered in one pass and each buffer is created once,
+	however many meshes are appended.
+	@param meshes Meshes to append, in order, which must still have their
+	       client-side copies
+	*/
+	void append(const vector<const Mesh*> &meshes);
+	
+	/**
+	Holds the mesh's vertices, normals, tex-coords and colors on the GPU in
+	compact formats, wherever their contents survive it (see VertexFormat).
+	Buffers created later, and those modified later, are packed as well.
+	*/
+	void pack();
+	
+	/**
+	Gets the bounds of the vertices. These are computed when the mesh is
+	built, and kept up to date by the methods of the mesh that move its
+	vertices, so they are read without scanning the vertices.
 	*/
-	inline float calculateSphericalRadius() const {
-		return calculateRadius(&Mesh::radiusSpherical);
+	inline const BoundingVolume& getBounds() const {
+		return bounds;
 	}
 	
 	/**
-	Calculates the radius of the smallest cylinder that encloses the object.
-	@return radius
+	Sets bounds computed earlier, such as those stored in a cooked model,
+	in place of computing them from the vertices
 	*/
-	inline float calculateCylindricalRadius() const {
-		return calculateRadius(&Mesh::radiusCylindrical);
+	inline void setBounds(const BoundingVolume &_bounds) {
+		bounds = _bounds;
 	}
 	
 	/**
-	Calculates the height of the object.  This is done by calculating the
-	difference between the maximum Y value and minimum Y value.
-	@return height
+	Computes the bounds from the vertices again, which is needed after the
+	vertices were modified through the vertex array
 	*/
-	float calculateHeight() const;
+	void calculateBounds();
 	
 	/**
-	Calculates the height of the portions of the object below the y=0 plane
-	(y=0 plane is ground)
-	@return height
+	Gets the memory used by the mesh's buffers
+	@return Size of the buffers, in bytes
 	*/
-	float calculateHeightBelowGround() const;
+	size_t getMemoryUsage() const;
 	
 	/**
-	Creates an object interpolated from two other existing objects
+	Gets the memory used by the mesh's buffers on the GPU, along with the
+	memory they would use if they were not packed
+	*/
+	VertexFootprint getFootprint() const;
+	
+	/**
+	Creates an object interpolated from two other existing objects. Its
+	bounds are those of the two together, which enclose any blend of them.
 	@param bias Interpolation bias between 0.0 and 1.0
 	@param a The first keyframe
 	@param b The second keyframe
@@ -107,46 +156,69 @@ public:
 	void interpolate(float bias, const Mesh &a, const Mesh &b);
 	
 	/**
-	Sets the material to use for this mesh
+	Sets the material to use for the whole mesh, in place of those of any
+	material ranges
 	@param material Material to use
 	@return The given material is passed through
 	*/
 	inline const Material& setMaterial(const Material &_material) {
+		materialRanges.clear();
 		return(material = _material);
 	}
 	
-	/** Creates a geometry object in ODE that uses this mesh's geometry */
-	tuple<dGeomID,dTriMeshDataID> createGeom(dSpaceID physicsSpace) const;
-	
 	void uniformScale(float scale);
 	
+	/** Moves every vertex of the mesh by an offset */
+	void translate(const vec3 &offset);
+	
+	/**
+	Releases the client-side copies of the buffers, leaving the geometry only
+	on the GPU. The mesh can then be rendered, but no longer read, modified,
+	interpolated or copied.
+	*/
+	void releaseClientCopies();
+	
+	/**
+	Creates a mesh that key frames like this one can be interpolated into.
+	It has vertices and normals of its own and shares everything else with
+	this mesh (see shareStaticBuffers).
+	@return new mesh
+	*/
+	shared_ptr<Mesh> createWorkingCopy() const;
+	
+	/**
+	Shares the buffers that do not change while a mesh is animated, the
+	tex-coords, colors and indices, along with the materials and winding
+	@param mesh Mesh to share with
+	*/
+	void shareStaticBuffers(const Mesh &mesh);
+	
 private:
+	/**
+	Welds and reorders the geometry, then creates the buffers from it
+	@param verticesArray Vertices
+	@param normalsArray Vertex normals
+	@param texcoordsArray Tex-Coords
+	@param colorsVector Vertex colors, or empty for none
+	@param facesArray Triangle indices
+	@param completelyStatic The mesh will be created and then never modified.
+	*/
+	void build(const vector<vec3> &verticesArray,
+	           const vector<vec3> &normalsArray,
+	           const vector<vec2> &texcoordsArray,
+	           const vector<color> &colorsVector,
+	           const vector<Face> &facesArray,
+	           bool completelyStatic);
+	           
 	/**
 	Copies the object
 	@param obj The object to copy from
 	*/
 	void copy(const Mesh &obj);
 	
-	typedef function<float(const vec3 &)> RadiusCalculator;
-	
-	static float radiusCylindrical(const vec3 &vertex) {
-		return sqrtf(SQR(vertex.x) + SQR(vertex.y));
-	}
-	
-	static float radiusSpherical(const vec3 &vertex) {
-		return vertex.getMagnitude();
-	}
+	/** Bounds of the vertices */
+	BoundingVolume bounds;
 	
-	/** Calculates a radius for the mesh using the given calculator */
-	float calculateRadius(RadiusCalculator radiusFn) const;
-	
-	/** Creates a geometry object in ODE that uses this mesh's geometry */
-	static tuple<dGeomID,dTriMeshDataID> createGeom(dSpaceID physicsSpace,
-	  const dVector3 *verts,
-	  int numVertices,
-	  const int *indices,
-	  int numIndices);
-	  
 public:
 	Material material;
 	ResourceBufferVerticesPtr vertexArray;
@@ -155,6 +227,12 @@ public:
 	ResourceBufferColorsPtr colorsArray;
 	ResourceBufferIndicesPtr indexArray;
 	GLenum polygonWinding;
+	
+	/**
+	Ranges of the indices drawn with materials of their own, in order and
+	covering every index. If empty, the whole mesh is drawn with 'material'.
+	*/
+	vector<MaterialRange> materialRanges;
 };
 
 #endif
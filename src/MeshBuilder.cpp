@@ -0,0 +1,373 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "MeshBuilder.h"
+
+Mutex MeshBuilder::statisticsMutex;
+MeshBuilderStatistics MeshBuilder::statistics;
+
+MeshBuilderStatistics::MeshBuilderStatistics()
+		: meshes(0),
+		corners(0),
+		vertices(0),
+		missesBefore(0),
+		missesAfter(0) {}
+
+string MeshBuilderStatistics::toString() const {
+	const float triangles = max(corners / 3, (size_t)1);
+	
+	return sizet_to_string(meshes) + " meshes, " +
+	       sizet_to_string(corners) + " corners welded into " +
+	       sizet_to_string(vertices) + " vertices, ACMR " +
+	       ftos(missesBefore / triangles, 3) + " before and " +
+	       ftos(missesAfter / triangles, 3) + " after reordering";
+}
+
+MeshBuilder::MeshBuilder(const vector<vec3> &verticesArray,
+                         const vector<vec3> &normalsArray,
+                         const vector<vec2> &texcoordsArray,
+                         const vector<color> &colorsArray,
+                         const vector<Face> &facesArray,
+                         Welding welding)
+		: numCorners(facesArray.size()*3),
+		missesBefore(0) {
+	const bool hasColors = !colorsArray.empty();
+	
+	vector<IndexKey> indexKeys(numCorners);
+	
+	for (size_t i=0; i<facesArray.size(); ++i) {
+		const Face &face = facesArray[i];
+		
+		for (int j=0; j<3; ++j) {
+			ASSERT(face.vertIndex[j] >= 0   && (size_t)face.vertIndex[j] < verticesArray.size(),   "Invalid vertex index: " + itos(face.vertIndex[j]));
+			ASSERT(face.coordIndex[j] >= 0  && (size_t)face.coordIndex[j] < texcoordsArray.size(), "Invalid tex-coord index: " + itos(face.coordIndex[j]));
+			ASSERT(face.normalIndex[j] >= 0 && (size_t)face.normalIndex[j] < normalsArray.size(),  "Invalid normal index: " + itos(face.normalIndex[j]));
+			ASSERT(!hasColors || (size_t)face.vertIndex[j] < colorsArray.size(), "Invalid color index: " + itos(face.vertIndex[j]));
+			
+			IndexKey &key = indexKeys[i*3 + j];
+			key.vertIndex = face.vertIndex[j];
+			key.coordIndex = face.coordIndex[j];
+			key.normalIndex = face.normalIndex[j];
+		}
+	}
+	
+	vector<size_t> firstCorners;
+	
+	if (welding == WELD_VALUES) {
+		vector<ValueKey> valueKeys(numCorners);
+		
+		for (size_t i=0; i<numCorners; ++i) {
+			const IndexKey &index = indexKeys[i];
+			ValueKey &key = valueKeys[i];
+			key.vertex = verticesArray[index.vertIndex];
+			key.normal = normalsArray[index.normalIndex];
+			key.texcoord = texcoordsArray[index.coordIndex];
+			
+			if (hasColors) {
+				key.col = colorsArray[index.vertIndex];
+			}
+		}
+		
+		weld(valueKeys, firstCorners);
+	} else {
+		weld(indexKeys, firstCorners);
+	}
+	
+	// Take the attributes of each vertex from the first corner welded into it
+	const size_t numVertices = firstCorners.size();
+	vertices.resize(numVertices);
+	normals.resize(numVertices);
+	texcoords.resize(numVertices);
+	
+	if (hasColors) {
+		colors.resize(numVertices);
+	}
+	
+	for (size_t i=0; i<numVertices; ++i) {
+		const IndexKey &index = indexKeys[firstCorners[i]];
+		vertices[i] = verticesArray[index.vertIndex];
+		normals[i] = normalsArray[index.normalIndex];
+		texcoords[i] = texcoordsArray[index.coordIndex];
+		
+		if (hasColors) {
+			colors[i] = colorsArray[index.vertIndex];
+		}
+	}
+	
+	missesBefore = countCacheMisses(indices, numVertices);
+}
+
+template<typename KEY>
+void MeshBuilder::weld(const vector<KEY> &keys, vector<size_t> &firstCorners) {
+	// Open-addressing hash table holding vertex+1 in each used slot
+	size_t numSlots = 16;
+	
+	while (numSlots < keys.size()*2) {
+		numSlots <<= 1;
+	}
+	
+	const size_t mask = numSlots - 1;
+	vector<size_t> slots(numSlots, 0);
+	
+	indices.resize(keys.size());
+	firstCorners.clear();
+	
+	for (size_t corner=0; corner<keys.size(); ++corner) {
+		const KEY &key = keys[corner];
+		size_t i = hash(&key, sizeof(KEY)) & mask;
+		
+		while (slots[i] != 0 &&
+		       memcmp(&keys[firstCorners[slots[i]-1]], &key, sizeof(KEY)) != 0) {
+			i = (i+1) & mask;
+		}
+		
+		if (slots[i] == 0) {
+			firstCorners.push_back(corner);
+			slots[i] = firstCorners.size();
+		}
+		
+		indices[corner] = (index_t)(slots[i]-1);
+	}
+}
+
+size_t MeshBuilder::hash(const void *key, size_t size) {
+	// FNV-1a
+	const unsigned char *bytes = (const unsigned char*)key;
+	size_t h = 2166136261U;
+	
+	for (size_t i=0; i<size; ++i) {
+		h ^= bytes[i];
+		h *= 16777619U;
+	}
+	
+	return h;
+}
+
+/** Scores a vertex by its place in the cache and its remaining triangles */
+static float scoreVertex(int cachePosition, size_t numActiveTriangles) {
+	if (numActiveTriangles == 0) {
+		return -1.0f; // no triangle needs this vertex any longer
+	}
+	
+	float score = 0.0f;
+	
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			// Used by the last triangle, so it scores low to avoid repeating
+			// the same triangle strip shape
+			score = 0.75f;
+		} else {
+			const float scale = 1.0f / (MeshBuilder::CACHE_SIZE - 3);
+			score = powf(1.0f - (cachePosition - 3) * scale, 1.5f);
+		}
+	}
+	
+	// Favor vertices with few triangles left, so that they leave the cache
+	// for good instead of leaving lone triangles behind
+	score += 2.0f / sqrtf((float)numActiveTriangles);
+	
+	return score;
+}
+
+void MeshBuilder::optimize() {
+	const size_t numVertices = vertices.size();
+	const size_t numTriangles = indices.size() / 3;
+	
+	if (numTriangles == 0) {
+		return;
+	}
+	
+	// Triangles using each vertex, packed into one array
+	vector<size_t> firstTriangle(numVertices+1, 0);
+	
+	for (size_t i=0; i<indices.size(); ++i) {
+		firstTriangle[indices[i]+1]++;
+	}
+	
+	for (size_t v=0; v<numVertices; ++v) {
+		firstTriangle[v+1] += firstTriangle[v];
+	}
+	
+	vector<size_t> numActive(numVertices, 0);
+	vector<size_t> vertexTriangles(indices.size());
+	
+	for (size_t i=0; i<indices.size(); ++i) {
+		const index_t v = indices[i];
+		vertexTriangles[firstTriangle[v] + numActive[v]++] = i/3;
+	}
+	
+	vector<int> cachePosition(numVertices, -1);
+	vector<float> vertexScore(numVertices);
+	
+	for (size_t v=0; v<numVertices; ++v) {
+		vertexScore[v] = scoreVertex(-1, numActive[v]);
+	}
+	
+	vector<float> triangleScore(numTriangles);
+	vector<bool> added(numTriangles, false);
+	
+	for (size_t t=0; t<numTriangles; ++t) {
+		triangleScore[t] = vertexScore[indices[t*3+0]]
+		                   + vertexScore[indices[t*3+1]]
+		                   + vertexScore[indices[t*3+2]];
+	}
+	
+	vector<index_t> cache, nextCache;
+	vector<index_t> reordered;
+	reordered.reserve(indices.size());
+	
+	size_t best = 0;
+	bool haveBest = false;
+	size_t scan = 0; // triangles before this have all been added
+	
+	while (reordered.size() < indices.size()) {
+		if (!haveBest) {
+			// Nothing in the cache has triangles left, so move on to the next
+			// triangle not yet added. Searching every triangle for the best
+			// instead would be quadratic in meshes with many separate parts.
+			while (added[scan]) {
+				++scan;
+			}
+			
+			best = scan;
+		}
+		
+		added[best] = true;
+		
+		// Emit the triangle and put its vertices at the front of the cache
+		nextCache.clear();
+		
+		for (int j=0; j<3; ++j) {
+			const index_t v = indices[best*3+j];
+			reordered.push_back(v);
+			
+			if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+				nextCache.push_back(v); // degenerate triangles repeat vertices
+			}
+			
+			// Remove the triangle from the vertex's list of active triangles
+			size_t *begin = &vertexTriangles[firstTriangle[v]];
+			size_t *end = begin + numActive[v];
+			*std::find(begin, end, best) = *(end-1);
+			numActive[v]--;
+		}
+		
+		const size_t numFront = nextCache.size();
+		
+		for (vector<index_t>::const_iterator i=cache.begin();
+		     i!=cache.end(); ++i) {
+			const vector<index_t>::iterator front = nextCache.begin() + numFront;
+			
+			if (std::find(nextCache.begin(), front, *i) == front) {
+				nextCache.push_back(*i);
+			}
+		}
+		
+		// Vertices pushed out of the cache lose their cache score
+		for (size_t i=CACHE_SIZE; i<nextCache.size(); ++i) {
+			cachePosition[nextCache[i]] = -1;
+			vertexScore[nextCache[i]] = scoreVertex(-1, numActive[nextCache[i]]);
+		}
+		
+		if (nextCache.size() > CACHE_SIZE) {
+			nextCache.resize(CACHE_SIZE);
+		}
+		
+		for (size_t i=0; i<nextCache.size(); ++i) {
+			cachePosition[nextCache[i]] = (int)i;
+			vertexScore[nextCache[i]] = scoreVertex((int)i, numActive[nextCache[i]]);
+		}
+		
+		cache.swap(nextCache);
+		
+		// Rescore the triangles of cached vertices and pick the best of them
+		haveBest = false;
+		float bestScore = -1.0f;
+		
+		for (vector<index_t>::const_iterator i=cache.begin();
+		     i!=cache.end(); ++i) {
+			const size_t *begin = &vertexTriangles[firstTriangle[*i]];
+			
+			for (size_t k=0; k<numActive[*i]; ++k) {
+				const size_t t = begin[k];
+				
+				triangleScore[t] = vertexScore[indices[t*3+0]]
+				                   + vertexScore[indices[t*3+1]]
+				                   + vertexScore[indices[t*3+2]];
+				
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					best = t;
+					haveBest = true;
+				}
+			}
+		}
+	}
+	
+	// Renumber the vertices in the order in which they are first used
+	vector<index_t> remap(numVertices, (index_t)-1);
+	vector<vec3> newVertices(numVertices);
+	vector<vec3> newNormals(numVertices);
+	vector<vec2> newTexcoords(numVertices);
+	vector<color> newColors(colors.size());
+	index_t next = 0;
+	
+	for (size_t i=0; i<reordered.size(); ++i) {
+		const index_t v = reordered[i];
+		
+		if (remap[v] == (index_t)-1) {
+			remap[v] = next;
+			newVertices[next] = vertices[v];
+			newNormals[next] = normals[v];
+			newTexcoords[next] = texcoords[v];
+			
+			if (!colors.empty()) {
+				newColors[next] = colors[v];
+			}
+			
+			++next;
+		}
+		
+		reordered[i] = remap[v];
+	}
+	
+	indices.swap(reordered);
+	vertices.swap(newVertices);
+	normals.swap(newNormals);
+	texcoords.swap(newTexcoords);
+	colors.swap(newColors);
+}
+
+size_t MeshBuilder::countCacheMisses(const vector<index_t> &indices,
+                                     size_t numVertices) {
+	// A vertex is in the FIFO while fewer than CACHE_SIZE others have been
+	// pushed after it
+	const size_t never = (size_t)-1;
+	vector<size_t> pushedAt(numVertices, never);
+	size_t misses = 0;
+	
+	for (size_t i=0; i<indices.size(); ++i) {
+		const index_t v = indices[i];
+		
+		if (pushedAt[v] == never || misses - pushedAt[v] >= CACHE_SIZE) {
+			pushedAt[v] = misses++;
+		}
+	}
+	
+	return misses;
+}
+
+void MeshBuilder::count() const {
+	const size_t missesAfter = countCacheMisses(indices, vertices.size());
+	
+	MutexLock lock(statisticsMutex);
+	statistics.meshes++;
+	statistics.corners += numCorners;
+	statistics.vertices += vertices.size();
+	statistics.missesBefore += missesBefore;
+	statistics.missesAfter += missesAfter;
+}
+
+MeshBuilderStatistics MeshBuilder::getStatistics() {
+	MutexLock lock(statisticsMutex);
+	return statistics;
+}
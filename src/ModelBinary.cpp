@@ -0,0 +1,635 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "FileMapping.h"
+#include "VirtualFileSystem.h"
+#include "ModelBinary.h"
+
+/**
+Gets a buffer created from an array of a cooked model, creating it the
+first time the array is asked for
+@param buffers Buffers created so far, by offset
+@param data Data of the cooked model
+@param offset Offset of the array within the data
+@param count Number of elements in the array
+@param packing Format in which the buffer is held on the GPU
+@return Buffer holding the array
+*/
+template<typename ELEMENT>
+static shared_ptr< ResourceBuffer<ELEMENT> >
+getSharedBuffer(map<U32, shared_ptr< ResourceBuffer<ELEMENT> > > &buffers,
+                const U8 *data,
+                U32 offset,
+                U32 count,
+                VERTEX_PACKING packing) {
+	shared_ptr< ResourceBuffer<ELEMENT> > &buffer = buffers[offset];
+	
+	if (!buffer) {
+		buffer = shared_ptr< ResourceBuffer<ELEMENT> >(new ResourceBuffer<ELEMENT>());
+		buffer->setPacking(packing);
+		buffer->recreate((int)count,
+		                 reinterpret_cast<const ELEMENT*>(data + offset),
+		                 STATIC_DRAW);
+	}
+	
+	return buffer;
+}
+
+FileName ModelBinary::getCookedFileName(const FileName &fileName) {
+	return FileName(FileName::stripExtension(fileName.str()) + ".model");
+}
+
+bool ModelBinary::isCookedFileUsable(const FileName &fileName) {
+	const FileName cookedFileName = getCookedFileName(fileName);
+	
+	if (!VirtualFileSystem::exists(cookedFileName)) {
+		return false;
+	}
+	
+#ifndef NDEBUG
+	// Models are made of several files, which are kept in one directory.
+	// An edit to any of them takes precedence over a stale cooked file.
+	if (isFileOnDisk(fileName)) {
+		const time_t cooked = getFileModificationTime(cookedFileName);
+		const FileName directory = fileName.getPath();
+		
+		vector<string> files;
+		listFilesOnDisk(directory, files);
+		
+		for (vector<string>::const_iterator i=files.begin(); i!=files.end(); ++i) {
+			const FileName file = directory.append(FileName(*i));
+			
+			if (file != cookedFileName &&
+			    cooked < getFileModificationTime(file)) {
+				return false;
+			}
+		}
+	}
+#endif
+	
+	return true;
+}
+
+U32 ModelBinary::addData(Tables &tables, const void *data, size_t size) {
+	const string bytes(static_cast<const char*>(data), size);
+	
+	map<string, U32>::const_iterator found = tables.dataOffsets.find(bytes);
+	
+	if (found != tables.dataOffsets.end()) {
+		return found->second;
+	}
+	
+	const U32 offset = (U32)tables.data.size();
+	tables.data.append(bytes);
+	
+	// Pad so that the next array starts on a boundary too
+	const size_t padded = (tables.data.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	tables.data.resize(padded, 0);
+	
+	tables.dataOffsets.insert(make_pair(bytes, offset));
+	return offset;
+}
+
+U32 ModelBinary::addString(Tables &tables, const string &str) {
+	return addData(tables, str.c_str(), str.length() + 1);
+}
+
+U32 ModelBinary::addMaterial(Tables &tables, const Material &material) {
+	MaterialRecord record;
+	memset(&record, 0, sizeof(record));
+	
+	record.texture = material.texture ? addString(tables, material.getFileName().str())
+	                 : NONE;
+	record.glow = material.glow ? 1 : 0;
+	record.shininess = material.shininess;
+	
+	for (size_t i=0; i<4; ++i) {
+		record.ambient[i] = material.Ka[i];
+		record.diffuse[i] = material.Kd[i];
+		record.specular[i] = material.Ks[i];
+	}
+	
+	// Every key frame usually has a copy of the same few materials
+	for (size_t i=0; i<tables.materials.size(); ++i) {
+		if (memcmp(&tables.materials[i], &record, sizeof(record)) == 0) {
+			return (U32)i;
+		}
+	}
+	
+	tables.materials.push_back(record);
+	return (U32)(tables.materials.size() - 1);
+}
+
+template<typename ELEMENT>
+bool ModelBinary::addBuffer(Tables &tables,
+                            ResourceBuffer<ELEMENT> &buffer,
+                            int count,
+                            U32 &offset) {
+	offset = NONE;
+	
+	if (buffer.getNumber() == 0) {
+		return true;
+	}
+	
+	if (buffer.getNumber() != count || !buffer.hasClientCopy()) {
+		return false;
+	}
+	
+	const void *elements = buffer.read_lock();
+	offset = addData(tables, elements, sizeof(ELEMENT) * count);
+	buffer.unlock();
+	
+	return true;
+}
+
+BoundingVolume ModelBinary::getBounds(const MeshRecord &record) {
+	return BoundingVolume(vec3(record.minimum[0], record.minimum[1], record.minimum[2]),
+	                      vec3(record.maximum[0], record.maximum[1], record.maximum[2]),
+	                      vec3(record.sphereCenter[0], record.sphereCenter[1], record.sphereCenter[2]),
+	                      record.sphereRadius,
+	                      record.radius,
+	                      record.cylindricalRadius);
+}
+
+U32 ModelBinary::addMesh(Tables &tables, const Mesh &mesh) {
+	map<const Mesh*, U32>::const_iterator found = tables.meshIndices.find(&mesh);
+	
+	if (found != tables.meshIndices.end()) {
+		return found->second;
+	}
+	
+	MeshRecord record;
+	record.material = addMaterial(tables, mesh.material);
+	record.polygonWinding = mesh.polygonWinding;
+	record.numVertices = (U32)mesh.vertexArray->getNumber();
+	record.numIndices = (U32)mesh.indexArray->getNumber();
+	
+	const int numVertices = mesh.vertexArray->getNumber();
+	
+	bool ok = numVertices > 0 && record.numIndices > 0;
+	ok = ok && addBuffer(tables, *mesh.vertexArray, numVertices, record.vertices);
+	ok = ok && addBuffer(tables, *mesh.normalArray, numVertices, record.normals);
+	ok = ok && record.normals != NONE;
+	ok = ok && addBuffer(tables, *mesh.texCoordArray, numVertices, record.texCoords);
+	ok = ok && addBuffer(tables, *mesh.colorsArray, numVertices, record.colors);
+	ok = ok && addBuffer(tables, *mesh.indexArray, (int)record.numIndices, record.indices);
+	
+	if (!ok) {
+		return NONE;
+	}
+	
+	record.firstRange = (U32)tables.ranges.size();
+	record.numRanges = (U32)mesh.materialRanges.size();
+	
+	const BoundingVolume &bounds = mesh.getBounds();
+	
+	for (int i=0; i<3; ++i) {
+		record.minimum[i] = bounds.getMinimum()[i];
+		record.maximum[i] = bounds.getMaximum()[i];
+		record.sphereCenter[i] = bounds.getSphereCenter()[i];
+	}
+	
+	record.sphereRadius = bounds.getSphereRadius();
+	record.radius = bounds.getRadius();
+	record.cylindricalRadius = bounds.getCylindricalRadius();
+	
+	for (vector<Mesh::MaterialRange>::const_iterator i=mesh.materialRanges.begin();
+	     i!=mesh.materialRanges.end(); ++i) {
+		RangeRecord range;
+		range.material = addMaterial(tables, i->material);
+		range.firstIndex = (U32)i->firstIndex;
+		range.numIndices = (U32)i->numIndices;
+		tables.ranges.push_back(range);
+	}
+	
+	const U32 index = (U32)tables.meshes.size();
+	tables.meshes.push_back(record);
+	tables.meshIndices.insert(make_pair(&mesh, index));
+	return index;
+}
+
+U32 ModelBinary::addKeyFrame(Tables &tables, const KeyFrame &keyFrame) {
+	const MeshSet &meshes = keyFrame.getMeshes();
+	
+	vector<U32> indices;
+	
+	for (MeshSet::const_iterator i=meshes.begin(); i!=meshes.end(); ++i) {
+		const U32 index = addMesh(tables, **i);
+		
+		if (index == NONE) {
+			return NONE;
+		}
+		
+		indices.push_back(index);
+	}
+	
+	// Copies of a key frame, such as those held by overlapping animations,
+	// are written once
+	map<vector<U32>, U32>::const_iterator found = tables.keyFrameIndices.find(indices);
+	
+	if (found != tables.keyFrameIndices.end()) {
+		return found->second;
+	}
+	
+	KeyFrameRecord record;
+	record.firstMesh = (U32)tables.meshRefs.size();
+	record.numMeshes = (U32)indices.size();
+	tables.meshRefs.insert(tables.meshRefs.end(), indices.begin(), indices.end());
+	
+	const U32 index = (U32)tables.keyFrames.size();
+	tables.keyFrames.push_back(record);
+	tables.keyFrameIndices.insert(make_pair(indices, index));
+	return index;
+}
+
+/** Writes a table to a file, unless the table is empty */
+template<typename T>
+static bool writeTable(FILE *stream, const vector<T> &table) {
+	return table.empty() ||
+	       fwrite(&table[0], sizeof(T), table.size(), stream) == table.size();
+}
+
+bool ModelBinary::saveToFile(const AnimationController &model,
+                             const FileName &fileName) {
+	Tables tables;
+	
+	for (size_t i=0; i<model.getNumAnimations(); ++i) {
+		const AnimationSequence &animation = model.getAnimation(i);
+		const vector<KeyFrame> &keyFrames = animation.getKeyFrames();
+		
+		AnimationRecord record;
+		record.name = addString(tables, animation.getName());
+		record.looping = animation.isLooping() ? 1 : 0;
+		record.priority = animation.getPriority();
+		record.fps = animation.getFPS();
+		record.firstKeyFrame = (U32)tables.keyFrameRefs.size();
+		record.numKeyFrames = (U32)keyFrames.size();
+		
+		for (vector<KeyFrame>::const_iterator j=keyFrames.begin(); j!=keyFrames.end(); ++j) {
+			const U32 keyFrame = addKeyFrame(tables, *j);
+			
+			if (keyFrame == NONE) {
+				TRACE("Model cannot be cooked, its meshes are incomplete: "
+				      + fileName.str());
+				return false;
+			}
+			
+			tables.keyFrameRefs.push_back(keyFrame);
+		}
+		
+		tables.animations.push_back(record);
+	}
+	
+	const size_t tablesSize = sizeof(Header)
+	                          + tables.materials.size() * sizeof(MaterialRecord)
+	                          + tables.meshes.size() * sizeof(MeshRecord)
+	                          + tables.keyFrames.size() * sizeof(KeyFrameRecord)
+	                          + tables.meshRefs.size() * sizeof(U32)
+	                          + tables.animations.size() * sizeof(AnimationRecord)
+	                          + tables.keyFrameRefs.size() * sizeof(U32)
+	                          + tables.ranges.size() * sizeof(RangeRecord);
+	const size_t dataOffset = (tablesSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	
+	Header header;
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.numMaterials = (U32)tables.materials.size();
+	header.numMeshes = (U32)tables.meshes.size();
+	header.numKeyFrames = (U32)tables.keyFrames.size();
+	header.numMeshRefs = (U32)tables.meshRefs.size();
+	header.numAnimations = (U32)tables.animations.size();
+	header.numKeyFrameRefs = (U32)tables.keyFrameRefs.size();
+	header.numRanges = (U32)tables.ranges.size();
+	header.dataOffset = (U32)dataOffset;
+	header.dataSize = (U32)tables.data.size();
+	
+	FILE *stream = fopen(fileName.c_str(), "wb");
+	
+	if (!stream) {
+		TRACE("Failed to open file for writing: " + fileName.str());
+		return false;
+	}
+	
+	const string padding(dataOffset - tablesSize, 0);
+	
+	bool ok = fwrite(&header, sizeof(header), 1, stream) == 1;
+	ok = ok && writeTable(stream, tables.materials);
+	ok = ok && writeTable(stream, tables.meshes);
+	ok = ok && writeTable(stream, tables.keyFrames);
+	ok = ok && writeTable(stream, tables.meshRefs);
+	ok = ok && writeTable(stream, tables.animations);
+	ok = ok && writeTable(stream, tables.keyFrameRefs);
+	ok = ok && writeTable(stream, tables.ranges);
+	ok = ok && fwrite(padding.data(), 1, padding.size(), stream) == padding.size();
+	ok = ok && fwrite(tables.data.data(), 1, tables.data.size(), stream) == tables.data.size();
+	ok = (fclose(stream) == 0) && ok;
+	
+	if (!ok) {
+		ERR("Failed to write file: " + fileName.str());
+		remove(fileName.c_str());
+	}
+	
+	return ok;
+}
+
+bool ModelBinary::isArrayValid(const Header &header,
+                               U32 offset,
+                               U32 count,
+                               size_t elementSize) {
+	return offset % ALIGNMENT == 0 &&
+	       offset <= header.dataSize &&
+	       count <= (header.dataSize - offset) / elementSize;
+}
+
+bool ModelBinary::isStringValid(const Document &document, U32 offset) {
+	const U32 dataSize = document.header->dataSize;
+	
+	return offset < dataSize &&
+	       memchr(document.data + offset, 0, dataSize - offset) != 0;
+}
+
+bool ModelBinary::validate(const U8 *buffer, size_t size, Document &document) {
+	if (size < sizeof(Header)) {
+		return false;
+	}
+	
+	document.header = reinterpret_cast<const Header*>(buffer);
+	
+	const Header &header = *document.header;
+	
+	if (header.magic != MAGIC || header.version != VERSION) {
+		ERR("Cooked model has an unsupported format");
+		return false;
+	}
+	
+	// Each count is bounded by the file size, so the sums cannot overflow
+	if (header.numMaterials > size / sizeof(MaterialRecord) ||
+	    header.numMeshes > size / sizeof(MeshRecord) ||
+	    header.numKeyFrames > size / sizeof(KeyFrameRecord) ||
+	    header.numMeshRefs > size / sizeof(U32) ||
+	    header.numAnimations > size / sizeof(AnimationRecord) ||
+	    header.numKeyFrameRefs > size / sizeof(U32) ||
+	    header.numRanges > size / sizeof(RangeRecord) ||
+	    header.numAnimations == 0) {
+		return false;
+	}
+	
+	const size_t materialsOffset = sizeof(Header);
+	const size_t meshesOffset = materialsOffset + header.numMaterials * sizeof(MaterialRecord);
+	const size_t keyFramesOffset = meshesOffset + header.numMeshes * sizeof(MeshRecord);
+	const size_t meshRefsOffset = keyFramesOffset + header.numKeyFrames * sizeof(KeyFrameRecord);
+	const size_t animationsOffset = meshRefsOffset + header.numMeshRefs * sizeof(U32);
+	const size_t keyFrameRefsOffset = animationsOffset + header.numAnimations * sizeof(AnimationRecord);
+	const size_t rangesOffset = keyFrameRefsOffset + header.numKeyFrameRefs * sizeof(U32);
+	const size_t tablesEnd = rangesOffset + header.numRanges * sizeof(RangeRecord);
+	
+	if (tablesEnd > header.dataOffset ||
+	    header.dataOffset % ALIGNMENT != 0 ||
+	    header.dataOffset > size ||
+	    header.dataSize != size - header.dataOffset) {
+		return false;
+	}
+	
+	document.materials = reinterpret_cast<const MaterialRecord*>(buffer + materialsOffset);
+	document.meshes = reinterpret_cast<const MeshRecord*>(buffer + meshesOffset);
+	document.keyFrames = reinterpret_cast<const KeyFrameRecord*>(buffer + keyFramesOffset);
+	document.meshRefs = reinterpret_cast<const U32*>(buffer + meshRefsOffset);
+	document.animations = reinterpret_cast<const AnimationRecord*>(buffer + animationsOffset);
+	document.keyFrameRefs = reinterpret_cast<const U32*>(buffer + keyFrameRefsOffset);
+	document.ranges = reinterpret_cast<const RangeRecord*>(buffer + rangesOffset);
+	document.data = buffer + header.dataOffset;
+	
+	for (U32 i=0; i<header.numMaterials; ++i) {
+		const MaterialRecord &material = document.materials[i];
+		
+		if (material.texture != NONE && !isStringValid(document, material.texture)) {
+			return false;
+		}
+	}
+	
+	for (U32 i=0; i<header.numMeshes; ++i) {
+		const MeshRecord &mesh = document.meshes[i];
+		
+		if (mesh.material >= header.numMaterials ||
+		    mesh.numVertices == 0 ||
+		    mesh.numIndices == 0 ||
+		    !isArrayValid(header, mesh.vertices, mesh.numVertices, sizeof(vec3)) ||
+		    !isArrayValid(header, mesh.normals, mesh.numVertices, sizeof(vec3)) ||
+		    !isArrayValid(header, mesh.indices, mesh.numIndices, sizeof(index_t))) {
+			return false;
+		}
+		
+		if ((mesh.texCoords != NONE &&
+		     !isArrayValid(header, mesh.texCoords, mesh.numVertices, sizeof(vec2))) ||
+		    (mesh.colors != NONE &&
+		     !isArrayValid(header, mesh.colors, mesh.numVertices, sizeof(color)))) {
+			return false;
+		}
+		
+		// Indices are trusted by the GPU, so they must not reach past the end
+		const index_t *indices = reinterpret_cast<const index_t*>(document.data + mesh.indices);
+		
+		for (U32 j=0; j<mesh.numIndices; ++j) {
+			if (indices[j] >= mesh.numVertices) {
+				return false;
+			}
+		}
+		
+		if (mesh.firstRange > header.numRanges ||
+		    mesh.numRanges > header.numRanges - mesh.firstRange) {
+			return false;
+		}
+		
+		for (U32 j=0; j<mesh.numRanges; ++j) {
+			const RangeRecord &range = document.ranges[mesh.firstRange + j];
+			
+			if (range.material >= header.numMaterials ||
+			    range.firstIndex > mesh.numIndices ||
+			    range.numIndices > mesh.numIndices - range.firstIndex) {
+				return false;
+			}
+		}
+		
+		const BoundingVolume bounds = getBounds(mesh);
+		
+		if (!bounds.isValid()) {
+			return false;
+		}
+		
+#ifndef NDEBUG
+		// Culling trusts the stored bounds, so development builds check that
+		// they enclose every vertex
+		const vec3 *vertices = reinterpret_cast<const vec3*>(document.data + mesh.vertices);
+		
+		for (U32 j=0; j<mesh.numVertices; ++j) {
+			if (!bounds.encloses(vertices[j])) {
+				return false;
+			}
+		}
+#endif
+	}
+	
+	for (U32 i=0; i<header.numKeyFrames; ++i) {
+		const KeyFrameRecord &keyFrame = document.keyFrames[i];
+		
+		if (keyFrame.firstMesh > header.numMeshRefs ||
+		    keyFrame.numMeshes > header.numMeshRefs - keyFrame.firstMesh) {
+			return false;
+		}
+	}
+	
+	for (U32 i=0; i<header.numMeshRefs; ++i) {
+		if (document.meshRefs[i] >= header.numMeshes) {
+			return false;
+		}
+	}
+	
+	for (U32 i=0; i<header.numAnimations; ++i) {
+		const AnimationRecord &animation = document.animations[i];
+		
+		if (!isStringValid(document, animation.name) ||
+		    animation.numKeyFrames == 0 ||
+		    animation.firstKeyFrame > header.numKeyFrameRefs ||
+		    animation.numKeyFrames > header.numKeyFrameRefs - animation.firstKeyFrame) {
+			return false;
+		}
+	}
+	
+	for (U32 i=0; i<header.numKeyFrameRefs; ++i) {
+		if (document.keyFrameRefs[i] >= header.numKeyFrames) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+AnimationController* ModelBinary::loadFromFile(const FileName &fileName,
+                                               TextureFactory &textureFactory) {
+	const FileMapping file(fileName);
+	
+	if (!file.isOpen()) {
+		ERR("Failed to open file: " + fileName.str());
+		return 0;
+	}
+	
+	Document document;
+	
+	if (!validate(file.getData(), file.getSize(), document)) {
+		ERR("Failed to read cooked model: " + fileName.str());
+		return 0;
+	}
+	
+	const Header &header = *document.header;
+	const U8 *data = document.data;
+	
+	vector<Material> materials(header.numMaterials);
+	
+	for (U32 i=0; i<header.numMaterials; ++i) {
+		const MaterialRecord &record = document.materials[i];
+		Material &material = materials[i];
+		
+		if (record.texture != NONE) {
+			const char *texture = reinterpret_cast<const char*>(data + record.texture);
+			material.setTexture(textureFactory.load(FileName(texture)));
+		}
+		
+		material.glow = record.glow != 0;
+		material.Ka = color(record.ambient[0], record.ambient[1], record.ambient[2], record.ambient[3]);
+		material.Kd = color(record.diffuse[0], record.diffuse[1], record.diffuse[2], record.diffuse[3]);
+		material.Ks = color(record.specular[0], record.specular[1], record.specular[2], record.specular[3]);
+		material.shininess = record.shininess;
+	}
+	
+	// Buffers that do not change while the model is animated are shared by
+	// the meshes whose arrays are identical
+	map<U32, ResourceBufferTexCoordsPtr> texCoordBuffers;
+	map<U32, ResourceBufferColorsPtr> colorBuffers;
+	map<U32, ResourceBufferIndicesPtr> indexBuffers;
+	
+	vector< shared_ptr<Mesh> > meshes(header.numMeshes);
+	
+	for (U32 i=0; i<header.numMeshes; ++i) {
+		const MeshRecord &record = document.meshes[i];
+		shared_ptr<Mesh> mesh(new Mesh());
+		
+		mesh->material = materials[record.material];
+		mesh->polygonWinding = (GLenum)record.polygonWinding;
+		mesh->pack();
+		
+		// Usage hints are those that Mesh::build gives animated meshes
+		mesh->vertexArray->recreate((int)record.numVertices,
+		                            reinterpret_cast<const vec3*>(data + record.vertices),
+		                            DYNAMIC_DRAW);
+		
+		mesh->normalArray->recreate((int)record.numVertices,
+		                            reinterpret_cast<const vec3*>(data + record.normals),
+		                            DYNAMIC_DRAW);
+		
+		if (record.texCoords != NONE) {
+			mesh->texCoordArray = getSharedBuffer(texCoordBuffers,
+			                                      data,
+			                                      record.texCoords,
+			                                      record.numVertices,
+			                                      PACK_TEXCOORDS);
+		}
+		
+		if (record.colors != NONE) {
+			mesh->colorsArray = getSharedBuffer(colorBuffers,
+			                                    data,
+			                                    record.colors,
+			                                    record.numVertices,
+			                                    PACK_COLORS);
+		}
+		
+		mesh->indexArray = getSharedBuffer(indexBuffers,
+		                                   data,
+		                                   record.indices,
+		                                   record.numIndices,
+		                                   PACK_NONE);
+		
+		for (U32 j=0; j<record.numRanges; ++j) {
+			const RangeRecord &range = document.ranges[record.firstRange + j];
+			mesh->materialRanges.push_back(Mesh::MaterialRange(materials[range.material],
+			                                                   (int)range.firstIndex,
+			                                                   (int)range.numIndices));
+		}
+		
+		mesh->setBounds(getBounds(record));
+		
+		meshes[i] = mesh;
+	}
+	
+	vector<KeyFrame> keyFrames;
+	keyFrames.reserve(header.numKeyFrames);
+	
+	for (U32 i=0; i<header.numKeyFrames; ++i) {
+		const KeyFrameRecord &record = document.keyFrames[i];
+		MeshSet keyFrameMeshes;
+		
+		for (U32 j=0; j<record.numMeshes; ++j) {
+			keyFrameMeshes.push_back(meshes[document.meshRefs[record.firstMesh + j]]);
+		}
+		
+		keyFrames.push_back(KeyFrame(keyFrameMeshes));
+	}
+	
+	AnimationController *controller = new AnimationController();
+	
+	for (U32 i=0; i<header.numAnimations; ++i) {
+		const AnimationRecord &record = document.animations[i];
+		vector<KeyFrame> animationKeyFrames;
+		
+		for (U32 j=0; j<record.numKeyFrames; ++j) {
+			animationKeyFrames.push_back(keyFrames[document.keyFrameRefs[record.firstKeyFrame + j]]);
+		}
+		
+		AnimationSequence sequence(animationKeyFrames,
+		                           reinterpret_cast<const char*>(data + record.name),
+		                           record.priority,
+		                           record.looping != 0,
+		                           record.fps);
+		controller->addAnimation(sequence);
+	}
+	
+	return controller;
+}
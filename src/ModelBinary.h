@@ -0,0 +1,265 @@
+#ifndef _MODEL_BINARY_H_
+#define _MODEL_BINARY_H_
+
+#include "AnimationController.h"
+
+/**
+Compiled ("cooked") binary form of an animated model.
+
+A cooked model holds the meshes of every key frame already welded, ordered
+and decoded, exactly as meshes hold them on the client-side: vertices, normals,
+tex-coords, colors and indices are arrays of the engine's own types, each
+starting on a 16-byte boundary. Small tables of materials, meshes, key
+frames and animations refer to those arrays by offset, and a mesh made of
+several surfaces lists the range of its indices drawn with each material.
+Each mesh also carries the bounds computed when it was built, so that
+loading does not scan the vertices for them.
+Loading maps the file and creates each buffer straight from the mapping,
+without parsing, decoding or welding anything. Arrays that are identical in several meshes,
+such as the indices and tex-coords that every key frame of an MD3 surface
+has in common, are stored once and share one buffer once loaded.
+
+The cooked file sits alongside the model's descriptor (e.g. "hero.md3xml"
+cooks to "hero.model") and is written by the Cooker tool, whatever the
+format of the source files; the game only ever reads it. Development builds
+ignore a cooked model that is older than any other file in the model's
+directory.
+*/
+class ModelBinary {
+public:
+	/**
+	Gets the name of the cooked file for a model
+	@param fileName Name of the model's descriptor
+	@return Name of the cooked file
+	*/
+	static FileName getCookedFileName(const FileName &fileName);
+	
+	/**
+	Determines whether there is a cooked file that should be used in place
+	of the model's source files
+	@param fileName Name of the model's descriptor
+	@return true if the cooked file should be loaded instead
+	*/
+	static bool isCookedFileUsable(const FileName &fileName);
+	
+	/**
+	Writes a model to a cooked file. The key frames must still have their
+	copies on the client-side.
+	@param model Model to write
+	@param fileName Name of the cooked file
+	@return true if successful
+	*/
+	static bool saveToFile(const AnimationController &model,
+	                       const FileName &fileName);
+	
+	/**
+	Reads a cooked file
+	@param fileName Name of the cooked file
+	@param textureFactory Loads the textures of the model's materials
+	@return New model, or null if the file could not be read
+	*/
+	static AnimationController* loadFromFile(const FileName &fileName,
+	                                         TextureFactory &textureFactory);
+	
+private:
+	/** Identifies a cooked model file */
+	static const U32 MAGIC = 0x4C444F4D; // "MODL"
+	
+	/** Incremented whenever the layout of the file changes */
+	static const U32 VERSION = 3;
+	
+	/** Marks an absent array or string */
+	static const U32 NONE = 0xFFFFFFFF;
+	
+	/** Arrays start at multiples of this many bytes */
+	static const U32 ALIGNMENT = 16;
+	
+	struct Header {
+		U32 magic;
+		U32 version;
+		U32 numMaterials;
+		U32 numMeshes;
+		U32 numKeyFrames;
+		U32 numMeshRefs;
+		U32 numAnimations;
+		U32 numKeyFrameRefs;
+		U32 numRanges;
+		
+		/** Start of the arrays, relative to the start of the file */
+		U32 dataOffset;
+		
+		/** Size of the arrays, in bytes */
+		U32 dataSize;
+	};
+	
+	struct MaterialRecord {
+		/** Offset of the texture's file name, or NONE for no texture */
+		U32 texture;
+		
+		U32 glow;
+		F32 ambient[4];
+		F32 diffuse[4];
+		F32 specular[4];
+		F32 shininess;
+	};
+	
+	struct MeshRecord {
+		/** Index of the material */
+		U32 material;
+		
+		/** GL_CW or GL_CCW */
+		U32 polygonWinding;
+		
+		U32 numVertices;
+		U32 numIndices;
+		
+		/**
+		Offsets of the arrays within the data. Tex-coords and colors may be
+		NONE; every mesh has normals, as the lighting needs them.
+		*/
+		U32 vertices, normals, texCoords, colors, indices;
+		
+		/** First of the mesh's material ranges in the table of ranges */
+		U32 firstRange;
+		
+		/** Number of material ranges, or zero to draw the whole mesh */
+		U32 numRanges;
+		
+		/** Bounds of the vertices (see BoundingVolume) */
+		F32 minimum[3];
+		F32 maximum[3];
+		F32 sphereCenter[3];
+		F32 sphereRadius;
+		F32 radius;
+		F32 cylindricalRadius;
+	};
+	
+	struct RangeRecord {
+		/** Index of the material */
+		U32 material;
+		
+		U32 firstIndex;
+		U32 numIndices;
+	};
+	
+	struct KeyFrameRecord {
+		/** First of the key frame's entries in the table of mesh indices */
+		U32 firstMesh;
+		
+		U32 numMeshes;
+	};
+	
+	struct AnimationRecord {
+		/** Offset of the name within the data */
+		U32 name;
+		
+		U32 looping;
+		F32 priority;
+		F32 fps;
+		
+		/** First of the animation's entries in the table of key frames */
+		U32 firstKeyFrame;
+		
+		U32 numKeyFrames;
+	};
+	
+	/** Tables of a cooked model, built up before being written out */
+	struct Tables {
+		vector<MaterialRecord> materials;
+		vector<MeshRecord> meshes;
+		vector<KeyFrameRecord> keyFrames;
+		vector<U32> meshRefs;
+		vector<AnimationRecord> animations;
+		vector<U32> keyFrameRefs;
+		vector<RangeRecord> ranges;
+		
+		/** Arrays and strings */
+		string data;
+		
+		/** Offset of each distinct array or string within the data */
+		map<string, U32> dataOffsets;
+		
+		/** Index of each mesh written so far */
+		map<const Mesh*, U32> meshIndices;
+		
+		/** Index of each key frame written so far, by its meshes */
+		map<vector<U32>, U32> keyFrameIndices;
+	};
+	
+	/** Cooked file that has been validated and may be read */
+	struct Document {
+		const Header *header;
+		const MaterialRecord *materials;
+		const MeshRecord *meshes;
+		const KeyFrameRecord *keyFrames;
+		const U32 *meshRefs;
+		const AnimationRecord *animations;
+		const U32 *keyFrameRefs;
+		const RangeRecord *ranges;
+		const U8 *data;
+	};
+	
+	/**
+	Adds an array or a string to the data, unless an identical one is
+	already there
+	@return Offset within the data
+	*/
+	static U32 addData(Tables &tables, const void *data, size_t size);
+	
+	/** Adds a NUL-terminated string to the data */
+	static U32 addString(Tables &tables, const string &str);
+	
+	/** Adds a material, unless an identical one is already there */
+	static U32 addMaterial(Tables &tables, const Material &material);
+	
+	/**
+	Adds the contents of a buffer to the data
+	@param tables Tables of the cooked model
+	@param buffer Buffer to add
+	@param count Number of elements that the buffer must hold, unless empty
+	@param offset Returns the offset within the data, or NONE if the buffer
+	       is empty
+	@return false if the buffer cannot be written
+	*/
+	template<typename ELEMENT>
+	static bool addBuffer(Tables &tables,
+	                      ResourceBuffer<ELEMENT> &buffer,
+	                      int count,
+	                      U32 &offset);
+	
+	/** Gets the bounds stored in a mesh record */
+	static BoundingVolume getBounds(const MeshRecord &record);
+	
+	/** Adds a mesh, unless it is already there */
+	static U32 addMesh(Tables &tables, const Mesh &mesh);
+	
+	/** Adds a key frame, unless one with the same meshes is already there */
+	static U32 addKeyFrame(Tables &tables, const KeyFrame &keyFrame);
+	
+	/**
+	Checks that every table, array and string of a cooked file lies within
+	the file
+	@param buffer Contents of the cooked file
+	@param size Size of the buffer, in bytes
+	@param document Receives the tables
+	@return true if the file is well-formed
+	*/
+	static bool validate(const U8 *buffer, size_t size, Document &document);
+	
+	/**
+	Checks that an array lies within the data
+	@param header Header of the cooked file
+	@param offset Offset of the array within the data
+	@param count Number of elements
+	@param elementSize Size of each element, in bytes
+	*/
+	static bool isArrayValid(const Header &header,
+	                         U32 offset,
+	                         U32 count,
+	                         size_t elementSize);
+	
+	/** Checks that a NUL-terminated string lies within the data */
+	static bool isStringValid(const Document &document, U32 offset);
+};
+
+#endif
@@ -1,38 +1,130 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
 #include "ModelLoader.h"
+#include "ModelBinary.h"
 
-FileNameToModel ModelLoader::cache;
+/**
+Memory that cached models may keep resident. Instances share the key frames
+of the cached model, so a model may be evicted while it has instances; its
+key frames are released along with the last instance, and it is only loaded
+again when another instance is created.
+*/
+static const size_t MODEL_BUDGET = 64 * 1024 * 1024;
+
+AssetCache<AnimationController> ModelLoader::cache("Models", MODEL_BUDGET);
+
+ModelLoadStatistics ModelLoader::statistics;
+
+ModelLoadStatistics::ModelLoadStatistics()
+		: fromSource(0),
+		sourceMilliseconds(0.0),
+		fromCooked(0),
+		cookedMilliseconds(0.0) {}
+
+string ModelLoadStatistics::toString() const {
+	const float perSource = (fromSource == 0) ? 0.0f
+	                        : (float)(sourceMilliseconds / fromSource);
+	const float perCooked = (fromCooked == 0) ? 0.0f
+	                        : (float)(cookedMilliseconds / fromCooked);
+	                        
+	return sizet_to_string(fromSource) + " from source in " +
+	       ftos((float)sourceMilliseconds) + "ms (" +
+	       ftos(perSource) + "ms each), " +
+	       sizet_to_string(fromCooked) + " cooked in " +
+	       ftos((float)cookedMilliseconds) + "ms (" +
+	       ftos(perCooked) + "ms each)";
+}
 
 void ModelLoader::insertInCache(const FileName &fileName, AnimationController *controller) {
 	ASSERT(controller!=0, "controller was null");
-	cache.insert(make_pair(fileName.str(), controller));
+	shared_ptr<AnimationController> model(controller);
+	cache.insert(fileName, model, controller->getMemoryUsage());
 }
 
-AnimationController* ModelLoader::getFromCache(const FileName &fileName) {
-	FileNameToModel::const_iterator iter = cache.find(fileName.str());
-	
-	if (iter == cache.end()) {
-		return 0;
-	} else {
-		return(iter->second);
-	}
+shared_ptr<AnimationController> ModelLoader::getFromCache(const FileName &fileName) {
+	return cache.find(fileName);
+}
+
+void ModelLoader::clearCache() {
+	cache.clear();
+}
+
+void ModelLoader::invalidate(const FileName &fileName) {
+	// Models are made of several files, which are kept in one directory
+	cache.removeInDirectory(fileName.getPath());
 }
 
 AnimationController* ModelLoader::load(const FileName &fileName,
                                        TextureFactory &textureFactory) {
-	AnimationController *controller = getFromCache(fileName);
+	shared_ptr<AnimationController> controller = getFromCache(fileName);
 	
-	if (controller == 0) {
+	if (!controller) {
 		// copy allocated for the cache alone
-		controller = loadFromFile(fileName, textureFactory);
+		AnimationController *loaded = loadCookedOrSource(fileName, textureFactory);
 		
-		if (!controller)
+		if (!loaded)
 			return 0; // failed to load model
 			
-		insertInCache(fileName, controller);
+		const BoundingVolume &bounds = loaded->getBounds();
+		VERIFY(!bounds.isEmpty() && bounds.isValid(),
+		       "Model has no valid bounds: " + fileName.str());
+		       
+		TRACE(fileName.str() + ": " + loaded->getFootprint().toString());
+		TRACE(fileName.str() + ": " + bounds.toString());
+		
+		insertInCache(fileName, loaded);
+		controller = getFromCache(fileName);
 	}
 	
-	ASSERT(controller!=0, "controller was null");
+	ASSERT(controller, "controller was null");
+	
+	return new AnimationController(*controller); // instance allocated for the client alone
+}
+
+AnimationController*
+ModelLoader::loadCookedOrSource(const FileName &fileName,
+                                TextureFactory &textureFactory) const {
+	const FileName cookedFileName = ModelBinary::getCookedFileName(fileName);
+	const double begin = Thread::getMilliseconds();
+	
+	if (ModelBinary::isCookedFileUsable(fileName)) {
+		AnimationController *model = ModelBinary::loadFromFile(cookedFileName,
+		                                                       textureFactory);
+		                                                       
+		if (model) {
+			statistics.fromCooked++;
+			statistics.cookedMilliseconds += Thread::getMilliseconds() - begin;
+			return model;
+		}
+		
+		// A damaged cooked file is passed over for the source files
+	}
+	
+	AnimationController *model = loadFromSource(fileName, textureFactory);
+	
+	if (!model) {
+		return 0;
+	}
+	
+	statistics.fromSource++;
+	statistics.sourceMilliseconds += Thread::getMilliseconds() - begin;
+	
+	return model;
+}
+
+AnimationController*
+ModelLoader::loadFromSource(const FileName &fileName,
+                            TextureFactory &textureFactory) const {
+	return loadFromFile(fileName, textureFactory);
+}
+
+bool ModelLoader::cook(const FileName &fileName,
+                       TextureFactory &textureFactory) const {
+	shared_ptr<AnimationController> model(loadFromSource(fileName, textureFactory));
+	
+	if (!model) {
+		return false;
+	}
 	
-	return new AnimationController(*controller); // copy allocated for the client alone
+	return ModelBinary::saveToFile(*model, ModelBinary::getCookedFileName(fileName));
 }
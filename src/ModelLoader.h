@@ -2,20 +2,54 @@
 #define _MODELLOADER_H_
 
 #include "AnimationController.h"
+#include "AssetCache.h"
 
-typedef map< string, AnimationController* > FileNameToModel;
+/** Counters describing the models loaded from file, ever */
+struct ModelLoadStatistics {
+	/** Models loaded from their source files */
+	size_t fromSource;
+	
+	/** Time spent loading models from their source files */
+	double sourceMilliseconds;
+	
+	/** Models loaded from cooked files (see ModelBinary) */
+	size_t fromCooked;
+	
+	/** Time spent loading models from cooked files */
+	double cookedMilliseconds;
+	
+	/** Constructor */
+	ModelLoadStatistics();
+	
+	/** Gets a readable summary of the counters */
+	string toString() const;
+};
 
 /** Generic model loader */
 class ModelLoader {
 private:
-	/** Stores previously loaded MD3 models */
-	static FileNameToModel cache;
+	/** Stores previously loaded models */
+	static AssetCache<AnimationController> cache;
+	
+	/** Counters describing the models loaded */
+	static ModelLoadStatistics statistics;
+	
+	/**
+	Loads a model from its cooked file, if there is one that is up to
+	date, and otherwise from its source files. Models are cooked by the
+	Cooker tool alone; loading never writes to the data directory.
+	@param fileName The file name of the model
+	@param textureFactory Texture factory tracks loaded textures
+	*/
+	AnimationController* loadCookedOrSource(const FileName &fileName,
+	                                        TextureFactory &textureFactory) const;
 	
 protected:
 	/**
 	Inserts the model into the cache
 	@param fileName file name to identify the model
-	@param controller animated model to cache
+	@param controller animated model to cache, which the cache takes
+	       ownership of
 	*/
 	static void insertInCache(const FileName &fileName, AnimationController *controller);
 	
@@ -24,7 +58,7 @@ protected:
 	@param fileName file name to identify the model
 	@return animated model retrieved from the cache
 	*/
-	static AnimationController* getFromCache(const FileName &fileName);
+	static shared_ptr<AnimationController> getFromCache(const FileName &fileName);
 	
 	/**
 	Loads a model from file
@@ -43,9 +77,45 @@ public:
 	Loads a model from file or the cache
 	@param fileName The file name of the model
 	@param textureFactory Texture factory tracks loaded textures
+	@return new instance of the model, sharing its animations with the
+	        model in the cache
 	*/
 	AnimationController* load(const FileName &fileName,
 	                          TextureFactory &textureFactory);
+	                          
+	/**
+	Loads a model from its source files, whether or not it has a cooked
+	file, without the cache
+	@param fileName The file name of the model
+	@param textureFactory Texture factory tracks loaded textures
+	@return new model; ownership passes to the caller
+	*/
+	AnimationController* loadFromSource(const FileName &fileName,
+	                                    TextureFactory &textureFactory) const;
+	                                    
+	/**
+	Loads a model from its source files, whether or not it has a cooked
+	file, and writes its cooked file (see ModelBinary)
+	@param fileName The file name of the model
+	@param textureFactory Texture factory tracks loaded textures
+	@return true if the cooked file was written
+	*/
+	bool cook(const FileName &fileName, TextureFactory &textureFactory) const;
+	
+	/** Drops all models from the cache, while OpenGL is still running */
+	static void clearCache();
+	
+	/**
+	Drops the models in the directory of a changed file, so that they are
+	loaded again the next time they are instantiated
+	@param fileName File that has changed
+	*/
+	static void invalidate(const FileName &fileName);
+	
+	/** Gets the counters describing the models loaded */
+	static ModelLoadStatistics getStatistics() {
+		return statistics;
+	}
 };
 
 #endif
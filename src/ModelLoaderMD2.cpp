@@ -1,4 +1,6 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "FileMapping.h"
 #include "Mesh.h"
 #include "ModelLoaderMD2.h"
 
@@ -20,20 +22,15 @@ vector<KeyFrame>
 ModelLoaderMD2::loadKeyFrames(const FileName &fileName,
                               const FileName &skinName,
                               TextureFactory &textureFactory) const {
-	FILE *stream=0;
+	const FileMapping file(fileName);
 	
-//	fopen_s(&stream, fileName.c_str(), "rb");
-	stream = fopen(fileName.c_str(), "rb");
+	VERIFY(file.isOpen(), "MD2 failed to open: "+fileName.str());
 	
-	VERIFY(stream && !ferror(stream), "MD2 failed to open: "+fileName.str());
-	
-	Header header = readHeader(stream);
-	Skin *skins = readSkins(stream, header);
-	TexCoord *texCoords = readTexCoords(stream, header);
-	Triangle *triangles = readTriangles(stream, header);
-	Frame *frames = readFrames(stream, header);
-	
-	fclose(stream);
+	Header header = readHeader(file);
+	Skin *skins = readSkins(file, header);
+	TexCoord *texCoords = readTexCoords(file, header);
+	Triangle *triangles = readTriangles(file, header);
+	Frame *frames = readFrames(file, header);
 	
 	Material skin;
 	
@@ -80,15 +77,11 @@ vector<KeyFrame> ModelLoaderMD2::buildKeyFrames(const FileName &fileName,
 		                           frames[i]);
 		                           
 		if (i==0) {
-			heightBelowGround = mesh->calculateHeightBelowGround();
+			heightBelowGround = mesh->getBounds().getHeightBelowGround();
 		}
 		
 		// Place the feet of the mesh on the ground
-		vec3 *vertices = (vec3*)mesh->vertexArray->lock();
-		for (int i=0; i<mesh->vertexArray->getNumber(); ++i) {
-			vertices[i].y -= heightBelowGround;
-		}
-		mesh->vertexArray->unlock();
+		mesh->translate(vec3(0.0f, -heightBelowGround, 0.0f));
 		
 		keyFrames.push_back(KeyFrame(mesh));
 	}
@@ -188,10 +181,11 @@ vector<Face> ModelLoaderMD2::getFaces(const Triangle *tris,
 	return r;
 }
 
-ModelLoaderMD2::Header ModelLoaderMD2::readHeader(FILE* stream) {
+ModelLoaderMD2::Header ModelLoaderMD2::readHeader(const FileMapping &file) {
 	Header header;
 	
-	fread(&header, sizeof(header), 1, stream);
+	VERIFY(file.readArray(0, &header, 1),
+	       "MD2 header is truncated: " + file.getFileName().str());
 	
 	ASSERT(header.magicNumber == (('2'<<24) + ('P'<<16) + ('D'<<8) + 'I'),
 	       "This file is not an MD2 file!");
@@ -216,7 +210,7 @@ ModelLoaderMD2::Header ModelLoaderMD2::readHeader(FILE* stream) {
 	return header;
 }
 
-ModelLoaderMD2::Skin* ModelLoaderMD2::readSkins(FILE* stream,
+ModelLoaderMD2::Skin* ModelLoaderMD2::readSkins(const FileMapping &file,
   const Header &header) {
 	if (header.numOfSkins==0)
 		return 0;
@@ -226,56 +220,62 @@ ModelLoaderMD2::Skin* ModelLoaderMD2::readSkins(FILE* stream,
 	       
 	Skin *skins = new Skin[header.numOfSkins];
 	
-	fseek(stream, header.offsetSkins, SEEK_SET);
-	fread(skins, sizeof(Skin), header.numOfSkins, stream);
+	VERIFY(file.readArray(header.offsetSkins, skins, header.numOfSkins),
+	       "MD2 skins are truncated: " + file.getFileName().str());
 	
 	return skins;
 }
 
-ModelLoaderMD2::TexCoord* ModelLoaderMD2::readTexCoords(FILE* stream,
+ModelLoaderMD2::TexCoord* ModelLoaderMD2::readTexCoords(const FileMapping &file,
   const Header &header) {
 	ASSERT(header.numOfSt>0 && header.numOfSt<MD2_MAX_TEX_VERTS,
 	       "Invalid number of tex-verts");
 	       
 	TexCoord *texCoords = new TexCoord[header.numOfSt];
 	
-	fseek(stream, header.offsetTexCoords, SEEK_SET);
-	fread(texCoords, sizeof(TexCoord), header.numOfSt, stream);
+	VERIFY(file.readArray(header.offsetTexCoords, texCoords, header.numOfSt),
+	       "MD2 tex-coords are truncated: " + file.getFileName().str());
 	
 	return texCoords;
 }
 
-ModelLoaderMD2::Triangle* ModelLoaderMD2::readTriangles(FILE* stream,
+ModelLoaderMD2::Triangle* ModelLoaderMD2::readTriangles(const FileMapping &file,
   const Header &header) {
 	ASSERT(header.offsetTriangles>0 && header.offsetTriangles<MD2_MAX_TRIANGLES,
 	       "Invalid number of triangles");
 	       
 	Triangle *triangles = new Triangle[header.numOfTris];
 	
-	fseek(stream, header.offsetTriangles, SEEK_SET);
-	fread(triangles, sizeof(Triangle), header.numOfTris, stream);
+	VERIFY(file.readArray(header.offsetTriangles, triangles, header.numOfTris),
+	       "MD2 triangles are truncated: " + file.getFileName().str());
 	
 	return triangles;
 }
 
-ModelLoaderMD2::Frame* ModelLoaderMD2::readFrames(FILE* stream,
+ModelLoaderMD2::Frame* ModelLoaderMD2::readFrames(const FileMapping &file,
   const Header &header) {
 	ASSERT(header.numOfFrames>0 && header.numOfFrames<MD2_MAX_FRAMES,
 	       "Invalid number of frames");
 	       
 	Frame *frames = new Frame[header.numOfFrames];
 	
-	fseek(stream, header.offsetFrames, SEEK_SET);
+	size_t offset = header.offsetFrames;
 	
 	for (S32 i=0; i<header.numOfFrames; ++i) {
 		Frame &frame = frames[i];
 		
 		frame.vertices = new Vertex[header.numOfVertices];
 		
-		fread(&frame.scale, sizeof(VEC3), 1, stream);
-		fread(&frame.translate, sizeof(VEC3), 1, stream);
-		fread(&frame.name, sizeof(U8), 16, stream);
-		fread(frame.vertices, sizeof(Vertex), header.numOfVertices, stream);
+		const bool ok = file.readArray(offset, &frame.scale, 1) &&
+		                file.readArray(offset + sizeof(VEC3), &frame.translate, 1) &&
+		                file.readArray(offset + 2*sizeof(VEC3), frame.name, 16) &&
+		                file.readArray(offset + 2*sizeof(VEC3) + 16,
+		                               frame.vertices,
+		                               header.numOfVertices);
+		                               
+		VERIFY(ok, "MD2 frames are truncated: " + file.getFileName().str());
+		
+		offset += 2*sizeof(VEC3) + 16 + sizeof(Vertex) * header.numOfVertices;
 	}
 	
 	return frames;
@@ -3,6 +3,8 @@
 
 #include "ModelLoaderSingle.h"
 
+class FileMapping;
+
 /**
 MD2 model loader
 Source for specs: <http://tfc.duke.free.fr/coding/md2-specs-en.html>
@@ -120,11 +122,11 @@ private:
 	                           const Frame &frame);
 	                           
 private:
-	static Header readHeader(FILE* stream);
-	static Skin* readSkins(FILE* stream, const Header &header);
-	static TexCoord* readTexCoords(FILE* stream, const Header &header);
-	static Triangle* readTriangles(FILE* stream, const Header &header);
-	static Frame* readFrames(FILE* stream, const Header &header);
+	static Header readHeader(const FileMapping &file);
+	static Skin* readSkins(const FileMapping &file, const Header &header);
+	static TexCoord* readTexCoords(const FileMapping &file, const Header &header);
+	static Triangle* readTriangles(const FileMapping &file, const Header &header);
+	static Frame* readFrames(const FileMapping &file, const Header &header);
 	
 	static vec3 transformVertex(const Vertex &v, VEC3 *scale, VEC3 *translate);
 	static vec3 transformNormal(const Vertex &v);
@@ -1,6 +1,9 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "FileMapping.h"
 #include "Mesh.h"
 #include "ModelLoaderMD3.h"
+#include "VirtualFileSystem.h"
 
 const S32 ModelLoaderMD3::MD3_MAX_FRAMES = 1024;
 const S32 ModelLoaderMD3::MD3_MAX_SURFACES = 16;
@@ -16,20 +19,17 @@ vector<KeyFrame>
 ModelLoaderMD3::loadKeyFrames(const FileName &fileName,
                               const FileName &skinName,
                               TextureFactory &textureFactory) const {
-	FILE * stream = fopen(fileName.c_str(), "rb");
-
-	
-	VERIFY(stream && !ferror(stream), "MD3 failed to open: "+fileName.str());
+	const FileMapping file(fileName);
 	
-	Header header = readHeader(stream);
+	VERIFY(file.isOpen(), "MD3 failed to open: "+fileName.str());
 	
-	Frame *frames = readFrames(stream, header);
+	Header header = readHeader(file);
 	
-	Tag *tags = readTags(stream, header);
+	Frame *frames = readFrames(file, header);
 	
-	Surface *surfaces = readSurfaces(stream, header);
+	Tag *tags = readTags(file, header);
 	
-	fclose(stream);
+	Surface *surfaces = readSurfaces(file, header);
 	
 	vector<KeyFrame> keyFrames = buildKeyFrame(surfaces,
 	                             fileName,
@@ -51,52 +51,102 @@ vector<KeyFrame> ModelLoaderMD3::buildKeyFrame(Surface * surfaces,
   TextureFactory &textureFactory) {
 	vector<KeyFrame> keyFrames;
 	
-	const FileName directory = fileName.getPath();
+	VERIFY(header.numSurfaces > 0 && header.numSurfaces <= MD3_MAX_SURFACES,
+	       "MD3 has an invalid number of surfaces: " + fileName.str());
+	       
+	const vector<Material> materials = loadMaterials(surfaces,
+	                                   fileName,
+	                                   skinName,
+	                                   header,
+	                                   textureFactory);
+	                                   
+	size_t numTriangles = 0;
+	
+	for (int s=0; s<header.numSurfaces; ++s) {
+		VERIFY(surfaces[s].header.numFrames == header.numFrames,
+		       "MD3 surface has the wrong number of frames: " + fileName.str());
+		numTriangles += surfaces[s].header.numTris;
+	}
 	
 	/*
-	Only the first frame loads texture files.
-	The other frames use a copy of the handles and that copy is stored in here.
+	All the surfaces of a frame are appended to one mesh, so they share its
+	buffers and are drawn as material ranges of it
 	*/
-	Material md3Material;
-	
-	// Take the all the surfaces and push each frame into the mesh manager
-	for (int i=0; i<surfaces[0].header.numFrames; ++i) {
-		string name = fileName.str() + "#" + itos(i);
-		
-		// Create a mesh from the surface
+	for (int i=0; i<header.numFrames; ++i) {
 		Mesh *mesh = surfaces[0].getObject(i);
+		mesh->material = materials[0]; // shallow copy
 		
-		// Load a material for the first mesh in the first model.
-		// First model only! Ignored for subsequent models
-		if (i==0) {
-			if (header.numSurfaces > 0) {
-				mesh->material.clear();
-				
-#if 0
-				if (surfaces[0].header.numShaders > 0) {
-					const char *shaderName=(char*)surfaces[0].shaders[0].name;
-					FileName skin = directory.append(FileName(shaderName));
-					mesh->material.setTexture(textureFactory.load(skin));
-				} else {
-					mesh->material.setTexture(textureFactory.load(skinName));
-				}
-#else
-				mesh->material.setTexture(textureFactory.load(skinName));
-#endif
-				// Keep a copy of the material to propagate to the subsequent frames
-				md3Material = mesh->material;
-			}
-		} else {
-			mesh->material = md3Material; // shallow copy
+		vector<const Mesh*> others;
+		
+		for (int s=1; s<header.numSurfaces; ++s) {
+			Mesh *surface = surfaces[s].getObject(i);
+			surface->material = materials[s];
+			others.push_back(surface);
+		}
+		
+		mesh->append(others);
+		
+		for (size_t s=0; s<others.size(); ++s) {
+			delete others[s];
 		}
 		
 		keyFrames.push_back(KeyFrame(mesh));
 	}
 	
+	// Surfaces and triangles are never dropped on the way into the meshes
+	VERIFY(keyFrames[0].getMeshes()[0]->indexArray->getNumber() == (int)numTriangles*3,
+	       "MD3 triangles were lost while loading: " + fileName.str());
+	       
+	TRACE(fileName.str() + ": " + itos(header.numSurfaces) + " surfaces, " +
+	      sizet_to_string(numTriangles) + " triangles, " +
+	      itos(header.numFrames) + " frames");
+	      
 	return keyFrames;
 }
 
-ModelLoaderMD3::Surface* ModelLoaderMD3::readSurfaces(FILE* stream,
+vector<Material> ModelLoaderMD3::loadMaterials(Surface * surfaces,
+  const FileName &fileName,
+  const FileName &skinName,
+  const Header &header,
+  TextureFactory &textureFactory) {
+	vector<Material> materials;
+	
+	const FileName directory = fileName.getPath();
+	
+	for (int s=0; s<header.numSurfaces; ++s) {
+		const Surface &surface = surfaces[s];
+		Material material;
+		
+		/*
+		A surface is textured with the image named by its shader, if that is
+		found alongside the model. Otherwise, and always for a model with a
+		single surface, the model's skin is used.
+		*/
+		FileName texture = skinName;
+		
+		if (header.numSurfaces > 1 && surface.header.numShaders > 0) {
+			// The name is not terminated if it fills the whole field
+			char shaderName[MAX_QPATH+1] = {0};
+			memcpy(shaderName, surface.shaders[0].name, MAX_QPATH);
+			
+			// Shaders name paths within the game that made the model
+			const string path = shaderName;
+			const string name = path.substr(path.find_last_of("/\\") + 1);
+			const FileName shaderTexture = directory.append(FileName(name));
+			
+			if (VirtualFileSystem::exists(shaderTexture)) {
+				texture = shaderTexture;
+			}
+		}
+		
+		material.setTexture(textureFactory.load(texture));
+		materials.push_back(material);
+	}
+	
+	return materials;
+}
+
+ModelLoaderMD3::Surface* ModelLoaderMD3::readSurfaces(const FileMapping &file,
   const Header &header) {
 	Surface *surfaces = 0;
 	
@@ -104,47 +154,48 @@ ModelLoaderMD3::Surface* ModelLoaderMD3::readSurfaces(FILE* stream,
 		surfaces = new Surface[header.numSurfaces];
 	}
 	
-	fseek(stream, header.surfacesOffset, SEEK_SET);
+	size_t offset = header.surfacesOffset;
 	
 	for (int i=0; i<header.numSurfaces; ++i) {
-		// Load the next surface
-		surfaces[i].create(stream);
+		// Load the next surface, which follows on from the last
+		offset = surfaces[i].create(file, offset);
 	}
 	
 	return surfaces;
 }
 
-ModelLoaderMD3::Tag* ModelLoaderMD3::readTags(FILE* stream,
+ModelLoaderMD3::Tag* ModelLoaderMD3::readTags(const FileMapping &file,
   const Header &header) {
 	Tag *tags = 0;
 	
 	if (header.numTags>0) {
 		tags = new Tag[header.numTags];
+		
+		VERIFY(file.readArray(header.tagsOffset, tags, header.numTags),
+		       "MD3 tags are truncated: " + file.getFileName().str());
 	}
 	
-	fseek(stream, header.tagsOffset, SEEK_SET);
-	fread(tags, sizeof(Tag), header.numTags, stream);
-	
 	return tags;
 }
 
-ModelLoaderMD3::Frame* ModelLoaderMD3::readFrames(FILE* stream,
+ModelLoaderMD3::Frame* ModelLoaderMD3::readFrames(const FileMapping &file,
   const Header &header) {
 	ASSERT(header.numFrames>0 && header.numFrames<MD3_MAX_FRAMES,
 	       "Invalid number of frames");
 	       
 	Frame *frames = new Frame[header.numFrames];
 	
-	fseek(stream, header.framesOffset, SEEK_SET);
-	fread(frames, sizeof(Frame), header.numFrames, stream);
+	VERIFY(file.readArray(header.framesOffset, frames, header.numFrames),
+	       "MD3 frames are truncated: " + file.getFileName().str());
 	
 	return frames;
 }
 
-ModelLoaderMD3::Header ModelLoaderMD3::readHeader(FILE* stream) {
+ModelLoaderMD3::Header ModelLoaderMD3::readHeader(const FileMapping &file) {
 	Header header;
 	
-	fread(&header, sizeof(header), 1, stream);
+	VERIFY(file.readArray(0, &header, 1),
+	       "MD3 header is truncated: " + file.getFileName().str());
 	
 	ASSERT(header.magicNumber[0] == 'I' &&
 	       header.magicNumber[1] == 'D' &&
@@ -162,9 +213,8 @@ ModelLoaderMD3::Surface::Surface() {
 	vertices = 0;
 }
 
-void ModelLoaderMD3::Surface::create(FILE *stream) {
-	const S32 surfaceStart = (S32)ftell(stream);
-	
+size_t ModelLoaderMD3::Surface::create(const FileMapping &file,
+                                       size_t surfaceStart) {
 	delete [] shaders;
 	shaders = 0;
 	
@@ -177,8 +227,9 @@ void ModelLoaderMD3::Surface::create(FILE *stream) {
 	delete [] vertices;
 	vertices = 0;
 	
-	fread(&header, sizeof(header), 1, stream);
-	
+	VERIFY(file.readArray(surfaceStart, &header, 1),
+	       "MD3 surface is truncated: " + file.getFileName().str());
+	       
 	ASSERT(header.magicNumber[0] == 'I' &&
 	       header.magicNumber[1] == 'D' &&
 	       header.magicNumber[2] == 'P' &&
@@ -187,28 +238,30 @@ void ModelLoaderMD3::Surface::create(FILE *stream) {
 	       
 	if (header.numShaders>0) {
 		shaders = new Shader[header.numShaders];
-		fseek(stream, surfaceStart + header.shadersOffset, SEEK_SET);
-		fread(shaders, sizeof(Shader), header.numShaders, stream);
+		VERIFY(file.readArray(surfaceStart + header.shadersOffset, shaders, header.numShaders),
+		       "MD3 surface is truncated: " + file.getFileName().str());
 	}
 	
 	if (header.numTris>0) {
 		triangles = new Triangle[header.numTris];
-		fseek(stream, surfaceStart + header.trianglesOffset, SEEK_SET);
-		fread(triangles, sizeof(Triangle), header.numTris, stream);
+		VERIFY(file.readArray(surfaceStart + header.trianglesOffset, triangles, header.numTris),
+		       "MD3 surface is truncated: " + file.getFileName().str());
 	}
 	
 	if (header.numVerts>0) {
 		texCoords = new TexCoord[header.numVerts];
-		fseek(stream, surfaceStart + header.texCoordsOffset, SEEK_SET);
-		fread(texCoords, sizeof(TexCoord), header.numVerts, stream);
+		VERIFY(file.readArray(surfaceStart + header.texCoordsOffset, texCoords, header.numVerts),
+		       "MD3 surface is truncated: " + file.getFileName().str());
 	}
 	
 	if (header.numVerts>0 && header.numFrames>0) {
 		const S32 totalNumberOfVertices = header.numVerts * header.numFrames;
 		vertices = new Vertex[totalNumberOfVertices];
-		fseek(stream, surfaceStart + header.vertexOffset, SEEK_SET);
-		fread(vertices, sizeof(Vertex), totalNumberOfVertices, stream);
+		VERIFY(file.readArray(surfaceStart + header.vertexOffset, vertices, totalNumberOfVertices),
+		       "MD3 surface is truncated: " + file.getFileName().str());
 	}
+	
+	return surfaceStart + header.endOffset;
 }
 
 ModelLoaderMD3::Surface::~Surface() {
@@ -3,6 +3,8 @@
 
 #include "ModelLoaderSingle.h"
 
+class FileMapping;
+
 /** MD3 model loader */
 class ModelLoaderMD3 : public ModelLoaderSingle {
 public:
@@ -113,10 +115,11 @@ private:
 		
 		/**
 		Loads a Surface from file
-		@param stream The file to load the surface from.
-		Assume the file cursor is set at the start of the surface already
+		@param file The file to load the surface from
+		@param surfaceStart Offset of the start of the surface in the file
+		@return Offset of the end of the surface in the file
 		*/
-		void create(FILE *stream);
+		size_t create(const FileMapping &file, size_t surfaceStart);
 		
 		/**
 		Allocates memory for a mesh object and copies the Surface into it.
@@ -252,18 +255,28 @@ private:
 	                                       const FileName &skinName,
 	                                       TextureFactory &tex) const;
 	                                       
-	/** Builds a key frame from the surfaces */
+	/**
+	Builds the key frames from the surfaces. Each key frame holds one mesh
+	in which every surface is a material range.
+	*/
 	static vector<KeyFrame> buildKeyFrame(Surface * surfaces,
 	                                      const FileName &fileName,
 	                                      const FileName &skinName,
 	                                      const Header &header,
 	                                      TextureFactory &textureFactory);
 	                                      
+	/** Loads the material of each surface */
+	static vector<Material> loadMaterials(Surface * surfaces,
+	                                      const FileName &fileName,
+	                                      const FileName &skinName,
+	                                      const Header &header,
+	                                      TextureFactory &textureFactory);
+	                                      
 private:
-	static Surface* readSurfaces(FILE* stream, const Header &header);
-	static Tag* readTags(FILE* stream, const Header &header);
-	static Frame* readFrames(FILE* stream, const Header &header);
-	static Header readHeader(FILE* stream);
+	static Surface* readSurfaces(const FileMapping &file, const Header &header);
+	static Tag* readTags(const FileMapping &file, const Header &header);
+	static Frame* readFrames(const FileMapping &file, const Header &header);
+	static Header readHeader(const FileMapping &file);
 };
 
 #endif
@@ -1,4 +1,5 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
 #include "Mesh.h"
 #include "ModelLoaderOBJ.h"
 
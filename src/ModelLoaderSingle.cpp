@@ -1,4 +1,5 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
 #include "Mesh.h"
 #include "ModelLoaderSingle.h"
 
@@ -25,7 +26,9 @@ ModelLoaderSingle::loadFromFile(const FileName &fileName,
 	}
 	vector<KeyFrame> keyFrames = loadKeyFrames(file, skinName, textureFactory);
 	
-	// Get the rest of the key frames
+	// Get key frames from the other sources
+	vector< vector<KeyFrame> > sources;
+	
 	for (size_t i = 1, numMD3 = xml.getNumInstances("model"); i<numMD3; ++i) {
 		PropertyBag fileBag = xml.getBag("model", i);
 		const FileName file = directory.append(fileBag.getFileName("file"));
@@ -34,16 +37,26 @@ ModelLoaderSingle::loadFromFile(const FileName &fileName,
 			skinName = directory.append(skinName);
 		}
 		
-		vector<KeyFrame> k = loadKeyFrames(file, skinName, textureFactory);
+		sources.push_back(loadKeyFrames(file, skinName, textureFactory));
 		
-		for (size_t i=0; i<k.size(); ++i) {
-			KeyFrame &keyFrame = keyFrames[i];
-			
-			keyFrame.merge(k[i]);
-			
-			// set polygon windings according to data file
-			setPolygonWinding(keyFrame, polygonWinding);
+		VERIFY(sources.back().size() == keyFrames.size(),
+		       "Model sources have different numbers of frames: " + file.str());
+	}
+	
+	// Append the geometry of every other source to the same meshes at once
+	for (size_t i=0; !sources.empty() && i<keyFrames.size(); ++i) {
+		KeyFrame &keyFrame = keyFrames[i];
+		vector<const KeyFrame*> others;
+		
+		for (size_t s=0; s<sources.size(); ++s) {
+			others.push_back(&sources[s][i]);
 		}
+		
+		VERIFY(keyFrame.append(others),
+		       "Model sources have different meshes: " + fileName.str());
+		       
+		// set polygon windings according to data file
+		setPolygonWinding(keyFrame, polygonWinding);
 	}
 	
 	// Build the animations from these keyframes
@@ -82,8 +95,8 @@ ModelLoaderSingle::loadFromFile(const FileName &fileName,
 
 void ModelLoaderSingle::setPolygonWinding(KeyFrame &keyFrame,
   const string &polygonWinding) {
-	vector<Mesh*> &meshes = keyFrame.getMeshes();
-	for (vector<Mesh*>::iterator i=meshes.begin(); i!=meshes.end(); ++i) {
+	MeshSet &meshes = keyFrame.getMeshes();
+	for (MeshSet::iterator i=meshes.begin(); i!=meshes.end(); ++i) {
 		(*i)->polygonWinding = polygonWinding=="CCW" ? GL_CCW : GL_CW;
 	}
 }
@@ -0,0 +1,267 @@
+#include "Core.h"
+#include "PackFile.h"
+
+PackFile::PackFile()
+		: header(0),
+		entries(0),
+		slots(0),
+		paths(0) {}
+
+bool PackFile::open(const FileName &fileName) {
+	close();
+	
+	if (!file.open(fileName)) {
+		ERR("Failed to open pack file: " + fileName.str());
+		return false;
+	}
+	
+	if (!validate()) {
+		ERR("Pack file is corrupt or out of date: " + fileName.str());
+		close();
+		return false;
+	}
+	
+	return true;
+}
+
+void PackFile::close() {
+	file.close();
+	header = 0;
+	entries = 0;
+	slots = 0;
+	paths = 0;
+}
+
+size_t PackFile::getNumFiles() const {
+	return header ? header->numEntries : 0;
+}
+
+string PackFile::getPath(size_t index) const {
+	ASSERT(index < getNumFiles(), "Pack file index out of range");
+	const Entry &entry = entries[index];
+	return string(paths + entry.path, entry.pathLength);
+}
+
+bool PackFile::find(const string &path, const U8 *&data, size_t &size) const {
+	if (!header || header->numSlots == 0) {
+		return false;
+	}
+	
+	const U32 h = hash(path.data(), path.length());
+	const U32 mask = header->numSlots - 1;
+	
+	for (U32 slot = h & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+		const Entry &entry = entries[slots[slot] - 1];
+		
+		if (entry.hash == h &&
+		    entry.pathLength == path.length() &&
+		    memcmp(paths + entry.path, path.data(), path.length()) == 0) {
+			data = file.getData() + entry.offset;
+			size = entry.size;
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+U32 PackFile::hash(const char *path, size_t length) {
+	// FNV-1a
+	U32 h = 2166136261U;
+	
+	for (size_t i=0; i<length; ++i) {
+		h = (h ^ (U8)path[i]) * 16777619U;
+	}
+	
+	return h;
+}
+
+bool PackFile::validate() {
+	const size_t fileSize = file.getSize();
+	
+	if (fileSize < sizeof(Header)) {
+		return false;
+	}
+	
+	header = reinterpret_cast<const Header*>(file.getData());
+	
+	if (header->magic != MAGIC || header->version != FORMAT_VERSION) {
+		return false;
+	}
+	
+	// Tables, in the order in which they follow the header
+	const size_t tables[] = {
+		sizeof(Entry) * (size_t)header->numEntries,
+		sizeof(U32) * (size_t)header->numSlots,
+		header->pathPoolSize
+	};
+	
+	size_t offset = sizeof(Header);
+	
+	for (size_t i=0; i<sizeof(tables)/sizeof(tables[0]); ++i) {
+		if (tables[i] > fileSize - offset) {
+			return false;
+		}
+		
+		offset += tables[i];
+	}
+	
+	// Slots must be a power of two, with at least one always left empty
+	const U32 numSlots = header->numSlots;
+	
+	if ((numSlots & (numSlots - 1)) != 0 ||
+	    (header->numEntries > 0 && header->numEntries >= numSlots) ||
+	    header->dataOffset < offset || header->dataOffset > fileSize) {
+		return false;
+	}
+	
+	entries = reinterpret_cast<const Entry*>(file.getData() + sizeof(Header));
+	slots = reinterpret_cast<const U32*>(entries + header->numEntries);
+	paths = reinterpret_cast<const char*>(slots + numSlots);
+	
+	for (U32 i=0; i<header->numEntries; ++i) {
+		const Entry &entry = entries[i];
+		
+		if (entry.path > header->pathPoolSize ||
+		    entry.pathLength > header->pathPoolSize - entry.path ||
+		    entry.offset < header->dataOffset ||
+		    entry.offset > fileSize ||
+		    entry.size > fileSize - entry.offset) {
+			return false;
+		}
+	}
+	
+	for (U32 i=0; i<numSlots; ++i) {
+		if (slots[i] > header->numEntries) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+/**
+Copies a file into an open stream
+@param fileName File to copy
+@param stream Destination
+@param size Returns the number of bytes copied
+@return true if successful
+*/
+static bool copyFile(const FileName &fileName, FILE *stream, U32 &size) {
+	const FileMapping source(fileName);
+	
+	if (!source.isOpen() || source.getSize() > 0xFFFFFFFFU) {
+		return false;
+	}
+	
+	size = (U32)source.getSize();
+	
+	return size == 0 ||
+	       fwrite(source.getData(), 1, size, stream) == size;
+}
+
+bool PackFile::saveToFile(const FileName &fileName,
+                          const vector<Source> &sources) {
+	const U32 numEntries = (U32)sources.size();
+	
+	// Keep the table no more than half full, so probes stay short
+	U32 numSlots = 0;
+	
+	if (numEntries > 0) {
+		numSlots = 1;
+		
+		while (numSlots < numEntries * 2) {
+			numSlots *= 2;
+		}
+	}
+	
+	vector<Entry> table(numEntries);
+	vector<U32> slotTable(numSlots, 0);
+	string pathPool;
+	
+	for (U32 i=0; i<numEntries; ++i) {
+		const string &path = sources[i].path;
+		Entry &entry = table[i];
+		entry.hash = hash(path.data(), path.length());
+		entry.path = (U32)pathPool.size();
+		entry.pathLength = (U32)path.length();
+		entry.offset = 0;
+		entry.size = 0;
+		
+		pathPool.append(path);
+		pathPool.push_back(0);
+		
+		U32 slot = entry.hash & (numSlots - 1);
+		
+		while (slotTable[slot] != 0) {
+			slot = (slot + 1) & (numSlots - 1);
+		}
+		
+		slotTable[slot] = i + 1;
+	}
+	
+	const size_t tablesSize = sizeof(Header)
+	                          + sizeof(Entry) * table.size()
+	                          + sizeof(U32) * slotTable.size()
+	                          + pathPool.size();
+	
+	Header header;
+	header.magic = MAGIC;
+	header.version = FORMAT_VERSION;
+	header.numEntries = numEntries;
+	header.numSlots = numSlots;
+	header.pathPoolSize = (U32)pathPool.size();
+	header.dataOffset = (U32)((tablesSize + DATA_ALIGNMENT - 1) & ~(size_t)(DATA_ALIGNMENT - 1));
+	
+	FILE *stream = fopen(fileName.c_str(), "wb");
+	
+	if (!stream) {
+		ERR("Failed to open file for writing: " + fileName.str());
+		return false;
+	}
+	
+	/*
+	Write the contents first, leaving room for the tables, since the
+	offsets and sizes of the files are known only once they are copied.
+	*/
+	const char padding[DATA_ALIGNMENT] = {0};
+	size_t offset = header.dataOffset;
+	bool ok = fseek(stream, (long)offset, SEEK_SET) == 0;
+	
+	for (U32 i=0; ok && i<numEntries; ++i) {
+		table[i].offset = (U32)offset;
+		ok = copyFile(sources[i].fileName, stream, table[i].size);
+		
+		if (!ok) {
+			ERR("Failed to copy into pack file: " + sources[i].fileName.str());
+			break;
+		}
+		
+		offset += table[i].size;
+		
+		const size_t pad = (DATA_ALIGNMENT - offset % DATA_ALIGNMENT) % DATA_ALIGNMENT;
+		ok = fwrite(padding, 1, pad, stream) == pad;
+		offset += pad;
+		ok = ok && offset <= 0xFFFFFFFFU;
+	}
+	
+	ok = ok && fseek(stream, 0, SEEK_SET) == 0;
+	ok = ok && fwrite(&header, sizeof(header), 1, stream) == 1;
+	
+	if (numEntries > 0) {
+		ok = ok && fwrite(&table[0], sizeof(Entry), table.size(), stream) == table.size();
+		ok = ok && fwrite(&slotTable[0], sizeof(U32), slotTable.size(), stream) == slotTable.size();
+	}
+	
+	ok = ok && fwrite(pathPool.data(), 1, pathPool.size(), stream) == pathPool.size();
+	
+	const size_t pad = header.dataOffset - tablesSize;
+	ok = ok && fwrite(padding, 1, pad, stream) == pad;
+	ok = (fclose(stream) == 0) && ok;
+	
+	if (!ok) {
+		ERR("Failed to write file: " + fileName.str());
+	}
+	
+	return ok;
+}
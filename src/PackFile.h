@@ -0,0 +1,142 @@
+#ifndef _PACK_FILE_H_
+#define _PACK_FILE_H_
+
+#include "FileMapping.h"
+
+/**
+Archive holding many data files in a single file.
+
+A pack file holds a header, a table of fixed-size entries, a hash table of
+the entries keyed by path, a pool of NUL-terminated paths and, finally, the
+contents of every file. File contents start on DATA_ALIGNMENT boundaries so
+that loaders may read structures straight out of the archive. The archive is
+opened once, through a FileMapping, and looking up a file costs a hash and a
+short probe rather than a trip through the operating system.
+
+Pack files are built with the Packer tool and made visible to the game by
+mounting them with VirtualFileSystem.
+*/
+class PackFile {
+public:
+	/** Location of a file to be written to a pack file */
+	struct Source {
+		/** Path of the file within the archive, e.g. "models/foo.md3" */
+		string path;
+		
+		/** File on disk holding the contents */
+		FileName fileName;
+	};
+	
+	/** Constructor */
+	PackFile();
+	
+	/**
+	Opens an archive, closing any archive that was already open
+	@param fileName Name of the pack file
+	@return true if successful
+	*/
+	bool open(const FileName &fileName);
+	
+	/** Closes the archive */
+	void close();
+	
+	/** Determines whether an archive is open */
+	inline bool isOpen() const {
+		return file.isOpen();
+	}
+	
+	/** Gets the name of the pack file */
+	inline const FileName& getFileName() const {
+		return file.getFileName();
+	}
+	
+	/** Gets the number of files in the archive */
+	size_t getNumFiles() const;
+	
+	/**
+	Gets the path of a file in the archive
+	@param index Index of the file
+	@return Path of the file within the archive
+	*/
+	string getPath(size_t index) const;
+	
+	/**
+	Finds a file in the archive
+	@param path Path of the file within the archive
+	@param data Returns the contents of the file, which remain valid for as
+	       long as the archive is open
+	@param size Returns the size of the file, in bytes
+	@return true if the file is in the archive
+	*/
+	bool find(const string &path, const U8 *&data, size_t &size) const;
+	
+	/**
+	Writes a pack file
+	@param fileName Name of the pack file
+	@param sources Files to put in the archive
+	@return true if successful
+	*/
+	static bool saveToFile(const FileName &fileName,
+	                       const vector<Source> &sources);
+	
+	/** Hashes the path of a file */
+	static U32 hash(const char *path, size_t length);
+	
+private:
+	PackFile(const PackFile&);
+	PackFile& operator=(const PackFile&);
+	
+	/** Identifies a pack file */
+	static const U32 MAGIC = 0x4B434150; // "PACK"
+	
+	/** Incremented whenever the layout of the file changes */
+	static const U32 FORMAT_VERSION = 1;
+	
+	/** Alignment of the contents of each file within the archive */
+	static const U32 DATA_ALIGNMENT = 16;
+	
+	struct Header {
+		U32 magic;
+		U32 version;
+		U32 numEntries;
+		U32 numSlots;
+		U32 pathPoolSize;
+		U32 dataOffset;
+	};
+	
+	struct Entry {
+		/** Hash of the path */
+		U32 hash;
+		
+		/** Offset of the path in the path pool */
+		U32 path;
+		
+		/** Length of the path */
+		U32 pathLength;
+		
+		/** Offset of the contents from the start of the archive */
+		U32 offset;
+		
+		/** Size of the contents, in bytes */
+		U32 size;
+	};
+	
+	/**
+	Checks that the archive is intact, so that lookups need no checks
+	@return true if the archive may be read
+	*/
+	bool validate();
+	
+	/** Contents of the archive */
+	FileMapping file;
+	
+	const Header *header;
+	const Entry *entries;
+	
+	/** Hash table slots, each holding an entry index+1 or zero */
+	const U32 *slots;
+	
+	const char *paths;
+};
+
+#endif
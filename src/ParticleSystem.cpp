@@ -16,14 +16,14 @@ ParticleSystem::ParticleSystem(const FileName &fileName,
 	loadParticleEmitters(data);
 	setPosition(_position);
 	
-	// allocate memory for all particle batches
+	// allocate memory for all particle batches, which are rebuilt every frame
 	for (map<string, ParticleElement>::const_iterator i=templatesByName.begin(); i!=templatesByName.end(); ++i) {
 		const ParticleElement &el = i->second;
 		ParticleBatch &batch = buckets[el.getMaterial()];
 		
-		batch.geometry.colorsArray   -> recreate(4 * (int)maxNumberOfParticles, 0, DYNAMIC_DRAW);
-		batch.geometry.vertexArray   -> recreate(4 * (int)maxNumberOfParticles, 0, DYNAMIC_DRAW);
-		batch.geometry.texCoordArray -> recreate(4 * (int)maxNumberOfParticles, 0, DYNAMIC_DRAW);
+		batch.geometry.colorsArray   -> recreate(4 * (int)maxNumberOfParticles, 0, STREAM_DRAW);
+		batch.geometry.vertexArray   -> recreate(4 * (int)maxNumberOfParticles, 0, STREAM_DRAW);
+		batch.geometry.texCoordArray -> recreate(4 * (int)maxNumberOfParticles, 0, STREAM_DRAW);
 	}
 }
 
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "color.h"
+#include "Mesh.h"
 #include "PhysicsEngine.h"
 #include "EventCollisionOccurred.h"
 
@@ -90,6 +91,16 @@ PhysicsEngine::PhysicsEngine(ActorSet *_actorSet)
 	
 	dWorldSetGravity(world, 0.0f, 0.0f, -9.81f);
 	
+	/*
+	Bodies that come to rest are disabled by ODE so that the simulation
+	cost scales with the number of moving bodies. Actors with a disabled
+	body are allowed to fall asleep (see Actor::sleep).
+	*/
+	dWorldSetAutoDisableFlag(world, 1);
+	dWorldSetAutoDisableLinearThreshold(world, 0.01f);
+	dWorldSetAutoDisableAngularThreshold(world, 0.01f);
+	dWorldSetAutoDisableSteps(world, 10);
+	
 	dCreatePlane(space, 0, 0, 1, 0); // catch spills
 	
 	ray = dCreateRay(0, 10.0f);
@@ -307,6 +318,57 @@ void PhysicsEngine::drawGeomAABB(dGeomID geom) {
 	CHECK_GL_ERROR();
 }
 
+tuple<dGeomID,dTriMeshDataID> PhysicsEngine::createTriMesh(const Mesh &mesh) const {
+	ResourceBufferVertices &vertexArray = *mesh.vertexArray;
+	ResourceBufferIndices &indexArray = *mesh.indexArray;
+	
+	dVector3 *triVert = new dVector3[vertexArray.getNumber()];
+	
+	// Convert vertices to a format that ODE can accept
+	{
+		const vec3 *vertices = (const vec3 *)vertexArray.read_lock();
+		for (index_t i=0; i < (index_t)vertexArray.getNumber(); ++i) {
+			triVert[i][0] = vertices[i].x;
+			triVert[i][1] = vertices[i].y;
+			triVert[i][2] = vertices[i].z;
+		}
+		vertexArray.unlock();
+	}
+	
+	int *indexes = new int[indexArray.getNumber()];
+	
+	// Convert indices to a format that ODE can accept
+	{
+		const index_t *indices = (const index_t*)indexArray.read_lock();
+		for (int i=0; i<indexArray.getNumber(); ++i) {
+			indexes[i] = (int)indices[i];
+		}
+		indexArray.unlock();
+	}
+	
+	return createTriMesh(space,
+	                     (const dVector3*)triVert,
+	                     vertexArray.getNumber(),
+	                     (const int*)indexes,
+	                     indexArray.getNumber());
+}
+
+tuple<dGeomID,dTriMeshDataID> PhysicsEngine::createTriMesh(dSpaceID physicsSpace,
+  const dVector3 *vertices,
+  int numVertices,
+  const int *indices, // in ODE format
+  int numIndices) {
+	dTriMeshDataID meshID = dGeomTriMeshDataCreate();
+	dGeomTriMeshDataBuildSimple(meshID,
+	                            (const dReal*)vertices,
+	                            numVertices,
+	                            indices,
+	                            numIndices);
+	dGeomID geom = dCreateTriMesh(physicsSpace, meshID, 0, 0, 0);
+	dGeomSetPosition(geom, 0.0, 0.0, 0.0);
+	return make_tuple(geom, meshID);
+}
+
 vec3 PhysicsEngine::getPosition(dGeomID geom) {
 	const dReal* p = dGeomGetPosition(geom);
 	return vec3((float)p[0], (float)p[1], (float)p[2]);
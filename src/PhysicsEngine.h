@@ -4,6 +4,8 @@
 #include "Actor.h"
 #include "ActorSet.h"
 
+class Mesh;
+
 class PhysicsEngine {
 public:
 	typedef function<void (dGeomID, dContact)> CollisionFn;
@@ -45,6 +47,14 @@ public:
 		return contactGroup;
 	}
 	
+	/**
+	Creates a geometry object in the physics space that uses a mesh's
+	geometry. The mesh must still have its client-side copies.
+	@param mesh Mesh to copy the triangles of
+	@return geometry object and the triangle data it uses
+	*/
+	tuple<dGeomID,dTriMeshDataID> createTriMesh(const Mesh &mesh) const;
+	
 	void nearCallback(dGeomID o1, dGeomID o2);
 	
 	void rayCallback(dGeomID ray, dGeomID o);
@@ -132,6 +142,13 @@ private:
 	static void drawGeomRay(dGeomID geom);
 	static void drawBox(dVector3 sides);
 	
+	/** Creates a geometry object from triangles in ODE's formats */
+	static tuple<dGeomID,dTriMeshDataID> createTriMesh(dSpaceID physicsSpace,
+	  const dVector3 *verts,
+	  int numVertices,
+	  const int *indices,
+	  int numIndices);
+	  
 	/** From the ODE sample code */
 	static void drawPatch(float p1[3], float p2[3], float p3[3], int level);
 	
@@ -10,22 +10,181 @@ McCuskey, Mason. "Game Programming Tricks of the Trade".
 
 #include "Core.h"
 #include "FileFuncs.h"
+#include "FileMapping.h"
 #include "FileText.h"
 #include "PropertyBag.h"
+#include "PropertyBagParser.h"
+#include "PropertyBagBinary.h"
+#include "PropertyBagStorage.h"
+#include "VirtualFileSystem.h"
+#include "AssetCache.h"
+
+/**
+Writes the items of a node as XML
+@param node Bag to write
+@param indentlevel Indentation level of the resultant XML code
+@param out Receives the XML
+*/
+static void saveNode(const PropertyBagNode &node, int indentlevel, string &out) {
+	const string indent(indentlevel, '\t');
+	
+	// Cycle through all the tags in this bag, in order of their names
+	vector<const PropertyBagGroup*> groups;
+	node.sort(groups);
+	
+	for (vector<const PropertyBagGroup*>::const_iterator i = groups.begin();
+	     i != groups.end(); ++i) {
+		const PropertyBagGroup &group = **i;
+		
+		for (size_t j=0; j<group.count; ++j) {
+			const PropertyBagValue &value = group.values[j];
+			
+			out += indent;
+			out += "<";
+			out.append(group.key->text, group.key->length);
+			
+			if (value.bag) {
+				// Put a new line after the opening tag, then indent and put the data
+				out += ">\n";
+				saveNode(*value.bag, indentlevel+1, out);
+				out += indent;
+			} else {
+				// Everything on one line
+				out += ">";
+				out.append(value.text, value.length);
+			}
+			
+			out += "</";
+			out.append(group.key->text, group.key->length);
+			out += ">\n";
+		}
+	}
+}
 
-PropertyBagItem::~PropertyBagItem() {}
+/** Determines whether two nodes hold equal items */
+static bool nodesAreEqual(const PropertyBagNode &l, const PropertyBagNode &r) {
+	if (l.numGroups != r.numGroups) {
+		return false;
+	}
+	
+	vector<const PropertyBagGroup*> lgroups, rgroups;
+	l.sort(lgroups);
+	r.sort(rgroups);
+	
+	for (size_t i=0; i<lgroups.size(); ++i) {
+		const PropertyBagGroup &lgroup = *lgroups[i];
+		const PropertyBagGroup &rgroup = *rgroups[i];
+		
+		if (lgroup.key->length != rgroup.key->length ||
+		    memcmp(lgroup.key->text, rgroup.key->text, lgroup.key->length) != 0 ||
+		    lgroup.count != rgroup.count) {
+			return false;
+		}
+		
+		for (size_t j=0; j<lgroup.count; ++j) {
+			const PropertyBagValue &lvalue = lgroup.values[j];
+			const PropertyBagValue &rvalue = rgroup.values[j];
+			
+			if (lvalue.bag && rvalue.bag) {
+				if (!nodesAreEqual(*lvalue.bag, *rvalue.bag)) {
+					return false;
+				}
+			} else if (lvalue.bag || rvalue.bag ||
+			           lvalue.length != rvalue.length ||
+			           memcmp(lvalue.text, rvalue.text, lvalue.length) != 0) {
+				return false;
+			}
+		}
+	}
+	
+	return true;
+}
 
-PropertyBagItem::PropertyBagItem() {}
+/** Gets the string data of an item, or the XML of a nested bag */
+static string getText(const PropertyBagValue &value) {
+	if (value.bag) {
+		string out;
+		saveNode(*value.bag, 0, out);
+		return out;
+	} else {
+		return string(value.text, value.length);
+	}
+}
 
-bool PropertyBagItem::operator!=( const PropertyBagItem &r ) {
-	return(!((*this) == r));
+/**
+Checks that an item has a pre-parsed value of a particular kind
+@param value Item, possibly null
+@param type Acceptable kind of pre-parsed value
+@param alternative Another acceptable kind of pre-parsed value
+@param count Minimum number of components in the pre-parsed value
+@return the item, or null if the item must be parsed from its string data
+*/
+static const PropertyBagValue* typed(const PropertyBagValue *value,
+                                     PropertyBagValue::Type type,
+                                     PropertyBagValue::Type alternative,
+                                     size_t count) {
+	if (value &&
+	    !value->bag &&
+	    (value->type == type || value->type == alternative) &&
+	    value->numNumbers >= count) {
+		return value;
+	}
+	
+	return 0;
 }
 
-string PropertyBagString::save(int) const {
-	return(itemData);
+/**
+Merges the items of one node into another
+@param document Document of the node being modified
+@param node Node to receive the new items
+@param newStuff Node holding the new items, from any other document
+@param overwrite If true, then conflicts are resolved by overwriting
+the existing elements.
+*/
+static void mergeNodes(PropertyBagDocument &document,
+                       PropertyBagNode *node,
+                       const PropertyBagNode &newStuff,
+                       bool overwrite) {
+	vector<const PropertyBagGroup*> groups;
+	newStuff.sort(groups);
+	
+	for (vector<const PropertyBagGroup*>::const_iterator i = groups.begin();
+	     i != groups.end(); ++i) {
+		const PropertyBagKey *tagName = (*i)->key;
+		
+		for (size_t j=0; j<(*i)->count; ++j) {
+			const PropertyBagValue &tagItem = (*i)->values[j];
+			
+			const PropertyBagGroup *existing =
+			 node->find(tagName->text, tagName->length, tagName->hash);
+			
+			if (!tagItem.bag) { // if the item is a string
+				if (!existing) {
+					document.appendCopy(node, tagName, tagItem);
+				} else if (overwrite) {
+					document.remove(node, tagName->text, tagName->length);
+					document.appendCopy(node, tagName, tagItem);
+				}
+			} else if (!existing) {
+				// if it doesn't exist, just add the bag (easy!)
+				document.appendCopy(node, tagName, tagItem);
+			} else if (!existing->values[0].bag) {
+				/*
+				The tag we are trying to add is a PropertyBag,
+				but it is possible that the existing tag is a
+				string.  If this is the case, we should *always*
+				overwrite the existing tag.
+				*/
+				document.remove(node, tagName->text, tagName->length);
+				document.appendCopy(node, tagName, tagItem);
+			} else {
+				mergeNodes(document, existing->values[0].bag, *tagItem.bag, overwrite);
+			}
+		}
+	}
 }
 
-string PropertyBagString::makeStringSafe(const string &str) {
+string PropertyBag::makeStringSafe(const string &str) {
 	/*
 	replace all &'s with &amp's
 	replace all <'s with &lt's
@@ -37,91 +196,71 @@ string PropertyBagString::makeStringSafe(const string &str) {
 	               ">", "&gt;");
 }
 
-string PropertyBagString::restoreFromSafeString(const string &str) {
-	/*
-	replace all &amp's with &'s
-	replace all &lt's with <'s
-	replace all &gt's with >'s
-	*/
-	
-	return replace(replace(replace(str, "&amp;", "&"),
-	                       "&lt;",  "<"),
-	               "&gt;",  ">");
-}
+PropertyBag::PropertyBag()
+		: node(0) {}
 
-bool PropertyBagString::operator==( const PropertyBagItem &r ) const {
-	return(itemData == static_cast<const PropertyBagString &>(r).itemData);
-}
+PropertyBag::PropertyBag(const PropertyBag &r)
+		: document(r.document),
+		node(r.node) {}
 
-const string& PropertyBagString::getName( void ) const {
-	return itemName;
+PropertyBag::PropertyBag(const string &s)
+		: node(0) {
+	loadMergeFromString(s);
 }
 
-const string& PropertyBagString::setName( const string &name ) {
-	itemName = name;
-	return itemName;
-}
+PropertyBag::~PropertyBag() {}
 
-const string& PropertyBagString::setData( const string &data, bool convert ) {
-	if (convert) {
-		itemData = makeStringSafe(data);
-		itemHasBeenConverted = true;
-	} else {
-		itemData = data;
-		itemHasBeenConverted = false;
+/**
+Memory that bags loaded from file may keep resident. Copies of a cached bag
+share its document, so evicting the bag never frees a document in use.
+*/
+static const size_t PROPERTY_BAG_BUDGET = 8 * 1024 * 1024;
+
+/**
+Cache of bags loaded with fromFile. Constructed during static initialization,
+before any thread can load a bag.
+*/
+static AssetCache<PropertyBag> fileCache("Property bags", PROPERTY_BAG_BUDGET);
+
+PropertyBag PropertyBag::fromFile(const FileName &fileName) {
+	shared_ptr<PropertyBag> bag = fileCache.find(fileName);
+	
+	if (!bag) {
+		bag = shared_ptr<PropertyBag>(new PropertyBag());
+		VERIFY(bag->loadFromFile(fileName),
+		       "Failed to load data from file: " + fileName.str());
+		fileCache.insert(fileName, bag, bag->getMemoryUsage());
 	}
 	
-	return itemData;
+	// The copy shares the cached document, and copies it only if modified
+	return *bag;
 }
 
-string PropertyBagString::getData( void ) const {
-	if (itemHasBeenConverted) {
-		return restoreFromSafeString(itemData);
-	} else {
-		return itemData;
+void PropertyBag::invalidate(const FileName &fileName) {
+	fileCache.remove(fileName);
+	
+	// Bags are cached by the name of the source file, even when cooked
+	if (fileName == PropertyBagBinary::getCookedFileName(fileName)) {
+		fileCache.remove(FileName(FileName::stripExtension(fileName.str()) + ".xml"));
 	}
 }
 
-PropertyBagString::PropertyBagString(const string &data, bool convert) {
-	setData(data, convert);
-}
-
-PropertyBagString::PropertyBagString(const string &name,
-                                     const string &data,
-                                     bool convert ) {
-	setData(data, convert);
-	setName(name);
-}
-
-PropertyBagString::~PropertyBagString() {}
-
-PropertyBag::PropertyBag() {
-	clear();
+size_t PropertyBag::getMemoryUsage() const {
+	return document ? document->arena.getSize() : 0;
 }
 
-PropertyBag::PropertyBag(const PropertyBag &r)
-		: PropertyBagItem(r) {
-	copy(r);
-}
-
-PropertyBag::PropertyBag(const string &s) {
-	clear();
-	loadMergeFromString(s);
-}
-
-PropertyBag::~PropertyBag() {
-	while (!data.empty()) {
-		PropertyMap::iterator i = data.begin();
-		delete(i->second);
-		data.erase(i);
+PropertyBagNode* PropertyBag::getNodeForWriting() {
+	if (!document) {
+		document = shared_ptr<PropertyBagDocument>(new PropertyBagDocument());
+		node = document->createNode();
+	} else if (!document.unique()) {
+		// Copy on write, so that other views of the document are unaffected
+		shared_ptr<PropertyBagDocument> copy(new PropertyBagDocument());
+		node = copy->copy(*node);
+		document = copy;
 	}
-}
-
-PropertyBag PropertyBag::fromFile(const FileName &fileName) {
-	PropertyBag bag;
-	VERIFY(bag.loadFromFile(fileName),
-	       "Failed to load data from file: " + fileName.str());
-	return bag;
+	
+	return node;
 }
 
 void PropertyBag::add(const string& key, const char* contents, bool convert) {
@@ -129,7 +268,10 @@ void PropertyBag::add(const string& key, const char* contents, bool convert) {
 }
 
 void PropertyBag::add(const string& key, const string &contents, bool convert) {
-	data.insert(make_pair(key, new PropertyBagString(key, contents, convert)));
+	const string data = convert ? makeStringSafe(contents) : contents;
+	PropertyBagNode *parent = getNodeForWriting();
+	PropertyBagValue *value = document->append(parent, key.data(), key.length());
+	document->setText(value, data.data(), data.length());
 }
 
 void PropertyBag::add(const string& key, int data) {
@@ -161,49 +303,32 @@ void PropertyBag::add(const string& key, float data) {
 }
 
 void PropertyBag::add(const string& key, const PropertyBag &contents) {
-	if (!contents.data.empty()) {
-		data.insert(make_pair(key, new PropertyBag(contents)));
+	if (!contents.node || contents.node->numGroups == 0) {
+		return;
 	}
+	
+	// Keep the contents alive, even if they are a part of this bag
+	const PropertyBag source(contents);
+	PropertyBagNode *parent = getNodeForWriting();
+	PropertyBagNode *bag = document->copy(*source.node);
+	document->setBag(document->append(parent, key.data(), key.length()), bag);
 }
 
 void PropertyBag::remove(const string &key) {
-	while (data.count(key)!=0) {
-		PropertyMap::iterator i = data.lower_bound(key);
-		delete(i->second);
-		data.erase(i);
+	if (getNumInstances(key) == 0) {
+		return;
 	}
 	
+	PropertyBagNode *parent = getNodeForWriting();
+	document->remove(parent, key.data(), key.length());
+	
 	ASSERT(getNumInstances(key)==0,
 	       "Failed to remove items sharing key: " + key);
 }
 
-#if 1
 void PropertyBag::remove(const string &key, int) {
-	if (data.empty()) return;
-	data.erase(key);
+	remove(key);
 }
-#else
-void PropertyBag::remove(const string &key, int instance) {
-	if (data.empty()) return;
-
-	PropertyMap::iterator i;
-	PropertyMap::iterator stop = data.upper_bound(key);
-	stop++;
-
-	i = data.lower_bound(key);
-
-	if (i == data.end()) return; // nothing to remove
-
-	for (int q=0; q < instance; q++, i++);
-
-	if (i != data.end()) {
-		do {
-			delete((*i).second);
-			data.erase(i);
-		} while (!data.empty() && (i++ != stop));
-	}
-}
-#endif
 
 void PropertyBag::saveToFile(const FileName &fileName, int indentLevel) const {
 	FileText file;
@@ -213,192 +338,103 @@ void PropertyBag::saveToFile(const FileName &fileName, int indentLevel) const {
 
 string PropertyBag::save(int indentlevel) const {
 	string out;
-	string indent(indentlevel, '\t');
-	
-	// Cycle through all the tags in this bag
-	for (PropertyMap::const_iterator i = data.begin(); i != data.end(); i++) {
-		PropertyBagItem *data = (*i).second; // Tag Value can be retrieved
-		string key = (*i).first; // Tag Name
-		string line; // TagValue is put in here
-		string withname; // <TagName>TagValue</TagName> in here
-		
-		// Dynamic cast will return NULL if data is not a CPropBag object
-		bool IsBag = dynamic_cast<PropertyBag*>(data) != NULL;
+	
+	if (node) {
+		saveNode(*node, indentlevel, out);
+	}
+	
+	return out;
+}
+
+#ifndef NDEBUG
+/** Logs the time taken to load a file, for comparing load times */
+static void traceLoadTime(const FileName &fileName, clock_t start) {
+	const double elapsed = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+	TRACE("Loaded " + fileName.str() + " in " + ftos((float)elapsed, 6) + "ms");
+}
+#endif
+
+bool PropertyBag::loadFromFile(const FileName &filename, bool merge) {
+#ifndef NDEBUG
+	const clock_t start = clock();
+#endif
+	
+	// Prefer the cooked form of the file, when there is one
+	if (PropertyBagBinary::isCookedFileUsable(filename)) {
+		const FileName cookedFileName = PropertyBagBinary::getCookedFileName(filename);
 		
-		/*
-		Get the tag value as a string.  CPropItem::Save() does this for us.
-		Note that if the data is a CPropString, then line is simple the
-		string's value. However, if the data is a CPropBag, then this function
-		recurses to make line = bag (If the conversion exists, have the data
-		be indented like a property bag should be)
-		*/
-		line = data->save(IsBag ? indentlevel+1 : indentlevel);
+		if (!merge) {
+			clear();
+		}
 		
-		if (IsBag) {
-			// Put a new line after the opening tag, then indent and put the data
-			withname  = indent;
-			withname += "<";
-			withname += key;
-			withname += ">\n";
-			withname += line;
-			withname += indent;
-			withname += "</";
-			withname += key;
-			withname += ">\n";
-		} else {
-			// Everything on one line
-			withname  = indent;
-			withname += "<";
-			withname += key;
-			withname += ">";
-			withname += line;
-			withname += "</";
-			withname += key;
-			withname += ">\n";
+		if (!PropertyBagBinary::loadFromFile(cookedFileName, *this)) {
+			FAIL("Failed to load cooked file: " + cookedFileName.str());
+			return false;
 		}
 		
-		// Add this tag to the total string dump of the property bag
-		out += withname;
+#ifndef NDEBUG
+		traceLoadTime(cookedFileName, start);
+#endif
+		
+		return true;
 	}
 	
-	return(out);
-}
-
-bool PropertyBag::loadFromFile(const FileName &filename, bool merge) {
-	if (!isFileOnDisk(filename)) {
+	if (!VirtualFileSystem::exists(filename)) {
 		ERR("File not found: " + filename.str());
 		return false;
 	}
 	
-	FileText file;
+	const FileMapping file(filename);
 	
-	if (!file.openStream(filename, File::FILE_MODE_READ)) {
+	if (!file.isOpen()) {
 		ERR("File failed to load: " + filename.str());
 		return false;
 	}
 	
-	const string fileContents = file.getFullText();
-	
-	// Load / Merge the data
+	// Load / Merge the data, parsing the file contents in place
 	if (!merge) {
-		data.clear();
+		clear();
 	}
 	
-	if (!loadMergeFromString(fileContents)) {
+	if (!PropertyBagParser::parse(file.begin(), file.end(), *this)) {
 		FAIL("Failed to merge file contents on load: " + filename.str());
 		return false;
 	}
 	
+#ifndef NDEBUG
+	traceLoadTime(filename, start);
+#endif
+	
 	return true;
 }
 
 bool PropertyBag::loadMergeFromString(const string &data) {
-	enum eElanPropBagReadState {
-		SearchingForOpenTag,
-		ReadingOpenTag,
-		ReadingTagContents
-	} curstate = SearchingForOpenTag;
-	
-	string tagname;
-	string tagvalue;
-	string closetag;
-	
-	unsigned char previous=0;
-	string possibleClosingTag;
-	bool isPossibleClosingTag=false;
-	
-	for (string::const_iterator iter = data.begin(); iter != data.end(); ++iter) {
-		const unsigned char b = (unsigned char)(*iter);
-		
-		switch (curstate) {
-		case SearchingForOpenTag: {
-			if (b == '<') {
-				// we've found our open tag!
-				curstate = ReadingOpenTag;
-			}
-		}
-		break;
-		
-		case ReadingOpenTag: {
-			if (b == '>') {
-				// end of tag
-				curstate = ReadingTagContents;
-				closetag = "</" + tagname + ">";
-			} else {
-				// add the character to the name of the tag
-				tagname += b;
-			}
-		}
-		break;
-		
-		case ReadingTagContents: {
-			// Add the character to the contents of the tag
-			tagvalue += b;
-			
-			// If we are possibly reading the closing tag now
-			if (isPossibleClosingTag) {
-				// Build the string for what may be the closing tag
-				possibleClosingTag += b;
-				
-				// Otherwise, search for the real closing tag
-				if (possibleClosingTag == closetag) {
-					// Remove that closing tag from the tag contents
-					tagvalue = replace(tagvalue, closetag, "");
-					
-					// Put the completed tag into the bag here
-					insertTag(tagname, tagvalue);
-					
-					// Reset the state
-					curstate = SearchingForOpenTag;
-					tagname = "";
-					tagvalue = "";
-				}
-				
-				// Has it become impossible that this is the closing tag?
-				if (b == '>') {
-					isPossibleClosingTag = false;
-				}
-			}
-			
-			// Have we begun to encounter what may be the closing tag?
-			if (previous == '<' && b == '/') {
-				isPossibleClosingTag = true;
-				possibleClosingTag = "</";
-			}
-		}
-		break;
-		}
-		; // end switch
-		
-		previous = b;
-	}
-	
-	return(true);
+	const char *begin = data.data();
+	return PropertyBagParser::parse(begin, begin + data.length(), *this);
 }
 
-void PropertyBag::insertTag(const string &tagName, const string &tagValue) {
-	PropertyBagItem *item = 0;
+const PropertyBagValue* PropertyBag::find(const string &key,
+                                          size_t instance) const {
+	if (!node) {
+		return 0;
+	}
 	
-	// a < and > mean it's a bag within a bag
-	if (tagValue.find("<") != string::npos && tagValue.find(">") != string::npos) {
-		item = new PropertyBag(tagValue);
-	} else {
-		item = new PropertyBagString(tagName, tagValue, false);
+	const PropertyBagGroup *group =
+	 node->find(key.data(),
+	            key.length(),
+	            PropertyBagDocument::hash(key.data(), key.length()));
+	
+	if (!group || instance >= group->count) {
+		return 0;
 	}
 	
-	data.insert(make_pair(tagName, item));
+	return &group->values[instance];
 }
 
 bool PropertyBag::get(const string& key, string &dest, size_t instance) const {
-	if (data.find(key) == data.end())
-		return(false);
-		
-	PropertyMap::const_iterator iter = data.lower_bound(key);
-	
-	for (size_t q=0; q < instance; q++) iter++;
-	
-	dest = (iter->second)->save();
-	
+	const PropertyBagValue *value = find(key, instance);
+	if (!value) return(false);
+	dest = getText(*value);
 	return(true);
 }
 
@@ -410,45 +446,60 @@ bool PropertyBag::get(const string &key, FileName &dest, size_t instance) const
 }
 
 bool PropertyBag::get(const string& key, int &dest, size_t instance) const {
-	string str;
-	if (!get(key, str, instance)) return(false);
-	dest = stoi(str);
+	const PropertyBagValue *value = find(key, instance);
+	if (!value) return(false);
+	dest = value->bag ? stoi(getText(*value)) :
+	       value->length==0 ? -1 : atoi(value->text);
 	return(true);
 }
 
 bool PropertyBag::get(const string& key, size_t &dest, size_t instance) const {
-	string str;
-	if (!get(key, str, instance)) return(false);
-	dest = static_cast<size_t>(stoi(str));
+	int x = 0;
+	if (!get(key, x, instance)) return(false);
+	dest = static_cast<size_t>(x);
 	return(true);
 }
 
 bool PropertyBag::get(const string& key, double &dest, size_t instance) const {
-	string str;
-	if (!get(key, str, instance)) return(false);
-	dest = stof(str);
+	float x = 0.0f;
+	if (!get(key, x, instance)) return(false);
+	dest = x;
 	return(true);
 }
 
 bool PropertyBag::get(const string& key, float &dest, size_t instance) const {
-	string str;
-	if (!get(key, str, instance)) return(false);
-	dest = stof(str);
-	return(true);
+	const PropertyBagValue *value = find(key, instance);
+	
+	if (!value) {
+		return false;
+	}
+	
+	if (typed(value, PropertyBagValue::VALUE_NUMBER,
+	          PropertyBagValue::VALUE_NUMBER, 1)) {
+		dest = value->numbers[0];
+	} else {
+		dest = value->bag ? stof(getText(*value)) : (float)atof(value->text);
+	}
+	
+	return true;
 }
 
 bool PropertyBag::get(const string& key, bool &dest, size_t instance) const {
-	string str;
+	const PropertyBagValue *value = find(key, instance);
 	
-	if (!get(key, str, instance)) return(false);
+	if (!value) return(false);
 	
-	str = toLowerCase(str);
+	const char *str = value->text;
 	
-	dest = (str == "true");
+	dest = !value->bag &&
+	       value->length == 4 &&
+	       tolower(str[0]) == 't' &&
+	       tolower(str[1]) == 'r' &&
+	       tolower(str[2]) == 'u' &&
+	       tolower(str[3]) == 'e';
 	
 	return(true);
 }
-
 bool PropertyBag::get(const string &key, ivec2 &vec, size_t instance) const {
 	string _s;
 	
@@ -465,10 +516,10 @@ bool PropertyBag::get(const string &key, ivec2 &vec, size_t instance) const {
 	
 	if (i == tokens.end())
 		return false;
-		
+	
 	if (string(*i) != "&ivec2")
 		return false;
-		
+	
 	vec.x = stoi(*(++i));
 	vec.y = stoi(*(++i));
 	
@@ -476,6 +527,17 @@ bool PropertyBag::get(const string &key, ivec2 &vec, size_t instance) const {
 }
 
 bool PropertyBag::get(const string &key, vec2 &vec, size_t instance) const {
+	const PropertyBagValue *item =
+	 typed(find(key, instance), PropertyBagValue::VALUE_VEC2,
+	       PropertyBagValue::VALUE_VEC, 2);
+	
+	if (item) {
+		const float *numbers = item->numbers;
+		vec.x = numbers[0];
+		vec.y = numbers[1];
+		return true;
+	}
+	
 	string s;
 	
 	if (!get(key, s, instance)) {
@@ -488,6 +550,18 @@ bool PropertyBag::get(const string &key, vec2 &vec, size_t instance) const {
 }
 
 bool PropertyBag::get(const string &key, vec3 &vec, size_t instance) const {
+	const PropertyBagValue *item =
+	 typed(find(key, instance), PropertyBagValue::VALUE_VEC3,
+	       PropertyBagValue::VALUE_VEC, 3);
+	
+	if (item) {
+		const float *numbers = item->numbers;
+		vec.x = numbers[0];
+		vec.y = numbers[1];
+		vec.z = numbers[2];
+		return true;
+	}
+	
 	string s;
 	
 	if (!get(key, s, instance)) {
@@ -500,6 +574,19 @@ bool PropertyBag::get(const string &key, vec3 &vec, size_t instance) const {
 }
 
 bool PropertyBag::get(const string &key, vec4 &vec, size_t instance) const {
+	const PropertyBagValue *item =
+	 typed(find(key, instance), PropertyBagValue::VALUE_VEC4,
+	       PropertyBagValue::VALUE_VEC, 4);
+	
+	if (item) {
+		const float *numbers = item->numbers;
+		vec.x = numbers[0];
+		vec.y = numbers[1];
+		vec.z = numbers[2];
+		vec.w = numbers[3];
+		return true;
+	}
+	
 	string s;
 	
 	if (!get(key, s, instance)) {
@@ -512,6 +599,19 @@ bool PropertyBag::get(const string &key, vec4 &vec, size_t instance) const {
 }
 
 bool PropertyBag::get(const string &key, color &c, size_t instance) const {
+	const PropertyBagValue *item =
+	 typed(find(key, instance), PropertyBagValue::VALUE_COLOR,
+	       PropertyBagValue::VALUE_COLOR, 4);
+	
+	if (item) {
+		const float *numbers = item->numbers;
+		c.r = numbers[0];
+		c.g = numbers[1];
+		c.b = numbers[2];
+		c.a = numbers[3];
+		return true;
+	}
+	
 	string s;
 	
 	if (!get(key, s, instance)) {
@@ -526,26 +626,19 @@ bool PropertyBag::get(const string &key, color &c, size_t instance) const {
 bool PropertyBag::get(const string& key,
                       PropertyBag &dest,
                       size_t instance) const {
-	if (data.find(key)==data.end())
+	const PropertyBagValue *value = find(key, instance);
+	
+	if (!value)
 		return false;
-		
-	PropertyMap::const_iterator iter;
-	
-	// check that the desired instance exists
-	ASSERT(instance<getNumInstances(key),
-	       "parameter \'instance\' is incorrect: " + sizet_to_string(instance));
-	       
-	// go to the desired instance
-	iter = data.lower_bound(key);
-	for (size_t q=0; q < instance; q++) iter++;
-	
-	ASSERT(dynamic_cast<PropertyBag*>(iter->second)!=0,
-	       "iter->second cannot be cast to a PropertyBag object: " \
-	       "key = \"" + key + "\"");
-	       
+	
+	ASSERT(value->bag != 0,
+	       "Item is not a PropertyBag: key = \"" + key + "\"");
+	
 	// I would rather have invalid behavior than a crash
-	if (dynamic_cast<PropertyBag*>(iter->second)!=0) {
-		dest = dynamic_cast<PropertyBag&>(*iter->second);
+	if (value->bag) {
+		// Share the document rather than copying the items
+		dest.document = document;
+		dest.node = value->bag;
 		return true;
 	} else {
 		return false;
@@ -555,19 +648,19 @@ bool PropertyBag::get(const string& key,
 string PropertyBag::getString(const string &key, size_t instance) const {
 	ASSERT(getNumInstances(key) > 0,
 	       "Key \"" + key + "\" not found");
-	       
+	
 	ASSERT(getNumInstances(key) > instance,
 	       "Not enough instances of key: " + key +
 	       " (wanted instance #" + sizet_to_string(instance) +
 	       " of only " + sizet_to_string(getNumInstances(key)) + ")");
-	       
+	
 	string x = "nill";
 	
 	VERIFY(get(key, x, instance),
 	       "Failed to get string from PropertyBag: " + key +
 	       " (wanted instance #" + sizet_to_string(instance) +
 	       " of " + sizet_to_string(getNumInstances(key)) + ")");
-	       
+	
 	return x;
 }
 
@@ -656,118 +749,50 @@ color PropertyBag::getColor(const string &key, size_t instance) const {
 }
 
 size_t PropertyBag::getNumInstances(const string &key) const {
-	return data.count(key);
+	if (!node) {
+		return 0;
+	}
+	
+	const PropertyBagGroup *group =
+	 node->find(key.data(),
+	            key.length(),
+	            PropertyBagDocument::hash(key.data(), key.length()));
+	
+	return group ? group->count : 0;
 }
 
 void PropertyBag::clear() {
-	for (PropertyMap::iterator propIter = data.begin();
-	     propIter != data.end(); ++propIter) {
-		delete(propIter->second);
-	}
-	data.clear();
+	document.reset();
+	node = 0;
 }
 
-void PropertyBag::copy(const PropertyBag &copyMe) {
-	clear();
-	
-	for (PropertyMap::const_iterator iter = copyMe.data.begin();
-	     iter != copyMe.data.end();
-	     ++iter) {
-		// alias the iterator's pair
-		const string &tagName = iter->first;
-		const PropertyBagItem *tagItem = iter->second;
-		
-		const PropertyBagString *pStr =
-		 dynamic_cast<const PropertyBagString*>(tagItem);
-		 
-		if (pStr) { // if the item is a PropertyBagString
-			add(tagName, pStr->getData(), false);
-		} else {
-			const PropertyBag *pBag = dynamic_cast<const PropertyBag*>(tagItem);
-			
-			if (pBag) { // if the item is a PropertyBag
-				add(tagName, *pBag);
-			}
-		}
-	} // loop
+void PropertyBag::merge(const PropertyBag &newStuff, bool overwrite) {
+	if (!newStuff.node) {
+		return;
+	}
 	
-	ASSERT(copyMe == (*this), "Failed to copy bag");
-}
-
-void PropertyBag::merge(const PropertyBag &newstuff, bool overwrite) {
-	for (PropertyMap::const_iterator newiter = newstuff.data.begin();
-	     newiter != newstuff.data.end();
-	     ++newiter) {
-		// alias the iterator's pair
-		const string &tagName = newiter->first;
-		const PropertyBagItem *tagItem = newiter->second;
-		
-		const bool tagAlreadyExists = data.find(tagName)!=data.end();
-		
-		const PropertyBagString *pStr =
-		 dynamic_cast<const PropertyBagString*>(tagItem);
-		const PropertyBag *pBag = dynamic_cast<const PropertyBag*>(tagItem);
-		
-		if (pStr) { // if the item is a PropertyBagString
-			if (!tagAlreadyExists) {
-				add(tagName, pStr->getData(), false);
-			} else if (overwrite && tagAlreadyExists) {
-				remove(tagName);
-				add(tagName, pStr->getData(), false);
-			}
-		}
-		
-		if (pBag) { // if the item is a PropertyBag
-			// if it doesn't exist, just add the bag (easy!)
-			if (!tagAlreadyExists) {
-				add(tagName, *pBag);
-			} else {
-				PropertyBagItem *originalItem = data.find(tagName)->second;
-				ASSERT(originalItem != 0, "originalItem was null!");
-				
-				/*
-				The tag we are trying to add is a PropertyBag,
-				but it is possible that the existing tag is a
-				PropertyBagString.  If this is the case, we
-				should *always* overwrite the existing tag.
-				*/
-				
-				if (dynamic_cast<const PropertyBagString*>(originalItem) != 0) {
-					remove(tagName);
-					add(tagName, *pBag);
-				} else {
-					(dynamic_cast<PropertyBag&>(*originalItem)).merge(*pBag,
-					  overwrite);
-				}
-			}
-		}
-	} // loop
+	// Keep the new items alive, even if they are a part of this bag
+	const PropertyBag source(newStuff);
+	PropertyBagNode *parent = getNodeForWriting();
+	mergeNodes(*document, parent, *source.node, overwrite);
 }
 
 bool PropertyBag::operator==(const PropertyBag &r) const {
-	if (r.data.size() != data.size())
-		return false;
-		
-	PropertyMap::const_iterator riter = r.data.begin();
-	PropertyMap::const_iterator liter = data.begin();
-	
-	for (; riter != r.data.end() && liter != data.end(); ++riter, ++liter) {
-		if ((liter->first) != (riter->first))
-			return(false);
-			
-		if (*(liter->second) != *(riter->second))
-			return(false);
+	if (!node || !r.node) {
+		return (!node || node->numGroups == 0) &&
+		       (!r.node || r.node->numGroups == 0);
 	}
 	
-	return true;
+	return node == r.node || nodesAreEqual(*node, *r.node);
 }
 
-bool PropertyBag::operator==( const PropertyBagItem &r ) const {
-	return(  (*this) == dynamic_cast<const PropertyBag &>(r)  );
+bool PropertyBag::operator!=(const PropertyBag &r) const {
+	return !(*this == r);
 }
 
-PropertyBag & PropertyBag::operator=( const PropertyBag &r ) {
-	copy(r);
+PropertyBag & PropertyBag::operator=(const PropertyBag &r) {
+	document = r.document;
+	node = r.node;
 	return(*this);
 }
 
@@ -18,141 +18,38 @@ McCuskey, Mason. "Game Programming Tricks of the Trade".
 #include "color.h"
 #include "ListBag.h"
 
-/** Item stored in a property bag */
-class PropertyBagItem {
-public:
-	/** Destructor */
-	virtual ~PropertyBagItem();
-	
-	/** Constructor */
-	PropertyBagItem();
-	
-	/** Copy Constructor */
-	PropertyBagItem(const PropertyBagItem&) {}
-	
-	/**
-	Return a string representation of some XML structure that in turn
-	represents this item.
-	@param indentlevel Indentation level of the resultant XML code
-	*/
-	virtual string save(int indentlevel=0) const = 0;
-	
-	/**
-	Equality operator
-	@param r Item to test
-	@return true when the objects are equal
-	*/
-	virtual bool operator==(const PropertyBagItem &r) const = 0;
-	
-	/**
-	Inequality operator
-	@param r Item to test
-	@return true when the objects are not equal
-	*/
-	bool operator!=(const PropertyBagItem &r);
-};
+class PropertyBagDocument;
+struct PropertyBagNode;
+struct PropertyBagValue;
+
+/**
+Contains property bag items.
 
-/** String stored in a property bag */
-class PropertyBagString : public PropertyBagItem {
+A bag is a lightweight handle to a node of a shared, immutable document (see
+PropertyBagStorage.h). Copying a bag, or getting a nested bag from one, only
+shares the document and never copies any items. The first modification made
+through a handle whose document is shared copies the handle's own items into
+a new document, leaving every other handle untouched.
+*/
+class PropertyBag {
 public:
-	/** Destructor */
-	virtual ~PropertyBagString();
-	
-	/**
-	Constructor
-	@param data The string data to accept
-	@param convert If true, the string should be made safe for an XML file
-	*/
-	PropertyBagString(const string &data, bool convert = true);
-	
-	/**
-	Constructor
-	@param name The name of the item
-	@param data The string data to accept
-	@param convert If true, the string should be made safe for an XML file
-	*/
-	PropertyBagString(const string &name, const string &data, bool convert = true);
-	
-	/**
-	Return a string representation of some XML structure that in turn
-	represents this item.
-	@param indentlevel Indentation level of the resultant XML code
-	*/
-	virtual string save(int indentlevel=0) const;
-	
-	/**
-	Equality operator
-	@param r The item with which to compare
-	@return true if the items are equal
-	*/
-	virtual bool operator==(const PropertyBagItem &r) const;
-	
-	/**
-	Gets the data from the item, converted as appropriate.
-	@return data from this item
-	*/
-	string getData() const;
-	
-	/**
-	Sets data for the item
-	@param data The data to accept
-	@param convert If true, then it is necessary to convert the string to
-	a form safe for XML.
-	@return The actual data stored for this item
-	*/
-	const string& setData(const string &data, bool convert);
-	
 	/**
-	Sets the name of the item
-	@param name The new name of the item
-	@return The name actually set for the item
-	*/
-	const string& setName(const string &name);
-	
-	/** Gets the name of the item */
-	const string& getName() const;
-	
-	/**
-	Makes a string safe for insertion into an XML file by replacing special
-	characters like '>' and '&' with the appropriate special entity.
-	@param str String parameter
-	@return Safe string
+	Loads a bag from file, failing if the file cannot be loaded. Bags are
+	cached, so files loaded again are neither read nor parsed again.
+	@param fileName Name of the file from which to load
+	@return Contents of the file
 	*/
-	static string makeStringSafe(const string &str);
+	static PropertyBag fromFile(const FileName &fileName);
 	
 	/**
-	Takes a string made safe for an XML file and replaces the entities like
-	"&amp;" and "&quot;" with the appropriate characters.
-	@param str String parameter
-	@return Original string
+	Drops a file from the cache used by fromFile, so that it is loaded again
+	@param fileName File that has changed, either the source file or its
+	       cooked form
 	*/
-	static string restoreFromSafeString(const string &str);
-	
-private:
-	/** Has the item been converted to a safe form? */
-	bool itemHasBeenConverted;
-	
-	/** Name of the item */
-	string itemName;
-	
-	/** Data stored for this item*/
-	string itemData;
-};
-
-/** Contains property bag items */
-class PropertyBag : public PropertyBagItem {
-private:
-	/** string -> PropertyBagItem */
-	typedef multimap<string, PropertyBagItem*> PropertyMap;
-	
-	/** Property bag content */
-	PropertyMap data;
-	
-public:
-	static PropertyBag fromFile(const FileName &fileName);
+	static void invalidate(const FileName &fileName);
 	
 	/** Destructor */
-	virtual ~PropertyBag();
+	~PropertyBag();
 	
 	/** Constructor */
 	PropertyBag();
@@ -172,22 +69,26 @@ public:
 	/** Assignment operator */
 	PropertyBag &operator=(const PropertyBag &r);
 	
-	/** Equality operator against CPropBag */
-	virtual bool operator==(const PropertyBag &r) const;
-	
 	/**
 	Equality operator
-	@param r Item to test
-	@return true when the objects are equal
+	@param r Bag to test
+	@return true when the bags hold equal items
+	*/
+	bool operator==(const PropertyBag &r) const;
+	
+	/**
+	Inequality operator
+	@param r Bag to test
+	@return true when the bags do not hold equal items
 	*/
-	virtual bool operator==(const PropertyBagItem &r) const;
+	bool operator!=(const PropertyBag &r) const;
 	
 	/**
 	Return a string representation of some XML structure that in turn
 	represents this item.
 	@param indentlevel Indentation level of the resultant XML code
 	*/
-	virtual string save(int indentlevel=0) const;
+	string save(int indentlevel=0) const;
 	
 	/**
 	Saves to file some XML structure that in turn represents this item.
@@ -390,13 +291,39 @@ public:
 		return x;
 	}
 	
+	/**
+	Makes a string safe for insertion into an XML file by replacing special
+	characters like '>' and '&' with the appropriate special entity.
+	@param str String parameter
+	@return Safe string
+	*/
+	static string makeStringSafe(const string &str);
+	
+	/**
+	Gets the memory used by the document holding the bag, which may be
+	shared with other bags
+	@return Size of the document, in bytes
+	*/
+	size_t getMemoryUsage() const;
+	
 private:
+	friend class PropertyBagParser;
+	friend class PropertyBagBinary;
+	
 	/**
-	Inserts a tag into the property bag
-	@param tagName Name of the tag
-	@param tagContent Content if the tag
+	Finds an item in the bag
+	@param key Name of the item
+	@param instance Index of the instance of the key
+	@return the item, or null if there is no such instance
 	*/
-	void insertTag(const string &tagName, const string &tagContent);
+	const PropertyBagValue* find(const string &key, size_t instance) const;
+	
+	/**
+	Gets the node of the bag so that it may be modified, first copying it
+	into a new document if the current document is shared with other bags
+	@return Node of this bag, owned by an unshared document
+	*/
+	PropertyBagNode* getNodeForWriting();
 	
 	/**
 	Interprets the contents of the string as property bag contents and
@@ -406,11 +333,11 @@ private:
 	*/
 	bool loadMergeFromString(const string &newStuff);
 	
-	/**
-	Copies the contents of this bag from another
-	@param r Bag to copy
-	*/
-	void copy(const PropertyBag &r);
+	/** Document holding the items, or null if the bag is empty */
+	shared_ptr<PropertyBagDocument> document;
+	
+	/** Node of the document that is this bag, or null if the bag is empty */
+	PropertyBagNode *node;
 };
 
 #endif
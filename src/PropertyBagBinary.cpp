@@ -0,0 +1,335 @@
+#include "Core.h"
+#include "FileMapping.h"
+#include "PropertyBag.h"
+#include "PropertyBagBinary.h"
+#include "PropertyBagStorage.h"
+#include "VirtualFileSystem.h"
+
+namespace {
+
+/** Interned strings that are to be written to a cooked file */
+class StringPool {
+public:
+	/**
+	Adds a string to the pool, unless it is already there
+	@param str String to add
+	@return Index of the string in the string table
+	*/
+	U32 intern(const string &str) {
+		map<string, U32>::const_iterator found = indices.find(str);
+		
+		if (found != indices.end()) {
+			return found->second;
+		}
+		
+		const U32 index = (U32)offsets.size();
+		offsets.push_back((U32)pool.size());
+		pool.append(str);
+		pool.push_back(0);
+		indices.insert(make_pair(str, index));
+		return index;
+	}
+	
+	/** Offset of each string in the pool */
+	vector<U32> offsets;
+	
+	/** NUL-terminated strings */
+	string pool;
+	
+private:
+	map<string, U32> indices;
+};
+
+} // namespace
+
+FileName PropertyBagBinary::getCookedFileName(const FileName &fileName) {
+	return FileName(FileName::stripExtension(fileName.str()) + ".bag");
+}
+
+bool PropertyBagBinary::isCookedFileUsable(const FileName &fileName) {
+	const FileName cookedFileName = getCookedFileName(fileName);
+	
+	if (!VirtualFileSystem::exists(cookedFileName)) {
+		return false;
+	}
+	
+#ifndef NDEBUG
+	// Edited source files take precedence over stale cooked files
+	if (isFileOnDisk(fileName) &&
+	    getFileModificationTime(cookedFileName) < getFileModificationTime(fileName)) {
+		return false;
+	}
+#endif
+	
+	return true;
+}
+
+bool PropertyBagBinary::saveToFile(const PropertyBag &bag,
+                                   const FileName &fileName) {
+	vector<Node> nodes;
+	vector<F32> numbers;
+	StringPool strings;
+	
+	Node root;
+	root.key = strings.intern(string());
+	root.value = 0;
+	root.count = 0;
+	root.numbers = NO_NUMBERS;
+	root.type = NODE_BAG;
+	root.valueType = PropertyBagValue::VALUE_NONE;
+	nodes.push_back(root);
+	
+	/*
+	Visit bags breadth-first, so that the children of each bag are
+	appended to the node table contiguously.
+	*/
+	queue<pair<U32, const PropertyBagNode*> > pending;
+	
+	if (bag.node) {
+		pending.push(make_pair(0U, bag.node));
+	}
+	
+	vector<const PropertyBagGroup*> groups;
+	
+	while (!pending.empty()) {
+		const U32 parent = pending.front().first;
+		const PropertyBagNode &parentBag = *pending.front().second;
+		pending.pop();
+		
+		nodes[parent].value = (U32)nodes.size();
+		nodes[parent].count = (U32)parentBag.size();
+		
+		// Items are stored in the order in which they are saved as XML
+		parentBag.sort(groups);
+		
+		for (vector<const PropertyBagGroup*>::const_iterator i = groups.begin();
+		     i != groups.end(); ++i) {
+			const PropertyBagGroup &group = **i;
+			const U32 key = strings.intern(string(group.key->text, group.key->length));
+			
+			for (size_t j=0; j<group.count; ++j) {
+				const PropertyBagValue &value = group.values[j];
+				
+				Node node;
+				node.key = key;
+				node.value = 0;
+				node.count = 0;
+				node.numbers = NO_NUMBERS;
+				node.valueType = PropertyBagValue::VALUE_NONE;
+				
+				if (value.bag) {
+					node.type = NODE_BAG;
+					pending.push(make_pair((U32)nodes.size(), value.bag));
+				} else {
+					// Strings are stored as they would be written to XML
+					node.type = NODE_STRING;
+					node.value = strings.intern(string(value.text, value.length));
+					node.valueType = (U16)value.type;
+					
+					if (value.type != PropertyBagValue::VALUE_NONE) {
+						node.numbers = (U32)numbers.size();
+						node.count = (U32)value.numNumbers;
+						numbers.insert(numbers.end(),
+						               value.numbers,
+						               value.numbers + value.numNumbers);
+					}
+				}
+				
+				nodes.push_back(node);
+			}
+		}
+	}
+	
+	Header header;
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.numNodes = (U32)nodes.size();
+	header.numStrings = (U32)strings.offsets.size();
+	header.numNumbers = (U32)numbers.size();
+	header.stringPoolSize = (U32)strings.pool.size();
+	
+	FILE *stream = fopen(fileName.c_str(), "wb");
+	
+	if (!stream) {
+		ERR("Failed to open file for writing: " + fileName.str());
+		return false;
+	}
+	
+	bool ok = fwrite(&header, sizeof(header), 1, stream) == 1;
+	ok = ok && fwrite(&nodes[0], sizeof(Node), nodes.size(), stream) == nodes.size();
+	ok = ok && fwrite(&strings.offsets[0], sizeof(U32), strings.offsets.size(), stream) == strings.offsets.size();
+	
+	if (!numbers.empty()) {
+		ok = ok && fwrite(&numbers[0], sizeof(F32), numbers.size(), stream) == numbers.size();
+	}
+	
+	ok = ok && fwrite(strings.pool.data(), 1, strings.pool.size(), stream) == strings.pool.size();
+	ok = (fclose(stream) == 0) && ok;
+	
+	if (!ok) {
+		ERR("Failed to write file: " + fileName.str());
+	}
+	
+	return ok;
+}
+
+bool PropertyBagBinary::loadFromFile(const FileName &fileName,
+                                     PropertyBag &bag) {
+	const FileMapping file(fileName);
+	
+	if (!file.isOpen()) {
+		ERR("Failed to open file: " + fileName.str());
+		return false;
+	}
+	
+	bool ok = file.getSize() > 0;
+	
+	if (ok) {
+		// Copy into the bag's own memory, so strings need no further copies
+		bag.getNodeForWriting();
+		U8 *buffer = bag.document->arena.allocateArray<U8>(file.getSize());
+		ok = file.read(0, buffer, file.getSize());
+		ok = ok && load(buffer, file.getSize(), bag, true);
+	}
+	
+	if (!ok) {
+		ERR("Failed to read cooked file: " + fileName.str());
+	}
+	
+	return ok;
+}
+
+bool PropertyBagBinary::load(const U8 *buffer,
+                             size_t size,
+                             PropertyBag &bag) {
+	return load(buffer, size, bag, false);
+}
+
+bool PropertyBagBinary::load(const U8 *buffer,
+                             size_t size,
+                             PropertyBag &bag,
+                             bool inPlace) {
+	if (size < sizeof(Header)) {
+		return false;
+	}
+	
+	Document document;
+	document.header = reinterpret_cast<const Header*>(buffer);
+	
+	const Header &header = *document.header;
+	
+	if (header.magic != MAGIC || header.version != VERSION) {
+		ERR("Cooked file has an unsupported format");
+		return false;
+	}
+	
+	// Each count is bounded by the file size, so the sums cannot overflow
+	if (header.numNodes == 0 ||
+	    header.numNodes > size / sizeof(Node) ||
+	    header.numStrings > size / sizeof(U32) ||
+	    header.numNumbers > size / sizeof(F32) ||
+	    header.stringPoolSize > size) {
+		return false;
+	}
+	
+	const size_t nodesOffset = sizeof(Header);
+	const size_t stringOffsetsOffset = nodesOffset + header.numNodes * sizeof(Node);
+	const size_t numbersOffset = stringOffsetsOffset + header.numStrings * sizeof(U32);
+	const size_t stringsOffset = numbersOffset + header.numNumbers * sizeof(F32);
+	
+	if (stringsOffset + header.stringPoolSize != size) {
+		return false;
+	}
+	
+	document.nodes = reinterpret_cast<const Node*>(buffer + nodesOffset);
+	document.stringOffsets = reinterpret_cast<const U32*>(buffer + stringOffsetsOffset);
+	document.numbers = reinterpret_cast<const F32*>(buffer + numbersOffset);
+	document.strings = reinterpret_cast<const char*>(buffer + stringsOffset);
+	
+	// Every string in the pool is terminated, so the last byte must be too
+	if (header.stringPoolSize == 0 ||
+	    document.strings[header.stringPoolSize-1] != 0) {
+		return false;
+	}
+	
+	PropertyBagNode *node = bag.getNodeForWriting();
+	return loadBag(document, 0, *bag.document, node, inPlace);
+}
+
+const char* PropertyBagBinary::getString(const Document &document, U32 index) {
+	if (index >= document.header->numStrings) {
+		return 0;
+	}
+	
+	const U32 offset = document.stringOffsets[index];
+	
+	if (offset >= document.header->stringPoolSize) {
+		return 0;
+	}
+	
+	return document.strings + offset;
+}
+
+bool PropertyBagBinary::loadBag(const Document &document,
+                                U32 index,
+                                PropertyBagDocument &target,
+                                PropertyBagNode *bag,
+                                bool inPlace) {
+	const Node &node = document.nodes[index];
+	const U32 numNodes = document.header->numNodes;
+	
+	// Children always follow their parent, which rules out cycles
+	if (node.type != NODE_BAG ||
+	    (node.count > 0 && node.value <= index) ||
+	    node.value > numNodes ||
+	    node.count > numNodes - node.value) {
+		return false;
+	}
+	
+	for (U32 i = node.value; i < node.value + node.count; ++i) {
+		const Node &child = document.nodes[i];
+		const char *key = getString(document, child.key);
+		
+		if (!key) {
+			return false;
+		}
+		
+		if (child.type == NODE_BAG) {
+			PropertyBagNode *childBag = target.createNode();
+			
+			if (!loadBag(document, i, target, childBag, inPlace)) {
+				return false;
+			}
+			
+			target.setBag(target.append(bag, key, strlen(key)), childBag);
+		} else if (child.type == NODE_STRING) {
+			const char *text = getString(document, child.value);
+			
+			if (!text) {
+				return false;
+			}
+			
+			const size_t length = strlen(text);
+			PropertyBagValue *item = target.append(bag, key, strlen(key));
+			target.setTextInPlace(item,
+			                      inPlace ? text : target.arena.copyString(text, length),
+			                      length);
+			
+			if (child.numbers != NO_NUMBERS) {
+				if (child.count > PropertyBagValue::MAX_NUMBERS ||
+				    child.numbers > document.header->numNumbers ||
+				    child.count > document.header->numNumbers - child.numbers) {
+					return false;
+				}
+				
+				item->setNumbers((PropertyBagValue::Type)child.valueType,
+				                 document.numbers + child.numbers,
+				                 child.count);
+			}
+		} else {
+			return false;
+		}
+	}
+	
+	return true;
+}
@@ -0,0 +1,148 @@
+#ifndef _PROPERTY_BAG_BINARY_H_
+#define _PROPERTY_BAG_BINARY_H_
+
+#include "PropertyBag.h"
+
+/**
+Compiled ("cooked") binary form of a property bag.
+
+A cooked file holds a header, a flat table of nodes, a table of offsets into
+a pool of interned, NUL-terminated strings, and a pool of pre-parsed numbers.
+Every bag's children are stored contiguously in the node table, so the whole
+tree is rebuilt by walking the table once without any text parsing. A cooked
+file is read directly into the arena of the bag that receives it, and the
+loaded strings point into the file rather than being copied. Numbers,
+vectors and colors are parsed once, offline, and attached to their items so
+that the typed PropertyBag getters do not need to parse them either.
+
+Data files are cooked with the Cooker tool. The cooked file sits alongside
+the source XML (e.g. "foo.xml" cooks to "foo.bag") and is used in its place
+by PropertyBag::loadFromFile. Development builds ignore a cooked file that is
+older than its source, so edited XML always takes effect.
+*/
+class PropertyBagBinary {
+public:
+	/**
+	Gets the name of the cooked file for a source file
+	@param fileName Name of the source XML file
+	@return Name of the cooked file
+	*/
+	static FileName getCookedFileName(const FileName &fileName);
+	
+	/**
+	Determines whether there is a cooked file that should be used in place
+	of the source file
+	@param fileName Name of the source XML file
+	@return true if the cooked file should be loaded instead
+	*/
+	static bool isCookedFileUsable(const FileName &fileName);
+	
+	/**
+	Writes a bag to a cooked file
+	@param bag Bag to write
+	@param fileName Name of the cooked file
+	@return true if successful
+	*/
+	static bool saveToFile(const PropertyBag &bag, const FileName &fileName);
+	
+	/**
+	Reads a cooked file and merges its contents into a bag
+	@param fileName Name of the cooked file
+	@param bag Receives the items from the file (existing items are kept)
+	@return true if successful
+	*/
+	static bool loadFromFile(const FileName &fileName, PropertyBag &bag);
+	
+	/**
+	Reads a cooked bag from memory and merges its contents into a bag
+	@param buffer Contents of a cooked file
+	@param size Size of the buffer, in bytes
+	@param bag Receives the items from the buffer (existing items are kept)
+	@return true if successful
+	*/
+	static bool load(const U8 *buffer, size_t size, PropertyBag &bag);
+	
+private:
+	/** Identifies a cooked property bag file */
+	static const U32 MAGIC = 0x47414250; // "PBAG"
+	
+	/** Incremented whenever the layout of the file changes */
+	static const U32 VERSION = 1;
+	
+	/** Marks a node that has no pre-parsed numbers */
+	static const U32 NO_NUMBERS = 0xFFFFFFFF;
+	
+	enum NodeType {
+		NODE_BAG,
+		NODE_STRING
+	};
+	
+	struct Header {
+		U32 magic;
+		U32 version;
+		U32 numNodes;
+		U32 numStrings;
+		U32 numNumbers;
+		U32 stringPoolSize;
+	};
+	
+	struct Node {
+		/** Index of the tag name in the string table */
+		U32 key;
+		
+		/** Bags: index of the first child node. Strings: index of the text */
+		U32 value;
+		
+		/** Bags: number of children. Strings: number of pre-parsed numbers */
+		U32 count;
+		
+		/** Index of the first pre-parsed number, or NO_NUMBERS */
+		U32 numbers;
+		
+		/** NodeType */
+		U16 type;
+		
+		/** PropertyBagValue::Type of the pre-parsed numbers */
+		U16 valueType;
+	};
+	
+	/** Cooked file that has been validated and may be read */
+	struct Document {
+		const Header *header;
+		const Node *nodes;
+		const U32 *stringOffsets;
+		const F32 *numbers;
+		const char *strings;
+	};
+	
+	/**
+	Reads a cooked bag from memory and merges its contents into a bag
+	@param buffer Contents of a cooked file
+	@param size Size of the buffer, in bytes
+	@param bag Receives the items from the buffer (existing items are kept)
+	@param inPlace If true, the buffer belongs to the bag's document and
+	       its strings are referenced rather than copied
+	@return true if successful
+	*/
+	static bool load(const U8 *buffer, size_t size, PropertyBag &bag, bool inPlace);
+	
+	/**
+	Rebuilds the children of a bag node
+	@param document Cooked file
+	@param index Index of the bag node
+	@param target Document that receives the items
+	@param node Receives the children of the bag node
+	@param inPlace If true, strings are referenced rather than copied
+	@return true if successful
+	*/
+	static bool loadBag(const Document &document,
+	                    U32 index,
+	                    PropertyBagDocument &target,
+	                    PropertyBagNode *node,
+	                    bool inPlace);
+	
+	/** Gets a string from the string table, or null if out of range */
+	static const char* getString(const Document &document, U32 index);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "Core.h"
+#include "PropertyBag.h"
+#include "PropertyBagParser.h"
+#include "PropertyBagStorage.h"
+
+bool PropertyBagParser::parse(const char *begin,
+                              const char *end,
+                              PropertyBag &bag) {
+	PropertyBagNode *root = bag.getNodeForWriting();
+	PropertyBagDocument &document = *bag.document;
+	vector<OpenTag> stack;
+	const char *p = begin;
+	
+	// The text is a good estimate of the memory needed for the items
+	document.arena.reserve(end - begin);
+	
+	while (p < end) {
+		// Skip to the next tag; text between tags is ignored
+		const char *lt = (const char *)memchr(p, '<', end - p);
+		
+		if (!lt) {
+			break;
+		}
+		
+		const char *gt = (const char *)memchr(lt + 1, '>', end - (lt + 1));
+		
+		if (!gt) {
+			ERR("Unterminated tag");
+			return false;
+		}
+		
+		if (lt[1] == '/') {
+			const StringView name(lt + 2, gt);
+			
+			if (stack.empty() || !(stack.back().name == name)) {
+				ERR("Unexpected closing tag: " + name.str());
+				return false;
+			}
+			
+			const OpenTag tag = stack.back();
+			stack.pop_back();
+			
+			PropertyBagNode *parent = stack.empty() ? root : stack.back().bag;
+			PropertyBagValue *item = document.append(parent,
+			                                         tag.name.begin,
+			                                         tag.name.length());
+			                                         
+			if (tag.bag) {
+				document.setBag(item, tag.bag);
+			} else {
+				// No child tags, so the contents are the value of the item
+				document.setText(item, tag.contents, lt - tag.contents);
+			}
+		} else {
+			if (!stack.empty() && !stack.back().bag) {
+				// Parent tag has a child, so it holds a bag
+				stack.back().bag = document.createNode();
+			}
+			
+			stack.push_back(OpenTag(StringView(lt + 1, gt), gt + 1));
+		}
+		
+		p = gt + 1;
+	}
+	
+	if (!stack.empty()) {
+		ERR("Unclosed tag: " + stack.back().name.str());
+		return false;
+	}
+	
+	return true;
+}
@@ -0,0 +1,68 @@
+#ifndef _PROPERTY_BAG_PARSER_H_
+#define _PROPERTY_BAG_PARSER_H_
+
+class PropertyBag;
+struct PropertyBagNode;
+
+/**
+Parses the XML-like property bag text format in a single pass.
+Tag names are referenced in place in the source buffer and are only copied
+into the bag's arena when the finished item is inserted into its bag. Open
+tags are kept on a stack, and each nested bag is created when its first child
+tag is opened and handed to its parent when its closing tag is reached. No
+part of the document is ever scanned or copied more than once.
+*/
+class PropertyBagParser {
+public:
+	/**
+	Parses property bag text and merges the results into a bag
+	@param begin Start of the text
+	@param end One past the end of the text
+	@param bag Receives the parsed items (existing items are kept)
+	@return true if successful, false if the text was malformed
+	*/
+	static bool parse(const char *begin, const char *end, PropertyBag &bag);
+	
+private:
+	/** Range of characters in the source buffer */
+	struct StringView {
+		const char *begin;
+		const char *end;
+		
+		StringView(const char *_begin, const char *_end)
+				: begin(_begin),
+				end(_end) {}
+		
+		inline size_t length() const {
+			return end - begin;
+		}
+		
+		inline bool operator==(const StringView &r) const {
+			return length() == r.length() &&
+			       memcmp(begin, r.begin, length()) == 0;
+		}
+		
+		inline string str() const {
+			return string(begin, end);
+		}
+	};
+	
+	/** Tag that has been opened but not yet closed */
+	struct OpenTag {
+		/** Name of the tag */
+		StringView name;
+		
+		/** Start of the tag's contents */
+		const char *contents;
+		
+		/** Child items, created when the first child tag is opened */
+		PropertyBagNode *bag;
+		
+		OpenTag(const StringView &_name, const char *_contents)
+				: name(_name),
+				contents(_contents),
+				bag(0) {}
+	};
+};
+
+#endif
@@ -0,0 +1,464 @@
+#include "Core.h"
+#include "PropertyBagStorage.h"
+
+/** Alignment of every allocation made from an arena */
+static const size_t ARENA_ALIGNMENT = 8;
+
+/** Size of the first block of an arena */
+static const size_t ARENA_MIN_BLOCK_SIZE = 256;
+
+/** Blocks grow geometrically up to this size, unless reserved otherwise */
+static const size_t ARENA_MAX_BLOCK_SIZE = 64 * 1024;
+
+/** Characters that separate the tokens of vector strings */
+static bool isVectorDelimiter(char c) {
+	return c=='(' || c==',' || c==')' || c=='\t' || c=='\n';
+}
+
+/**
+Finds the next token of a vector string, in the same manner as the
+boost::char_separator used by vec3::fromString and friends
+@param p Position to search from, updated to the end of the token
+@param end End of the string
+@param token Returns the start of the token
+@return Length of the token, or zero if there are no more tokens
+*/
+static size_t nextVectorToken(const char *&p, const char *end, const char *&token) {
+	while (p < end && isVectorDelimiter(*p)) {
+		++p;
+	}
+	
+	token = p;
+	
+	while (p < end && !isVectorDelimiter(*p)) {
+		++p;
+	}
+	
+	return p - token;
+}
+
+/** Compares a token with a lower case string, ignoring case */
+static bool tokenEquals(const char *token, size_t length, const char *lower) {
+	if (strlen(lower) != length) {
+		return false;
+	}
+	
+	for (size_t i=0; i<length; ++i) {
+		if ((char)tolower(token[i]) != lower[i]) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+PropertyBagArena::~PropertyBagArena() {
+	for (vector<char*>::iterator i = blocks.begin(); i != blocks.end(); ++i) {
+		delete [] (*i);
+	}
+}
+
+PropertyBagArena::PropertyBagArena()
+		: cursor(0),
+		remaining(0),
+		nextBlockSize(ARENA_MIN_BLOCK_SIZE),
+		allocatedSize(0) {}
+
+void PropertyBagArena::reserve(size_t size) {
+	if (size > remaining) {
+		nextBlockSize = max(nextBlockSize, size);
+	}
+}
+
+void* PropertyBagArena::allocate(size_t size) {
+	size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+	
+	if (size > remaining) {
+		const size_t blockSize = max(size, nextBlockSize);
+		cursor = new char[blockSize];
+		remaining = blockSize;
+		blocks.push_back(cursor);
+		allocatedSize += blockSize;
+		nextBlockSize = min(nextBlockSize * 2, ARENA_MAX_BLOCK_SIZE);
+	}
+	
+	void *memory = cursor;
+	cursor += size;
+	remaining -= size;
+	return memory;
+}
+
+const char* PropertyBagArena::copyString(const char *text, size_t length) {
+	char *copy = allocateArray<char>(length + 1);
+	memcpy(copy, text, length);
+	copy[length] = 0;
+	return copy;
+}
+
+void PropertyBagValue::setNumbers(Type _type,
+                                  const float *_numbers,
+                                  size_t count) {
+	ASSERT(count <= MAX_NUMBERS, "Too many numbers: " + sizet_to_string(count));
+	
+	type = _type;
+	numNumbers = count;
+	
+	for (size_t i=0; i<count; ++i) {
+		numbers[i] = _numbers[i];
+	}
+}
+
+PropertyBagValue::Type PropertyBagValue::classify(const char *text,
+                                                  size_t length,
+                                                  float *numbers,
+                                                  size_t &count) {
+	count = 0;
+	
+	const char *end = text + length;
+	const char *p = text;
+	const char *token = 0;
+	size_t tokenLength = nextVectorToken(p, end, token);
+	
+	if (tokenLength == 0) {
+		return VALUE_NONE;
+	}
+	
+	Type type = VALUE_NONE;
+	
+	if (token[0] == '&') {
+		if (tokenEquals(token, tokenLength, "&vec")) {
+			type = VALUE_VEC;
+		} else if (tokenEquals(token, tokenLength, "&vec2")) {
+			type = VALUE_VEC2;
+		} else if (tokenEquals(token, tokenLength, "&vec3")) {
+			type = VALUE_VEC3;
+		} else if (tokenEquals(token, tokenLength, "&vec4")) {
+			type = VALUE_VEC4;
+		} else if (tokenEquals(token, tokenLength, "&color")) {
+			type = VALUE_COLOR;
+		}
+	}
+	
+	if (type != VALUE_NONE) {
+		while ((tokenLength = nextVectorToken(p, end, token)) != 0) {
+			// Each token is converted on its own, just as stof(*i) would
+			char buffer[64];
+			
+			if (count == MAX_NUMBERS || tokenLength >= sizeof(buffer)) {
+				count = 0;
+				return VALUE_NONE;
+			}
+			
+			memcpy(buffer, token, tokenLength);
+			buffer[tokenLength] = 0;
+			numbers[count++] = (float)atof(buffer);
+		}
+		
+		return count>0 ? type : VALUE_NONE;
+	}
+	
+	// Plain numbers must consist of nothing but the number itself
+	char *numberEnd = 0;
+	strtod(text, &numberEnd);
+	
+	if (numberEnd == text) {
+		return VALUE_NONE;
+	}
+	
+	while (numberEnd < end && isspace((unsigned char)*numberEnd)) {
+		++numberEnd;
+	}
+	
+	if (numberEnd != end) {
+		return VALUE_NONE;
+	}
+	
+	numbers[0] = (float)atof(text);
+	count = 1;
+	return VALUE_NUMBER;
+}
+
+size_t PropertyBagNode::size() const {
+	size_t total = 0;
+	
+	for (size_t i=0; i<numGroups; ++i) {
+		total += groups[i].count;
+	}
+	
+	return total;
+}
+
+const PropertyBagGroup* PropertyBagNode::find(const char *key,
+                                              size_t length,
+                                              size_t hash) const {
+	if (numSlots == 0) {
+		return 0;
+	}
+	
+	const size_t mask = numSlots - 1;
+	
+	for (size_t i = hash & mask; slots[i] != 0; i = (i+1) & mask) {
+		const PropertyBagGroup &group = groups[slots[i]-1];
+		
+		if (group.key->hash == hash &&
+		    group.key->length == length &&
+		    memcmp(group.key->text, key, length) == 0) {
+			return &group;
+		}
+	}
+	
+	return 0;
+}
+
+/** Orders groups by key, as std::string comparison would */
+static bool compareGroupKeys(const PropertyBagGroup *a, const PropertyBagGroup *b) {
+	const size_t length = min(a->key->length, b->key->length);
+	const int c = memcmp(a->key->text, b->key->text, length);
+	return c<0 || (c==0 && a->key->length < b->key->length);
+}
+
+void PropertyBagNode::sort(vector<const PropertyBagGroup*> &sorted) const {
+	sorted.resize(numGroups);
+	
+	for (size_t i=0; i<numGroups; ++i) {
+		sorted[i] = &groups[i];
+	}
+	
+	std::sort(sorted.begin(), sorted.end(), compareGroupKeys);
+}
+
+PropertyBagDocument::PropertyBagDocument()
+		: keySlots(0),
+		numKeySlots(0),
+		numKeys(0) {}
+
+size_t PropertyBagDocument::hash(const char *text, size_t length) {
+	// FNV-1a
+	size_t h = 2166136261U;
+	
+	for (size_t i=0; i<length; ++i) {
+		h ^= (unsigned char)text[i];
+		h *= 16777619U;
+	}
+	
+	return h;
+}
+
+PropertyBagNode* PropertyBagDocument::createNode() {
+	PropertyBagNode *node = arena.allocateArray<PropertyBagNode>(1);
+	node->groups = 0;
+	node->numGroups = 0;
+	node->groupCapacity = 0;
+	node->slots = 0;
+	node->numSlots = 0;
+	return node;
+}
+
+const PropertyBagKey* PropertyBagDocument::intern(const char *text,
+                                                  size_t length,
+                                                  size_t hash) {
+	if ((numKeys+1)*2 > numKeySlots) {
+		rehashKeys(max(numKeySlots*2, (size_t)16));
+	}
+	
+	const size_t mask = numKeySlots - 1;
+	size_t i = hash & mask;
+	
+	for (; keySlots[i] != 0; i = (i+1) & mask) {
+		const PropertyBagKey *key = keySlots[i];
+		
+		if (key->hash == hash &&
+		    key->length == length &&
+		    memcmp(key->text, text, length) == 0) {
+			return key;
+		}
+	}
+	
+	PropertyBagKey *key = arena.allocateArray<PropertyBagKey>(1);
+	key->text = arena.copyString(text, length);
+	key->length = length;
+	key->hash = hash;
+	
+	keySlots[i] = key;
+	numKeys++;
+	
+	return key;
+}
+
+void PropertyBagDocument::rehashKeys(size_t _numSlots) {
+	const PropertyBagKey **slots = arena.allocateArray<const PropertyBagKey*>(_numSlots);
+	memset(slots, 0, sizeof(const PropertyBagKey*) * _numSlots);
+	
+	const size_t mask = _numSlots - 1;
+	
+	for (size_t i=0; i<numKeySlots; ++i) {
+		if (keySlots[i]) {
+			size_t j = keySlots[i]->hash & mask;
+			
+			while (slots[j] != 0) {
+				j = (j+1) & mask;
+			}
+			
+			slots[j] = keySlots[i];
+		}
+	}
+	
+	keySlots = slots;
+	numKeySlots = _numSlots;
+}
+
+void PropertyBagDocument::rehash(PropertyBagNode *node, size_t numSlots) {
+	if (numSlots != node->numSlots) {
+		node->slots = arena.allocateArray<size_t>(numSlots);
+		node->numSlots = numSlots;
+	}
+	
+	memset(node->slots, 0, sizeof(size_t) * numSlots);
+	
+	for (size_t i=0; i<node->numGroups; ++i) {
+		insertSlot(node, i);
+	}
+}
+
+void PropertyBagDocument::insertSlot(PropertyBagNode *node, size_t group) {
+	const size_t mask = node->numSlots - 1;
+	size_t i = node->groups[group].key->hash & mask;
+	
+	while (node->slots[i] != 0) {
+		i = (i+1) & mask;
+	}
+	
+	node->slots[i] = group+1;
+}
+
+PropertyBagValue* PropertyBagDocument::append(PropertyBagNode *node,
+                                              const char *key,
+                                              size_t length) {
+	const size_t h = hash(key, length);
+	PropertyBagGroup *group = const_cast<PropertyBagGroup*>(node->find(key, length, h));
+	
+	if (!group) {
+		if (node->numGroups == node->groupCapacity) {
+			const size_t capacity = max(node->groupCapacity*2, (size_t)4);
+			PropertyBagGroup *groups = arena.allocateArray<PropertyBagGroup>(capacity);
+			
+			if (node->numGroups > 0) {
+				memcpy(groups, node->groups, sizeof(PropertyBagGroup) * node->numGroups);
+			}
+			
+			node->groups = groups;
+			node->groupCapacity = capacity;
+		}
+		
+		group = &node->groups[node->numGroups++];
+		group->key = intern(key, length, h);
+		group->values = 0;
+		group->count = 0;
+		group->capacity = 0;
+		
+		// Keep the table at most half full
+		if (node->numGroups*2 > node->numSlots) {
+			rehash(node, max(node->numSlots*2, (size_t)8));
+		} else {
+			insertSlot(node, node->numGroups-1);
+		}
+	}
+	
+	if (group->count == group->capacity) {
+		const size_t capacity = max(group->capacity*2, (size_t)1);
+		PropertyBagValue *values = arena.allocateArray<PropertyBagValue>(capacity);
+		
+		if (group->count > 0) {
+			memcpy(values, group->values, sizeof(PropertyBagValue) * group->count);
+		}
+		
+		group->values = values;
+		group->capacity = capacity;
+	}
+	
+	PropertyBagValue *value = &group->values[group->count++];
+	value->bag = 0;
+	value->text = "";
+	value->length = 0;
+	value->type = PropertyBagValue::VALUE_NONE;
+	value->numNumbers = 0;
+	
+	return value;
+}
+
+void PropertyBagDocument::setText(PropertyBagValue *value,
+                                  const char *text,
+                                  size_t length) {
+	setTextInPlace(value, arena.copyString(text, length), length);
+	
+	float numbers[PropertyBagValue::MAX_NUMBERS];
+	size_t count = 0;
+	const PropertyBagValue::Type type =
+	 PropertyBagValue::classify(value->text, length, numbers, count);
+	
+	if (type != PropertyBagValue::VALUE_NONE) {
+		value->setNumbers(type, numbers, count);
+	}
+}
+
+void PropertyBagDocument::setTextInPlace(PropertyBagValue *value,
+                                         const char *text,
+                                         size_t length) {
+	value->bag = 0;
+	value->text = text;
+	value->length = length;
+	value->type = PropertyBagValue::VALUE_NONE;
+	value->numNumbers = 0;
+}
+
+void PropertyBagDocument::setBag(PropertyBagValue *value,
+                                 PropertyBagNode *bag) {
+	value->bag = bag;
+	value->text = "";
+	value->length = 0;
+	value->type = PropertyBagValue::VALUE_NONE;
+	value->numNumbers = 0;
+}
+
+void PropertyBagDocument::appendCopy(PropertyBagNode *node,
+                                     const PropertyBagKey *key,
+                                     const PropertyBagValue &value) {
+	if (value.bag) {
+		PropertyBagNode *bag = copy(*value.bag);
+		setBag(append(node, key->text, key->length), bag);
+	} else {
+		PropertyBagValue *copied = append(node, key->text, key->length);
+		setTextInPlace(copied, arena.copyString(value.text, value.length), value.length);
+		copied->setNumbers(value.type, value.numbers, value.numNumbers);
+	}
+}
+
+void PropertyBagDocument::remove(PropertyBagNode *node,
+                                 const char *key,
+                                 size_t length) {
+	const PropertyBagGroup *group = node->find(key, length, hash(key, length));
+	
+	if (!group) {
+		return;
+	}
+	
+	// Groups are unordered, so the last one may simply fill the gap
+	const size_t index = group - node->groups;
+	node->groups[index] = node->groups[node->numGroups-1];
+	node->numGroups--;
+	rehash(node, node->numSlots);
+}
+
+PropertyBagNode* PropertyBagDocument::copy(const PropertyBagNode &node) {
+	PropertyBagNode *copied = createNode();
+	
+	for (size_t i=0; i<node.numGroups; ++i) {
+		const PropertyBagGroup &group = node.groups[i];
+		
+		for (size_t j=0; j<group.count; ++j) {
+			appendCopy(copied, group.key, group.values[j]);
+		}
+	}
+	
+	return copied;
+}
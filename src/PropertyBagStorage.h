@@ -0,0 +1,308 @@
+#ifndef _PROPERTY_BAG_STORAGE_H_
+#define _PROPERTY_BAG_STORAGE_H_
+
+/*
+In-memory representation of property bags. This is private to PropertyBag
+and to the classes that load and save bags; nothing else should include it.
+
+A document owns an arena from which every node, key, value and string of a
+tree of bags is allocated, so that loading a file costs a handful of large
+allocations rather than several per item. Nothing in the arena is freed
+individually: removed items simply become unreachable until the whole
+document is released. Documents are shared between PropertyBag handles and
+are never modified while shared, so they may be read from several threads.
+*/
+
+/** Bump allocator that frees all of its memory at once */
+class PropertyBagArena {
+public:
+	/** Destructor */
+	~PropertyBagArena();
+	
+	/** Constructor */
+	PropertyBagArena();
+	
+	/**
+	Sets the size of the next block to be allocated, so that data of a known
+	size (such as a file being parsed) fits in a single block
+	@param size Expected number of bytes to be allocated
+	*/
+	void reserve(size_t size);
+	
+	/**
+	Allocates memory, aligned for any of the storage structures
+	@param size Number of bytes
+	@return Uninitialized memory that lives as long as the arena
+	*/
+	void* allocate(size_t size);
+	
+	/**
+	Allocates an array
+	@param count Number of elements
+	@return Uninitialized elements that live as long as the arena
+	*/
+	template<typename T>
+	T* allocateArray(size_t count) {
+		return static_cast<T*>(allocate(sizeof(T) * count));
+	}
+	
+	/**
+	Copies a string into the arena
+	@param text Characters to copy
+	@param length Number of characters
+	@return NUL-terminated copy of the string
+	*/
+	const char* copyString(const char *text, size_t length);
+	
+	/** Gets the total size of the allocated blocks, in bytes */
+	inline size_t getSize() const {
+		return allocatedSize;
+	}
+	
+private:
+	PropertyBagArena(const PropertyBagArena&);
+	PropertyBagArena& operator=(const PropertyBagArena&);
+	
+	/** Allocated blocks */
+	vector<char*> blocks;
+	
+	/** Next free byte in the current block */
+	char *cursor;
+	
+	/** Bytes remaining in the current block */
+	size_t remaining;
+	
+	/** Size of the next block to allocate */
+	size_t nextBlockSize;
+	
+	/** Total size of the allocated blocks */
+	size_t allocatedSize;
+};
+
+/** Interned tag name */
+struct PropertyBagKey {
+	/** NUL-terminated name */
+	const char *text;
+	
+	/** Length of the name */
+	size_t length;
+	
+	/** Hash of the name */
+	size_t hash;
+};
+
+struct PropertyBagNode;
+
+/** Single item of a bag: either a string or a nested bag */
+struct PropertyBagValue {
+	/**
+	Kinds of pre-parsed value that may accompany the string data, so that
+	numbers and vectors are not parsed from text every time they are read.
+	*/
+	enum Type {
+		VALUE_NONE,   // No pre-parsed value, parse the string
+		VALUE_NUMBER, // Plain number
+		VALUE_VEC,    // "&vec(...)", may be read as a vec2, vec3 or vec4
+		VALUE_VEC2,   // "&vec2(...)"
+		VALUE_VEC3,   // "&vec3(...)"
+		VALUE_VEC4,   // "&vec4(...)"
+		VALUE_COLOR   // "&color(...)"
+	};
+	
+	/** Maximum number of pre-parsed numbers stored with an item */
+	static const size_t MAX_NUMBERS = 4;
+	
+	/** Nested bag, or null if the item is a string */
+	PropertyBagNode *bag;
+	
+	/** NUL-terminated string data, exactly as written to XML */
+	const char *text;
+	
+	/** Length of the string data */
+	size_t length;
+	
+	/** Kind of pre-parsed value */
+	Type type;
+	
+	/** Number of components in the pre-parsed value */
+	size_t numNumbers;
+	
+	/** Components of the pre-parsed value */
+	float numbers[MAX_NUMBERS];
+	
+	/**
+	Attaches a pre-parsed value to the item. The value must agree with the
+	string data, as it will be returned in place of parsing the string.
+	@param type Kind of value
+	@param numbers Components of the value
+	@param count Number of components (at most MAX_NUMBERS)
+	*/
+	void setNumbers(Type type, const float *numbers, size_t count);
+	
+	/**
+	Determines the pre-parsed value of a string, if it has one. Numbers are
+	read exactly as the text getters and vec3::fromString and friends would.
+	@param text NUL-terminated string data
+	@param length Length of the string data
+	@param numbers Returns the components of the value
+	@param count Returns the number of components
+	@return Kind of value the string holds, possibly VALUE_NONE
+	*/
+	static Type classify(const char *text,
+	                     size_t length,
+	                     float *numbers,
+	                     size_t &count);
+};
+
+/** All instances of one key within a bag, in the order they were added */
+struct PropertyBagGroup {
+	const PropertyBagKey *key;
+	PropertyBagValue *values;
+	size_t count;
+	size_t capacity;
+};
+
+/** Bag of items, with its keys indexed by an open-addressing hash table */
+struct PropertyBagNode {
+	/** Groups, in the order their keys were first added */
+	PropertyBagGroup *groups;
+	size_t numGroups;
+	size_t groupCapacity;
+	
+	/** Hash table slots, each holding a group index+1 or zero */
+	size_t *slots;
+	
+	/** Number of slots, always zero or a power of two */
+	size_t numSlots;
+	
+	/** Gets the total number of items in the bag */
+	size_t size() const;
+	
+	/**
+	Finds the instances of a key
+	@param key Tag name
+	@param length Length of the tag name
+	@param hash Hash of the tag name
+	@return Group of the key, or null if the key is not present
+	*/
+	const PropertyBagGroup* find(const char *key,
+	                             size_t length,
+	                             size_t hash) const;
+	
+	/**
+	Gets the groups sorted by key, which is the order in which bags are
+	saved and compared
+	@param sorted Returns the groups
+	*/
+	void sort(vector<const PropertyBagGroup*> &sorted) const;
+};
+
+/** Arena, key table and tree of nodes that make up a loaded bag */
+class PropertyBagDocument {
+public:
+	/** Constructor */
+	PropertyBagDocument();
+	
+	/** Hashes a tag name */
+	static size_t hash(const char *text, size_t length);
+	
+	/** Creates a new, empty node */
+	PropertyBagNode* createNode();
+	
+	/**
+	Adds a new item to the end of the instances of a key
+	@param node Bag to receive the item
+	@param key Tag name
+	@param length Length of the tag name
+	@return Item, which the caller must set with setText or setBag
+	*/
+	PropertyBagValue* append(PropertyBagNode *node,
+	                         const char *key,
+	                         size_t length);
+	
+	/**
+	Sets an item to a string, copied into the arena, and pre-parses it
+	@param value Item to set
+	@param text String data, exactly as written to XML
+	@param length Length of the string data
+	*/
+	void setText(PropertyBagValue *value, const char *text, size_t length);
+	
+	/**
+	Sets an item to a string that already lives as long as the document.
+	The string is neither copied nor pre-parsed.
+	@param value Item to set
+	@param text NUL-terminated string data, exactly as written to XML
+	@param length Length of the string data
+	*/
+	void setTextInPlace(PropertyBagValue *value, const char *text, size_t length);
+	
+	/**
+	Sets an item to a bag
+	@param value Item to set
+	@param bag Node from this document, which must have no other parent
+	*/
+	void setBag(PropertyBagValue *value, PropertyBagNode *bag);
+	
+	/**
+	Copies an item, possibly from another document, to the end of the
+	instances of a key
+	@param node Bag to receive the item
+	@param key Tag name
+	@param value Item to copy
+	*/
+	void appendCopy(PropertyBagNode *node,
+	                const PropertyBagKey *key,
+	                const PropertyBagValue &value);
+	
+	/**
+	Removes all instances of a key
+	@param node Bag to modify
+	@param key Tag name
+	@param length Length of the tag name
+	*/
+	void remove(PropertyBagNode *node, const char *key, size_t length);
+	
+	/**
+	Copies a node, possibly from another document, into this document
+	@param node Node to copy
+	@return New node
+	*/
+	PropertyBagNode* copy(const PropertyBagNode &node);
+	
+	/** Memory of the document */
+	PropertyBagArena arena;
+	
+private:
+	PropertyBagDocument(const PropertyBagDocument&);
+	PropertyBagDocument& operator=(const PropertyBagDocument&);
+	
+	/**
+	Gets the interned copy of a tag name
+	@param text Tag name
+	@param length Length of the tag name
+	@param hash Hash of the tag name
+	@return Interned key, unique within the document
+	*/
+	const PropertyBagKey* intern(const char *text, size_t length, size_t hash);
+	
+	/** Rebuilds the key table with a new number of slots */
+	void rehashKeys(size_t numSlots);
+	
+	/** Rebuilds the hash table of a node with a new number of slots */
+	void rehash(PropertyBagNode *node, size_t numSlots);
+	
+	/** Adds a group of a node to the node's hash table */
+	void insertSlot(PropertyBagNode *node, size_t group);
+	
+	/** Key table slots, each holding an interned key or null */
+	const PropertyBagKey **keySlots;
+	
+	/** Number of key table slots, always zero or a power of two */
+	size_t numKeySlots;
+	
+	/** Number of interned keys */
+	size_t numKeys;
+};
+
+#endif
@@ -0,0 +1,299 @@
+#include "Core.h"
+#include "RangeAllocator.h"
+
+RangeAllocatorStatistics::RangeAllocatorStatistics()
+		: capacity(0),
+		used(0),
+		numAllocations(0),
+		numFreeRanges(0),
+		largestFreeRange(0) {}
+
+float RangeAllocatorStatistics::getFragmentation() const {
+	const size_t free = capacity - used;
+	return (free == 0) ? 0.0f : 1.0f - (float)largestFreeRange / free;
+}
+
+void RangeAllocatorStatistics::add(const RangeAllocatorStatistics &o) {
+	capacity += o.capacity;
+	used += o.used;
+	numAllocations += o.numAllocations;
+	numFreeRanges += o.numFreeRanges;
+	largestFreeRange = max(largestFreeRange, o.largestFreeRange);
+}
+
+string RangeAllocatorStatistics::toString() const {
+	return sizet_to_string(used) + " of " +
+	       sizet_to_string(capacity) + " bytes used by " +
+	       sizet_to_string(numAllocations) + " ranges, " +
+	       sizet_to_string(numFreeRanges) + " free ranges, largest " +
+	       sizet_to_string(largestFreeRange) + " bytes, fragmentation " +
+	       ftos(getFragmentation(), 3);
+}
+
+/** Gets the index of the highest bit set, which must exist */
+static int findLastSet(size_t x) {
+	int bit = -1;
+	
+	while (x) {
+		x >>= 1;
+		++bit;
+	}
+	
+	return bit;
+}
+
+/** Gets the index of the lowest bit set, which must exist */
+static int findFirstSet(unsigned int x) {
+	int bit = 0;
+	
+	while (!(x & 1)) {
+		x >>= 1;
+		++bit;
+	}
+	
+	return bit;
+}
+
+RangeAllocator::RangeAllocator(size_t _capacity, size_t _granularity)
+		: flBitmap(0),
+		capacity(_capacity / _granularity),
+		granularity(_granularity),
+		used(0),
+		numAllocations(0) {
+	ASSERT(granularity > 0, "Granularity must be positive");
+	ASSERT(capacity > 0, "Capacity must be at least the granularity");
+	
+	for (int fl=0; fl<FL_COUNT; ++fl) {
+		slBitmap[fl] = 0;
+		
+		for (int sl=0; sl<SL_COUNT; ++sl) {
+			heads[fl][sl] = NONE;
+		}
+	}
+	
+	// The whole span starts out as one free block
+	const size_t block = createBlock();
+	blocks[block].offset = 0;
+	blocks[block].size = capacity;
+	blocks[block].prevPhysical = NONE;
+	blocks[block].nextPhysical = NONE;
+	insertFree(block);
+}
+
+size_t RangeAllocator::allocate(size_t bytes) {
+	const size_t size = max((bytes + granularity - 1) / granularity, (size_t)1);
+	
+	const size_t block = findFree(size);
+	
+	if (block == NONE) {
+		return NONE;
+	}
+	
+	// Return the rest of the block to the free lists
+	const size_t remainder = blocks[block].size - size;
+	
+	if (remainder > 0) {
+		const size_t rest = createBlock();
+		Block &b = blocks[block];
+		Block &r = blocks[rest];
+		
+		r.offset = b.offset + size;
+		r.size = remainder;
+		r.prevPhysical = block;
+		r.nextPhysical = b.nextPhysical;
+		
+		if (b.nextPhysical != NONE) {
+			blocks[b.nextPhysical].prevPhysical = rest;
+		}
+		
+		b.nextPhysical = rest;
+		b.size = size;
+		
+		insertFree(rest);
+	}
+	
+	blocks[block].free = false;
+	used += size;
+	numAllocations++;
+	
+	return block;
+}
+
+void RangeAllocator::free(size_t range) {
+	ASSERT(range < blocks.size() && !blocks[range].free,
+	       "Range is not allocated: " + sizet_to_string(range));
+	
+	size_t block = range;
+	used -= blocks[block].size;
+	numAllocations--;
+	
+	// Merge with the free neighbours
+	const size_t prev = blocks[block].prevPhysical;
+	
+	if (prev != NONE && blocks[prev].free) {
+		removeFree(prev);
+		blocks[prev].size += blocks[block].size;
+		blocks[prev].nextPhysical = blocks[block].nextPhysical;
+		
+		if (blocks[block].nextPhysical != NONE) {
+			blocks[blocks[block].nextPhysical].prevPhysical = prev;
+		}
+		
+		destroyBlock(block);
+		block = prev;
+	}
+	
+	const size_t next = blocks[block].nextPhysical;
+	
+	if (next != NONE && blocks[next].free) {
+		removeFree(next);
+		blocks[block].size += blocks[next].size;
+		blocks[block].nextPhysical = blocks[next].nextPhysical;
+		
+		if (blocks[next].nextPhysical != NONE) {
+			blocks[blocks[next].nextPhysical].prevPhysical = block;
+		}
+		
+		destroyBlock(next);
+	}
+	
+	insertFree(block);
+}
+
+RangeAllocatorStatistics RangeAllocator::getStatistics() const {
+	RangeAllocatorStatistics statistics;
+	statistics.capacity = capacity * granularity;
+	statistics.used = used * granularity;
+	statistics.numAllocations = numAllocations;
+	
+	for (int fl=0; fl<FL_COUNT; ++fl) {
+		for (int sl=0; sl<SL_COUNT; ++sl) {
+			for (size_t i=heads[fl][sl]; i!=NONE; i=blocks[i].nextFree) {
+				statistics.numFreeRanges++;
+				statistics.largestFreeRange = max(statistics.largestFreeRange,
+				                                  blocks[i].size * granularity);
+			}
+		}
+	}
+	
+	return statistics;
+}
+
+void RangeAllocator::mapping(size_t size, int &fl, int &sl) {
+	if (size < (size_t)SL_COUNT) {
+		fl = 0;
+		sl = (int)size;
+	} else {
+		const int msb = findLastSet(size);
+		fl = msb - SL_LOG2 + 1;
+		sl = (int)((size >> (msb - SL_LOG2)) ^ SL_COUNT);
+	}
+	
+	ASSERT(fl < FL_COUNT, "Range is too large: " + sizet_to_string(size));
+}
+
+void RangeAllocator::mappingSearch(size_t size, int &fl, int &sl) {
+	// Round up to the next size class, so that any block found fits
+	if (size >= (size_t)SL_COUNT) {
+		size += ((size_t)1 << (findLastSet(size) - SL_LOG2)) - 1;
+	}
+	
+	mapping(size, fl, sl);
+}
+
+size_t RangeAllocator::findFree(size_t size) {
+	int fl=0, sl=0;
+	mappingSearch(size, fl, sl);
+	
+	unsigned int slMap = slBitmap[fl] & (~0U << sl);
+	
+	if (!slMap) {
+		const unsigned int flMap = (fl+1 < FL_COUNT)
+		                           ? flBitmap & (~0U << (fl+1))
+		                           : 0;
+		
+		if (flMap) {
+			fl = findFirstSet(flMap);
+			slMap = slBitmap[fl];
+		}
+	}
+	
+	if (slMap) {
+		const size_t block = heads[fl][findFirstSet(slMap)];
+		removeFree(block);
+		return block;
+	}
+	
+	// Blocks in the requested size class may still be large enough, such as
+	// when the whole span is asked for
+	mapping(size, fl, sl);
+	
+	for (size_t i=heads[fl][sl]; i!=NONE; i=blocks[i].nextFree) {
+		if (blocks[i].size >= size) {
+			removeFree(i);
+			return i;
+		}
+	}
+	
+	return NONE;
+}
+
+void RangeAllocator::insertFree(size_t block) {
+	int fl=0, sl=0;
+	mapping(blocks[block].size, fl, sl);
+	
+	Block &b = blocks[block];
+	b.free = true;
+	b.prevFree = NONE;
+	b.nextFree = heads[fl][sl];
+	
+	if (b.nextFree != NONE) {
+		blocks[b.nextFree].prevFree = block;
+	}
+	
+	heads[fl][sl] = block;
+	flBitmap |= 1U << fl;
+	slBitmap[fl] |= 1U << sl;
+}
+
+void RangeAllocator::removeFree(size_t block) {
+	int fl=0, sl=0;
+	mapping(blocks[block].size, fl, sl);
+	
+	Block &b = blocks[block];
+	
+	if (b.prevFree != NONE) {
+		blocks[b.prevFree].nextFree = b.nextFree;
+	} else {
+		heads[fl][sl] = b.nextFree;
+	}
+	
+	if (b.nextFree != NONE) {
+		blocks[b.nextFree].prevFree = b.prevFree;
+	}
+	
+	if (heads[fl][sl] == NONE) {
+		slBitmap[fl] &= ~(1U << sl);
+		
+		if (!slBitmap[fl]) {
+			flBitmap &= ~(1U << fl);
+		}
+	}
+	
+	b.free = false;
+}
+
+size_t RangeAllocator::createBlock() {
+	if (!unusedBlocks.empty()) {
+		const size_t block = unusedBlocks.back();
+		unusedBlocks.pop_back();
+		return block;
+	}
+	
+	blocks.push_back(Block());
+	return blocks.size() - 1;
+}
+
+void RangeAllocator::destroyBlock(size_t block) {
+	unusedBlocks.push_back(block);
+}
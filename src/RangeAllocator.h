@@ -0,0 +1,183 @@
+#ifndef _RANGE_ALLOCATOR_H_
+#define _RANGE_ALLOCATOR_H_
+
+/** Counters describing the ranges handed out by an allocator */
+struct RangeAllocatorStatistics {
+	/** Bytes managed by the allocator */
+	size_t capacity;
+	
+	/** Bytes handed out, rounded up to the granularity */
+	size_t used;
+	
+	/** Ranges handed out */
+	size_t numAllocations;
+	
+	/** Separate free ranges, which would be one after defragmenting */
+	size_t numFreeRanges;
+	
+	/** Size of the largest free range, in bytes */
+	size_t largestFreeRange;
+	
+	/** Constructor */
+	RangeAllocatorStatistics();
+	
+	/**
+	Gets the share of the free bytes that lie outside the largest free
+	range: zero when the free space is in one piece, approaching one as it
+	breaks up into many small pieces.
+	*/
+	float getFragmentation() const;
+	
+	/**
+	Adds the counters of another allocator
+	@param o Counters to add
+	*/
+	void add(const RangeAllocatorStatistics &o);
+	
+	/** Gets a readable summary of the counters */
+	string toString() const;
+};
+
+/**
+Hands out ranges of a fixed span of memory that the allocator itself never
+touches, such as a buffer object on the graphics device. This is a
+two-level segregated fit (TLSF) allocator: free ranges are kept in lists
+by size class, found through two levels of bitmaps, so both allocation and
+release take constant time. Released ranges are merged with free
+neighbours at once.
+*/
+class RangeAllocator {
+public:
+	/** Returned when a range could not be allocated */
+	static const size_t NONE = (size_t)-1;
+	
+	/**
+	Constructor
+	@param capacity Size of the span to manage, in bytes
+	@param granularity Every range starts at a multiple of this, and sizes
+	       are rounded up to it
+	*/
+	RangeAllocator(size_t capacity, size_t granularity);
+	
+	/**
+	Allocates a range
+	@param size Size of the range, in bytes
+	@return ID of the range, or NONE if there is no free range large enough
+	*/
+	size_t allocate(size_t size);
+	
+	/**
+	Releases a range
+	@param range ID of the range
+	*/
+	void free(size_t range);
+	
+	/**
+	Gets the start of a range
+	@param range ID of the range
+	@return Offset into the span, in bytes
+	*/
+	inline size_t getOffset(size_t range) const {
+		return blocks[range].offset * granularity;
+	}
+	
+	/**
+	Gets the size of a range, rounded up to the granularity
+	@param range ID of the range
+	@return Size in bytes
+	*/
+	inline size_t getSize(size_t range) const {
+		return blocks[range].size * granularity;
+	}
+	
+	/** Gets the size of the span, in bytes */
+	inline size_t getCapacity() const {
+		return capacity * granularity;
+	}
+	
+	/** Determines whether no ranges are handed out */
+	inline bool isEmpty() const {
+		return numAllocations == 0;
+	}
+	
+	/** Gets the counters describing the ranges handed out */
+	RangeAllocatorStatistics getStatistics() const;
+	
+private:
+	/** Number of second level lists per first level, as a power of two */
+	static const int SL_LOG2 = 4;
+	
+	/** Number of second level lists per first level */
+	static const int SL_COUNT = 1 << SL_LOG2;
+	
+	/** Number of first level lists */
+	static const int FL_COUNT = 32;
+	
+	/** Range of the span, either free or handed out */
+	struct Block {
+		/** Start of the range, in units of the granularity */
+		size_t offset;
+		
+		/** Size of the range, in units of the granularity */
+		size_t size;
+		
+		/** Blocks before and after this one in the span */
+		size_t prevPhysical, nextPhysical;
+		
+		/** Neighbours in the list of free blocks of the same size class */
+		size_t prevFree, nextFree;
+		
+		/** Indicates that the range is free */
+		bool free;
+	};
+	
+	/** Finds the list for blocks of a given size */
+	static void mapping(size_t size, int &fl, int &sl);
+	
+	/** Finds the first list whose blocks are all at least a given size */
+	static void mappingSearch(size_t size, int &fl, int &sl);
+	
+	/** Finds a free block at least the given size and unlinks it */
+	size_t findFree(size_t size);
+	
+	/** Links a free block into the list of its size class */
+	void insertFree(size_t block);
+	
+	/** Unlinks a free block from the list of its size class */
+	void removeFree(size_t block);
+	
+	/** Gets an unused block record */
+	size_t createBlock();
+	
+	/** Returns a block record for reuse */
+	void destroyBlock(size_t block);
+	
+	/** Records for every range of the span, plus unused records */
+	vector<Block> blocks;
+	
+	/** Unused records in the blocks array */
+	vector<size_t> unusedBlocks;
+	
+	/** First free block in each list */
+	size_t heads[FL_COUNT][SL_COUNT];
+	
+	/** Bit set for each first level with any free blocks */
+	unsigned int flBitmap;
+	
+	/** Bit set for each second level list with any free blocks */
+	unsigned int slBitmap[FL_COUNT];
+	
+	/** Size of the span, in units of the granularity */
+	size_t capacity;
+	
+	/** Unit of offsets and sizes, in bytes */
+	size_t granularity;
+	
+	/** Units handed out */
+	size_t used;
+	
+	/** Ranges handed out */
+	size_t numAllocations;
+};
+
+#endif
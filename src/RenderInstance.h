@@ -22,9 +22,17 @@ public:
 	GLenum polygonWinding;
 	GLenum primitiveMode;
 	
+	/** First index drawn */
+	int firstIndex;
+	
+	/** Number of indices drawn, or -1 to draw up to the end of the indices */
+	int numIndices;
+	
 	GeometryChunk() {
 		polygonWinding = GL_CW;
 		primitiveMode = GL_TRIANGLES;
+		firstIndex = 0;
+		numIndices = -1;
 	}
 };
 
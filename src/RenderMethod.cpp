@@ -1,7 +1,11 @@
 #include "stdafx.h"
 #include "RenderMethod.h"
+#include "FileText.h"
 
 RenderMethod::RenderMethod() {
+	boundChunk = 0;
+	cgPositionScale = 0;
+	cgPositionBias = 0;
 	useCG = false;
 }
 
@@ -18,35 +22,91 @@ void RenderMethod::acceptgc(const GeometryChunk &gc) {
 	bucket.push_back(gc);
 }
 
-void RenderMethod::renderChunk(const GeometryChunk &gc) {
-	CHECK_GL_ERROR();
-	
-	glPushMatrix();
-	glMultMatrixf(gc.transformation);
-	
-	// Bind material settings
-	gc.material.bind();
-	setShaderData(gc);
+bool RenderMethod::sharesArrays(const GeometryChunk &a,
+                                const GeometryChunk &b) {
+	return a.vertexArray == b.vertexArray &&
+	       a.normalArray == b.normalArray &&
+	       a.texCoordArray == b.texCoordArray &&
+	       a.colorsArray == b.colorsArray &&
+	       a.indexArray == b.indexArray &&
+	       a.polygonWinding == b.polygonWinding;
+}
+
+void RenderMethod::bindArrays(const GeometryChunk &gc) {
+	if (boundChunk && sharesArrays(*boundChunk, gc)) {
+		return;
+	}
 	
 	glFrontFace(gc.polygonWinding);
 	
-	// Bind vertex arrays
+	// Bind vertex arrays, in whichever format each is held on the GPU
 	gc.texCoordArray->bind();
-	glTexCoordPointer(2, GL_FLOAT, 0, 0);
+	glTexCoordPointer(2,
+	                  gc.texCoordArray->getElementType(),
+	                  (GLsizei)gc.texCoordArray->getStride(),
+	                  gc.texCoordArray->getOffsetPointer());
 	
 	gc.normalArray->bind();
-	glNormalPointer(GL_FLOAT, 0, 0);
+	glNormalPointer(gc.normalArray->getElementType(),
+	                (GLsizei)gc.normalArray->getStride(),
+	                gc.normalArray->getOffsetPointer());
 	
 	gc.vertexArray->bind();
-	glVertexPointer(3, GL_FLOAT, 0, 0);
+	glVertexPointer(3,
+	                gc.vertexArray->getElementType(),
+	                (GLsizei)gc.vertexArray->getStride(),
+	                gc.vertexArray->getOffsetPointer());
 	
 	gc.colorsArray->bind();
-	glColorPointer(4, GL_FLOAT, 0, 0);
+	glColorPointer(4,
+	               gc.colorsArray->getElementType(),
+	               (GLsizei)gc.colorsArray->getStride(),
+	               gc.colorsArray->getOffsetPointer());
 	
-	// And actually render the batch using the element buffer object's indices
-	GLsizei count = gc.indexArray->getNumber();
 	gc.indexArray->bind();
-	glDrawElements(gc.primitiveMode, count, MESH_INDEX_FORMAT, 0);
+	
+	boundChunk = &gc;
+}
+
+void RenderMethod::setPositionDecoding(const GeometryChunk &gc) {
+	const float scale = gc.vertexArray->getDecodeScale();
+	const vec3 &bias = gc.vertexArray->getDecodeBias();
+	
+	if (useCG && cgPositionScale && cgPositionBias) {
+		cgGLSetParameter1f(cgPositionScale, scale);
+		cgGLSetParameter3f(cgPositionBias, bias.x, bias.y, bias.z);
+	} else if (gc.vertexArray->isPacked()) {
+		glTranslatef(bias.x, bias.y, bias.z);
+		glScalef(scale, scale, scale);
+	}
+}
+
+void RenderMethod::renderChunk(const GeometryChunk &gc) {
+	CHECK_GL_ERROR();
+	
+	glPushMatrix();
+	glMultMatrixf(gc.transformation);
+	
+	// Bind material settings. Shader data may depend upon the model-view
+	// matrix, which decoding the positions may change.
+	gc.material.bind();
+	setPositionDecoding(gc);
+	setShaderData(gc);
+	
+	bindArrays(gc);
+	
+	// And actually render the batch using the element buffer object's
+	// indices, or the chunk's range of them
+	const GLenum type = gc.indexArray->getElementType();
+	const size_t indexSize = (type == GL_UNSIGNED_SHORT) ? sizeof(GLushort)
+	                         : sizeof(GLuint);
+	const GLsizei count = (gc.numIndices < 0)
+	                      ? gc.indexArray->getNumber() - gc.firstIndex
+	                      : gc.numIndices;
+	const GLubyte *indices = (const GLubyte*)gc.indexArray->getOffsetPointer()
+	                         + gc.firstIndex * indexSize;
+	                         
+	glDrawElements(gc.primitiveMode, count, type, indices);
 	
 	glPopMatrix();
 	
@@ -62,11 +122,16 @@ void RenderMethod::renderChunks() {
 		cgGLEnableProfile(cgFragmentProfile);
 	}
 	
+	// Other rendering may have bound arrays of its own since the last time
+	boundChunk = 0;
+	
 	for (vector<GeometryChunk>::const_iterator i = bucket.begin();
 	     i != bucket.end(); ++i) {
 		renderChunk(*i);
 	}
 	
+	boundChunk = 0;
+	
 	if (useCG) {
 		cgGLDisableProfile(cgVertexProfile);
 		cgGLDisableProfile(cgFragmentProfile);
@@ -99,14 +164,20 @@ void RenderMethod::setupShader( CGcontext &cg, CGprofile &cgVertexProfile, CGpro
 
 void RenderMethod::createVertexProgram( CGcontext & cg, const FileName &vp ) {
 	TRACE(string("Creating vertex program: ") + vp.str());
-	vertex_program = cgCreateProgramFromFile(cg, CG_SOURCE, vp.c_str(), cgVertexProfile, "main", NULL);
+	const string source = FileText::readFile(vp);
+	vertex_program = cgCreateProgram(cg, CG_SOURCE, source.c_str(), cgVertexProfile, "main", NULL);
 	checkForCgError(cg, "Create vertex program (" + vp.str() + ")");
 	cgGLLoadProgram(vertex_program);
+	
+	// Programs that decode packed positions have these, and others have not
+	cgPositionScale = cgGetNamedParameter(vertex_program, "PositionScale");
+	cgPositionBias = cgGetNamedParameter(vertex_program, "PositionBias");
 }
 
 void RenderMethod::createFragmentProgram( CGcontext & cg, const FileName &fp ) {
 	TRACE(string("Creating fragment program: ") + fp.str());
-	fragment_program = cgCreateProgramFromFile(cg, CG_SOURCE, fp.c_str(), cgFragmentProfile, "main", NULL);
+	const string source = FileText::readFile(fp);
+	fragment_program = cgCreateProgram(cg, CG_SOURCE, source.c_str(), cgFragmentProfile, "main", NULL);
 	checkForCgError(cg, "Create fragment program (" + fp.str() + ")");
 	cgGLLoadProgram(fragment_program);
 }
@@ -51,6 +51,23 @@ protected:
 	/** Render a single geometry chunk using the active settings */
 	virtual void renderChunk(const GeometryChunk &gc);
 	
+	/**
+	Binds the vertex arrays and indices of a geometry chunk, unless they are
+	those of the chunk rendered last, as when consecutive chunks draw the
+	material ranges of one mesh
+	*/
+	void bindArrays(const GeometryChunk &gc);
+	
+	/**
+	Decodes the packed positions of a geometry chunk (see VertexFormat),
+	through the vertex program's PositionScale and PositionBias parameters
+	where it has them, or else through the model-view matrix
+	*/
+	void setPositionDecoding(const GeometryChunk &gc);
+	
+	/** Determines whether two geometry chunks draw from the same arrays */
+	static bool sharesArrays(const GeometryChunk &a, const GeometryChunk &b);
+	
 	/** Allows a RenderMethod to set shader data per geometry chunk */
 	virtual void setShaderData(const GeometryChunk &) {
 		// Do Nothing
@@ -107,9 +124,16 @@ protected:
 protected:
 	vector<GeometryChunk> bucket;
 	
+	/** Chunk whose arrays are bound, or null if none are known to be bound */
+	const GeometryChunk *boundChunk;
+	
 	CGprogram vertex_program;
 	CGprogram fragment_program;
 	
+	/** Parameters of the vertex program that decode packed positions */
+	CGparameter cgPositionScale;
+	CGparameter cgPositionBias;
+	
 	CGprofile cgVertexProfile;
 	CGprofile cgFragmentProfile;
 	
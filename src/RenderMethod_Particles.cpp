@@ -51,13 +51,13 @@ void RenderMethod_Particles::renderParticleBatch(const GeometryChunk &gc) {
 	
 	// Bind vertex arrays
 	gc.colorsArray->bind();
-	glColorPointer(4, GL_FLOAT, 0, 0);
+	glColorPointer(4, GL_FLOAT, 0, gc.colorsArray->getOffsetPointer());
 	
 	gc.texCoordArray->bind();
-	glTexCoordPointer(2, GL_FLOAT, 0, 0);
+	glTexCoordPointer(2, GL_FLOAT, 0, gc.texCoordArray->getOffsetPointer());
 	
 	gc.vertexArray->bind();
-	glVertexPointer(3, GL_FLOAT, 0, 0);
+	glVertexPointer(3, GL_FLOAT, 0, gc.vertexArray->getOffsetPointer());
 	
 	// Draw the geometry without an element buffer
 	glDrawArrays(gc.primitiveMode, 0, count);
@@ -1,9 +1,15 @@
-#include "stdafx.h"
+#include "Core.h"
+#include "gl_wrapper.h"
 #include "ResourceBuffer.h"
 
+extern shared_ptr<BufferPool> g_BufferPool;
+
 template<typename ELEMENT>
 ResourceBuffer<ELEMENT>::~ResourceBuffer() {
-	glDeleteBuffers(1, &handle);
+	if (g_BufferPool) {
+		g_BufferPool->free(range);
+	}
+	
 	delete [] buffer;
 }
 
@@ -12,8 +18,14 @@ ResourceBuffer<ELEMENT>::ResourceBuffer()
 		: locked(false),
 		numElements(0),
 		buffer(0),
-		handle(0),
-		usage(STREAM_DRAW) {
+		usage(STREAM_DRAW),
+		narrow(false),
+		packing(PACK_NONE),
+		packed(false),
+		decodeScale(1.0f),
+		decodeBias(0.0f, 0.0f, 0.0f),
+		dirtyBegin(0),
+		dirtyEnd(0) {
 	// Do Nothing
 }
 
@@ -23,8 +35,14 @@ ResourceBuffer<ELEMENT>::ResourceBuffer(int numElements,
 		: locked(false),
 		numElements(0),
 		buffer(0),
-		handle(0),
-		usage(STREAM_DRAW) {
+		usage(STREAM_DRAW),
+		narrow(false),
+		packing(PACK_NONE),
+		packed(false),
+		decodeScale(1.0f),
+		decodeBias(0.0f, 0.0f, 0.0f),
+		dirtyBegin(0),
+		dirtyEnd(0) {
 	recreate(numElements, buffer, STREAM_DRAW);
 }
 
@@ -33,8 +51,16 @@ ResourceBuffer<ELEMENT>::ResourceBuffer(const ResourceBuffer &copyMe)
 		: locked(false),
 		numElements(0),
 		buffer(0),
-		handle(0),
-		usage(STREAM_DRAW) {
+		usage(STREAM_DRAW),
+		narrow(false),
+		packing(copyMe.packing),
+		packed(false),
+		decodeScale(1.0f),
+		decodeBias(0.0f, 0.0f, 0.0f),
+		dirtyBegin(0),
+		dirtyEnd(0) {
+	ASSERT(copyMe.hasClientCopy(),
+	       "Cannot copy a buffer whose client-side copy was released");
 	recreate(copyMe.numElements, copyMe.buffer, copyMe.usage);
 }
 
@@ -55,7 +81,7 @@ void ResourceBuffer<ELEMENT>::recreate(int numElements,
 	this->usage = usage;
 	
 	create_cpu_buffer(numElements, buffer);
-	create_gpu_buffer(numElements, buffer, getGLUsageToken(usage));
+	upload();
 }
 
 template<typename ELEMENT>
@@ -63,42 +89,82 @@ int ResourceBuffer<ELEMENT>::getNumber() const {
 	return numElements;
 }
 
+template<typename ELEMENT>
+size_t ResourceBuffer<ELEMENT>::getSize() const {
+	return numElements * getStride();
+}
+
+template<typename ELEMENT>
+size_t ResourceBuffer<ELEMENT>::getStride() const {
+	if (narrow) {
+		return sizeof(GLushort);
+	} else if (packed) {
+		return VertexFormat::getStride(packing);
+	} else {
+		return sizeof(ELEMENT);
+	}
+}
+
+template<typename ELEMENT>
+GLenum ResourceBuffer<ELEMENT>::getElementType() const {
+	return packed ? VertexFormat::getComponentType(packing) : GL_FLOAT;
+}
+
+template<> GLenum ResourceBuffer<index_t>::getElementType() const {
+	return narrow ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+template<typename ELEMENT>
+void ResourceBuffer<ELEMENT>::setPacking(VERTEX_PACKING packing) {
+	ASSERT(!locked, "Cannot pack a locked buffer!");
+	
+	if (this->packing == packing) {
+		return;
+	}
+	
+	this->packing = packing;
+	
+	if (numElements > 0) {
+		ASSERT(hasClientCopy(), "Cannot pack a buffer whose client-side copy was released");
+		upload();
+	}
+}
+
 template<typename ELEMENT>
 void ResourceBuffer<ELEMENT>::bind() const {
 	ASSERT(!locked, "Cannot bind buffer for use when the buffer is locked!");
-	CHECK_GL_ERROR();
-	glBindBuffer(getTarget(), handle);
-	CHECK_GL_ERROR();
+	
+	// Streamed data only lasts for the frame in which it was written
+	if (isStreamed() && numElements>0 && !g_BufferPool->isCurrent(range)) {
+		upload();
+	}
+	
+	g_BufferPool->bind(getTarget(), range);
 }
 
 template<typename ELEMENT>
 void* ResourceBuffer<ELEMENT>::lock() {
-	void *mapped_buffer=0;
-	
+	return lock(0, numElements);
+}
+
+template<typename ELEMENT>
+void* ResourceBuffer<ELEMENT>::lock(int first, int count) {
 	ASSERT(!locked, "Cannot lock a buffer that is already locked!");
+	ASSERT(hasClientCopy(), "Cannot lock a buffer whose client-side copy was released");
+	ASSERT(first>=0 && count>=0 && first+count<=numElements,
+	       "Locked range is out of bounds");
 	locked=true;
-	
-	CHECK_GL_ERROR();
-	glBindBuffer(getTarget(), handle);
-	mapped_buffer = glMapBuffer(getTarget(), GL_READ_WRITE);
-	CHECK_GL_ERROR();
-	
-	return mapped_buffer;
+	dirtyBegin=first;
+	dirtyEnd=first+count;
+	return buffer;
 }
 
 template<typename ELEMENT>
 void* ResourceBuffer<ELEMENT>::read_lock() {
-	void *mapped_buffer=0;
-	
 	ASSERT(!locked, "Cannot lock a buffer that is already locked!");
+	ASSERT(hasClientCopy(), "Cannot lock a buffer whose client-side copy was released");
 	locked=true;
-	
-	CHECK_GL_ERROR();
-	glBindBuffer(getTarget(), handle);
-	mapped_buffer = glMapBuffer(getTarget(), GL_READ_ONLY);
-	CHECK_GL_ERROR();
-	
-	return mapped_buffer;
+	return buffer;
 }
 
 template<typename ELEMENT>
@@ -106,10 +172,20 @@ void ResourceBuffer<ELEMENT>::unlock() const {
 	ASSERT(locked, "Cannot unlock a buffer that is not locked!");
 	locked=false;
 	
-	CHECK_GL_ERROR();
-	glBindBuffer(getTarget(), handle);
-	glUnmapBuffer(getTarget());
-	CHECK_GL_ERROR();
+	if (dirtyEnd > dirtyBegin) {
+		uploadDirty();
+	}
+	
+	dirtyBegin=dirtyEnd=0;
+}
+
+template<typename ELEMENT>
+void ResourceBuffer<ELEMENT>::releaseClientCopy() {
+	ASSERT(!locked, "Cannot release a locked buffer!");
+	ASSERT(!isStreamed() || numElements==0,
+	       "Streamed buffers must keep their client-side copy");
+	delete [] buffer;
+	buffer = 0;
 }
 
 template<typename ELEMENT>
@@ -131,22 +207,90 @@ void ResourceBuffer<ELEMENT>::create_cpu_buffer( int numElements, const ELEMENT
 }
 
 template<typename ELEMENT>
-void ResourceBuffer<ELEMENT>::create_gpu_buffer(int numElements,
-  const ELEMENT * buffer,
-  GLenum usage) {
-	GLenum target = getTarget();
+void ResourceBuffer<ELEMENT>::upload() const {
+	if (numElements == 0) {
+		if (g_BufferPool) {
+			g_BufferPool->free(range);
+		}
+		
+		narrow = false;
+		packed = false;
+		return;
+	}
+	
+	ASSERT(g_BufferPool, "Buffer pool has not been created");
+	BufferPool &pool = *g_BufferPool;
 	
-	CHECK_GL_ERROR();
+	vector<GLushort> narrowed;
+	vector<U8> packedElements;
+	const void *data = buffer;
+	
+	narrow = canNarrow(numElements, buffer);
+	
+	fitPacking();
+	packed = packing != PACK_NONE && canPack(0, numElements);
+	
+	if (!packed) {
+		decodeScale = 1.0f;
+		decodeBias.zero();
+	}
+	
+	if (narrow) {
+		narrowElements(numElements, buffer, narrowed);
+		data = &narrowed[0];
+	} else if (packed) {
+		packElements(0, numElements, packedElements);
+		data = &packedElements[0];
+	}
 	
-	// Create and fill a buffer object on the GPU
-	glGenBuffers(1, &handle);
-	glBindBuffer(target, handle);
-	glBufferData(target,
-	             sizeof(ELEMENT) * numElements,
-	             buffer,
-	             usage);
-	             
-	CHECK_GL_ERROR();
+	const size_t size = getSize();
+	
+	if (isStreamed()) {
+		pool.free(range);
+		range = pool.stream(getTarget(), size, data);
+	} else {
+		// Keep the range unless the buffer has changed size
+		if (range.size != size) {
+			pool.free(range);
+			range = pool.allocate(getTarget(), usage, size);
+		}
+		
+		pool.upload(getTarget(), range, 0, size, data);
+	}
+}
+
+template<typename ELEMENT>
+void ResourceBuffer<ELEMENT>::uploadDirty() const {
+	const int count = dirtyEnd - dirtyBegin;
+	
+	// Streamed buffers are written anew, and so is a buffer that has no
+	// range yet or that was modified as a whole. Indices that no longer fit
+	// into 16 bits widen the whole buffer, and elements that no longer fit
+	// the packing pack the whole buffer anew.
+	if (isStreamed() ||
+	    range.handle == 0 ||
+	    count == numElements ||
+	    (narrow && !canNarrow(count, buffer + dirtyBegin)) ||
+	    (packed && !canPack(dirtyBegin, count))) {
+		upload();
+		return;
+	}
+	
+	vector<GLushort> narrowed;
+	vector<U8> packedElements;
+	const void *data = buffer + dirtyBegin;
+	
+	if (narrow) {
+		narrowElements(count, buffer + dirtyBegin, narrowed);
+		data = &narrowed[0];
+	} else if (packed) {
+		packElements(dirtyBegin, count, packedElements);
+		data = &packedElements[0];
+	}
+	
+	const size_t stride = getStride();
+	
+	g_BufferPool->upload(getTarget(), range, dirtyBegin * stride, count * stride, data);
 }
 
 template<typename ELEMENT>
@@ -163,32 +307,113 @@ template<> GLenum ResourceBuffer<index_t>::getTarget() {
 }
 
 template<typename ELEMENT>
-GLenum ResourceBuffer<ELEMENT>::getGLUsageToken(BUFFER_USAGE usage) {
-	switch (usage) {
-	case STREAM_DRAW:
-		return GL_STREAM_DRAW;
-	case STREAM_READ:
-		return GL_STREAM_READ;
-	case STREAM_COPY:
-		return GL_STREAM_COPY;
-	case STATIC_DRAW:
-		return GL_STATIC_DRAW;
-	case STATIC_READ:
-		return GL_STATIC_READ;
-	case STATIC_COPY:
-		return GL_STATIC_COPY;
-	case DYNAMIC_DRAW:
-		return GL_DYNAMIC_DRAW;
-	case DYNAMIC_READ:
-		return GL_DYNAMIC_READ;
-	case DYNAMIC_COPY:
-		return GL_DYNAMIC_COPY;
+bool ResourceBuffer<ELEMENT>::canNarrow(int, const ELEMENT *) {
+	return false;
+}
+
+/**
+Index buffers are narrowed when every index fits into 16 bits, halving
+their size.
+*/
+template<> bool ResourceBuffer<index_t>::canNarrow(int numElements,
+                                                  const index_t *buffer) {
+	for (int i=0; i<numElements; ++i) {
+		if (buffer[i] > 0xFFFF) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+template<typename ELEMENT>
+void ResourceBuffer<ELEMENT>::narrowElements(int,
+                                             const ELEMENT *,
+                                             vector<GLushort> &) {
+	FAIL("Only index buffers can be narrowed");
+}
+
+template<> void ResourceBuffer<index_t>::narrowElements(int numElements,
+                                                       const index_t *buffer,
+                                                       vector<GLushort> &narrowed) {
+	narrowed.assign(buffer, buffer + numElements);
+}
+
+template<typename ELEMENT>
+void ResourceBuffer<ELEMENT>::fitPacking() const {
+	// Only positions need to know the range of the whole buffer
+}
+
+template<> void ResourceBuffer<vec3>::fitPacking() const {
+	if (packing == PACK_POSITIONS) {
+		VertexFormat::fitPositions(buffer, numElements, decodeScale, decodeBias);
+	}
+}
+
+template<typename ELEMENT>
+bool ResourceBuffer<ELEMENT>::canPack(int, int) const {
+	return false;
+}
+
+template<> bool ResourceBuffer<vec3>::canPack(int first, int count) const {
+	switch (packing) {
+	case PACK_POSITIONS:
+		return VertexFormat::canPackPositions(buffer + first,
+		                                      count,
+		                                      decodeScale,
+		                                      decodeBias);
+	case PACK_NORMALS:
+		return true;
 	default:
-		FAIL("Invalid enumerant");
-		return 0;
+		return false;
+	}
+}
+
+template<> bool ResourceBuffer<vec2>::canPack(int first, int count) const {
+	return packing == PACK_TEXCOORDS &&
+	       VertexFormat::canPackTexCoords(buffer + first, count);
+}
+
+template<> bool ResourceBuffer<color>::canPack(int first, int count) const {
+	return packing == PACK_COLORS &&
+	       VertexFormat::canPackColors(buffer + first, count);
+}
+
+template<typename ELEMENT>
+void ResourceBuffer<ELEMENT>::packElements(int, int, vector<U8> &) const {
+	FAIL("Buffers of this type cannot be packed");
+}
+
+template<> void ResourceBuffer<vec3>::packElements(int first,
+                                                  int count,
+                                                  vector<U8> &packedElements) const {
+	packedElements.resize(count * getStride());
+	
+	if (packing == PACK_POSITIONS) {
+		VertexFormat::packPositions(buffer + first,
+		                            count,
+		                            decodeScale,
+		                            decodeBias,
+		                            (S16*)&packedElements[0]);
+	} else {
+		VertexFormat::packNormals(buffer + first, count, (S8*)&packedElements[0]);
 	}
 }
 
+template<> void ResourceBuffer<vec2>::packElements(int first,
+                                                  int count,
+                                                  vector<U8> &packedElements) const {
+	packedElements.resize(count * getStride());
+	VertexFormat::packTexCoords(buffer + first, count, (U16*)&packedElements[0]);
+}
+
+template<> void ResourceBuffer<color>::packElements(int first,
+                                                   int count,
+                                                   vector<U8> &packedElements) const {
+	packedElements.resize(count * getStride());
+	VertexFormat::packColors(buffer + first, count, (U8*)&packedElements[0]);
+}
+
 // template class instantiations
 // (see http://www.codeproject.com/cpp/templatesourceorg.asp)
 template class ResourceBuffer<vec3>;
@@ -4,32 +4,31 @@
 #include "vec2.h"
 #include "vec3.h"
 #include "color.h"
+#include "BufferPool.h"
+#include "VertexFormat.h"
 
-#if 0
-#define MESH_INDEX_FORMAT (GLenum)(GL_UNSIGNED_SHORT)
-typedef unsigned short index_t;
-#else
-#define MESH_INDEX_FORMAT (GLenum)(GL_UNSIGNED_INT)
+/**
+Index of a vertex. Index buffers whose indices all fit in 16 bits are
+narrowed to 16 bits on the GPU, see ResourceBuffer::getElementType.
+*/
 typedef unsigned int index_t;
-#endif
-
-enum BUFFER_USAGE {
-	STREAM_DRAW,
-	STREAM_READ,
-	STREAM_COPY,
-	STATIC_DRAW,
-	STATIC_READ,
-	STATIC_COPY,
-	DYNAMIC_DRAW,
-	DYNAMIC_READ,
-	DYNAMIC_COPY
-};
-
 
 /**
 Contains a buffer of graphically related data such as an index array or a
 vertex array. This data may be stored in memory on the graphics device after
-being submitted.
+being submitted, in a range of one of the large buffer objects handed out
+by the buffer pool. Buffers with a STREAM usage are instead written through
+the pool's per-frame ring buffer each time they are modified.
+
+The copy on the client-side is authoritative: locking a buffer never reads
+back from the graphics device. Writes are tracked as a dirty range of
+elements, and only that range is submitted when the buffer is unlocked.
+Buffers that are never read or modified again may release the copy on the
+client-side once it has been submitted.
+
+Vertex buffers may be packed into one of the compact formats of
+VertexFormat as they are submitted, see setPacking. Like narrowed indices,
+a buffer is only packed when its contents survive packing.
 */
 template<typename ELEMENT>
 class ResourceBuffer {
@@ -82,37 +81,169 @@ public:
 	*/
 	int getNumber() const;
 	
-	/** Binds the buffer for use on the GPU */
+	/**
+	Gets the size of the buffer on the GPU
+	@return Size in bytes
+	*/
+	size_t getSize() const;
+	
+	/**
+	Gets the size that the buffer would have on the GPU as floats, or as
+	32-bit indices
+	@return Size in bytes
+	*/
+	inline size_t getUnpackedSize() const {
+		return numElements * sizeof(ELEMENT);
+	}
+	
+	/**
+	Gets the type of the elements as they are stored on the GPU. Index
+	buffers hold 16-bit indices whenever every index fits, and vertex
+	buffers hold the components of their packed format once packed.
+	@return GL type enumerant
+	*/
+	GLenum getElementType() const;
+	
+	/** Gets the size of one element on the GPU, in bytes */
+	size_t getStride() const;
+	
+	/**
+	Sets the compact format that the buffer is held in on the GPU, whenever
+	its contents survive packing. The buffer is submitted again if it has
+	already been.
+	@param packing Format, which must suit the type of the elements
+	*/
+	void setPacking(VERTEX_PACKING packing);
+	
+	/** Gets the compact format that the buffer may be held in on the GPU */
+	inline VERTEX_PACKING getPacking() const {
+		return packing;
+	}
+	
+	/** Indicates that the buffer is held on the GPU in its packed format */
+	inline bool isPacked() const {
+		return packed;
+	}
+	
+	/** Gets the scale that decodes packed positions, or one if unpacked */
+	inline float getDecodeScale() const {
+		return decodeScale;
+	}
+	
+	/** Gets the bias that decodes packed positions, or zero if unpacked */
+	inline const vec3& getDecodeBias() const {
+		return decodeBias;
+	}
+	
+	/**
+	Binds the buffer object holding the buffer for use on the GPU. The
+	buffer starts at getOffsetPointer() within the buffer object.
+	*/
 	void bind() const;
 	
 	/**
-	Locks the buffer to allow read-write access by the client.
+	Gets the start of the buffer within its buffer object, to be passed to
+	gl*Pointer or glDrawElements once the buffer is bound
+	*/
+	inline const GLvoid* getOffsetPointer() const {
+		return (const GLvoid*)range.offset;
+	}
+	
+	/**
+	Locks the buffer to allow read-write access by the client. The whole
+	buffer is submitted to the GPU again when it is unlocked.
 	@return elements array
 	*/
 	void* lock();
 	
 	/**
-	Obtaind read access to the buffer. Do not rely on write access.
+	Locks the buffer to allow read-write access by the client, where only
+	some of the elements will be modified. Only those elements are submitted
+	to the GPU again when the buffer is unlocked.
+	@param first Index of the first element to be modified
+	@param count Number of elements to be modified
+	@return elements array, starting from the first element of the buffer
+	*/
+	void* lock(int first, int count);
+	
+	/**
+	Obtaind read access to the buffer. Do not rely on write access. Reads
+	come from the copy on the client-side and never from the GPU.
 	@return elements array
 	*/
 	void* read_lock();
 	
 	/**
-	Unlocks the buffer and removes memory maps.
+	Unlocks the buffer, submitting any changes to the GPU.
 	Only call on locked buffers.
 	*/
 	void unlock() const;
 	
+	/**
+	Releases the copy of the buffer on the client-side, leaving only the
+	copy on the GPU. Afterwards, the buffer can no longer be locked or
+	cloned. Buffers with a STREAM usage are written again each frame and
+	must keep their copy.
+	*/
+	void releaseClientCopy();
+	
+	/** Determines whether the buffer still has a copy on the client-side */
+	inline bool hasClientCopy() const {
+		return buffer!=0 || numElements==0;
+	}
+	
+	/** Gets the usage hint given when the buffer was created */
+	inline BUFFER_USAGE getUsage() const {
+		return usage;
+	}
+	
 private:
 	void create_cpu_buffer(int numElements, const ELEMENT * buffer);
 	
-	void create_gpu_buffer(int numElements,
-	                       const ELEMENT * buffer,
-	                       GLenum usage);
-	                       
+	/** Submits the client-side buffer to the GPU */
+	void upload() const;
+	
+	/** Submits the dirty range of the client-side buffer to the GPU */
+	void uploadDirty() const;
+	
+	/** Determines whether the buffer is streamed, rather than allocated */
+	inline bool isStreamed() const {
+		return usage == STREAM_DRAW || usage == STREAM_READ || usage == STREAM_COPY;
+	}
+	
 	static GLenum getTarget();
 	
-	static GLenum getGLUsageToken(BUFFER_USAGE usage);
+	/** Determines whether the elements fit into 16-bit indices */
+	static bool canNarrow(int numElements, const ELEMENT *buffer);
+	
+	/**
+	Converts the elements to 16-bit indices
+	@param numElements Number of elements
+	@param buffer Elements to convert
+	@param narrowed Receives the converted elements
+	*/
+	static void narrowElements(int numElements,
+	                           const ELEMENT *buffer,
+	                           vector<GLushort> &narrowed);
+	                           
+	/** Chooses how positions are packed from the whole buffer */
+	void fitPacking() const;
+	
+	/**
+	Determines whether elements survive being packed, with the packing
+	chosen by the last call to fitPacking
+	@param first Index of the first element
+	@param count Number of elements
+	*/
+	bool canPack(int first, int count) const;
+	
+	/**
+	Converts elements to the packed format
+	@param first Index of the first element
+	@param count Number of elements
+	@param packed Receives the packed elements
+	*/
+	void packElements(int first, int count, vector<U8> &packed) const;
 	
 private:
 	/** Indicates that the buffer is currently locked */
@@ -124,11 +255,32 @@ private:
 	/** Buffer, stored on the client-side */
 	ELEMENT *buffer;
 	
-	/** OpenGL buffer object name */
-	GLuint handle;
+	/** Range of a buffer object holding the buffer on the GPU */
+	mutable BufferRange range;
 	
 	/** Store this so if we are cloned, the copy can set usage properly */
 	BUFFER_USAGE usage;
+	
+	/** Indicates that the GPU holds the elements as 16-bit indices */
+	mutable bool narrow;
+	
+	/** Compact format that the buffer may be held in on the GPU */
+	VERTEX_PACKING packing;
+	
+	/** Indicates that the GPU holds the elements in the packed format */
+	mutable bool packed;
+	
+	/** Packed positions are decoded as position * decodeScale + decodeBias */
+	mutable float decodeScale;
+	
+	/** Packed positions are decoded as position * decodeScale + decodeBias */
+	mutable vec3 decodeBias;
+	
+	/** First element that may be modified while the buffer is locked */
+	mutable int dirtyBegin;
+	
+	/** One past the last element that may be modified while locked */
+	mutable int dirtyEnd;
 };
 
 /* Buffers for various purposes */
@@ -3,6 +3,7 @@
 #include "FileFuncs.h"
 #include "ScreenShot.h"
 #include "devil_wrapper.h"
+#include "Thread.h"
 
 static FileName getScreenShotFileName(const string &prefix) {
 	int highestNumber = 0;
@@ -30,6 +31,8 @@ static FileName getScreenShotFileName(const string &prefix) {
 }
 
 void takeScreenShot(const string prefix) {
+	MutexLock lock(devil_getMutex());
+	
 	ILuint handle=0;
 	ilGenImages(1, &handle);
 	
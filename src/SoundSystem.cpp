@@ -10,13 +10,42 @@
 
 #include "stdafx.h"
 #include "SoundSystem.h"
+#include "VirtualFileSystem.h"
+#include "AssetLoader.h"
+#include "AssetRequestSound.h"
 
+/** Memory that sound effects not being played may keep resident */
+static const size_t SOUND_BUDGET = 32 * 1024 * 1024;
+
+SoundSystem::Sample::~Sample() {
+	if (sample) {
+		::FSOUND_Sample_Free(sample);
+	}
+}
+
+SoundSystem::Sample::Sample(FSOUND_SAMPLE *_sample)
+		: sample(_sample) {}
+		
+size_t SoundSystem::Sample::getSize() const {
+	if (!sample) {
+		return 0;
+	}
+	
+	const unsigned int mode = ::FSOUND_Sample_GetMode(sample);
+	size_t bytesPerSample = (mode & FSOUND_16BITS) ? 2 : 1;
+	
+	if (mode & FSOUND_STEREO) {
+		bytesPerSample *= 2;
+	}
+	
+	return ::FSOUND_Sample_GetLength(sample) * bytesPerSample;
+}
 
 SoundSystem::SoundSystem(UID uid, ScopedEventHandler *parentScope)
-		: ScopedEventHandlerSubscriber(uid, parentScope) {
+		: ScopedEventHandlerSubscriber(uid, parentScope),
+		cache("Sounds", SOUND_BUDGET) {
 	REGISTER_HANDLER(SoundSystem::handleActionPlaySound);
 	
-	cache.clear();
 	soundVolume = 1.0f;
 	musicVolume = 0.5f;
 	mute = false;
@@ -37,6 +66,7 @@ void SoundSystem::handleActionPlaySound( const ActionPlaySound *action ) {
 
 SoundSystem::~SoundSystem() {
 	stopMusic();
+	cache.clear(); // samples must be freed while FMOD is running
 	FSOUND_Close();
 }
 
@@ -50,9 +80,23 @@ void SoundSystem::playMusic(const FileName &fileName) {
 	stopMusic();
 	
 	if (!mute && fileName!=FileName("none") && fileName!=FileName("")) {
-		musicStream = FSOUND_Stream_Open(fileName.c_str(),
-		                                 FSOUND_LOOP_NORMAL,
-		                                 0, 0);
+		shared_ptr<PackFile> pack;
+		const U8 *data = 0;
+		size_t size = 0;
+		
+		if (VirtualFileSystem::find(fileName, pack, data, size) &&
+		    musicFile.open(fileName)) {
+			// FMOD streams from the archive, which stays open until stopMusic
+			musicStream = FSOUND_Stream_Open(musicFile.begin(),
+			                                 FSOUND_LOOP_NORMAL | FSOUND_LOADMEMORY,
+			                                 0,
+			                                 (int)musicFile.getSize());
+		} else {
+			musicStream = FSOUND_Stream_Open(fileName.c_str(),
+			                                 FSOUND_LOOP_NORMAL,
+			                                 0, 0);
+		}
+		
 		musicChannel = FSOUND_Stream_Play(FSOUND_FREE, musicStream);
 		TRACE("Playing music: " + fileName.str());
 	}
@@ -224,20 +268,53 @@ signed char SoundSystem::FSOUND_Stream_Close(FSOUND_STREAM *stream) {
 }
 
 FSOUND_SAMPLE * SoundSystem::getSample( const FileName &fileName ) {
-	map<FileName, FSOUND_SAMPLE*>::const_iterator i;
-	FSOUND_SAMPLE *sound = 0;
-	
-	i = cache.find(fileName); // check for it in the cache
+	shared_ptr<Sample> sample = cache.find(fileName); // check for it in the cache
 	
-	if (i == cache.end()) {
-		sound = FSOUND_Sample_Load(FSOUND_FREE, fileName.c_str(), 0, 0, 0);
-		cache.insert(make_pair(fileName, sound)); // cache the sound chunk
+	if (!sample) {
+		const FileMapping file(fileName);
+		
+		if (file.isOpen()) {
+			return cacheSample(fileName, file);
+		}
+		
+		sample = shared_ptr<Sample>(new Sample(FSOUND_Sample_Load(FSOUND_FREE, fileName.c_str(), 0, 0, 0)));
+		cache.insert(fileName, sample, sample->getSize()); // cache the sound chunk
 		TRACE("Loaded and cached sound file:" + fileName.str());
-	} else {
-		sound = i->second;
 	}
 	
-	return sound;
+	return sample->sample;
+}
+
+FSOUND_SAMPLE * SoundSystem::cacheSample(const FileName &fileName,
+                                         const FileMapping &file) {
+	shared_ptr<Sample> sample = cache.find(fileName);
+	
+	if (sample) {
+		return sample->sample; // played before the preload finished
+	}
+	
+	// FMOD copies and decodes the sample, so the file may be closed
+	sample = shared_ptr<Sample>(new Sample(FSOUND_Sample_Load(FSOUND_FREE,
+	                                                          file.begin(),
+	                                                          FSOUND_LOADMEMORY,
+	                                                          0,
+	                                                          (int)file.getSize())));
+	                                                          
+	cache.insert(fileName, sample, sample->getSize()); // cache the sound chunk
+	TRACE("Loaded and cached sound file:" + fileName.str());
+	
+	return sample->sample;
+}
+
+void SoundSystem::preload(const FileName &fileName, AssetLoader &loader) {
+	if (!cache.find(fileName)) {
+		shared_ptr<AssetRequest> request(new AssetRequestSound(this, fileName));
+		loader.load(request);
+	}
+}
+
+void SoundSystem::invalidate(const FileName &fileName) {
+	cache.remove(fileName);
 }
 
 void SoundSystem::stopMusic() {
@@ -246,4 +323,6 @@ void SoundSystem::stopMusic() {
 		FSOUND_Stream_Close(musicStream);
 		musicStream=0;
 	}
+	
+	musicFile.close();
 }
@@ -3,6 +3,10 @@
 
 #include "ScopedEventHandler.h"
 #include "ActionPlaySound.h"
+#include "FileMapping.h"
+#include "AssetCache.h"
+
+class AssetLoader;
 
 // FMOD defined types
 typedef struct FSOUND_SAMPLE FSOUND_SAMPLE;
@@ -28,6 +32,21 @@ public:
 	*/
 	void play(const FileName &fileName);
 	
+	/**
+	Loads a sound file in the background, so that it does not have to be
+	loaded when it is first played
+	@param fileName The name of the sound file
+	@param loader Loader to load the sound with
+	*/
+	void preload(const FileName &fileName, AssetLoader &loader);
+	
+	/**
+	Drops a sound file from the cache, so that it is loaded again the next
+	time it is played
+	@param fileName The name of the sound file
+	*/
+	void invalidate(const FileName &fileName);
+	
 	/**
 	Plays music
 	@param fileName The name of a music file
@@ -57,10 +76,43 @@ public:
 	void setMute(bool mute);
 	
 private:
+	/** Decoded sound sample, freed along with this object */
+	class Sample {
+	public:
+		/** Destructor */
+		~Sample();
+		
+		/**
+		Constructor
+		@param sample Sample to take ownership of, which may be null
+		*/
+		Sample(FSOUND_SAMPLE *sample);
+		
+		/** Gets the memory used by the decoded sample, in bytes */
+		size_t getSize() const;
+		
+		/** The sample, or null if it failed to load */
+		FSOUND_SAMPLE * const sample;
+		
+	private:
+		Sample(const Sample&);
+		Sample& operator=(const Sample&);
+	};
+	
 	void handleActionPlaySound(const ActionPlaySound *action);
 	
 	FSOUND_SAMPLE * getSample( const FileName &fileName);
 	
+	/**
+	Decodes a sound file that has been read into memory, and caches it
+	@param fileName The name of the sound file
+	@param file Contents of the sound file
+	@return The sample, which may be one that was already cached
+	*/
+	FSOUND_SAMPLE * cacheSample(const FileName &fileName, const FileMapping &file);
+	
+	friend class AssetRequestSound;
+	
 	static int FSOUND_Init(int mixrate, int maxsoftwarechannels, unsigned int flags);
 	static FSOUND_SAMPLE * FSOUND_Sample_Load(int index, const char *name_or_data, unsigned int mode, int offset, int length);
 	static void FSOUND_StopSound(int channel);
@@ -84,11 +136,14 @@ private:
 	float musicVolume;
 	
 	/** Quick reference to loaded sound effects */
-	map<FileName, FSOUND_SAMPLE*> cache;
+	AssetCache<Sample> cache;
 	
 	/** Music stream */
 	FSOUND_STREAM *musicStream;
 	
+	/** Contents of a music file in a pack file, streamed from memory */
+	FileMapping musicFile;
+	
 	/** Channel that music plays on */
 	int musicChannel;
 };
@@ -0,0 +1,262 @@
+#include "stdafx.h"
+#include "SpatialIndex.h"
+
+namespace {
+
+/** Collects actors within a sphere */
+class CollectInRadius {
+public:
+	CollectInRadius(const vec3 &center,
+	                float radius,
+	                SpatialIndex::ActorIDList &results)
+			: center(center),
+			radiusSqr(radius*radius),
+			results(results) {}
+	
+	void operator()(ActorID id, const vec3 &position) {
+		if (position.distanceSqr(center) <= radiusSqr) {
+			results.push_back(id);
+		}
+	}
+	
+private:
+	vec3 center;
+	float radiusSqr;
+	SpatialIndex::ActorIDList &results;
+};
+
+/** Collects actors within an axis-aligned bounding box */
+class CollectInBox {
+public:
+	CollectInBox(const vec3 &mins,
+	             const vec3 &maxs,
+	             SpatialIndex::ActorIDList &results)
+			: mins(mins),
+			maxs(maxs),
+			results(results) {}
+	
+	void operator()(ActorID id, const vec3 &position) {
+		if (position.x >= mins.x && position.x <= maxs.x &&
+		    position.y >= mins.y && position.y <= maxs.y &&
+		    position.z >= mins.z && position.z <= maxs.z) {
+			results.push_back(id);
+		}
+	}
+	
+private:
+	vec3 mins, maxs;
+	SpatialIndex::ActorIDList &results;
+};
+
+/** Collects every actor along with its squared distance from a point */
+class CollectCandidates {
+public:
+	typedef vector<pair<float, ActorID> > Candidates;
+	
+	CollectCandidates(const vec3 &center, Candidates &candidates)
+			: center(center),
+			candidates(candidates) {}
+	
+	void operator()(ActorID id, const vec3 &position) {
+		candidates.push_back(make_pair(position.distanceSqr(center), id));
+	}
+	
+private:
+	vec3 center;
+	Candidates &candidates;
+};
+
+} // namespace
+
+SpatialIndex::SpatialIndex(float _cellSize, size_t numBuckets)
+		: cellSize(_cellSize),
+		inverseCellSize(1.0f / _cellSize),
+		buckets(numBuckets) {
+	ASSERT(cellSize > 0.0f, "Cell size must be positive");
+	ASSERT(numBuckets > 0, "There must be at least one bucket");
+}
+
+void SpatialIndex::clear() {
+	for (vector<Bucket>::iterator i = buckets.begin(); i != buckets.end(); ++i) {
+		i->clear();
+	}
+	
+	entries.clear();
+}
+
+size_t SpatialIndex::findInBucket(const Bucket &bucket, ActorID id) {
+	size_t i = 0;
+	
+	while (i < bucket.size() && bucket[i].id != id) {
+		++i;
+	}
+	
+	return i;
+}
+
+void SpatialIndex::update(ActorID id, const vec3 &position) {
+	const Cell cell = toCell(position);
+	MapIDToCell::iterator iter = entries.find(id);
+	
+	if (iter != entries.end()) {
+		Cell &oldCell = iter->second;
+		Bucket &oldBucket = buckets[getBucket(oldCell.x, oldCell.y)];
+		const size_t idx = findInBucket(oldBucket, id);
+		ASSERT(idx < oldBucket.size(), "Spatial index is inconsistent");
+		
+		if (oldCell.x == cell.x && oldCell.y == cell.y) {
+			// Still in the same cell; only the position changes
+			oldBucket[idx].position = position;
+			return;
+		}
+		
+		oldBucket[idx] = oldBucket.back();
+		oldBucket.pop_back();
+		oldCell = cell;
+	} else {
+		entries.insert(make_pair(id, cell));
+	}
+	
+	Item item;
+	item.id = id;
+	item.cell = cell;
+	item.position = position;
+	buckets[getBucket(cell.x, cell.y)].push_back(item);
+}
+
+void SpatialIndex::remove(ActorID id) {
+	MapIDToCell::iterator iter = entries.find(id);
+	
+	if (iter != entries.end()) {
+		const Cell &cell = iter->second;
+		Bucket &bucket = buckets[getBucket(cell.x, cell.y)];
+		const size_t idx = findInBucket(bucket, id);
+		
+		if (idx < bucket.size()) {
+			bucket[idx] = bucket.back();
+			bucket.pop_back();
+		}
+		
+		entries.erase(iter);
+	}
+}
+
+bool SpatialIndex::getPosition(ActorID id, vec3 &position) const {
+	MapIDToCell::const_iterator iter = entries.find(id);
+	
+	if (iter == entries.end()) {
+		return false;
+	}
+	
+	const Cell &cell = iter->second;
+	const Bucket &bucket = buckets[getBucket(cell.x, cell.y)];
+	const size_t idx = findInBucket(bucket, id);
+	
+	if (idx == bucket.size()) {
+		return false;
+	}
+	
+	position = bucket[idx].position;
+	return true;
+}
+
+template<typename FN>
+void SpatialIndex::forEachInCells(int minX, int minY,
+                                  int maxX, int maxY,
+                                  FN &fn) const {
+	for (int y = minY; y <= maxY; ++y) {
+		for (int x = minX; x <= maxX; ++x) {
+			const Bucket &bucket = buckets[getBucket(x, y)];
+			
+			for (Bucket::const_iterator i = bucket.begin(); i != bucket.end(); ++i) {
+				// Several cells may share a bucket
+				if (i->cell.x == x && i->cell.y == y) {
+					fn(i->id, i->position);
+				}
+			}
+		}
+	}
+}
+
+void SpatialIndex::queryRadius(const vec3 &center,
+                               float radius,
+                               ActorIDList &results) const {
+	const Cell mins = toCell(center - vec3(radius, radius, 0));
+	const Cell maxs = toCell(center + vec3(radius, radius, 0));
+	CollectInRadius fn(center, radius, results);
+	forEachInCells(mins.x, mins.y, maxs.x, maxs.y, fn);
+}
+
+void SpatialIndex::queryAABB(const vec3 &mins,
+                             const vec3 &maxs,
+                             ActorIDList &results) const {
+	const Cell minCell = toCell(mins);
+	const Cell maxCell = toCell(maxs);
+	CollectInBox fn(mins, maxs, results);
+	forEachInCells(minCell.x, minCell.y, maxCell.x, maxCell.y, fn);
+}
+
+void SpatialIndex::queryNearest(const vec3 &center,
+                                size_t k,
+                                ActorIDList &results) const {
+	if (k == 0 || entries.empty()) {
+		return;
+	}
+	
+	const Cell c = toCell(center);
+	CollectCandidates::Candidates candidates;
+	CollectCandidates fn(center, candidates);
+	
+	/*
+	Search rings of cells of increasing size around the center cell. Any
+	actor outside the rings searched so far is at least r*cellSize away
+	from the center, so we may stop once the k-th closest candidate is
+	nearer than that. We also stop once every actor has been seen. If the
+	actors are so sparse that the rings cover more cells than there are
+	buckets then it is cheaper to simply examine every actor.
+	*/
+	for (int r = 0; ; ++r) {
+		if ((size_t)((2*r+1) * (2*r+1)) > buckets.size()) {
+			candidates.clear();
+			
+			for (vector<Bucket>::const_iterator i = buckets.begin();
+			     i != buckets.end(); ++i) {
+				for (Bucket::const_iterator j = i->begin(); j != i->end(); ++j) {
+					fn(j->id, j->position);
+				}
+			}
+			
+			break;
+		} else if (r == 0) {
+			forEachInCells(c.x, c.y, c.x, c.y, fn);
+		} else {
+			forEachInCells(c.x-r, c.y-r, c.x+r, c.y-r, fn); // bottom row
+			forEachInCells(c.x-r, c.y+r, c.x+r, c.y+r, fn); // top row
+			forEachInCells(c.x-r, c.y-r+1, c.x-r, c.y+r-1, fn); // left column
+			forEachInCells(c.x+r, c.y-r+1, c.x+r, c.y+r-1, fn); // right column
+		}
+		
+		if (candidates.size() == entries.size()) {
+			break;
+		}
+		
+		if (candidates.size() >= k) {
+			nth_element(candidates.begin(),
+			            candidates.begin() + (k-1),
+			            candidates.end());
+			
+			const float bound = r * cellSize;
+			
+			if (candidates[k-1].first <= bound*bound) {
+				break;
+			}
+		}
+	}
+	
+	const size_t n = min(k, candidates.size());
+	partial_sort(candidates.begin(), candidates.begin() + n, candidates.end());
+	
+	for (size_t i = 0; i < n; ++i) {
+		results.push_back(candidates[i].second);
+	}
+}
@@ -0,0 +1,129 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+/**
+Spatial hash of actor positions.
+The XY plane is divided into a uniform grid of square cells and each cell is
+hashed into a fixed number of buckets. Actors are filed in the bucket of the
+cell that contains them, so proximity queries only examine actors in the
+cells that overlap the query region and run in time proportional to the
+local density of actors rather than the total number of actors.
+*/
+class SpatialIndex {
+public:
+	typedef vector<ActorID> ActorIDList;
+	
+	/**
+	Constructor
+	@param cellSize Length of a grid cell on each side
+	@param numBuckets Number of hash buckets the cells are hashed into
+	*/
+	SpatialIndex(float cellSize = 4.0f, size_t numBuckets = 1024);
+	
+	/** Removes all actors from the index */
+	void clear();
+	
+	/**
+	Inserts an actor into the index or moves it to a new position
+	@param id Actor to insert or move
+	@param position New position of the actor
+	*/
+	void update(ActorID id, const vec3 &position);
+	
+	/** Removes an actor from the index, if it is present */
+	void remove(ActorID id);
+	
+	/**
+	Gets the position of an actor in the index
+	@param id Actor to look up
+	@param position Returns the indexed position of the actor
+	@return true if the actor is present in the index
+	*/
+	bool getPosition(ActorID id, vec3 &position) const;
+	
+	/** Gets the number of actors in the index */
+	inline size_t size() const {
+		return entries.size();
+	}
+	
+	/**
+	Finds all actors within some distance of a point
+	@param center Center of the query sphere
+	@param radius Radius of the query sphere
+	@param results Returns the actors within the sphere (appended)
+	*/
+	void queryRadius(const vec3 &center,
+	                 float radius,
+	                 ActorIDList &results) const;
+	
+	/**
+	Finds all actors within an axis-aligned bounding box
+	@param mins Minimum corner of the box
+	@param maxs Maximum corner of the box
+	@param results Returns the actors within the box (appended)
+	*/
+	void queryAABB(const vec3 &mins,
+	               const vec3 &maxs,
+	               ActorIDList &results) const;
+	
+	/**
+	Finds the actors closest to a point
+	@param center Point to search around
+	@param k Maximum number of actors to find
+	@param results Returns up to k actors, ordered by increasing distance
+	               from the point (appended)
+	*/
+	void queryNearest(const vec3 &center,
+	                  size_t k,
+	                  ActorIDList &results) const;
+	
+private:
+	/** Grid cell coordinates */
+	struct Cell {
+		int x, y;
+	};
+	
+	/** Actor stored in a bucket */
+	struct Item {
+		ActorID id;
+		Cell cell;
+		vec3 position;
+	};
+	
+	typedef vector<Item> Bucket;
+	typedef map<ActorID, Cell> MapIDToCell;
+	
+	/** Gets the grid cell containing a point */
+	inline Cell toCell(const vec3 &position) const {
+		Cell cell;
+		cell.x = (int)floorf(position.x * inverseCellSize);
+		cell.y = (int)floorf(position.y * inverseCellSize);
+		return cell;
+	}
+	
+	/** Gets the bucket that a grid cell is hashed into */
+	inline size_t getBucket(int x, int y) const {
+		return (((unsigned)x * 73856093U) ^ ((unsigned)y * 19349663U)) % buckets.size();
+	}
+	
+	/**
+	Finds an actor in a bucket
+	@return index of the actor in the bucket, or the bucket size if absent
+	*/
+	static size_t findInBucket(const Bucket &bucket, ActorID id);
+	
+	/**
+	Calls a function for each actor in a rectangle of grid cells
+	@param fn Called for each actor with the actor's ID and position
+	*/
+	template<typename FN>
+	void forEachInCells(int minX, int minY, int maxX, int maxY, FN &fn) const;
+	
+private:
+	float cellSize;
+	float inverseCellSize;
+	vector<Bucket> buckets;
+	MapIDToCell entries;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include "Mesh.h"
 #include "PhysicsEngine.h"
 #include "devil_wrapper.h"
+#include "Thread.h"
+#include "JobGraph.h"
 #include "ActionQueueRenderInstance.h"
 #include "GrassLayer.h"
 #include "TreeLayer.h"
@@ -52,6 +54,7 @@ void Terrain::clear() {
 HeightMapData Terrain::loadHeightMap(const FileName &fileName) {
 	CHECK_GL_ERROR();
 	
+	MutexLock lock(devil_getMutex());
 	unsigned int imageName = devil_loadImage(fileName);
 	
 	// Get image data
@@ -87,35 +90,41 @@ HeightMapData Terrain::loadHeightMap(const FileName &fileName) {
 	return data;
 }
 
-void Terrain::generateVertices(vector<vec3> &verticesArray,
-                               vector<vec3> &normalsArray,
-                               vector<vec2> &texcoordsArray,
-                               const int heightmapSize,
-                               const float *heightmap,
-                               const float scaleXY,
-                               const float scaleZ) {
-	const int numVertices = heightmapSize * heightmapSize;
-	
-	verticesArray.resize(numVertices);
-	normalsArray.resize(numVertices);
-	texcoordsArray.resize(numVertices);
-	
-	for (int y=0; y<heightmapSize; ++y) {
+void Terrain::generateVertices(PendingGeometry *geometry,
+                               HeightMapData heightmap,
+                               float scaleXY,
+                               float scaleZ,
+                               int beginRow,
+                               int endRow) {
+	const int heightmapSize = heightmap.w;
+	vector<vec3> &verticesArray = geometry->vertices;
+	vector<vec3> &normalsArray = geometry->normals;
+	vector<vec2> &texcoordsArray = geometry->texcoords;
+	
+	for (int y=beginRow; y<endRow; ++y) {
 		for (int x=0; x<heightmapSize; ++x) {
 			const size_t idx = y*heightmapSize + x;
 			
 			verticesArray[idx] = vec3((float)x*scaleXY,
 			                          (float)y*scaleXY,
-			                          heightmap[idx]*scaleZ);
+			                          heightmap.heightmap[idx]*scaleZ);
 			                          
 			normalsArray[idx] = vec3(0,0,1); // fake
 			
 			texcoordsArray[idx] = vec2((float)x, (float)y);
 		}
 	}
+}
+
+void Terrain::generateNormals(PendingGeometry *geometry,
+                              int heightmapSize,
+                              int beginRow,
+                              int endRow) {
+	const vector<vec3> &verticesArray = geometry->vertices;
+	vector<vec3> &normalsArray = geometry->normals;
 	
 	// Generate face normals (except for edge vertices, don't care about them)
-	for (int y=1; y<heightmapSize-1; ++y) {
+	for (int y=max(beginRow, 1); y<min(endRow, heightmapSize-1); ++y) {
 		for (int x=1; x<heightmapSize-1; ++x) {
 			Triangle t1 = {verticesArray[(y+0)*heightmapSize + (x+0)],
 			               verticesArray[(y+1)*heightmapSize + (x-1)],
@@ -176,44 +185,15 @@ vector<Face> Terrain::generateIndices(const int heightmapSize) {
 	return facesArray;
 }
 
-shared_ptr<Mesh> Terrain::generateGeometry(const int heightmapSize,
-  const float *heightmap,
-  TextureFactory &textureFactory,
-  const FileName heightmapTex,
-  const float scaleXY,
-  const float scaleZ) {
-	vector<vec3> verticesArray;
-	vector<vec3> normalsArray;
-	vector<vec2> texcoordsArray;
-	
-	// Generate geometry
-	generateVertices(verticesArray,
-	                 normalsArray,
-	                 texcoordsArray,
-	                 heightmapSize,
-	                 heightmap,
-	                 scaleXY,
-	                 scaleZ);
-	                 
-	vector<Face> facesArray = generateIndices(heightmapSize);
-	
-	shared_ptr<Mesh> mesh(new Mesh(verticesArray,
-	                               normalsArray,
-	                               texcoordsArray,
-	                               facesArray,
-	                               true)); // completely static mesh
-	                               
-	mesh->material = Material(textureFactory.load(heightmapTex));
-	mesh->material.shininess = 64.0f;
-	mesh->polygonWinding = GL_CCW;
-	
-	return mesh;
+void Terrain::generateFaces(PendingGeometry *geometry, int heightmapSize) {
+	geometry->faces = generateIndices(heightmapSize);
 }
 
-void Terrain::create(const PropertyBag &data,
-                     shared_ptr<class Renderer> renderer,
-                     TextureFactory &textureFactory,
-                     shared_ptr<PhysicsEngine> _physicsEngine) {
+void Terrain::prepare(const PropertyBag &data,
+                      shared_ptr<class Renderer> renderer,
+                      TextureFactory &textureFactory,
+                      shared_ptr<PhysicsEngine> _physicsEngine,
+                      JobGraph &graph) {
 	ASSERT(_physicsEngine, "Physics engine was null");
 	physicsEngine = _physicsEngine;
 	
@@ -222,21 +202,98 @@ void Terrain::create(const PropertyBag &data,
 	
 	const FileName heightmapFile = data.getFileName("heightmap");
 	const FileName heightmapTex = data.getFileName("material");
-	const FileName grassMaterial = data.getFileName("grassMaterial");
 	
 	// Loads heightmap
 	this->heightmap = loadHeightMap(heightmapFile);
 	
-	// Generate heightmap geometry
-	mesh = generateGeometry(heightmap.w,
-	                        heightmap.heightmap,
-	                        textureFactory,
-	                        heightmapTex,
-	                        scaleXY, scaleZ);
-	                        
+	material = Material(textureFactory.load(heightmapTex));
+	material.shininess = 64.0f;
+	
+	// Generate heightmap geometry in bands of rows
+	const int heightmapSize = heightmap.w;
+	const size_t numVertices = heightmapSize * heightmapSize;
+	
+	pending = shared_ptr<PendingGeometry>(new PendingGeometry);
+	pending->vertices.resize(numVertices);
+	pending->normals.resize(numVertices);
+	pending->texcoords.resize(numVertices);
+	
+	vector<JobGraph::JobID> vertexJobs;
+	
+	for (int y=0; y<heightmapSize; y+=ROWS_PER_JOB) {
+		const int endRow = min(y + ROWS_PER_JOB, heightmapSize);
+		vertexJobs.push_back(graph.add(bind(&Terrain::generateVertices,
+		                                    pending.get(),
+		                                    heightmap,
+		                                    scaleXY, scaleZ,
+		                                    y, endRow)));
+	}
+	
+	// Normals of a band depend on the vertices of the neighboring bands
+	for (size_t i=0; i<vertexJobs.size(); ++i) {
+		vector<JobGraph::JobID> dependencies;
+		
+		for (size_t j=(i>0 ? i-1 : 0); j<=i+1 && j<vertexJobs.size(); ++j) {
+			dependencies.push_back(vertexJobs[j]);
+		}
+		
+		const int beginRow = (int)i * ROWS_PER_JOB;
+		const int endRow = min(beginRow + ROWS_PER_JOB, heightmapSize);
+		graph.add(bind(&Terrain::generateNormals,
+		               pending.get(),
+		               heightmapSize,
+		               beginRow, endRow),
+		          dependencies);
+	}
+	
+	graph.add(bind(&Terrain::generateFaces, pending.get(), heightmapSize));
+	
+	// Grass and trees are placed on the heightmap, not on the mesh, so they
+	// need not wait for the terrain geometry
+	const vec2 center = vec2(heightmap.w, heightmap.h) * (scaleXY / 2);
+	const float size = heightmap.h * scaleXY;
+	
+	// Each job draws from its own generator, seeded from the map, so the
+	// grass and trees do not depend on which thread runs which job
+	int seed = 0;
+	data.get("seed", seed); // optional tag
+	
+	grassLayer = shared_ptr<GrassLayer>(new GrassLayer(renderer, textureFactory));
+	grassLayer->prepare(center, size);
+	
+	for (int column=0; column<grassLayer->getNumColumns(); ++column) {
+		graph.add(bind(&GrassLayer::generateColumn,
+		               grassLayer.get(),
+		               column,
+		               (unsigned int)(seed + column),
+		               getElevationFunction()));
+	}
+	
+	treeLayer = shared_ptr<TreeLayer>(new TreeLayer());
+	graph.add(bind(&TreeLayer::generate,
+	               treeLayer.get(),
+	               center,
+	               size,
+	               (unsigned int)(seed + grassLayer->getNumColumns()),
+	               getElevationFunction()));
+}
+
+void Terrain::finish() {
+	ASSERT(pending, "Terrain has not been prepared");
+	
+	mesh = shared_ptr<Mesh>(new Mesh(pending->vertices,
+	                                 pending->normals,
+	                                 pending->texcoords,
+	                                 pending->faces,
+	                                 true)); // completely static mesh
+	                                 
+	mesh->material = material;
+	mesh->polygonWinding = GL_CCW;
+	pending.reset();
+	
 	// Send heightmap to physics engine
 	{
-		tuple<dGeomID,dTriMeshDataID> result = mesh->createGeom(physicsEngine->getSpace());
+		tuple<dGeomID,dTriMeshDataID> result = physicsEngine->createTriMesh(*mesh);
 		geom = result.get<0>();
 		dGeomSetPosition(geom, 0.0f, 0.0f, 0.0f);
 	}
@@ -248,8 +305,13 @@ void Terrain::create(const PropertyBag &data,
 		// Stick with default render method and material settings
 	}
 	
-	generateGrassLayer(renderer, textureFactory);
-	generateTreeLayer();
+	// Physics and rendering have what they need from the mesh, so the
+	// client-side copy of its geometry is no longer needed
+	mesh->releaseClientCopies();
+	
+	TRACE("Terrain: " + mesh->getFootprint().toString());
+	
+	grassLayer->upload();
 }
 
 void Terrain::emitGeometry() {
@@ -265,27 +327,49 @@ void Terrain::emitGeometry() {
 	}
 }
 
-tuple<float,vec3> Terrain::getElevation(const HeightMapData &heightmap,
+function<tuple<float,vec3>(vec2)> Terrain::getElevationFunction() const {
+	return bind(&Terrain::getElevation, heightmap, scaleXY, scaleZ, _1);
+}
+
+tuple<float,vec3> Terrain::getElevation(HeightMapData heightmap,
+                                        float scaleXY,
+                                        float scaleZ,
                                         vec2 p) {
-	// Ray cast to get all contact points with the terrain
-	float rayLength = 100.0f;
-	vec3 rayOrigin = vec3(p.x, p.y, rayLength);
-	vec3 rayDirection = vec3(0,0,-1);
-	
-	dContactGeom contact;
-	if (physicsEngine->rayCast(rayOrigin, rayDirection, rayLength, geom, contact)) {
-		// Pack the results
-		float z = (float)contact.pos[2];
-		vec3 n = vec3((float)contact.normal[0],
-		              (float)contact.normal[1],
-		              (float)contact.normal[2]);
-		              
-		return make_tuple(z,n);
+	const int size = heightmap.w;
+	const float gx = p.x / scaleXY;
+	const float gy = p.y / scaleXY;
+	const int x = (int)floorf(gx);
+	const int y = (int)floorf(gy);
+	
+	if (x < 0 || y < 0 || x >= size-1 || y >= size-1) {
+		// Off the edge of the terrain
+		return make_tuple(0.0f, vec3(0.0f, 0.0f, 1.0f));
+	}
+	
+	const float *h = heightmap.heightmap;
+	const float h00 = h[(y+0)*size + (x+0)] * scaleZ;
+	const float h10 = h[(y+0)*size + (x+1)] * scaleZ;
+	const float h01 = h[(y+1)*size + (x+0)] * scaleZ;
+	const float h11 = h[(y+1)*size + (x+1)] * scaleZ;
+	const float fx = gx - x;
+	const float fy = gy - y;
+	
+	// Each quad is split along the same diagonal as in addTerrainQuad
+	float z, dzdx, dzdy;
+	
+	if (fx + fy <= 1.0f) {
+		dzdx = h10 - h00;
+		dzdy = h01 - h00;
+		z = h00 + fx*dzdx + fy*dzdy;
 	} else {
-		float z = 0.0f;
-		vec3 n = vec3(0.0f, 0.0f, 1.0f);
-		return make_tuple(z,n);
+		dzdx = h11 - h01;
+		dzdy = h11 - h10;
+		z = h11 - (1.0f-fx)*dzdx - (1.0f-fy)*dzdy;
 	}
+	
+	const vec3 n = vec3(-dzdx * scaleXY, -dzdy * scaleXY, scaleXY * scaleXY);
+	
+	return make_tuple(z, n.getNormal());
 }
 
 void Terrain::addTerrainQuad(int x, int y,
@@ -336,24 +420,3 @@ void Terrain::emitTreeGeometry() {
 		sendGlobalAction(&action);
 	}
 }
-
-void Terrain::generateTreeLayer() {
-	treeLayer = shared_ptr<TreeLayer>(new TreeLayer());
-	vec2 center = vec2(heightmap.w, heightmap.h) * (scaleXY / 2);
-	float size = heightmap.h * scaleXY;
-	treeLayer->generate(center, size,
-	                    bind(&Terrain::getElevation, this,
-	                         heightmap,
-	                         _1));
-}
-
-void Terrain::generateGrassLayer(shared_ptr<class Renderer> renderer,
-                                 TextureFactory & textureFactory) {
-	grassLayer = shared_ptr<GrassLayer>(new GrassLayer(renderer, textureFactory));
-	vec2 center = vec2(heightmap.w, heightmap.h) * (scaleXY / 2);
-	float size = heightmap.h * scaleXY;
-	grassLayer->generate(center, size,
-	                     bind(&Terrain::getElevation, this,
-	                          heightmap,
-	                          _1));
-}
@@ -10,6 +10,7 @@
 class GrassLayer;
 class TreeLayer;
 class PhysicsEngine;
+class JobGraph;
 
 struct HeightMapData {
 	float *heightmap;
@@ -21,6 +22,17 @@ struct HeightMapData {
 /** Terrain */
 class Terrain : public ScopedEventHandlerSubscriber {
 private:
+	/** Geometry generated by load jobs, waiting to be uploaded */
+	struct PendingGeometry {
+		vector<vec3> vertices;
+		vector<vec3> normals;
+		vector<vec2> texcoords;
+		vector<Face> faces;
+	};
+	
+	/** Number of heightmap rows generated by each load job */
+	static const int ROWS_PER_JOB = 32;
+	
 	shared_ptr<Mesh> mesh;
 	dGeomID geom;
 	HeightMapData heightmap;
@@ -30,7 +42,9 @@ private:
 	shared_ptr<TreeLayer> treeLayer;
 	bool enableGrass;
 	bool enableTrees;
-	shared_ptr<PhysicsEngine> physicsEngine; // keep this around to do ray casts with
+	shared_ptr<PhysicsEngine> physicsEngine;
+	shared_ptr<PendingGeometry> pending;
+	Material material;
 	
 public:
 	~Terrain();
@@ -40,16 +54,29 @@ public:
 	void clear();
 	
 	/**
-	Creates a map from data
+	Begins creating a map from data. The heightmap and textures are loaded
+	at once, and the jobs that generate the terrain, grass and trees from
+	the heightmap are added to a job graph. Once the graph has finished,
+	finish() must be called on the main thread.
 	@param data terrain data source
 	@param textureFactory texture factory tracks loaded textures
 	@param physicsEngine Physics engine
+	@param graph Receives the jobs that generate geometry
+	*/
+	void prepare(const PropertyBag &data,
+	             shared_ptr<class Renderer> renderer,
+	             TextureFactory &textureFactory,
+	             shared_ptr<PhysicsEngine> physicsEngine,
+	             JobGraph &graph);
+	             
+	/**
+	Finishes creating a map on the main thread, once the jobs added by
+	prepare() have finished, by uploading the geometry to the graphics
+	device and sending the terrain to the physics engine
 	*/
-	void create(const PropertyBag &data,
-	            shared_ptr<class Renderer> renderer,
-	            TextureFactory &textureFactory,
-	            shared_ptr<PhysicsEngine> physicsEngine);
-	            
+	void finish();
+	
+
 	/** emits a mesh to the renderer */
 	void emitGeometry();
 	
@@ -68,39 +95,65 @@ private:
 	*/
 	HeightMapData loadHeightMap(const FileName &fileName);
 	
-	/** Generates geometry from heightmap data */
-	static shared_ptr<Mesh> generateGeometry(const int heightmapSize,
-	  const float *heightmap,
-	  TextureFactory &textureFactory,
-	  const FileName heightmapTex,
-	  const float scaleXY,
-	  const float scaleZ);
-	  
-	/** Generate vertices from heightmap data */
-	static void generateVertices(vector<vec3> &verticesArray,
-	                             vector<vec3> &normalsArray,
-	                             vector<vec2> &texcoordsArray,
-	                             const int heightmapSize,
-	                             const float *heightmap,
-	                             const float scaleXY,
-	                             const float scaleZ);
+	/**
+	Generate vertices from heightmap data for a band of rows. Normals are
+	left pointing straight up until generateNormals() smooths them.
+	@param geometry Receives the vertices, which must already be sized
+	@param heightmap Heightmap data
+	@param scaleXY Scale of the terrain along the XY plane
+	@param scaleZ Scale of the terrain elevation
+	@param beginRow First row of the band
+	@param endRow One past the last row of the band
+	*/
+	static void generateVertices(PendingGeometry *geometry,
+	                             HeightMapData heightmap,
+	                             float scaleXY,
+	                             float scaleZ,
+	                             int beginRow,
+	                             int endRow);
 	                             
+	/**
+	Generate smooth normals for a band of rows. The vertices of the rows
+	on either side of the band must have been generated.
+	@param geometry Geometry holding the vertices and receiving the normals
+	@param heightmapSize Size of the square heightmap on a side
+	@param beginRow First row of the band
+	@param endRow One past the last row of the band
+	*/
+	static void generateNormals(PendingGeometry *geometry,
+	                            int heightmapSize,
+	                            int beginRow,
+	                            int endRow);
+	                            
 	/** Generate indices for heightmap geometry */
 	static vector<Face> generateIndices(const int heightmapSize);
 	
+	/** Generate the faces of the pending geometry */
+	static void generateFaces(PendingGeometry *geometry, int heightmapSize);
+	
 	/** Adds two triangles the terrain making up a non-co-planar quad */
 	static void addTerrainQuad(int x, int y,
 	                           int heightmapSize,
 	                           vector<Face> &facesArray,
 	                           int &idx);
 	                           
-	void generateTreeLayer();
+	/** Gets the elevation function used to place grass and trees */
+	function<tuple<float,vec3>(vec2)> getElevationFunction() const;
 	
-	void generateGrassLayer(shared_ptr<class Renderer> renderer,
-	                        TextureFactory & textureFactory);
-	                        
-	/** Gets the elevation of the heightmap at point along the XY plane */
-	tuple<float,vec3> getElevation(const HeightMapData &heightmap, vec2 p);
+	/**
+	Gets the elevation of the terrain at point along the XY plane, from the
+	same triangles that make up the terrain geometry. Only reads the
+	heightmap, so it may be called from any thread.
+	@param heightmap Heightmap data
+	@param scaleXY Scale of the terrain along the XY plane
+	@param scaleZ Scale of the terrain elevation
+	@param p Point along the XY plane
+	@return elevation and normal of the terrain at that point
+	*/
+	static tuple<float,vec3> getElevation(HeightMapData heightmap,
+	                                      float scaleXY,
+	                                      float scaleZ,
+	                                      vec2 p);
 };
 
 #endif
@@ -1,27 +1,57 @@
 #include "stdafx.h"
 #include "TextureFactory.h"
 #include "devil_wrapper.h"
+#include "VirtualFileSystem.h"
+#include "AssetLoader.h"
+#include "AssetRequestTexture.h"
+#include "Thread.h"
 
-TextureFactory::TextureFactory() {}
+/** Video memory that unused textures may keep resident */
+static const size_t TEXTURE_BUDGET = 128 * 1024 * 1024;
 
-TextureFactory::~TextureFactory() {
-	for (map<FileName, Handle>::iterator iter = textures.begin();
-	     iter != textures.end();
-	     ++iter) {
-		unsigned int id = (iter->second).getID();
+TextureFactory::Handle::~Handle() {
+	if (id != 0) {
 		glDeleteTextures(1, &id);
 	}
 }
 
-unsigned int TextureFactory::loadTexture(const FileName &fileName, bool repeat) {
-	CHECK_GL_ERROR();
+TextureFactory::TextureFactory()
+		: textures("Textures", TEXTURE_BUDGET) {}
+		
+TextureFactory::~TextureFactory() {
+	textures.clear();
+}
+
+unsigned int TextureFactory::loadTexture(const FileName &fileName,
+                                         bool repeat,
+                                         size_t &size) {
+	MutexLock lock(devil_getMutex());
 	
 	unsigned int imageName = devil_loadImage(fileName);
-	unsigned char *pixels = ilGetData();
-	int width		      = ilGetInteger(IL_IMAGE_WIDTH);
-	int height		      = ilGetInteger(IL_IMAGE_HEIGHT);
-	int bytesPerPixel	  = ilGetInteger(IL_IMAGE_BYTES_PER_PIXEL);
-	int wrapMode          = repeat ? GL_REPEAT : GL_CLAMP;
+	const int width = ilGetInteger(IL_IMAGE_WIDTH);
+	const int height = ilGetInteger(IL_IMAGE_HEIGHT);
+	const int bytesPerPixel = ilGetInteger(IL_IMAGE_BYTES_PER_PIXEL);
+	unsigned int textureName = uploadTexture(ilGetData(),
+	                                         width,
+	                                         height,
+	                                         bytesPerPixel,
+	                                         repeat);
+	                                         
+	size = getTextureSize(width, height, bytesPerPixel);
+	
+	ilDeleteImages(1, &imageName);
+	
+	return textureName;
+}
+
+unsigned int TextureFactory::uploadTexture(const unsigned char *pixels,
+                                           int width,
+                                           int height,
+                                           int bytesPerPixel,
+                                           bool repeat) {
+	CHECK_GL_ERROR();
+	
+	int wrapMode = repeat ? GL_REPEAT : GL_CLAMP;
 	
 	unsigned int textureName=0;
 	glGenTextures(1, &textureName);
@@ -41,24 +71,66 @@ unsigned int TextureFactory::loadTexture(const FileName &fileName, bool repeat)
 	                  
 	CHECK_GL_ERROR();
 	
-	ilDeleteImages(1, &imageName);
-	
 	return textureName;
 }
 
-TextureFactory::Handle*
+size_t TextureFactory::getTextureSize(int width, int height, int bytesPerPixel) {
+	// The mipmap chain adds a third to the size of the base level
+	return (size_t)width * height * bytesPerPixel * 4 / 3;
+}
+
+TextureFactory::HandlePtr
 TextureFactory::load(const FileName &fileName, bool repeat) {
-	map<FileName, Handle>::iterator iter = textures.find(fileName);
+	HandlePtr handle = textures.find(fileName);
 	
-	if (iter != textures.end()) {
-		return &(iter->second);
+	if (handle) {
+		return handle;
 	}
 	
-	VERIFY(isFileOnDisk(fileName),
+	VERIFY(VirtualFileSystem::exists(fileName),
 	       "Texture file not found: " + fileName.str());
 	       
-	unsigned int id = loadTexture(fileName, repeat);
-	textures.insert(make_pair(fileName, Handle(fileName, id)));
+	size_t size = 0;
+	unsigned int id = loadTexture(fileName, repeat, size);
+	
+	return textures.insert(fileName, HandlePtr(new Handle(fileName, id, repeat)), size);
+}
+
+TextureFactory::HandlePtr
+TextureFactory::loadAsync(const FileName &fileName,
+                          AssetLoader &loader,
+                          bool repeat) {
+	HandlePtr handle = textures.find(fileName);
+	
+	if (handle) {
+		return handle;
+	}
+	
+	// The texture ID stays zero, which binds no texture, until the upload
+	handle = textures.insert(fileName, HandlePtr(new Handle(fileName, 0, repeat)), 0);
+	
+	shared_ptr<AssetRequest> request(new AssetRequestTexture(this, handle, repeat));
+	loader.load(request);
+	
+	return handle;
+}
+
+void TextureFactory::reload(const FileName &fileName) {
+	HandlePtr handle = textures.find(fileName);
+	
+	if (!handle || !isFileOnDisk(fileName)) {
+		return;
+	}
+	
+	size_t size = 0;
+	unsigned int id = loadTexture(fileName, handle->repeat, size);
+	
+	if (handle->id != 0) {
+		glDeleteTextures(1, &handle->id);
+	}
+	
+	handle->id = id;
+	textures.insert(fileName, handle, size);
 	
-	return &textures.find(fileName)->second;
+	TRACE("Reloaded texture: " + fileName.str());
 }
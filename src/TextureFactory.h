@@ -1,25 +1,35 @@
 #ifndef _TEXTURE_FACTORY_H_
 #define _TEXTURE_FACTORY_H_
 
+#include "AssetCache.h"
+
+class AssetLoader;
+
 class TextureFactory {
 public:
-	/** Handle to a texture object */
+	/** Handle to a texture object, which deletes the texture */
 	class Handle {
 	private:
 		FileName fileName; /** file name of the texture */
 		unsigned int id;   /** the texture ID */
+		bool repeat;       /** GL_REPEAT when true, GL_CLAMP otherwise */
 		
 	public:
+		/** Destructor */
+		~Handle();
+		
 		/**
 		Constructor
 		@param fileName The name of the image file
 		@param dimemsions Dimensions of the texture
 		@param alpha Indicates the texture has an alpha component
 		@param id
+		@param repeat Indicates GL_REPEAT when true, GL_CLAMP otherwise
 		*/
-		Handle(const FileName &_fileName, unsigned int _id)
+		Handle(const FileName &_fileName, unsigned int _id, bool _repeat)
 				: fileName(_fileName),
-				id(_id) {}
+				id(_id),
+				repeat(_repeat) {}
 				
 		/** Gets the file name of the texture */
 		inline const FileName& getFileName() const {
@@ -30,10 +40,20 @@ public:
 		inline unsigned int getID() const {
 			return id;
 		}
+		
+	private:
+		Handle(const Handle&);
+		Handle& operator=(const Handle&);
+		
+		friend class TextureFactory;
+		friend class AssetRequestTexture;
 	};
 	
+	/** Reference counted handle to a texture */
+	typedef shared_ptr<Handle> HandlePtr;
+	
 private:
-	map<FileName, Handle> textures;
+	AssetCache<Handle> textures;
 	
 public:
 	~TextureFactory();
@@ -45,17 +65,64 @@ public:
 	@param repeat Indicates that we want GL_REPEAT, as opposed to GL_CLAMP
 	@return TextureHandle
 	*/
-	Handle* load(const FileName &fileName, bool repeat = true);
-private:
-
+	HandlePtr load(const FileName &fileName, bool repeat = true);
+	
+	/**
+	Load a texture in the background. The handle is valid immediately, but
+	refers to no texture until the texture has been uploaded.
+	@param fileName texture to load
+	@param loader Loader to load the texture with
+	@param repeat Indicates that we want GL_REPEAT, as opposed to GL_CLAMP
+	@return TextureHandle
+	*/
+	HandlePtr loadAsync(const FileName &fileName,
+	                    AssetLoader &loader,
+	                    bool repeat = true);
+	                    
+	/**
+	Loads a texture again, if it is resident. Handles to the texture stay
+	valid and refer to the new texture.
+	@param fileName texture that has changed
+	*/
+	void reload(const FileName &fileName);
+	
+	/**
+	Creates an OpenGL texture, with mipmaps, from decoded pixels
+	@param pixels Pixels, in rows from the top of the image
+	@param width Width of the image
+	@param height Height of the image
+	@param bytesPerPixel 3 for RGB or 4 for RGBA
+	@param repeat Indicates GL_REPEAT when true, GL_CLAMP otherwise
+	@return OpenGL texture handle
+	*/
+	static unsigned int uploadTexture(const unsigned char *pixels,
+	                                  int width,
+	                                  int height,
+	                                  int bytesPerPixel,
+	                                  bool repeat);
+	                                  
+	/**
+	Gets the video memory used by a texture and its mipmaps
+	@param width Width of the image
+	@param height Height of the image
+	@param bytesPerPixel 3 for RGB or 4 for RGBA
+	@return Size of the texture, in bytes
+	*/
+	static size_t getTextureSize(int width, int height, int bytesPerPixel);
+	
 private:
+	friend class AssetRequestTexture;
+	
 	/**
 	Loads an OpenGL texture
 	@param fileName Image file name
 	@param repeat Indicates GL_REPEAT when true, GL_CLAMP otherwise
+	@param size Returns the size of the texture, in bytes
 	@return OpenGL texture handle
 	*/
-	static unsigned int loadTexture(const FileName &fileName, bool repeat);
+	static unsigned int loadTexture(const FileName &fileName,
+	                                bool repeat,
+	                                size_t &size);
 };
 
 #endif
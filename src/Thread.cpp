@@ -0,0 +1,144 @@
+#include "Core.h"
+#include "Thread.h"
+
+#ifdef _WIN32
+#	include <process.h>
+#else
+#	include <unistd.h>
+#	include <sys/time.h>
+#endif
+
+Mutex::~Mutex() {
+#ifdef _WIN32
+	DeleteCriticalSection(&section);
+#else
+	pthread_mutex_destroy(&mutex);
+#endif
+}
+
+Mutex::Mutex() {
+#ifdef _WIN32
+	InitializeCriticalSection(&section);
+#else
+	pthread_mutex_init(&mutex, 0);
+#endif
+}
+
+void Mutex::lock() {
+#ifdef _WIN32
+	EnterCriticalSection(&section);
+#else
+	pthread_mutex_lock(&mutex);
+#endif
+}
+
+void Mutex::unlock() {
+#ifdef _WIN32
+	LeaveCriticalSection(&section);
+#else
+	pthread_mutex_unlock(&mutex);
+#endif
+}
+
+Semaphore::~Semaphore() {
+#ifdef _WIN32
+	CloseHandle(semaphore);
+#else
+	sem_destroy(&semaphore);
+#endif
+}
+
+Semaphore::Semaphore(unsigned int count) {
+#ifdef _WIN32
+	semaphore = CreateSemaphore(NULL, count, LONG_MAX, NULL);
+	VERIFY(semaphore != NULL, "Failed to create semaphore");
+#else
+	VERIFY(sem_init(&semaphore, 0, count) == 0, "Failed to create semaphore");
+#endif
+}
+
+void Semaphore::post() {
+#ifdef _WIN32
+	ReleaseSemaphore(semaphore, 1, NULL);
+#else
+	sem_post(&semaphore);
+#endif
+}
+
+void Semaphore::wait() {
+#ifdef _WIN32
+	WaitForSingleObject(semaphore, INFINITE);
+#else
+	// Retry when interrupted by a signal
+	while (sem_wait(&semaphore) != 0 && errno == EINTR);
+#endif
+}
+
+Thread::~Thread() {
+	join();
+}
+
+Thread::Thread(const Function &function)
+		: entryPoint(function),
+		joinable(false) {
+#ifdef _WIN32
+	handle = (HANDLE)_beginthreadex(NULL, 0, &Thread::run, this, 0, NULL);
+	joinable = (handle != 0);
+#else
+	joinable = (pthread_create(&handle, 0, &Thread::run, this) == 0);
+#endif
+	
+	VERIFY(joinable, "Failed to start thread");
+}
+
+void Thread::join() {
+	if (!joinable) {
+		return;
+	}
+	
+#ifdef _WIN32
+	WaitForSingleObject(handle, INFINITE);
+	CloseHandle(handle);
+#else
+	pthread_join(handle, 0);
+#endif
+	
+	joinable = false;
+}
+
+size_t Thread::getNumProcessors() {
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	const long count = (long)info.dwNumberOfProcessors;
+#else
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	
+	return count > 0 ? (size_t)count : 1;
+}
+
+double Thread::getMilliseconds() {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+	struct timeval now;
+	gettimeofday(&now, 0);
+	return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+#endif
+}
+
+#ifdef _WIN32
+unsigned int __stdcall Thread::run(void *thread) {
+	static_cast<Thread*>(thread)->entryPoint();
+	return 0;
+}
+#else
+void* Thread::run(void *thread) {
+	static_cast<Thread*>(thread)->entryPoint();
+	return 0;
+}
+#endif
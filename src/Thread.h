@@ -0,0 +1,140 @@
+#ifndef _THREAD_H_
+#define _THREAD_H_
+
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <pthread.h>
+#	include <semaphore.h>
+#endif
+
+/** Mutual exclusion lock */
+class Mutex {
+public:
+	/** Destructor */
+	~Mutex();
+	
+	/** Constructor */
+	Mutex();
+	
+	/** Blocks until the lock is acquired */
+	void lock();
+	
+	/** Releases the lock */
+	void unlock();
+	
+private:
+	Mutex(const Mutex&);
+	Mutex& operator=(const Mutex&);
+	
+#ifdef _WIN32
+	CRITICAL_SECTION section;
+#else
+	pthread_mutex_t mutex;
+#endif
+};
+
+/** Holds a mutex for as long as it is in scope */
+class MutexLock {
+public:
+	/** Releases the mutex */
+	~MutexLock() {
+		mutex.unlock();
+	}
+	
+	/**
+	Acquires a mutex
+	@param _mutex Mutex to acquire
+	*/
+	MutexLock(Mutex &_mutex)
+			: mutex(_mutex) {
+		mutex.lock();
+	}
+	
+private:
+	MutexLock(const MutexLock&);
+	MutexLock& operator=(const MutexLock&);
+	
+	Mutex &mutex;
+};
+
+/** Counting semaphore */
+class Semaphore {
+public:
+	/** Destructor */
+	~Semaphore();
+	
+	/**
+	Constructor
+	@param count Initial count
+	*/
+	Semaphore(unsigned int count = 0);
+	
+	/** Increments the count, waking a waiting thread */
+	void post();
+	
+	/** Blocks until the count is above zero, then decrements it */
+	void wait();
+	
+private:
+	Semaphore(const Semaphore&);
+	Semaphore& operator=(const Semaphore&);
+	
+#ifdef _WIN32
+	HANDLE semaphore;
+#else
+	sem_t semaphore;
+#endif
+};
+
+/** Thread of execution, which runs a function to completion */
+class Thread {
+public:
+	typedef function<void ()> Function;
+	
+	/** Waits for the thread to finish */
+	~Thread();
+	
+	/**
+	Starts a thread
+	@param function Function to run on the new thread
+	*/
+	Thread(const Function &function);
+	
+	/** Waits for the thread to finish */
+	void join();
+	
+	/** Gets the number of processors available to run threads */
+	static size_t getNumProcessors();
+	
+	/**
+	Gets the wall clock time, for timing work that is spread over threads
+	@return time in milliseconds, from an arbitrary starting point
+	*/
+	static double getMilliseconds();
+	
+private:
+	Thread(const Thread&);
+	Thread& operator=(const Thread&);
+	
+	/** Entry point of the new thread */
+#ifdef _WIN32
+	static unsigned int __stdcall run(void *thread);
+#else
+	static void* run(void *thread);
+#endif
+	
+	/** Function that the thread runs */
+	Function entryPoint;
+	
+	/** Indicates that the thread has been started and not yet joined */
+	bool joinable;
+	
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+};
+
+#endif
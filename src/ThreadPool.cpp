@@ -0,0 +1,57 @@
+#include "Core.h"
+#include "ThreadPool.h"
+
+ThreadPool::~ThreadPool() {
+	{
+		MutexLock lock(mutex);
+		quitting = true;
+	}
+	
+	for (size_t i=0; i<threads.size(); ++i) {
+		pending.post();
+	}
+	
+	threads.clear(); // joins each thread
+}
+
+ThreadPool::ThreadPool(size_t numThreads)
+		: quitting(false) {
+	for (size_t i=0; i<max(numThreads, (size_t)1); ++i) {
+		Thread::Function function = bind(&ThreadPool::run, this);
+		threads.push_back(shared_ptr<Thread>(new Thread(function)));
+	}
+}
+
+void ThreadPool::add(const Job &job) {
+	{
+		MutexLock lock(mutex);
+		ASSERT(!quitting, "Job added to a pool that is shutting down");
+		jobs.push_back(job);
+	}
+	
+	pending.post();
+}
+
+void ThreadPool::run() {
+	for (;;) {
+		pending.wait();
+		Job job;
+		
+		{
+			MutexLock lock(mutex);
+			
+			if (jobs.empty()) {
+				if (quitting) {
+					return;
+				}
+				
+				continue;
+			}
+			
+			job = jobs.front();
+			jobs.pop_front();
+		}
+		
+		job();
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include "Thread.h"
+
+/**
+Set of threads that run jobs from a shared queue, in the order in which the
+jobs were added
+*/
+class ThreadPool {
+public:
+	typedef function<void ()> Job;
+	
+	/** Finishes the jobs already queued, then stops the threads */
+	~ThreadPool();
+	
+	/**
+	Constructor
+	@param numThreads Number of threads to start (at least one)
+	*/
+	ThreadPool(size_t numThreads);
+	
+	/**
+	Queues a job to be run on one of the threads
+	@param job Job to run
+	*/
+	void add(const Job &job);
+	
+	/** Gets the number of threads in the pool */
+	inline size_t getNumThreads() const {
+		return threads.size();
+	}
+	
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+	
+	/** Runs jobs until the pool is destroyed */
+	void run();
+	
+	/** Guards the queue */
+	Mutex mutex;
+	
+	/** Counts the queued jobs, plus one for each thread once quitting */
+	Semaphore pending;
+	
+	/** Jobs waiting to run */
+	deque<Job> jobs;
+	
+	/** Indicates that the threads should stop once the queue is empty */
+	bool quitting;
+	
+	/** Threads of the pool */
+	vector<shared_ptr<Thread> > threads;
+};
+
+#endif
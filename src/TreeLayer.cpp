@@ -22,7 +22,10 @@ TreeLayer::TreeLayer() {
 
 void TreeLayer::generate(const vec2 &center,
                          float size,
+                         unsigned int seed,
                          function<tuple<float,vec3>(vec2)> elevationFunc) {
+	mt19937 rng(seed);
+	
 	int s = (int)ceilf(size / 8.0f);
 	numCellColumns = s;
 	numCellRows = s;
@@ -37,6 +40,7 @@ void TreeLayer::generate(const vec2 &center,
 			generateCell(cell,
 			             vec2(col + 0.5f, row + 0.5f) * cellSpacing,
 			             cellSize,
+			             rng,
 			             elevationFunc);
 		}
 	}
@@ -45,6 +49,7 @@ void TreeLayer::generate(const vec2 &center,
 void TreeLayer::generateCell(struct TreeCell &cell,
                              const vec2 &center,
                              float size,
+                             mt19937 &rng,
                              function<tuple<float,vec3>(vec2)> elevationFunc) {
 	vec2 bounds_min = center - vec2(size, size);
 	vec2 bounds_max = center + vec2(size, size);
@@ -55,14 +60,14 @@ void TreeLayer::generateCell(struct TreeCell &cell,
 	vec2 pos;
 	for (pos.y = bounds_min.y; pos.y < bounds_max.y; pos.y += spacing.y) {
 		for (pos.x = bounds_min.x; pos.x < bounds_max.x; pos.x += spacing.x) {
-			float angle = FRAND_RANGE(0.0f, (float)(M_PI * 2.0));
-			vec2 offset = vec2(cos(angle), sin(angle)) * SampleNormal(displacement, 0.0f);
+			float angle = SampleUniform(rng, 0.0f, (float)(M_PI * 2.0));
+			vec2 offset = vec2(cos(angle), sin(angle)) * SampleNormal(rng, displacement, 0.0f);
 			vec2 tuftPos =  pos + offset;
 			tuple<float, vec3> zn = elevationFunc(tuftPos);
 			
 			TreeData tree;
 			tree.position = vec3(tuftPos, zn.get<0>());
-			tree.seed = rand();
+			tree.seed = SampleUniformInt(rng, 0, RAND_MAX);
 			cell.trees.push_back(tree);
 		}
 	}
@@ -48,12 +48,14 @@ public:
 	at the point specified.
 	@param center Position of the layer
 	@param size Length of the entire layer on each side (its a square)
+	@param seed Seeds the random placement of the trees
 	@param elevationFunc Given the coordinates (x,y) of a region within the
 	bounding rectangle, return the elevation (z) of that
 	point and the normal at that point.
 	*/
 	void generate(const vec2 &center,
 	              float size,
+	              unsigned int seed,
 	              function<tuple<float,vec3>(vec2)> elevationFunc);
 	              
 	/**
@@ -67,6 +69,7 @@ private:
 	Generates a single tree cell.
 	@param center Position of the center of the grass cell
 	@param size Length of the cell square on it side
+	@param rng Random number generator of the layer
 	@param elevationFunc Given the coordinates (x,y) of a region within the
 	bounding rectangle, return the elevation (z) of that
 	point and the normal at that point.
@@ -74,6 +77,7 @@ private:
 	void generateCell(struct TreeCell &cell,
 	                  const vec2 &center,
 	                  float size,
+	                  mt19937 &rng,
 	                  function<tuple<float,vec3>(vec2)> elevationFunc);
 };
 
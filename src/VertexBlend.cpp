@@ -0,0 +1,157 @@
+#include "Core.h"
+#include "VertexBlend.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_BLEND_SSE2
+#include <emmintrin.h>
+#endif
+
+VertexBlendStatistics::VertexBlendStatistics()
+		: frames(0),
+		reusedFrames(0),
+		vertices(0),
+		milliseconds(0.0) {}
+
+double VertexBlendStatistics::getVerticesPerSecond() const {
+	return (milliseconds > 0.0) ? vertices * 1000.0 / milliseconds : 0.0;
+}
+
+string VertexBlendStatistics::toString() const {
+	return sizet_to_string(frames) + " frames blended, " +
+	       sizet_to_string(reusedFrames) + " reused; " +
+	       sizet_to_string(vertices) + " vertices in " +
+	       ftos((float)milliseconds) + "ms (" +
+	       ftos((float)(getVerticesPerSecond() / 1000000.0)) + "M vertices/sec, " +
+	       (VertexBlend::isVectorized() ? "SSE2" : "scalar") + ")";
+}
+
+bool VertexBlend::isVectorized() {
+#ifdef VERTEX_BLEND_SSE2
+	return true;
+#else
+	return false;
+#endif
+}
+
+void VertexBlend::blend(vec3 *out,
+                        const vec3 *a,
+                        const vec3 *b,
+                        size_t count,
+                        float bias) {
+	// The vectors are blended as one stream of floats
+	float *o = &out[0].x;
+	const float *fa = &a[0].x;
+	const float *fb = &b[0].x;
+	const size_t n = count * 3;
+	size_t i = 0;
+	
+#ifdef VERTEX_BLEND_SSE2
+	const __m128 t = _mm_set1_ps(bias);
+	
+	for (; i+4 <= n; i+=4) {
+		const __m128 va = _mm_loadu_ps(fa + i);
+		const __m128 vb = _mm_loadu_ps(fb + i);
+		_mm_storeu_ps(o + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), t)));
+	}
+#endif
+	
+	blendScalar(o + i, fa + i, fb + i, n - i, bias);
+}
+
+void VertexBlend::normalize(vec3 *vectors, size_t count) {
+	size_t i = 0;
+	
+#ifdef VERTEX_BLEND_SSE2
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 threeHalves = _mm_set1_ps(1.5f);
+	const __m128 zero = _mm_setzero_ps();
+	
+	for (; i+4 <= count; i+=4) {
+		float *p = &vectors[i].x;
+		
+		// Four vectors fill three registers: x0 y0 z0 x1, y1 z1 x2 y2, z2 x3 y3 z3
+		__m128 m0 = _mm_loadu_ps(p);
+		__m128 m1 = _mm_loadu_ps(p + 4);
+		__m128 m2 = _mm_loadu_ps(p + 8);
+		
+		// Gather the x, y and z components into registers of their own
+		const __m128 t1 = _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(1,0,3,2)); // x2 y2 z2 x3
+		const __m128 t2 = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1,0,2,1)); // y0 z0 y1 z1
+		const __m128 t3 = _mm_shuffle_ps(t1, m2, _MM_SHUFFLE(3,2,2,1)); // y2 z2 y3 z3
+		const __m128 x = _mm_shuffle_ps(m0, t1, _MM_SHUFFLE(3,0,3,0));
+		const __m128 y = _mm_shuffle_ps(t2, t3, _MM_SHUFFLE(2,0,2,0));
+		const __m128 z = _mm_shuffle_ps(t2, t3, _MM_SHUFFLE(3,1,3,1));
+		
+		const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x),
+		                                                   _mm_mul_ps(y, y)),
+		                                        _mm_mul_ps(z, z));
+		
+		// Reciprocal square root estimate, refined with a Newton-Raphson
+		// step, and zero for zero vectors
+		__m128 r = _mm_rsqrt_ps(lengthSquared);
+		r = _mm_mul_ps(r, _mm_sub_ps(threeHalves,
+		                             _mm_mul_ps(_mm_mul_ps(half, lengthSquared),
+		                                        _mm_mul_ps(r, r))));
+		r = _mm_and_ps(r, _mm_cmpgt_ps(lengthSquared, zero));
+		
+		// Spread the scale of each vector back over its components
+		m0 = _mm_mul_ps(m0, _mm_shuffle_ps(r, r, _MM_SHUFFLE(1,0,0,0)));
+		m1 = _mm_mul_ps(m1, _mm_shuffle_ps(r, r, _MM_SHUFFLE(2,2,1,1)));
+		m2 = _mm_mul_ps(m2, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3,3,3,2)));
+		
+		_mm_storeu_ps(p, m0);
+		_mm_storeu_ps(p + 4, m1);
+		_mm_storeu_ps(p + 8, m2);
+	}
+#endif
+	
+	normalizeScalar(vectors + i, count - i);
+}
+
+void VertexBlend::blendScalar(float *out,
+                              const float *a,
+                              const float *b,
+                              size_t count,
+                              float bias) {
+	for (size_t i=0; i<count; ++i) {
+		out[i] = a[i] + (b[i] - a[i]) * bias;
+	}
+}
+
+void VertexBlend::normalizeScalar(vec3 *vectors, size_t count) {
+	for (size_t i=0; i<count; ++i) {
+		const float length = vectors[i].getMagnitude();
+		
+		if (length > 0.0f) {
+			vectors[i] = vectors[i] * (1.0f / length);
+		}
+	}
+}
+
+void VertexBlend::countFrame(size_t vertices, double milliseconds) {
+	MutexLock lock(getStatisticsMutex());
+	VertexBlendStatistics &statistics = getMutableStatistics();
+	statistics.frames++;
+	statistics.vertices += vertices;
+	statistics.milliseconds += milliseconds;
+}
+
+void VertexBlend::countReusedFrame() {
+	MutexLock lock(getStatisticsMutex());
+	getMutableStatistics().reusedFrames++;
+}
+
+Mutex& VertexBlend::getStatisticsMutex() {
+	static Mutex mutex;
+	return mutex;
+}
+
+VertexBlendStatistics& VertexBlend::getMutableStatistics() {
+	static VertexBlendStatistics statistics;
+	return statistics;
+}
+
+VertexBlendStatistics VertexBlend::getStatistics() {
+	MutexLock lock(getStatisticsMutex());
+	return getMutableStatistics();
+}
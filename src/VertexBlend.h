@@ -0,0 +1,96 @@
+#ifndef _VERTEX_BLEND_H_
+#define _VERTEX_BLEND_H_
+
+#include "vec3.h"
+#include "Thread.h"
+
+/** Counters describing the vertex blending done so far */
+struct VertexBlendStatistics {
+	/** Frames of animation interpolated for a working set */
+	size_t frames;
+	
+	/** Frames that a working set already held, and were not blended again */
+	size_t reusedFrames;
+	
+	/** Vertices blended, counting positions and normals as one vertex */
+	size_t vertices;
+	
+	/** Time spent blending those vertices */
+	double milliseconds;
+	
+	/** Constructor */
+	VertexBlendStatistics();
+	
+	/** Gets the vertices blended per second */
+	double getVerticesPerSecond() const;
+	
+	/** Gets a readable summary of the counters */
+	string toString() const;
+};
+
+/**
+Blends the key frames of vertex animation. Positions and normals are
+stored as streams of floats, x, y and z one vertex after another, so
+blending two of them applies the same operation to every float; this is
+done four floats at a time with SSE2 where the compiler targets it, and
+one at a time otherwise. Normals are normalized four at a time, gathered
+into separate x, y and z registers.
+*/
+class VertexBlend {
+public:
+	/** Determines whether the SSE2 kernels were compiled in */
+	static bool isVectorized();
+	
+	/**
+	Blends two streams of vectors
+	@param out Receives a + (b - a) * bias, and may be the same as a or b
+	@param a Vectors at bias zero
+	@param b Vectors at bias one
+	@param count Number of vectors
+	@param bias Interpolation bias between 0.0 and 1.0
+	*/
+	static void blend(vec3 *out,
+	                  const vec3 *a,
+	                  const vec3 *b,
+	                  size_t count,
+	                  float bias);
+	
+	/**
+	Scales vectors to unit length. Zero vectors are left as they are.
+	@param vectors Vectors to normalize
+	@param count Number of vectors
+	*/
+	static void normalize(vec3 *vectors, size_t count);
+	
+	/**
+	Records blending done for a frame of animation
+	@param vertices Vertices blended
+	@param milliseconds Time taken
+	*/
+	static void countFrame(size_t vertices, double milliseconds);
+	
+	/** Records a frame of animation that did not need blending again */
+	static void countReusedFrame();
+	
+	/** Gets the counters describing the blending done so far */
+	static VertexBlendStatistics getStatistics();
+	
+private:
+	/** Blends floats one at a time */
+	static void blendScalar(float *out,
+	                        const float *a,
+	                        const float *b,
+	                        size_t count,
+	                        float bias);
+	
+	/** Normalizes vectors one at a time */
+	static void normalizeScalar(vec3 *vectors, size_t count);
+	
+	/** Gets the mutex guarding the statistics */
+	static Mutex& getStatisticsMutex();
+	
+	/** Gets the statistics for modification, with the mutex held */
+	static VertexBlendStatistics& getMutableStatistics();
+};
+
+#endif
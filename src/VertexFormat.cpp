@@ -0,0 +1,260 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "VertexFormat.h"
+
+const float VertexFormat::TEXCOORD_TOLERANCE = 1.0f / 2048.0f;
+
+bool VertexFormat::halfFloatSupported = false;
+
+VertexFootprint::VertexFootprint()
+		: packed(0),
+		unpacked(0) {}
+
+VertexFootprint& VertexFootprint::operator+=(const VertexFootprint &footprint) {
+	packed += footprint.packed;
+	unpacked += footprint.unpacked;
+	return *this;
+}
+
+string VertexFootprint::toString() const {
+	const int saved = (unpacked == 0) ? 0
+	                  : (int)(100 - packed * 100 / unpacked);
+	
+	return sizet_to_string(packed) + " bytes of vertex data on the GPU, " +
+	       sizet_to_string(unpacked) + " unpacked (" +
+	       itos(saved) + "% saved)";
+}
+
+void VertexFormat::setHalfFloatSupported(bool supported) {
+	halfFloatSupported = supported;
+}
+
+size_t VertexFormat::getStride(VERTEX_PACKING packing) {
+	switch (packing) {
+	case PACK_POSITIONS:
+		return 4 * sizeof(S16);
+	case PACK_NORMALS:
+		return 4 * sizeof(S8);
+	case PACK_TEXCOORDS:
+		return 2 * sizeof(U16);
+	case PACK_COLORS:
+		return 4 * sizeof(U8);
+	default:
+		FAIL("Buffer is not packed");
+		return 0;
+	}
+}
+
+GLenum VertexFormat::getComponentType(VERTEX_PACKING packing) {
+	switch (packing) {
+	case PACK_POSITIONS:
+		return GL_SHORT;
+	case PACK_NORMALS:
+		return GL_BYTE;
+	case PACK_TEXCOORDS:
+		return GL_HALF_FLOAT_ARB;
+	case PACK_COLORS:
+		return GL_UNSIGNED_BYTE;
+	default:
+		return GL_FLOAT;
+	}
+}
+
+U16 VertexFormat::toHalf(float value) {
+	union {
+		float f;
+		U32 u;
+	} bits;
+	
+	bits.f = value;
+	
+	const U32 sign = (bits.u >> 16) & 0x8000;
+	const int exponent = (int)((bits.u >> 23) & 0xFF) - 127 + 15;
+	U32 mantissa = bits.u & 0x7FFFFF;
+	
+	if (exponent >= 31) {
+		// Infinity and NaN keep their meaning, and too large becomes infinite
+		const bool isNaN = ((bits.u >> 23) & 0xFF) == 0xFF && mantissa != 0;
+		return (U16)(sign | (isNaN ? 0x7E00 : 0x7C00));
+	}
+	
+	if (exponent <= 0) {
+		// Too small for a normal half, so denormalize or flush to zero
+		if (exponent < -10) {
+			return (U16)sign;
+		}
+		
+		mantissa |= 0x800000;
+		
+		const int shift = 14 - exponent;
+		U32 half = mantissa >> shift;
+		
+		if ((mantissa >> (shift - 1)) & 1) {
+			half++;
+		}
+		
+		return (U16)(sign | half);
+	}
+	
+	// Rounding may carry into the exponent, which is what rounding up to
+	// the next power of two must do
+	U32 half = sign | ((U32)exponent << 10) | (mantissa >> 13);
+	
+	if (mantissa & 0x1000) {
+		half++;
+	}
+	
+	return (U16)half;
+}
+
+float VertexFormat::fromHalf(U16 value) {
+	const U32 sign = (U32)(value & 0x8000) << 16;
+	const U32 exponent = (value >> 10) & 0x1F;
+	const U32 mantissa = value & 0x3FF;
+	
+	if (exponent == 0) {
+		const float magnitude = mantissa / 16777216.0f; // 2^-24
+		return sign ? -magnitude : magnitude;
+	}
+	
+	union {
+		float f;
+		U32 u;
+	} bits;
+	
+	if (exponent == 31) {
+		bits.u = sign | 0x7F800000 | (mantissa << 13);
+	} else {
+		bits.u = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+	
+	return bits.f;
+}
+
+void VertexFormat::fitPositions(const vec3 *positions,
+                                int count,
+                                float &scale,
+                                vec3 &bias) {
+	if (count == 0) {
+		scale = 1.0f;
+		bias.zero();
+		return;
+	}
+	
+	vec3 minimum = positions[0];
+	vec3 maximum = positions[0];
+	
+	for (int i=1; i<count; ++i) {
+		const vec3 &p = positions[i];
+		minimum = vec3(min(minimum.x, p.x), min(minimum.y, p.y), min(minimum.z, p.z));
+		maximum = vec3(max(maximum.x, p.x), max(maximum.y, p.y), max(maximum.z, p.z));
+	}
+	
+	bias = (minimum + maximum) * 0.5f;
+	
+	const vec3 extent = (maximum - minimum) * 0.5f;
+	const float largest = max(extent.x, max(extent.y, extent.z));
+	
+	scale = (largest > 0.0f) ? largest / POSITION_RANGE : 1.0f;
+}
+
+bool VertexFormat::canPackPositions(const vec3 *positions,
+                                    int count,
+                                    float scale,
+                                    const vec3 &bias) {
+	const float limit = (POSITION_RANGE + 0.5f) * scale;
+	
+	for (int i=0; i<count; ++i) {
+		const vec3 d = positions[i] - bias;
+		
+		if (fabsf(d.x) > limit || fabsf(d.y) > limit || fabsf(d.z) > limit) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+/** Rounds to the nearest integer within [-range, range] */
+static int quantize(float value, int range) {
+	const int i = (int)floorf(value + 0.5f);
+	return min(max(i, -range), range);
+}
+
+void VertexFormat::packPositions(const vec3 *positions,
+                                 int count,
+                                 float scale,
+                                 const vec3 &bias,
+                                 S16 *packed) {
+	const float inverseScale = 1.0f / scale;
+	
+	for (int i=0; i<count; ++i) {
+		const vec3 d = (positions[i] - bias) * inverseScale;
+		
+		packed[i*4+0] = (S16)quantize(d.x, POSITION_RANGE);
+		packed[i*4+1] = (S16)quantize(d.y, POSITION_RANGE);
+		packed[i*4+2] = (S16)quantize(d.z, POSITION_RANGE);
+		packed[i*4+3] = 0;
+	}
+}
+
+void VertexFormat::packNormals(const vec3 *normals, int count, S8 *packed) {
+	for (int i=0; i<count; ++i) {
+		const vec3 &n = normals[i];
+		
+		packed[i*4+0] = (S8)quantize(n.x * 127.0f, 127);
+		packed[i*4+1] = (S8)quantize(n.y * 127.0f, 127);
+		packed[i*4+2] = (S8)quantize(n.z * 127.0f, 127);
+		packed[i*4+3] = 0;
+	}
+}
+
+bool VertexFormat::canPackTexCoords(const vec2 *texCoords, int count) {
+	if (!halfFloatSupported) {
+		return false;
+	}
+	
+	for (int i=0; i<count; ++i) {
+		const vec2 &t = texCoords[i];
+		
+		if (fabsf(fromHalf(toHalf(t.x)) - t.x) > TEXCOORD_TOLERANCE ||
+		    fabsf(fromHalf(toHalf(t.y)) - t.y) > TEXCOORD_TOLERANCE) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+void VertexFormat::packTexCoords(const vec2 *texCoords, int count, U16 *packed) {
+	for (int i=0; i<count; ++i) {
+		packed[i*2+0] = toHalf(texCoords[i].x);
+		packed[i*2+1] = toHalf(texCoords[i].y);
+	}
+}
+
+bool VertexFormat::canPackColors(const color *colors, int count) {
+	for (int i=0; i<count; ++i) {
+		const color &c = colors[i];
+		
+		if (c.r < 0.0f || c.r > 1.0f ||
+		    c.g < 0.0f || c.g > 1.0f ||
+		    c.b < 0.0f || c.b > 1.0f ||
+		    c.a < 0.0f || c.a > 1.0f) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+void VertexFormat::packColors(const color *colors, int count, U8 *packed) {
+	for (int i=0; i<count; ++i) {
+		const color &c = colors[i];
+		
+		packed[i*4+0] = (U8)floorf(c.r * 255.0f + 0.5f);
+		packed[i*4+1] = (U8)floorf(c.g * 255.0f + 0.5f);
+		packed[i*4+2] = (U8)floorf(c.b * 255.0f + 0.5f);
+		packed[i*4+3] = (U8)floorf(c.a * 255.0f + 0.5f);
+	}
+}
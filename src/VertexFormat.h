@@ -0,0 +1,140 @@
+#ifndef _VERTEX_FORMAT_H_
+#define _VERTEX_FORMAT_H_
+
+#include "vec2.h"
+#include "vec3.h"
+#include "color.h"
+
+/** Compact formats in which vertex buffers may be held on the GPU */
+enum VERTEX_PACKING {
+	/** Elements are held as the engine's own 32-bit floats */
+	PACK_NONE,
+	
+	/**
+	Positions are held as 16-bit integers, four to a vertex, relative to the
+	center of the buffer's bounding box and scaled uniformly to fill the
+	range of the integers
+	*/
+	PACK_POSITIONS,
+	
+	/** Normals are held as signed bytes, four to a vertex */
+	PACK_NORMALS,
+	
+	/** Tex-coords are held as half floats */
+	PACK_TEXCOORDS,
+	
+	/** Colors are held as unsigned bytes */
+	PACK_COLORS
+};
+
+/** Memory used by vertex buffers on the GPU, packed and as floats */
+struct VertexFootprint {
+	/** Bytes that the buffers use on the GPU */
+	size_t packed;
+	
+	/** Bytes that the buffers would use without packing */
+	size_t unpacked;
+	
+	/** Constructor */
+	VertexFootprint();
+	
+	/** Adds the footprint of other buffers */
+	VertexFootprint& operator+=(const VertexFootprint &footprint);
+	
+	/** Gets a readable summary of the footprint */
+	string toString() const;
+};
+
+/**
+Packs vertex attributes into the compact formats that ResourceBuffer may
+hold on the GPU. The client-side copy of a buffer is always kept as
+floats, and is packed as it is submitted.
+
+Packed positions are decoded as position * scale + bias. The fixed function
+pipeline does this through the model-view matrix, and the Cg vertex
+programs through their PositionScale and PositionBias parameters. Normals
+and colors are normalized by OpenGL itself and tex-coords are read as half
+floats, so those need no decoding. The scale is the same along every axis
+so that lighting by the model-view matrix stays correct.
+
+A buffer is only packed when its contents survive packing. Colors that
+carry values outside of [0,1], as the grass layer's do, and tex-coords
+that half floats would shift noticeably, are left as floats.
+*/
+class VertexFormat {
+public:
+	/**
+	Records whether the GPU reads half floats from vertex arrays. Until
+	then, tex-coords are not packed.
+	*/
+	static void setHalfFloatSupported(bool supported);
+	
+	/** Gets the size of one packed element, in bytes */
+	static size_t getStride(VERTEX_PACKING packing);
+	
+	/** Gets the type of each component of a packed element */
+	static GLenum getComponentType(VERTEX_PACKING packing);
+	
+	/** Converts a float to the nearest half float */
+	static U16 toHalf(float value);
+	
+	/** Converts a half float to a float */
+	static float fromHalf(U16 value);
+	
+	/**
+	Chooses how positions are packed
+	@param positions Positions to pack
+	@param count Number of positions
+	@param scale Returns the decoding scale
+	@param bias Returns the decoding bias, the center of the bounding box
+	*/
+	static void fitPositions(const vec3 *positions,
+	                         int count,
+	                         float &scale,
+	                         vec3 &bias);
+	
+	/** Determines whether positions lie within the range of a packing */
+	static bool canPackPositions(const vec3 *positions,
+	                             int count,
+	                             float scale,
+	                             const vec3 &bias);
+	
+	/** Packs positions into four 16-bit integers each */
+	static void packPositions(const vec3 *positions,
+	                          int count,
+	                          float scale,
+	                          const vec3 &bias,
+	                          S16 *packed);
+	
+	/** Packs unit normals into four signed bytes each */
+	static void packNormals(const vec3 *normals, int count, S8 *packed);
+	
+	/**
+	Determines whether tex-coords may be packed, which requires the GPU to
+	read half floats and every coordinate to be within 1/2048 of its half
+	@param texCoords Tex-coords to pack
+	@param count Number of tex-coords
+	*/
+	static bool canPackTexCoords(const vec2 *texCoords, int count);
+	
+	/** Packs tex-coords into two half floats each */
+	static void packTexCoords(const vec2 *texCoords, int count, U16 *packed);
+	
+	/** Determines whether every component of the colors is within [0,1] */
+	static bool canPackColors(const color *colors, int count);
+	
+	/** Packs colors into four unsigned bytes each */
+	static void packColors(const color *colors, int count, U8 *packed);
+	
+private:
+	/** Largest magnitude of a packed position */
+	static const int POSITION_RANGE = 32767;
+	
+	/** Largest error allowed of a tex-coord packed into a half float */
+	static const float TEXCOORD_TOLERANCE;
+	
+	/** Indicates that the GPU reads half floats from vertex arrays */
+	static bool halfFloatSupported;
+};
+
+#endif
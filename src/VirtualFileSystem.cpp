@@ -0,0 +1,144 @@
+#include "Core.h"
+#include "FileFuncs.h"
+#include "VirtualFileSystem.h"
+
+vector<VirtualFileSystem::Mount>& VirtualFileSystem::getMounts() {
+	static vector<Mount> mounts;
+	return mounts;
+}
+
+string VirtualFileSystem::normalize(const string &fileName) {
+	const string fixed = FileName::fix(fileName);
+	string path;
+	path.reserve(fixed.length());
+	
+	for (size_t i=0; i<fixed.length(); ++i) {
+		const bool atStart = path.empty() || path[path.length()-1] == '/';
+		
+		if (atStart && fixed[i] == '/') {
+			continue; // doubled or leading separator
+		}
+		
+		if (atStart && fixed[i] == '.' &&
+		    (i+1 == fixed.length() || fixed[i+1] == '/')) {
+			++i; // "./"
+			continue;
+		}
+		
+		path += fixed[i];
+	}
+	
+	return path;
+}
+
+bool VirtualFileSystem::mount(const FileName &packFileName,
+                              const FileName &mountPoint) {
+	shared_ptr<PackFile> pack(new PackFile);
+	
+	if (!pack->open(packFileName)) {
+		return false;
+	}
+	
+	Mount m;
+	m.mountPoint = normalize(mountPoint.str());
+	m.pack = pack;
+	
+	if (!m.mountPoint.empty() && m.mountPoint[m.mountPoint.length()-1] != '/') {
+		m.mountPoint += '/';
+	}
+	
+	getMounts().push_back(m);
+	
+	TRACE("Mounted " + packFileName.str() + " at \"" + m.mountPoint + "\" ("
+	      + sizet_to_string(pack->getNumFiles()) + " files)");
+	
+	return true;
+}
+
+void VirtualFileSystem::unmount(const FileName &packFileName) {
+	vector<Mount> &mounts = getMounts();
+	
+	for (vector<Mount>::iterator i = mounts.begin(); i != mounts.end(); ) {
+		if (i->pack->getFileName() == packFileName) {
+			i = mounts.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void VirtualFileSystem::unmountAll() {
+	getMounts().clear();
+}
+
+bool VirtualFileSystem::find(const FileName &fileName,
+                             shared_ptr<PackFile> &pack,
+                             const U8 *&data,
+                             size_t &size) {
+	const vector<Mount> &mounts = getMounts();
+	
+	if (mounts.empty()) {
+		return false;
+	}
+	
+	const string path = normalize(fileName.str());
+	
+	for (vector<Mount>::const_reverse_iterator i = mounts.rbegin();
+	     i != mounts.rend(); ++i) {
+		const string &mountPoint = i->mountPoint;
+		
+		if (path.compare(0, mountPoint.length(), mountPoint) == 0 &&
+		    i->pack->find(path.substr(mountPoint.length()), data, size)) {
+			pack = i->pack;
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+bool VirtualFileSystem::exists(const FileName &fileName) {
+	shared_ptr<PackFile> pack;
+	const U8 *data = 0;
+	size_t size = 0;
+	
+	return find(fileName, pack, data, size) || isFileOnDisk(fileName);
+}
+
+void VirtualFileSystem::list(const FileName &directory,
+                             vector<FileName> &files) {
+	string prefix = normalize(directory.str());
+	
+	if (!prefix.empty() && prefix[prefix.length()-1] != '/') {
+		prefix += '/';
+	}
+	
+	set<string> paths;
+	
+	const vector<Mount> &mounts = getMounts();
+	
+	for (vector<Mount>::const_iterator i = mounts.begin();
+	     i != mounts.end(); ++i) {
+		for (size_t j=0, n=i->pack->getNumFiles(); j<n; ++j) {
+			const string path = i->mountPoint + i->pack->getPath(j);
+			
+			if (path.length() > prefix.length() &&
+			    path.compare(0, prefix.length(), prefix) == 0 &&
+			    path.find('/', prefix.length()) == string::npos) {
+				paths.insert(path);
+			}
+		}
+	}
+	
+	vector<string> onDisk;
+	listFilesOnDisk(directory, onDisk);
+	
+	for (vector<string>::const_iterator i = onDisk.begin();
+	     i != onDisk.end(); ++i) {
+		paths.insert(prefix + *i);
+	}
+	
+	for (set<string>::const_iterator i = paths.begin(); i != paths.end(); ++i) {
+		files.push_back(FileName(*i));
+	}
+}
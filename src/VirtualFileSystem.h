@@ -0,0 +1,90 @@
+#ifndef _VIRTUAL_FILE_SYSTEM_H_
+#define _VIRTUAL_FILE_SYSTEM_H_
+
+#include "PackFile.h"
+
+/**
+Table of pack files mounted over the directory tree.
+
+Mounting a pack file at a directory makes each file in the archive appear
+at that directory, e.g. "models/foo.md3" in a pack mounted at "data" is
+found as "data/models/foo.md3". FileMapping consults the mount table before
+the disk, so every loader that reads through FileMapping or FileText sees
+packed files transparently. Archives mounted later take precedence over
+those mounted earlier, and all archives take precedence over loose files.
+
+Mount archives at start-up, before any loading begins; lookups are not
+synchronized against changes to the table.
+*/
+class VirtualFileSystem {
+public:
+	/**
+	Mounts a pack file
+	@param packFileName Name of the pack file
+	@param mountPoint Directory at which the contents of the archive appear
+	@return true if successful
+	*/
+	static bool mount(const FileName &packFileName, const FileName &mountPoint);
+	
+	/**
+	Unmounts a pack file. Files already opened from the archive remain valid.
+	@param packFileName Name of the pack file
+	*/
+	static void unmount(const FileName &packFileName);
+	
+	/** Unmounts all pack files */
+	static void unmountAll();
+	
+	/**
+	Finds a file in the mounted archives
+	@param fileName Name of the file
+	@param pack Returns the archive holding the file; the contents remain
+	       valid for as long as a reference to the archive is held
+	@param data Returns the contents of the file
+	@param size Returns the size of the file, in bytes
+	@return true if the file is in a mounted archive
+	*/
+	static bool find(const FileName &fileName,
+	                 shared_ptr<PackFile> &pack,
+	                 const U8 *&data,
+	                 size_t &size);
+	
+	/**
+	Determines whether a file exists, either in a mounted archive or on disk
+	@param fileName Name of the file
+	@return true if the file exists
+	*/
+	static bool exists(const FileName &fileName);
+	
+	/**
+	Lists the files in a directory, both in mounted archives and on disk,
+	not including subdirectories
+	@param directory Directory to list
+	@param files Receives the name of each file, including the directory,
+	       sorted and without duplicates
+	*/
+	static void list(const FileName &directory, vector<FileName> &files);
+	
+private:
+	/** Entry of the mount table */
+	struct Mount {
+		/** Directory of the mount point, ending in '/', or empty */
+		string mountPoint;
+		
+		/** Mounted archive */
+		shared_ptr<PackFile> pack;
+	};
+	
+	/** Gets the mount table, in the order the archives were mounted */
+	static vector<Mount>& getMounts();
+	
+	/**
+	Transforms a file name into the form in which paths are stored in
+	pack files, without "./" prefixes or doubled separators
+	@param fileName File name to transform
+	@return Transformed file name
+	*/
+	static string normalize(const string &fileName);
+};
+
+#endif
@@ -7,6 +7,13 @@
 #include "ComponentPhysics.h"
 #include "ComponentMovement.h"
 #include "ComponentHealth.h"
+#include "ActorPrototypes.h"
+#include "AssetLoader.h"
+#include "AssetCache.h"
+#include "AssetRequestPropertyBag.h"
+#include "JobGraph.h"
+#include "BufferPool.h"
+#include "AnimationLOD.h"
 
 #include "ActionDeleteActor.h"
 
@@ -14,6 +21,12 @@
 #include "EventExplosionOccurred.h"
 #include "EventGameOver.h"
 
+extern shared_ptr<AssetLoader> g_AssetLoader;
+extern shared_ptr<BufferPool> g_BufferPool;
+
+/** Chooses the detail of animated models; reset with each world */
+AnimationLOD g_AnimationLOD;
+
 World::World(UID uid,
              ScopedEventHandler *parentScope,
              shared_ptr<class Renderer> _renderer,
@@ -51,9 +64,19 @@ World::World(UID uid,
 	REGISTER_HANDLER(World::handleInputKeyDown);
 }
 
+void World::reloadMapIfChanged(const FileName &changedFile) {
+	if (changedFile == fileName) {
+		TRACE("Reloading modified map: " + fileName.str());
+		mapChangeRequested = true;
+		nextMap = fileName;
+		nextMapRequest.reset();
+	}
+}
+
 void World::handleActionChangeMap(const ActionChangeMap *action) {
 	mapChangeRequested = true;
 	nextMap = action->nextMap;
+	nextMapRequest.reset(); // a load in progress is for some other map
 }
 
 void World::loadFromFile(const FileName &_fileName) {
@@ -72,14 +95,71 @@ void World::load(const PropertyBag &bag) {
 	
 	name = bag.getString("name");
 	objects.setParentScope(getParentScopePtr());
+	
+	// Optional tags control when distant, idle actors fall asleep
+	{
+		float sleepRadius = 30.0f;
+		int sleepFrames = 60;
+		bag.get("actorSleepRadius", sleepRadius);
+		bag.get("actorSleepFrames", sleepFrames);
+		objects.setSleepParameters(sleepRadius, (unsigned int)sleepFrames);
+	}
+	
+	// Optional tags control the detail of animated models
+	{
+		float nearDistance = 15.0f;
+		float farDistance = 40.0f;
+		int budget = 0;
+		bag.get("animationNearDistance", nearDistance);
+		bag.get("animationFarDistance", farDistance);
+		bag.get("animationVertexBudget", budget);
+		g_AnimationLOD = AnimationLOD();
+		g_AnimationLOD.setParameters(nearDistance,
+		                             farDistance,
+		                             (size_t)max(budget, 0));
+	}
+	
+	// Terrain and vegetation are generated on the worker threads
+	JobGraph graph;
+	const bool hasMap = bag.get("map", mapBag);
+	
+	if (hasMap) {
+		terrain->prepare(mapBag, renderer, textureFactory, physicsEngine, graph);
+	}
+	
+	const double begin = Thread::getMilliseconds();
+	ThreadPool *workers = g_AssetLoader ? &g_AssetLoader->getWorkers() : 0;
+	graph.start(workers);
+	
+	// Actors touch the physics engine and the renderer, so they are loaded
+	// on the main thread while the map is generated
 	objects.load(bag.getBag("objects"), this);
 	
-	if (bag.get("map", mapBag)) {
-		terrain->create(mapBag, renderer, textureFactory, physicsEngine);
+	graph.wait();
+	
+	if (hasMap) {
+		terrain->finish();
+	}
+	
+	{
+		const double wallTime = Thread::getMilliseconds() - begin;
+		const double jobTime = graph.getTotalJobTime();
+		TRACE("Map jobs: " + itos((int)graph.getNumJobs()) + " on "
+		      + itos(workers ? (int)workers->getNumThreads() : 0)
+		      + " worker threads, " + ftos((float)jobTime) + "ms of work in "
+		      + ftos((float)wallTime) + "ms ("
+		      + ftos(wallTime > 0.0 ? (float)(jobTime / wallTime) : 0.0f)
+		      + "x)");
 	}
 	
 	broadcastDebugModeDisable();
 	cameraLooksAtPlayerStartPoint();
+	
+	// Evict what the previous map used and this one does not
+	AssetCacheBase::trimAll();
+	g_BufferPool->trim();
+	TRACE("Resident assets after loading " + name + ":\n"
+	      + AssetCacheBase::summarizeAll());
 }
 
 void World::draw() const {
@@ -99,6 +179,7 @@ void World::update(float deltaTime) {
 		broadcastGameOverEvent();
 	} else {
 		handleMapChangeRequest();
+		g_AnimationLOD.beginFrame(camera->getPosition());
 		objects.update(deltaTime);
 		terrain->emitGeometry();
 		recalculateAveragePlayerPosition();
@@ -111,17 +192,12 @@ void World::update(float deltaTime) {
 }
 
 ActorPtr World::createPlayer(const vec3 &initialPosition,
-                             const PropertyBag &playerData,
+                             const ComponentDataSet &playerData,
                              int playerNumber,
                              int numOfPlayers) {
 	const ActorPtr player = objects.create().get<1>();
 	
-	const PropertyBag base = playerData.getBag("components");
-	const PropertyBag spec = PropertyBag(); // empty
-	
-	const ComponentDataSet components = ComponentDataSet::load(base, spec);
-	
-	player->load(components, initialPosition, vec3(0,0,0), this);
+	player->load(playerData, initialPosition, vec3(0,0,0), this);
 	
 	sendPlayerNumber(playerNumber, player);
 	
@@ -147,8 +223,8 @@ void World::playersEnter(int numOfPlayers) {
 	
 	const vec3 playerPosition = getPlayerStartPoint();
 	
-	const PropertyBag playerData =
-	 PropertyBag::fromFile(FileName("data/actorDefs/startingPlayer.xml"));
+	const ComponentDataSet &playerData =
+	 ActorPrototypes::get(FileName("data/actorDefs/startingPlayer.xml"));
 	 
 	int numOfJoy = SDL_NumJoysticks();
 	numOfPlayers = (numOfPlayers>numOfJoy) ? numOfJoy : numOfPlayers;
@@ -185,11 +261,8 @@ void World::updateCamera_Overhead() {
 			ActorPtr player = i->second;
 			ASSERT(player, "Null pointer: pl");
 			
-			shared_ptr<Component> component = player->getComponent("Physics");
-			shared_ptr<ComponentPhysics> physics = dynamic_pointer_cast<ComponentPhysics>(component);
-			
-			if (physics) {
-				const vec3 position = physics->getPosition();
+			if (player->hasPosition()) {
+				const vec3 &position = player->getPosition();
 				vec3 delta = position - averagePlayerPosition;
 				const float distanceToLocus = delta.getMagnitude();
 				maxPlayerDistance = max(maxPlayerDistance, distanceToLocus);
@@ -270,16 +343,15 @@ vec3 World::findAveragePlayerPosition() const {
 		const ActorPtr player = i->second;
 		ASSERT(player, "Null parameter: player");
 		
-		shared_ptr<Component> component = player->getComponent("Physics");
-		shared_ptr<ComponentPhysics> physics = dynamic_pointer_cast<ComponentPhysics>(component);
-		
-		if (physics) {
-			averagePlayerPosition=averagePlayerPosition+physics->getPosition();
+		if (player->hasPosition()) {
+			averagePlayerPosition=averagePlayerPosition+player->getPosition();
 			count++;
 		}
 	}
 	
-	averagePlayerPosition = averagePlayerPosition * (1.0f/count);
+	if (count>0) {
+		averagePlayerPosition = averagePlayerPosition * (1.0f/count);
+	}
 	
 	return averagePlayerPosition;
 }
@@ -337,6 +409,57 @@ void World::onKeyTogglePhysics() {
 	playSound(FileName("data/sound/flashlight-toggle.wav"));
 }
 
+void World::onKeyBenchmarkMapGeneration() {
+	PropertyBag mapBag;
+	
+	if (fileName == FileName() ||
+	    !PropertyBag::fromFile(fileName).get("map", mapBag)) {
+		return;
+	}
+	
+	vector<size_t> threadCounts;
+	threadCounts.push_back(1);
+	threadCounts.push_back(2);
+	
+	const size_t numProcessors = Thread::getNumProcessors();
+	
+	if (numProcessors > 2) {
+		threadCounts.push_back(numProcessors);
+	}
+	
+	double baseline = 0.0;
+	
+	for (vector<size_t>::const_iterator i = threadCounts.begin();
+	     i != threadCounts.end(); ++i) {
+		const double time = generateMap(mapBag, *i);
+		
+		if (*i == 1) {
+			baseline = time;
+		}
+		
+		TRACE("Map generation on " + itos((int)*i) + " threads: "
+		      + ftos((float)time) + "ms ("
+		      + ftos(time > 0.0 ? (float)(baseline / time) : 0.0f)
+		      + "x speedup)");
+	}
+}
+
+double World::generateMap(const PropertyBag &mapBag, size_t numThreads) {
+	ThreadPool workers(numThreads);
+	JobGraph graph;
+	
+	terrain->clear();
+	terrain->prepare(mapBag, renderer, textureFactory, physicsEngine, graph);
+	
+	const double begin = Thread::getMilliseconds();
+	graph.start(&workers);
+	graph.wait();
+	const double time = Thread::getMilliseconds() - begin;
+	
+	terrain->finish();
+	return time;
+}
+
 void World::onKeyToggleDebugRendering() {
 	if (displayDebugData) {
 		broadcastDebugModeDisable();
@@ -357,6 +480,7 @@ void World::destroy() {
 	terrain->clear();
 	objects.destroy();
 	players.clear();
+	spatialIndex.clear();
 	physicsEngine.reset();
 }
 
@@ -410,11 +534,37 @@ bool World::isGameOver() {
 }
 
 void World::handleMapChangeRequest() {
-	if (mapChangeRequested) {
-		int numOfPlayers = (int)players.size();
+	if (!mapChangeRequested) {
+		return;
+	}
+	
+	int numOfPlayers = (int)players.size();
+	
+	if (!g_AssetLoader) {
 		loadFromFile(nextMap);
 		playersEnter(numOfPlayers);
 		mapChangeRequested = false;
+		return;
+	}
+	
+	// The current map keeps running while the next one loads
+	if (!nextMapRequest) {
+		nextMapRequest = shared_ptr<AssetRequestPropertyBag>(new AssetRequestPropertyBag(nextMap));
+		g_AssetLoader->load(nextMapRequest);
+	}
+	
+	if (nextMapRequest->isDone()) {
+		shared_ptr<AssetRequestPropertyBag> request = nextMapRequest;
+		nextMapRequest.reset();
+		mapChangeRequested = false;
+		
+		if (request->succeeded()) {
+			fileName = nextMap;
+			load(request->getBag());
+			playersEnter(numOfPlayers);
+		} else {
+			ERR("Failed to change map: " + nextMap.str());
+		}
 	}
 }
 
@@ -513,6 +663,9 @@ void World::handleInputKeyPress(const InputKeyPress *input) {
 	case SDLK_F3:
 		onKeyTogglePhysics();
 		break;
+	case SDLK_F4:
+		onKeyBenchmarkMapGeneration();
+		break;
 	}
 }
 
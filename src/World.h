@@ -11,6 +11,7 @@
 #include "Fog.h"
 #include "PhysicsEngine.h"
 #include "ParticleEngine.h"
+#include "SpatialIndex.h"
 #include "SDLinput.h"
 
 #include "ActionChangeMap.h"
@@ -40,6 +41,13 @@ public:
 	/** Loads the world from file */
 	void loadFromFile(const FileName &fileName);
 	
+	/**
+	Reloads the map, keeping the players, if it was loaded from a file
+	that has changed
+	@param changedFile File that has changed
+	*/
+	void reloadMapIfChanged(const FileName &changedFile);
+	
 	/**
 	Retrieves the name of the realm
 	@return Name of the realm
@@ -96,6 +104,16 @@ public:
 		return physicsEngine;
 	}
 	
+	/** Gets the index of actor positions used for proximity queries */
+	inline SpatialIndex& getSpatialIndex() {
+		return spatialIndex;
+	}
+	
+	/** Gets the index of actor positions used for proximity queries */
+	inline const SpatialIndex& getSpatialIndex() const {
+		return spatialIndex;
+	}
+	
 	TextureFactory& getTextureFactory() {
 		return textureFactory;
 	}
@@ -148,6 +166,21 @@ private:
 	void onKeyToggleDebugRendering();
 	void onKeyTogglePhysics();
 	
+	/**
+	Generates the map's terrain and vegetation again with the worker pool
+	limited to one thread, two threads, and one thread per processor, and
+	reports the speedup over a single thread
+	*/
+	void onKeyBenchmarkMapGeneration();
+	
+	/**
+	Generates the map's terrain and vegetation on a pool of worker threads
+	@param mapBag Map data source
+	@param numThreads Number of worker threads
+	@return Wall clock time taken by the generation jobs, in milliseconds
+	*/
+	double generateMap(const PropertyBag &mapBag, size_t numThreads);
+	
 	void handleActionChangeMap(const ActionChangeMap *action);
 	void handleActionDebugEnable(const ActionDebugEnable *action);
 	void handleActionDebugDisable(const ActionDebugDisable *action);
@@ -187,7 +220,7 @@ private:
 	@return Player
 	*/
 	ActorPtr createPlayer(const vec3 &initialPosition,
-	                      const PropertyBag &playerData,
+	                      const ComponentDataSet &playerData,
 	                      int playerNumber,
 	                      int numOfPlayers);
 	                      
@@ -291,6 +324,9 @@ private:
 	/** Physics engine subsystem */
 	shared_ptr<PhysicsEngine> physicsEngine;
 	
+	/** Positions of all actors, updated as the actors move */
+	SpatialIndex spatialIndex;
+	
 	/** Indicates that the camera is in FP mode (true) or game mode (false) */
 	enum {
 		FIRST_PERSON_CAMERA,
@@ -315,6 +351,9 @@ private:
 	*/
 	FileName nextMap;
 	
+	/** Loads the next map in the background, while the current one runs */
+	shared_ptr<class AssetRequestPropertyBag> nextMapRequest;
+	
 	/** Indicates that a map change was requested in the previous tick */
 	bool mapChangeRequested;
 	
@@ -1,5 +1,7 @@
 #include "stdafx.h"
 #include "devil_wrapper.h"
+#include "FileMapping.h"
+#include "Thread.h"
 
 ILboolean ilLoadImage(const FileName &fileName) {
 	char *pszFileName = strdup(fileName.str());
@@ -8,12 +10,46 @@ ILboolean ilLoadImage(const FileName &fileName) {
 	return r;
 }
 
+Mutex& devil_getMutex() {
+	static Mutex mutex;
+	return mutex;
+}
+
+/**
+Loads an image from the contents of its file, rather than letting DevIL
+open the file and read it a piece at a time
+@param fileName File name of the image, which determines its type
+@param data Contents of the image file, or null to have DevIL read the file
+@param size Size of the image file, in bytes
+@return true if successful
+*/
+static ILboolean loadImageFromMemory(const FileName &fileName,
+                                     const U8 *data,
+                                     size_t size) {
+	char *pszFileName = strdup(fileName.str());
+	const ILenum type = ilTypeFromExt(pszFileName);
+	free(pszFileName);
+	
+	if (type == IL_TYPE_UNKNOWN || !data || size == 0) {
+		return ilLoadImage(fileName);
+	}
+	
+	return ilLoadL(type, data, (ILuint)size);
+}
+
 unsigned int devil_loadImage(const FileName &fileName) {
+	const FileMapping file(fileName);
+	return devil_loadImage(fileName, file.getData(), file.getSize());
+}
+
+unsigned int devil_loadImage(const FileName &fileName,
+                             const U8 *data,
+                             size_t size) {
 	unsigned int imageName = 0;
 	ilGenImages(1, &imageName);
 	ilBindImage(imageName);
 	
-	ilLoadImage(fileName);
+	loadImageFromMemory(fileName, data, size);
 	
 	ILenum error = ilGetError();
 	
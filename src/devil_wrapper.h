@@ -11,6 +11,14 @@
 #include <IL/ilu.h>
 #include <IL/ilut.h>
 
+class Mutex;
+
+/**
+Gets the lock that must be held while using DevIL, as DevIL keeps the bound
+image in global state and images are decoded on loader threads too
+*/
+Mutex& devil_getMutex();
+
 /**
 Loads an image and returns the DevIL image handle
 @param fileName File name of the font image
@@ -18,6 +26,17 @@ Loads an image and returns the DevIL image handle
 */
 unsigned int devil_loadImage(const FileName &fileName);
 
+/**
+Loads an image from the contents of its file
+@param fileName File name of the image, which determines its type
+@param data Contents of the image file
+@param size Size of the image file, in bytes
+@return DevIL image handle
+*/
+unsigned int devil_loadImage(const FileName &fileName,
+                             const U8 *data,
+                             size_t size);
+
 /**
 Calls DevIL's ilLoadImage, but allowing FileName type parameter
 @param fileName File name of the font image
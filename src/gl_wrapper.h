@@ -0,0 +1,18 @@
+#ifndef GL_WRAPPER_H
+#define GL_WRAPPER_H
+
+/*
+OpenGL types and enumerants, along with the extensions loaded by GLEW.
+Including the headers links nothing in, so sources that only need the
+types, such as the buffer pool, can be built into tools that never create
+a GL context.
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#endif
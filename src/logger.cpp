@@ -1,11 +1,16 @@
 #include "Core.h"
 #include "FileFuncs.h"
+#include "Thread.h"
 
 #ifdef _WIN32
 #include <windows.h>
 #endif
 
 void PrintStringToLog(const string &s) {
+	// Messages may be logged from loader threads
+	static Mutex mutex;
+	MutexLock lock(mutex);
+	
 	static bool firstTime = true;
 	static fstream stream;
 	
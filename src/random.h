@@ -3,6 +3,7 @@
 
 #include "tstring.h"
 #include "vec3.h"
+#include <boost/random/mersenne_twister.hpp>
 
 // Random Number Macros
 #define IRAND (rand())                                 // Get a random integer
@@ -25,4 +26,20 @@ float SampleNormal(float mean, float sigma);
 
 float SampleLogNormal(float mean, float sigma);
 
+/*
+The functions below draw from a generator owned by the caller rather than
+from the shared generators above, so that code running on several threads at
+once can draw the same numbers on every run given the same seeds.
+*/
+
+/** Get a random float between low and high */
+float SampleUniform(boost::mt19937 &rng, float low, float high);
+
+/** Get a random integer between low and high, inclusive */
+int SampleUniformInt(boost::mt19937 &rng, int low, int high);
+
+float SampleNormal(boost::mt19937 &rng, float mean, float sigma);
+
+float SampleLogNormal(boost::mt19937 &rng, float mean, float sigma);
+
 #endif
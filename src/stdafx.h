@@ -17,8 +17,7 @@
 #include "Core.h"
 
 /* OpenGL Library */
-#include <GL/glew.h>
-#include <GL/gl.h>
+#include "gl_wrapper.h"
 #include <GL/glu.h>
 
 /* ODE Physics Engine */
@@ -0,0 +1,54 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+class AnimationController;
+
+/**
+Reports a measurement that must reach a threshold. Measurements that miss
+their thresholds are counted, and the benchmark program fails if any did.
+@param name What was measured
+@param value Measurement
+@param minimum Lowest acceptable measurement
+@param unit Unit of the measurement
+@return true if the measurement reached the threshold
+*/
+bool reportAtLeast(const string &name, double value, double minimum, const string &unit);
+
+/**
+Reports a measurement that must not exceed a threshold
+@param name What was measured
+@param value Measurement
+@param maximum Highest acceptable measurement
+@param unit Unit of the measurement
+@return true if the measurement stayed within the threshold
+*/
+bool reportAtMost(const string &name, double value, double maximum, const string &unit);
+
+/** Gets the bytes currently allocated on the heap */
+size_t getHeapBytes();
+
+/**
+Gets the most bytes allocated on the heap at once, since the last call to
+resetHeapPeak
+*/
+size_t getHeapPeak();
+
+/** Starts measuring the peak of the heap from the bytes allocated now */
+void resetHeapPeak();
+
+/**
+Loads an instance of an MD3 model, with textures tracked by name alone
+@param fileName Model description (.md3xml)
+@return new instance of the model; ownership passes to the caller
+*/
+AnimationController* loadModel(const FileName &fileName);
+
+/** Model that the animation benchmarks are run on */
+#define BENCHMARK_MODEL "data/models/hero-green/hero-green.md3xml"
+
+// Benchmarks, one for each source file in this directory
+void benchmarkModelLoad();
+void benchmarkVertexBlend();
+void benchmarkWorkingSet();
+
+#endif
@@ -0,0 +1,136 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "ModelLoaderMD3.h"
+#include "ModelBinary.h"
+#include "Benchmark.h"
+
+extern shared_ptr<BufferPool> g_BufferPool;
+
+/** Times each form of the model is loaded, taking the average */
+static const size_t LOADS = 10;
+
+/**
+Cooked file written and loaded by the benchmark, in the working directory
+rather than alongside the model so that the data files are left alone
+*/
+static const char COOKED_FILE_NAME[] = "benchmark.model";
+
+/** Lowest acceptable speed of loading the cooked file over the sources */
+static const double MIN_SPEEDUP = 2.0;
+
+/**
+Highest acceptable peak of the heap while loading the cooked file, as a
+share of the peak while loading the sources
+*/
+static const double MAX_PEAK_SHARE = 1.0;
+
+/** Time taken and memory used by loading one form of a model */
+struct LoadMeasurement {
+	/** Average time taken by a load */
+	double milliseconds;
+	
+	/** Most heap allocated at once by a load, beyond what was there before */
+	size_t heapPeak;
+	
+	/** Memory that the loaded model holds in the buffer pool */
+	size_t poolBytes;
+	
+	/** Vertices of the loaded model's current animation */
+	size_t vertices;
+	
+	/** Animations of the loaded model */
+	size_t animations;
+	
+	/** Constructor */
+	LoadMeasurement()
+			: milliseconds(0.0),
+			heapPeak(0),
+			poolBytes(0),
+			vertices(0),
+			animations(0) {}
+};
+
+/** Loads a model from its sources, as ModelLoader does without a cooked file */
+static AnimationController* loadSource(TextureFactory &textureFactory) {
+	ModelLoaderMD3 loader;
+	return loader.loadFromSource(FileName(BENCHMARK_MODEL), textureFactory);
+}
+
+/** Loads a model from the cooked file written by the benchmark */
+static AnimationController* loadCooked(TextureFactory &textureFactory) {
+	return ModelBinary::loadFromFile(FileName(COOKED_FILE_NAME), textureFactory);
+}
+
+/**
+Loads a model over and over and measures the loads
+@param load Function loading the model
+@param textureFactory Tracks the textures of the model by name
+*/
+static LoadMeasurement measure(AnimationController* (*load)(TextureFactory&),
+                               TextureFactory &textureFactory) {
+	LoadMeasurement measurement;
+	
+	for (size_t i=0; i<LOADS; ++i) {
+		const size_t heapBefore = getHeapBytes();
+		const size_t poolBefore = g_BufferPool->getStatistics().ranges.used;
+		resetHeapPeak();
+		
+		const double begin = Thread::getMilliseconds();
+		shared_ptr<AnimationController> model(load(textureFactory));
+		measurement.milliseconds += Thread::getMilliseconds() - begin;
+		
+		VERIFY(model, "Failed to load the model");
+		
+		measurement.heapPeak = max(measurement.heapPeak, getHeapPeak() - heapBefore);
+		measurement.poolBytes = g_BufferPool->getStatistics().ranges.used - poolBefore;
+		measurement.vertices = model->getNumVertices();
+		measurement.animations = model->getNumAnimations();
+	}
+	
+	measurement.milliseconds /= LOADS;
+	
+	return measurement;
+}
+
+/** Prints a measurement of one form of the model */
+static void print(const string &name, const LoadMeasurement &measurement) {
+	cout << "  " << name << ": " << measurement.milliseconds << "ms, "
+	     << measurement.heapPeak << " bytes of heap at most, "
+	     << measurement.poolBytes << " bytes of buffers" << endl;
+}
+
+void benchmarkModelLoad() {
+	TextureFactory textureFactory;
+	
+	// Both forms load the same textures, tracked alike by the factory
+	shared_ptr<AnimationController> model(loadSource(textureFactory));
+	VERIFY(model, "Failed to load the model: " BENCHMARK_MODEL);
+	VERIFY(ModelBinary::saveToFile(*model, FileName(COOKED_FILE_NAME)),
+	       "Failed to cook the model: " BENCHMARK_MODEL);
+	model.reset();
+	
+	const LoadMeasurement source = measure(loadSource, textureFactory);
+	const LoadMeasurement cooked = measure(loadCooked, textureFactory);
+	
+	remove(COOKED_FILE_NAME);
+	
+	print("sources", source);
+	print("cooked", cooked);
+	
+	reportAtLeast("speed of the cooked file over the sources",
+	              source.milliseconds / max(cooked.milliseconds, 0.001),
+	              MIN_SPEEDUP,
+	              "x");
+	reportAtMost("peak heap of the cooked file, share of the sources",
+	             (double)cooked.heapPeak / max(source.heapPeak, (size_t)1),
+	             MAX_PEAK_SHARE,
+	             "");
+	reportAtMost("animations lost in cooking",
+	             (double)source.animations - (double)cooked.animations,
+	             0.0,
+	             "");
+	reportAtMost("vertices lost in cooking",
+	             (double)source.vertices - (double)cooked.vertices,
+	             0.0,
+	             "");
+}
@@ -0,0 +1,199 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "AnimationController.h"
+#include "VertexBlend.h"
+#include "Benchmark.h"
+
+/** Times the pair of key frames is blended in the kernel benchmark */
+static const size_t KERNEL_REPEATS = 2000;
+
+/** Frames of animation interpolated in the end-to-end benchmark */
+static const size_t FRAMES = 2000;
+
+/**
+Lowest acceptable rate of the kernels, blending positions and normals and
+normalizing the normals. Conservative, so that unoptimized builds pass too.
+*/
+static const double MIN_KERNEL_VERTICES_PER_SECOND = 20000000.0;
+
+/**
+Lowest acceptable rate of interpolating frames through the animation,
+which also locks the meshes of the working set and submits them again
+*/
+static const double MIN_FRAME_VERTICES_PER_SECOND = 5000000.0;
+
+/** Lowest acceptable speed of the kernels over blending vec3 by vec3 */
+static const double MIN_SPEEDUP = 1.0;
+
+/** Largest acceptable difference from blending vec3 by vec3 */
+static const double MAX_DIFFERENCE = 0.001;
+
+/** Blends and normalizes vectors one vec3 at a time, as a reference */
+static void blendReference(vector<vec3> &positions,
+                           vector<vec3> &normals,
+                           const vector<vec3> &positionsA,
+                           const vector<vec3> &positionsB,
+                           const vector<vec3> &normalsA,
+                           const vector<vec3> &normalsB,
+                           float bias) {
+	for (size_t i=0; i<positions.size(); ++i) {
+		positions[i] = positionsA[i] + (positionsB[i] - positionsA[i]) * bias;
+		normals[i] = normalsA[i] + (normalsB[i] - normalsA[i]) * bias;
+		
+		const float length = normals[i].getMagnitude();
+		
+		if (length > 0.0f) {
+			normals[i] = normals[i] * (1.0f / length);
+		}
+	}
+}
+
+/** Blends and normalizes vectors with the kernels of VertexBlend */
+static void blendKernels(vector<vec3> &positions,
+                         vector<vec3> &normals,
+                         const vector<vec3> &positionsA,
+                         const vector<vec3> &positionsB,
+                         const vector<vec3> &normalsA,
+                         const vector<vec3> &normalsB,
+                         float bias) {
+	const size_t count = positions.size();
+	VertexBlend::blend(&positions[0], &positionsA[0], &positionsB[0], count, bias);
+	VertexBlend::blend(&normals[0], &normalsA[0], &normalsB[0], count, bias);
+	VertexBlend::normalize(&normals[0], count);
+}
+
+/** Appends the vectors of a buffer of every mesh of a key frame */
+static void gather(vector<vec3> &out,
+                   const KeyFrame &keyFrame,
+                   ResourceBufferVerticesPtr Mesh::*buffer) {
+	const MeshSet &meshes = keyFrame.getMeshes();
+	
+	for (size_t i=0; i<meshes.size(); ++i) {
+		ResourceBufferVertices &vectors = *(meshes[i].get()->*buffer);
+		const vec3 *v = (const vec3 *)vectors.read_lock();
+		out.insert(out.end(), v, v + vectors.getNumber());
+		vectors.unlock();
+	}
+}
+
+/** Gets the largest difference between the components of two streams */
+static double getDifference(const vector<vec3> &a, const vector<vec3> &b) {
+	double difference = 0.0;
+	
+	for (size_t i=0; i<a.size(); ++i) {
+		difference = max(difference, (double)fabsf(a[i].x - b[i].x));
+		difference = max(difference, (double)fabsf(a[i].y - b[i].y));
+		difference = max(difference, (double)fabsf(a[i].z - b[i].z));
+	}
+	
+	return difference;
+}
+
+/**
+Blends two key frames of the model over and over, with the kernels and
+vec3 by vec3, and compares the two in speed and result
+*/
+static void benchmarkKernels(const AnimationSequence &animation) {
+	const KeyFrame &lower = animation.getKeyFrames()[0];
+	const KeyFrame &upper = animation.getKeyFrames()[1];
+	
+	vector<vec3> positionsA, positionsB, normalsA, normalsB;
+	gather(positionsA, lower, &Mesh::vertexArray);
+	gather(positionsB, upper, &Mesh::vertexArray);
+	gather(normalsA, lower, &Mesh::normalArray);
+	gather(normalsB, upper, &Mesh::normalArray);
+	
+	const size_t count = positionsA.size();
+	vector<vec3> positions(count), normals(count);
+	vector<vec3> referencePositions(count), referenceNormals(count);
+	
+	double begin = Thread::getMilliseconds();
+	
+	for (size_t i=0; i<KERNEL_REPEATS; ++i) {
+		blendKernels(positions, normals,
+		             positionsA, positionsB, normalsA, normalsB,
+		             (float)i / KERNEL_REPEATS);
+	}
+	
+	const double kernelMilliseconds = Thread::getMilliseconds() - begin;
+	begin = Thread::getMilliseconds();
+	
+	for (size_t i=0; i<KERNEL_REPEATS; ++i) {
+		blendReference(referencePositions, referenceNormals,
+		               positionsA, positionsB, normalsA, normalsB,
+		               (float)i / KERNEL_REPEATS);
+	}
+	
+	const double referenceMilliseconds = Thread::getMilliseconds() - begin;
+	const double vertices = (double)count * KERNEL_REPEATS;
+	
+	cout << "  " << count << " vertices a frame, "
+	     << (VertexBlend::isVectorized() ? "SSE2" : "scalar") << " kernels"
+	     << endl;
+	
+	reportAtLeast("kernels",
+	              vertices * 1000.0 / max(kernelMilliseconds, 0.001),
+	              MIN_KERNEL_VERTICES_PER_SECOND,
+	              "vertices/sec");
+	reportAtLeast("speed over vec3 by vec3",
+	              referenceMilliseconds / max(kernelMilliseconds, 0.001),
+	              MIN_SPEEDUP,
+	              "x");
+	reportAtMost("difference in positions from vec3 by vec3",
+	             getDifference(positions, referencePositions),
+	             MAX_DIFFERENCE,
+	             "");
+	reportAtMost("difference in normals from vec3 by vec3",
+	             getDifference(normals, referenceNormals),
+	             MAX_DIFFERENCE,
+	             "");
+}
+
+/**
+Interpolates frames through the animation into a working set, as an
+instance of the model does, and asks for the last of them again
+*/
+static void benchmarkFrames(const AnimationSequence &animation) {
+	WorkingSet workingSet;
+	const float length = animation.getLength();
+	
+	// Times fall between key frames, never on one
+	const float step = length / (FRAMES + 1);
+	
+	const VertexBlendStatistics before = VertexBlend::getStatistics();
+	
+	for (size_t i=0; i<FRAMES; ++i) {
+		animation.getFrame(step * (i + 0.5f), workingSet);
+	}
+	
+	const VertexBlendStatistics blended = VertexBlend::getStatistics();
+	
+	animation.getFrame(step * (FRAMES - 0.5f), workingSet);
+	
+	const VertexBlendStatistics after = VertexBlend::getStatistics();
+	
+	const double vertices = (double)(blended.vertices - before.vertices);
+	const double milliseconds = blended.milliseconds - before.milliseconds;
+	
+	reportAtLeast("frames through the animation",
+	              vertices * 1000.0 / max(milliseconds, 0.001),
+	              MIN_FRAME_VERTICES_PER_SECOND,
+	              "vertices/sec");
+	reportAtLeast("frames asked for again and reused",
+	              (double)(after.reusedFrames - blended.reusedFrames),
+	              1.0,
+	              "frames");
+	reportAtMost("frames asked for again and blended",
+	             (double)(after.frames - blended.frames),
+	             0.0,
+	             "frames");
+}
+
+void benchmarkVertexBlend() {
+	shared_ptr<AnimationController> model(loadModel(FileName(BENCHMARK_MODEL)));
+	const AnimationSequence &animation =
+	    model->getAnimation(model->getAnimationHandle("walk"));
+	
+	benchmarkKernels(animation);
+	benchmarkFrames(animation);
+}
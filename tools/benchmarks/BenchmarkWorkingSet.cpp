@@ -0,0 +1,73 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "AnimationController.h"
+#include "Benchmark.h"
+
+extern shared_ptr<BufferPool> g_BufferPool;
+
+/** Numbers of instances that are measured */
+static const size_t INSTANCE_COUNTS[] = { 1, 10, 50 };
+
+/**
+Highest acceptable memory added by each instance, as a share of the memory
+of the model. An instance holds a single pose of vertices and normals,
+while the model holds every key frame along with tex-coords and indices.
+*/
+static const double MAX_INSTANCE_SHARE = 0.1;
+
+/**
+Highest acceptable memory added by each of many instances, compared with
+that added by a single instance. Key frames that were copied along with
+each instance would show up here.
+*/
+static const double MAX_INSTANCE_GROWTH = 1.05;
+
+/** Gets the bytes held in ranges of the buffer pool */
+static size_t getPoolBytes() {
+	return g_BufferPool->getStatistics().ranges.used;
+}
+
+void benchmarkWorkingSet() {
+	const size_t poolBefore = getPoolBytes();
+	shared_ptr<AnimationController> model(loadModel(FileName(BENCHMARK_MODEL)));
+	const size_t modelBytes = getPoolBytes() - poolBefore;
+	
+	cout << "  model: " << modelBytes << " bytes of key frames, "
+	     << model->getNumAnimations() << " animations" << endl;
+	
+	double firstPerInstance = 0.0;
+	
+	for (size_t c=0; c<sizeof(INSTANCE_COUNTS)/sizeof(INSTANCE_COUNTS[0]); ++c) {
+		const size_t count = INSTANCE_COUNTS[c];
+		const size_t before = getPoolBytes();
+		
+		vector< shared_ptr<AnimationController> > instances;
+		vector<GeometryChunk> chunks;
+		
+		for (size_t i=0; i<count; ++i) {
+			shared_ptr<AnimationController> instance(loadModel(FileName(BENCHMARK_MODEL)));
+			
+			// Each instance is drawn between two key frames of its own
+			instance->requestAnimationChange("walk");
+			instance->update(100.0f + (float)i);
+			instance->getGeometryChunks(chunks);
+			
+			instances.push_back(instance);
+		}
+		
+		const double perInstance = (double)(getPoolBytes() - before) / count;
+		
+		if (c == 0) {
+			firstPerInstance = perInstance;
+		}
+		
+		reportAtMost(sizet_to_string(count) + " instances, bytes added by each",
+		             perInstance,
+		             modelBytes * MAX_INSTANCE_SHARE,
+		             "bytes");
+		reportAtMost(sizet_to_string(count) + " instances, growth over one instance",
+		             perInstance / firstPerInstance,
+		             MAX_INSTANCE_GROWTH,
+		             "x");
+	}
+}
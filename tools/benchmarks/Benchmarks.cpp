@@ -0,0 +1,151 @@
+/*
+Measures the engine's model loading and animation, and checks the
+measurements against thresholds.
+
+Usage: Benchmarks
+
+Run from the directory holding "data". Each benchmark prints what it
+measured; a measurement that misses its threshold is marked as such, and
+the program exits with a failure status if any did. Nothing is drawn, so
+no window or GL context is opened: meshes are built in a buffer pool whose
+backend keeps no buffer objects.
+*/
+
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "BufferPool.h"
+#include "ModelLoaderMD3.h"
+#include "Benchmark.h"
+
+/** Buffer pool that the meshes of the measured models are built in */
+shared_ptr<BufferPool> g_BufferPool;
+
+/** Textures of the measured models, tracked by name alone */
+static shared_ptr<TextureFactory> textureFactory;
+
+static size_t numMeasurements = 0;
+static size_t numMisses = 0;
+
+/**
+Bytes allocated on the heap through operator new, now and at most. The
+benchmarks run on a single thread, so the counters are not guarded.
+*/
+static size_t heapBytes = 0;
+static size_t heapPeak = 0;
+
+/**
+Room kept ahead of each allocation for its size, which keeps the alignment
+that malloc gives
+*/
+static const size_t HEAP_HEADER = 2 * sizeof(size_t);
+
+void* operator new(size_t size) {
+	size_t *block = static_cast<size_t*>(malloc(HEAP_HEADER + size));
+	
+	if (!block) {
+		throw std::bad_alloc();
+	}
+	
+	block[0] = size;
+	heapBytes += size;
+	heapPeak = max(heapPeak, heapBytes);
+	
+	return reinterpret_cast<char*>(block) + HEAP_HEADER;
+}
+
+void operator delete(void *p) throw() {
+	if (p) {
+		size_t *block = reinterpret_cast<size_t*>(static_cast<char*>(p) - HEAP_HEADER);
+		heapBytes -= block[0];
+		free(block);
+	}
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete[](void *p) throw() {
+	operator delete(p);
+}
+
+size_t getHeapBytes() {
+	return heapBytes;
+}
+
+size_t getHeapPeak() {
+	return heapPeak;
+}
+
+void resetHeapPeak() {
+	heapPeak = heapBytes;
+}
+
+/**
+Prints a measurement along with its threshold
+@param passed Indicates that the measurement is within its threshold
+*/
+static bool report(bool passed,
+                   const string &name,
+                   double value,
+                   const char *relation,
+                   double threshold,
+                   const string &unit) {
+	numMeasurements++;
+	
+	if (!passed) {
+		numMisses++;
+	}
+	
+	cout << (passed ? "  " : "  MISSED ") << name << ": " << value
+	     << (unit.empty() ? "" : " " + unit)
+	     << " (" << relation << " " << threshold << ")" << endl;
+	
+	return passed;
+}
+
+bool reportAtLeast(const string &name, double value, double minimum, const string &unit) {
+	return report(value >= minimum, name, value, "at least", minimum, unit);
+}
+
+bool reportAtMost(const string &name, double value, double maximum, const string &unit) {
+	return report(value <= maximum, name, value, "at most", maximum, unit);
+}
+
+AnimationController* loadModel(const FileName &fileName) {
+	ModelLoaderMD3 loader;
+	return loader.load(fileName, *textureFactory);
+}
+
+/**
+Runs a benchmark and reports whether it met its thresholds. Models it
+loaded are dropped afterwards, so each benchmark loads them afresh.
+@param name Name of the benchmark
+@param benchmark Function running the benchmark
+*/
+static void run(const string &name, void (*benchmark)()) {
+	const size_t missesBefore = numMisses;
+	cout << name << endl;
+	benchmark();
+	ModelLoader::clearCache();
+	cout << (numMisses == missesBefore ? "passed " : "FAILED ")
+	     << name << endl;
+}
+
+int main(int, char *[]) {
+	shared_ptr<BufferBackend> backend(new BufferBackendNull());
+	g_BufferPool = shared_ptr<BufferPool>(new BufferPool(backend));
+	textureFactory = shared_ptr<TextureFactory>(new TextureFactory());
+	
+	run("ModelLoad", benchmarkModelLoad);
+	run("VertexBlend", benchmarkVertexBlend);
+	run("WorkingSet", benchmarkWorkingSet);
+	
+	textureFactory.reset();
+	g_BufferPool.reset();
+	
+	cout << (numMeasurements - numMisses) << " of " << numMeasurements
+	     << " measurements within their thresholds" << endl;
+	
+	return numMisses==0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,48 @@
+/*
+Stands in for src/TextureFactory.cpp in the tools, which have no graphics
+device and do not link OpenGL or DevIL.
+
+Textures are tracked by file name alone: loading one checks that the image
+exists and hands out a handle that names no texture object, so that models
+can be loaded, measured and cooked without decoding their images. Loading in
+the background and uploading decoded pixels need a graphics device, and are
+left out.
+*/
+
+#include "Core.h"
+#include "TextureFactory.h"
+#include "VirtualFileSystem.h"
+
+TextureFactory::Handle::~Handle() {
+	// No texture object was ever created
+}
+
+TextureFactory::TextureFactory()
+		: textures("Textures", 0) {}
+
+TextureFactory::~TextureFactory() {
+	textures.clear();
+}
+
+size_t TextureFactory::getTextureSize(int width, int height, int bytesPerPixel) {
+	// The mipmap chain adds a third to the size of the base level
+	return (size_t)width * height * bytesPerPixel * 4 / 3;
+}
+
+TextureFactory::HandlePtr
+TextureFactory::load(const FileName &fileName, bool repeat) {
+	HandlePtr handle = textures.find(fileName);
+	
+	if (handle) {
+		return handle;
+	}
+	
+	VERIFY(VirtualFileSystem::exists(fileName),
+	       "Texture file not found: " + fileName.str());
+	
+	return textures.insert(fileName, HandlePtr(new Handle(fileName, 0, repeat)), 0);
+}
+
+void TextureFactory::reload(const FileName &) {
+	// Nothing is held that could go stale
+}
@@ -0,0 +1,149 @@
+/*
+Converts the data files of the game to cooked binary files.
+
+Usage: Cooker [directory ...]
+
+Each directory (by default, "data") is searched recursively for XML files
+and models. Every file "foo.xml" is parsed and written out as "foo.bag"
+alongside it, and every model "bar.md3xml" (or .md2xml, or .objxml) is
+loaded from its source files and written out as "bar.model" (see
+ModelBinary). The game loads the cooked files in place of the sources from
+then on, and never writes them itself. Models are built without a graphics
+device, with textures tracked by name alone.
+*/
+
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "FileText.h"
+#include "PropertyBag.h"
+#include "PropertyBagBinary.h"
+#include "BufferPool.h"
+#include "ModelBinary.h"
+#include "ModelLoaderMD2.h"
+#include "ModelLoaderMD3.h"
+#include "ModelLoaderOBJ.h"
+
+/** Buffer pool that the meshes of the cooked models are built in */
+shared_ptr<BufferPool> g_BufferPool;
+
+/** Loaders of the model formats, by the extension of the descriptor */
+typedef map<string, shared_ptr<ModelLoader> > ModelLoaders;
+
+/**
+Cooks a single XML file
+@param fileName XML file to cook
+@return true if successful
+*/
+static bool cookBag(const FileName &fileName) {
+	const FileName cookedFileName = PropertyBagBinary::getCookedFileName(fileName);
+	
+	// Always parse the XML, even if there is an existing cooked file
+	const PropertyBag bag(FileText::readFile(fileName));
+	
+	if (!PropertyBagBinary::saveToFile(bag, cookedFileName)) {
+		return false;
+	}
+	
+	// Read the cooked file back to be certain that nothing was lost
+	PropertyBag cooked;
+	
+	if (!PropertyBagBinary::loadFromFile(cookedFileName, cooked) ||
+	    !(cooked == bag)) {
+		ERR("Cooked file does not match the source: " + cookedFileName.str());
+		return false;
+	}
+	
+	return true;
+}
+
+/**
+Cooks a single model
+@param fileName Descriptor of the model
+@param loader Loader of the model's format
+@param textureFactory Tracks the textures of the model by name
+@return true if successful
+*/
+static bool cookModel(const FileName &fileName,
+                      const ModelLoader &loader,
+                      TextureFactory &textureFactory) {
+	// Always load the source files, even if there is an existing cooked file
+	if (!loader.cook(fileName, textureFactory)) {
+		return false;
+	}
+	
+	// Read the cooked file back to be certain that it loads
+	const FileName cookedFileName = ModelBinary::getCookedFileName(fileName);
+	shared_ptr<AnimationController> cooked(ModelBinary::loadFromFile(cookedFileName,
+	                                                                 textureFactory));
+	
+	if (!cooked) {
+		ERR("Cooked model does not load: " + cookedFileName.str());
+		return false;
+	}
+	
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	vector<string> directories;
+	
+	for (int i=1; i<argc; ++i) {
+		directories.push_back(argv[i]);
+	}
+	
+	if (directories.empty()) {
+		directories.push_back("data");
+	}
+	
+	shared_ptr<BufferBackend> backend(new BufferBackendNull());
+	g_BufferPool = shared_ptr<BufferPool>(new BufferPool(backend));
+	shared_ptr<TextureFactory> textureFactory(new TextureFactory());
+	
+	ModelLoaders loaders;
+	loaders[".md2xml"] = shared_ptr<ModelLoader>(new ModelLoaderMD2());
+	loaders[".md3xml"] = shared_ptr<ModelLoader>(new ModelLoaderMD3());
+	loaders[".objxml"] = shared_ptr<ModelLoader>(new ModelLoaderOBJ());
+	
+	vector<FileName> files;
+	
+	for (vector<string>::const_iterator i = directories.begin();
+	     i != directories.end(); ++i) {
+		vector<string> found;
+		findFilesOnDisk(FileName(*i), found);
+		
+		for (vector<string>::const_iterator j = found.begin();
+		     j != found.end(); ++j) {
+			const string extension = FileName::getExtension(*j);
+			
+			if (extension == ".xml" || loaders.find(extension) != loaders.end()) {
+				files.push_back(FileName(*i + "/" + *j));
+			}
+		}
+	}
+	
+	size_t failures = 0;
+	
+	for (vector<FileName>::const_iterator i = files.begin();
+	     i != files.end(); ++i) {
+		ModelLoaders::const_iterator loader = loaders.find(i->getExtension());
+		
+		const bool cooked = (loader == loaders.end())
+		                    ? cookBag(*i)
+		                    : cookModel(*i, *loader->second, *textureFactory);
+		                    
+		if (cooked) {
+			cout << "Cooked " << i->str() << endl;
+		} else {
+			cout << "FAILED " << i->str() << endl;
+			failures++;
+		}
+	}
+	
+	cout << "Cooked " << (files.size() - failures) << " of "
+	     << files.size() << " files" << endl;
+	
+	textureFactory.reset();
+	g_BufferPool.reset();
+	
+	return failures==0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
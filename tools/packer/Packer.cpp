@@ -0,0 +1,162 @@
+/*
+Packs the data files of the game into a single pack file.
+
+Usage: Packer [pack file [directory]]
+
+Every file under the directory (by default, "data") is written to the pack
+file (by default, "data.pak") with its path relative to the directory. The
+game mounts "data.pak" at "data" on start-up, and reads from the archive in
+place of the loose files from then on.
+
+Once the archive is written, every file is read back from it and compared
+with the loose copy. The time taken to read all of the files both ways is
+reported, as a comparison of the two layouts. For a cold-start comparison,
+flush the operating system's file cache before running the tool with
+"-benchmark", which skips packing and only times the reads.
+*/
+
+#include "Core.h"
+#include "File.h"
+#include "FileMapping.h"
+#include "PackFile.h"
+#include "VirtualFileSystem.h"
+
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+
+/** Orders files by their paths within the archive */
+static bool comparePaths(const PackFile::Source &a, const PackFile::Source &b) {
+	return a.path < b.path;
+}
+
+/** Gets the wall clock time, in milliseconds */
+static double getMilliseconds() {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+	struct timeval now;
+	gettimeofday(&now, 0);
+	return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+#endif
+}
+
+/**
+Reads every file, touching every byte, as loading them would
+@param directory Directory that the files were found in
+@param sources Files to read
+@param checksum Returns a checksum of the contents of all files
+@return Time taken, in milliseconds
+*/
+static double readAll(const string &directory,
+                      const vector<PackFile::Source> &sources,
+                      U32 &checksum) {
+	const double start = getMilliseconds();
+	checksum = 0;
+	
+	for (vector<PackFile::Source>::const_iterator i = sources.begin();
+	     i != sources.end(); ++i) {
+		const FileMapping file(FileName(directory + "/" + i->path));
+		
+		for (size_t j=0; j<file.getSize(); ++j) {
+			checksum = checksum * 31 + file.getData()[j];
+		}
+	}
+	
+	return getMilliseconds() - start;
+}
+
+/**
+Checks that every file in the archive matches its loose copy
+@param packFileName Pack file, which must not be mounted
+@param sources Files that were packed
+@return true if all files match
+*/
+static bool verify(const FileName &packFileName,
+                   const vector<PackFile::Source> &sources) {
+	PackFile pack;
+	
+	if (!pack.open(packFileName)) {
+		return false;
+	}
+	
+	bool ok = pack.getNumFiles() == sources.size();
+	
+	for (vector<PackFile::Source>::const_iterator i = sources.begin();
+	     ok && i != sources.end(); ++i) {
+		const FileMapping loose(i->fileName);
+		const U8 *data = 0;
+		size_t size = 0;
+		
+		ok = loose.isOpen() &&
+		     pack.find(i->path, data, size) &&
+		     size == loose.getSize() &&
+		     (size == 0 || memcmp(data, loose.getData(), size) == 0);
+		
+		if (!ok) {
+			ERR("Packed file does not match the source: " + i->fileName.str());
+		}
+	}
+	
+	return ok;
+}
+
+int main(int argc, char *argv[]) {
+	bool benchmarkOnly = false;
+	vector<string> args;
+	
+	for (int i=1; i<argc; ++i) {
+		if (string(argv[i]) == "-benchmark") {
+			benchmarkOnly = true;
+		} else {
+			args.push_back(argv[i]);
+		}
+	}
+	
+	const FileName packFileName(args.size() > 0 ? args[0] : "data.pak");
+	const string directory = FileName::fix(args.size() > 1 ? args[1] : "data");
+	
+	vector<string> files;
+	findFilesOnDisk(FileName(directory), files);
+	
+	vector<PackFile::Source> sources;
+	
+	for (vector<string>::const_iterator i = files.begin(); i != files.end(); ++i) {
+		PackFile::Source source;
+		source.path = *i;
+		source.fileName = FileName(directory + "/" + *i);
+		sources.push_back(source);
+	}
+	
+	// Directory order varies, so sort to make the archive reproducible
+	sort(sources.begin(), sources.end(), comparePaths);
+	
+	if (!benchmarkOnly) {
+		if (!PackFile::saveToFile(packFileName, sources) ||
+		    !verify(packFileName, sources)) {
+			cout << "FAILED to pack " << directory << endl;
+			return EXIT_FAILURE;
+		}
+		
+		cout << "Packed " << sources.size() << " files into "
+		     << packFileName.str() << endl;
+	}
+	
+	U32 looseChecksum = 0, packedChecksum = 0;
+	const double looseTime = readAll(directory, sources, looseChecksum);
+	
+	if (!VirtualFileSystem::mount(packFileName, FileName(directory))) {
+		return EXIT_FAILURE;
+	}
+	
+	const double packedTime = readAll(directory, sources, packedChecksum);
+	
+	cout << "Read " << sources.size() << " loose files in "
+	     << looseTime << "ms, packed files in " << packedTime << "ms" << endl;
+	cout << File::getStatistics().toString() << endl;
+	
+	return looseChecksum==packedChecksum ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,25 @@
+#ifndef TEST_H
+#define TEST_H
+
+/**
+Records the outcome of a single check. Failures are reported on the console
+and counted, and the test program fails if any check failed.
+@param passed Outcome of the check
+@param expression Text of the expression that was checked
+@param file Source file containing the check
+@param line Line number of the check
+@return passed
+*/
+bool checkResult(bool passed, const char *expression, const char *file, int line);
+
+/** Checks that a condition holds */
+#define CHECK(condition) checkResult((condition) ? true : false, #condition, __FILE__, __LINE__)
+
+// Test suites, one for each source file in this directory
+void testBounds();
+void testBufferPool();
+void testComponentDataSet();
+void testMeshBuilder();
+void testModelLoaderMD3();
+
+#endif
@@ -0,0 +1,175 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "ModelLoaderMD3.h"
+#include "ModelBinary.h"
+#include "Test.h"
+
+/** Shipped models whose bounds are checked */
+static const char *MODELS[] = {
+	"data/models/cylinder/cylinder.md3xml",
+	"data/models/hero-green/hero-green.md3xml"
+};
+
+/**
+Cooked file written and read back by the test, in the working directory
+rather than alongside the models
+*/
+static const char COOKED_FILE_NAME[] = "test-bounds.model";
+
+/** Largest difference allowed between bounds computed alike */
+static const float EPSILON = 0.001f;
+
+/** Determines whether two vectors are within EPSILON of one another */
+static bool isClose(const vec3 &a, const vec3 &b) {
+	return fabsf(a.x - b.x) <= EPSILON &&
+	       fabsf(a.y - b.y) <= EPSILON &&
+	       fabsf(a.z - b.z) <= EPSILON;
+}
+
+/** Determines whether two bounds are the same, within EPSILON */
+static bool isSame(const BoundingVolume &a, const BoundingVolume &b) {
+	return a.isEmpty() == b.isEmpty() &&
+	       isClose(a.getMinimum(), b.getMinimum()) &&
+	       isClose(a.getMaximum(), b.getMaximum()) &&
+	       isClose(a.getSphereCenter(), b.getSphereCenter()) &&
+	       fabsf(a.getSphereRadius() - b.getSphereRadius()) <= EPSILON &&
+	       fabsf(a.getRadius() - b.getRadius()) <= EPSILON &&
+	       fabsf(a.getCylindricalRadius() - b.getCylindricalRadius()) <= EPSILON;
+}
+
+/**
+Determines whether bounds enclose the whole of other bounds: the box, the
+bounding sphere and the radii. The corners of a box need not lie within its
+own sphere, so the boxes and spheres are compared apart.
+*/
+static bool encloses(const BoundingVolume &outer, const BoundingVolume &inner) {
+	const vec3 &a = outer.getMinimum(), &b = outer.getMaximum();
+	const vec3 &c = inner.getMinimum(), &d = inner.getMaximum();
+	
+	return a.x <= c.x + EPSILON && a.y <= c.y + EPSILON && a.z <= c.z + EPSILON &&
+	       b.x + EPSILON >= d.x && b.y + EPSILON >= d.y && b.z + EPSILON >= d.z &&
+	       outer.getSphereCenter().distance(inner.getSphereCenter()) + inner.getSphereRadius()
+	       <= outer.getSphereRadius() + EPSILON &&
+	       outer.getRadius() + EPSILON >= inner.getRadius() &&
+	       outer.getCylindricalRadius() + EPSILON >= inner.getCylindricalRadius();
+}
+
+/** Computes the bounds of a mesh from its vertices */
+static BoundingVolume computeBounds(const Mesh &mesh) {
+	const vec3 *vertices = (const vec3*)mesh.vertexArray->read_lock();
+	const BoundingVolume bounds(vertices, mesh.vertexArray->getNumber());
+	mesh.vertexArray->unlock();
+	return bounds;
+}
+
+/** Checks bounds computed from a handful of points */
+static void testPoints() {
+	const vec3 points[] = {
+		vec3(-1.0f, 2.0f, 0.0f),
+		vec3(3.0f, -2.0f, 1.0f),
+		vec3(0.0f, 0.0f, 4.0f)
+	};
+	const int count = sizeof(points)/sizeof(points[0]);
+	
+	const BoundingVolume bounds(points, count);
+	CHECK(!bounds.isEmpty());
+	CHECK(bounds.isValid());
+	CHECK(isClose(bounds.getMinimum(), vec3(-1.0f, -2.0f, 0.0f)));
+	CHECK(isClose(bounds.getMaximum(), vec3(3.0f, 2.0f, 4.0f)));
+	CHECK(fabsf(bounds.getHeight() - 4.0f) <= EPSILON);
+	CHECK(fabsf(bounds.getRadius() - 4.0f) <= EPSILON);
+	
+	for (int i=0; i<count; ++i) {
+		CHECK(bounds.encloses(points[i]));
+		CHECK(bounds.getSphereCenter().distance(points[i]) <=
+		      bounds.getSphereRadius() + EPSILON);
+	}
+	
+	CHECK(!bounds.encloses(vec3(0.0f, 0.0f, 5.0f)));
+	
+	// Empty bounds take on whatever they are merged with
+	BoundingVolume merged;
+	CHECK(merged.isEmpty());
+	merged.merge(bounds);
+	CHECK(isSame(merged, bounds));
+	
+	const vec3 far(10.0f, 10.0f, 10.0f);
+	merged.merge(BoundingVolume(&far, 1));
+	CHECK(encloses(merged, bounds));
+	CHECK(merged.encloses(far));
+}
+
+/**
+Checks that the bounds of every key frame of a model are those of its
+vertices, and that each animation's bounds enclose its key frames
+*/
+static void checkModel(const AnimationController &model) {
+	for (size_t i=0; i<model.getNumAnimations(); ++i) {
+		const AnimationSequence &animation = model.getAnimation(i);
+		const vector<KeyFrame> &keyFrames = animation.getKeyFrames();
+		
+		CHECK(animation.getBounds().isValid());
+		
+		for (size_t j=0; j<keyFrames.size(); ++j) {
+			const MeshSet &meshes = keyFrames[j].getMeshes();
+			
+			for (size_t k=0; k<meshes.size(); ++k) {
+				CHECK(isSame(meshes[k]->getBounds(), computeBounds(*meshes[k])));
+			}
+			
+			CHECK(encloses(animation.getBounds(), keyFrames[j].getBounds()));
+		}
+	}
+}
+
+/**
+Checks the bounds of the shipped models as loaded from their sources, and
+that cooking them keeps the bounds of every key frame
+*/
+static void testShippedModels() {
+	TextureFactory textureFactory;
+	ModelLoaderMD3 loader;
+	
+	for (size_t i=0; i<sizeof(MODELS)/sizeof(MODELS[0]); ++i) {
+		const FileName fileName(MODELS[i]);
+		shared_ptr<AnimationController> model(loader.loadFromSource(fileName, textureFactory));
+		
+		if (!CHECK(model)) {
+			continue;
+		}
+		
+		checkModel(*model);
+		
+		// Models stand on the ground plane
+		CHECK(model->getBounds().getHeightBelowGround() >= -EPSILON);
+		CHECK(model->getBounds().getHeight() > 0.0f);
+		
+		const FileName cookedFileName(COOKED_FILE_NAME);
+		
+		if (!CHECK(ModelBinary::saveToFile(*model, cookedFileName))) {
+			continue;
+		}
+		
+		shared_ptr<AnimationController> cooked(ModelBinary::loadFromFile(cookedFileName,
+		                                                                 textureFactory));
+		remove(COOKED_FILE_NAME);
+		
+		if (!CHECK(cooked)) {
+			continue;
+		}
+		
+		checkModel(*cooked);
+		
+		CHECK(cooked->getNumAnimations() == model->getNumAnimations());
+		
+		for (size_t j=0; j<model->getNumAnimations() && j<cooked->getNumAnimations(); ++j) {
+			CHECK(isSame(cooked->getAnimation(j).getBounds(),
+			             model->getAnimation(j).getBounds()));
+		}
+	}
+}
+
+void testBounds() {
+	testPoints();
+	testShippedModels();
+}
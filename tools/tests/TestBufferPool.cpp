@@ -0,0 +1,293 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "BufferPool.h"
+#include "Test.h"
+
+/**
+Backend that keeps track of the buffer objects the pool would create on the
+graphics device, and checks that every write lands inside one of them
+*/
+class MockBufferBackend : public BufferBackend {
+public:
+	/** Sizes of the live buffer objects, by name */
+	map<GLuint, size_t> buffers;
+	
+	/** Calls made to the backend */
+	size_t creates, destroys, uploads, orphans, binds;
+	
+	/** Calls naming no live buffer object, or writing past the end of one */
+	size_t badWrites;
+	
+	MockBufferBackend()
+			: creates(0),
+			destroys(0),
+			uploads(0),
+			orphans(0),
+			binds(0),
+			badWrites(0),
+			nextHandle(1) {}
+	
+	virtual GLuint create(GLenum, size_t size, GLenum) {
+		creates++;
+		buffers[nextHandle] = size;
+		return nextHandle++;
+	}
+	
+	virtual void destroy(GLuint handle) {
+		destroys++;
+		
+		if (buffers.erase(handle) == 0) {
+			badWrites++;
+		}
+	}
+	
+	virtual void upload(GLenum,
+	                    GLuint handle,
+	                    size_t offset,
+	                    size_t size,
+	                    const void *) {
+		uploads++;
+		
+		map<GLuint, size_t>::const_iterator i = buffers.find(handle);
+		
+		if (i == buffers.end() || offset + size > i->second) {
+			badWrites++;
+		}
+	}
+	
+	virtual void orphan(GLenum, GLuint handle, size_t size, GLenum) {
+		orphans++;
+		
+		if (buffers.find(handle) == buffers.end()) {
+			badWrites++;
+		} else {
+			buffers[handle] = size;
+		}
+	}
+	
+	virtual void bind(GLenum, GLuint handle) {
+		binds++;
+		
+		if (buffers.find(handle) == buffers.end()) {
+			badWrites++;
+		}
+	}
+
+private:
+	GLuint nextHandle;
+};
+
+/** Size of the pages of the pools under test */
+static const size_t PAGE_SIZE = 1024;
+
+/** Initial size of the ring buffers of the pools under test */
+static const size_t RING_SIZE = 256;
+
+/** Contents written by the tests; only its size matters */
+static const char data[2*PAGE_SIZE] = {0};
+
+static void testRangeAllocator() {
+	RangeAllocator allocator(1024, 16);
+	
+	// Sizes are rounded up to the granularity
+	const size_t tiny = allocator.allocate(1);
+	CHECK(allocator.getSize(tiny) == 16);
+	allocator.free(tiny);
+	CHECK(allocator.isEmpty());
+	
+	const size_t a = allocator.allocate(256);
+	const size_t b = allocator.allocate(256);
+	const size_t c = allocator.allocate(256);
+	CHECK(allocator.getOffset(a) == 0);
+	CHECK(allocator.getOffset(b) == 256);
+	CHECK(allocator.getOffset(c) == 512);
+	CHECK(allocator.allocate(512) == RangeAllocator::NONE);
+	
+	// Freeing the middle range leaves a hole apart from the free tail
+	allocator.free(b);
+	RangeAllocatorStatistics statistics = allocator.getStatistics();
+	CHECK(statistics.numFreeRanges == 2);
+	CHECK(statistics.largestFreeRange == 256);
+	CHECK(statistics.getFragmentation() > 0.0f);
+	
+	// Freeing its neighbour merges the two into one range
+	allocator.free(a);
+	statistics = allocator.getStatistics();
+	CHECK(statistics.numFreeRanges == 2);
+	CHECK(statistics.largestFreeRange == 512);
+	
+	const size_t d = allocator.allocate(512);
+	CHECK(d != RangeAllocator::NONE);
+	CHECK(allocator.getOffset(d) == 0);
+	
+	// Freeing everything merges back into the whole span
+	allocator.free(c);
+	allocator.free(d);
+	statistics = allocator.getStatistics();
+	CHECK(allocator.isEmpty());
+	CHECK(statistics.used == 0);
+	CHECK(statistics.numFreeRanges == 1);
+	CHECK(statistics.largestFreeRange == 1024);
+	CHECK(statistics.getFragmentation() == 0.0f);
+	
+	// The whole span can be had in one piece
+	const size_t all = allocator.allocate(1024);
+	CHECK(all != RangeAllocator::NONE);
+	CHECK(allocator.getStatistics().numFreeRanges == 0);
+	allocator.free(all);
+	
+	// Many small ranges freed in a scrambled order leave no fragments
+	vector<size_t> ranges;
+	
+	for (size_t i=0; i<64; ++i) {
+		ranges.push_back(allocator.allocate(16));
+	}
+	
+	CHECK(allocator.allocate(16) == RangeAllocator::NONE);
+	
+	for (size_t i=0; i<ranges.size(); ++i) {
+		allocator.free(ranges[(i*37) % ranges.size()]);
+	}
+	
+	statistics = allocator.getStatistics();
+	CHECK(statistics.numFreeRanges == 1);
+	CHECK(statistics.largestFreeRange == 1024);
+}
+
+static void testRing() {
+	shared_ptr<MockBufferBackend> backend(new MockBufferBackend());
+	BufferPool pool(backend, PAGE_SIZE, RING_SIZE);
+	
+	// Streamed ranges follow one another through the ring
+	const BufferRange a = pool.stream(GL_ARRAY_BUFFER, 100, data);
+	const BufferRange b = pool.stream(GL_ARRAY_BUFFER, 100, data);
+	CHECK(!a.page && !b.page);
+	CHECK(a.handle == b.handle);
+	CHECK(a.offset == 0);
+	CHECK(b.offset == 112);
+	CHECK(pool.isCurrent(a));
+	CHECK(backend->buffers[a.handle] == RING_SIZE);
+	
+	// Starting a frame reuses the ring from the start, with fresh storage
+	pool.beginFrame();
+	CHECK(!pool.isCurrent(a));
+	CHECK(backend->orphans == 1);
+	
+	const BufferRange c = pool.stream(GL_ARRAY_BUFFER, 100, data);
+	CHECK(c.handle == a.handle);
+	CHECK(c.offset == 0);
+	CHECK(pool.isCurrent(c));
+	
+	// An idle ring is left alone
+	pool.beginFrame();
+	pool.beginFrame();
+	CHECK(backend->orphans == 2);
+	
+	// Rings are kept apart by target
+	const BufferRange d = pool.stream(GL_ELEMENT_ARRAY_BUFFER, 100, data);
+	CHECK(d.handle != a.handle);
+	CHECK(d.offset == 0);
+	
+	CHECK(pool.getStatistics().streamOverflows == 0);
+	CHECK(backend->badWrites == 0);
+}
+
+static void testRingOverflow() {
+	shared_ptr<MockBufferBackend> backend(new MockBufferBackend());
+	BufferPool pool(backend, PAGE_SIZE, RING_SIZE);
+	
+	const BufferRange a = pool.stream(GL_ARRAY_BUFFER, 200, data);
+	CHECK(!a.page);
+	
+	// Too little room remains, and the ring cannot start over mid-frame, so
+	// the data spills into a dynamic page
+	BufferRange b = pool.stream(GL_ARRAY_BUFFER, 200, data);
+	CHECK(b.page);
+	CHECK(b.handle != a.handle);
+	CHECK(pool.isCurrent(b));
+	CHECK(pool.getStatistics().streamOverflows == 1);
+	CHECK(pool.getStatistics().pages == 1);
+	pool.free(b);
+	CHECK(!b.page && b.handle == 0);
+	
+	// The next frame gets a ring large enough for everything streamed
+	pool.beginFrame();
+	const BufferRange c = pool.stream(GL_ARRAY_BUFFER, 200, data);
+	const BufferRange d = pool.stream(GL_ARRAY_BUFFER, 200, data);
+	CHECK(!c.page && !d.page);
+	CHECK(c.handle == d.handle);
+	CHECK(c.offset == 0);
+	CHECK(backend->buffers[c.handle] == 2*RING_SIZE);
+	CHECK(backend->buffers.find(a.handle) == backend->buffers.end());
+	CHECK(pool.getStatistics().streamOverflows == 1);
+	CHECK(pool.getStatistics().bytesStreamed == 400);
+	
+	CHECK(backend->badWrites == 0);
+}
+
+static void testPages() {
+	shared_ptr<MockBufferBackend> backend(new MockBufferBackend());
+	
+	{
+		BufferPool pool(backend, PAGE_SIZE, RING_SIZE);
+		
+		// Ranges share a page until it is full
+		BufferRange a = pool.allocate(GL_ARRAY_BUFFER, STATIC_DRAW, 600);
+		BufferRange b = pool.allocate(GL_ARRAY_BUFFER, STATIC_DRAW, 400);
+		BufferRange c = pool.allocate(GL_ARRAY_BUFFER, STATIC_DRAW, 400);
+		CHECK(a.handle == b.handle);
+		CHECK(b.offset == 608);
+		CHECK(c.handle != a.handle);
+		
+		// Static and dynamic ranges never share a page
+		BufferRange d = pool.allocate(GL_ARRAY_BUFFER, DYNAMIC_DRAW, 16);
+		CHECK(d.handle != a.handle && d.handle != c.handle);
+		
+		pool.upload(GL_ARRAY_BUFFER, b, 0, 400, data);
+		pool.bind(GL_ARRAY_BUFFER, b);
+		CHECK(backend->binds == 1);
+		CHECK(pool.getStatistics().uploads == 1);
+		CHECK(pool.getStatistics().bytesUploaded == 400);
+		CHECK(pool.getStatistics().pages == 3);
+		
+		// Ranges too large for a page get buffer objects of their own,
+		// which go away with the range
+		BufferRange e = pool.allocate(GL_ARRAY_BUFFER, STATIC_DRAW, 2*PAGE_SIZE);
+		CHECK(e.page);
+		CHECK(backend->buffers[e.handle] == 2*PAGE_SIZE);
+		CHECK(pool.getStatistics().dedicated == 1);
+		CHECK(pool.getStatistics().pages == 3);
+		const GLuint dedicated = e.handle;
+		pool.free(e);
+		CHECK(backend->buffers.find(dedicated) == backend->buffers.end());
+		
+		// Trimming releases only the pages left empty
+		const GLuint emptied = c.handle;
+		pool.free(a);
+		pool.free(c);
+		pool.free(d);
+		pool.trim();
+		CHECK(pool.getStatistics().pages == 1);
+		CHECK(backend->buffers.find(emptied) == backend->buffers.end());
+		
+		// Freed space is handed out again
+		BufferRange f = pool.allocate(GL_ARRAY_BUFFER, STATIC_DRAW, 600);
+		CHECK(f.handle == b.handle);
+		CHECK(f.offset == 0);
+		
+		pool.free(b);
+		pool.free(f);
+	}
+	
+	// Nothing outlives the pool and its ranges
+	CHECK(backend->buffers.empty());
+	CHECK(backend->creates == backend->destroys);
+	CHECK(backend->badWrites == 0);
+}
+
+void testBufferPool() {
+	testRangeAllocator();
+	testRing();
+	testRingOverflow();
+	testPages();
+}
@@ -0,0 +1,88 @@
+#include "Core.h"
+#include "ComponentDataSet.h"
+#include "Test.h"
+
+/** Data of a component type that only exists in this test */
+struct TestComponentData {
+	TestComponentData() : value(0) {}
+	int value;
+};
+
+/** Registers a schema for "TestSchema", but none for "TestNoSchema" */
+static void registerTestSchema() {
+	typedef ComponentSchemaOf<TestComponentData> Schema;
+	shared_ptr<Schema> schema(new Schema("TestSchema"));
+	schema->field("value", &TestComponentData::value);
+	ComponentSchema::registerSchema(schema);
+}
+
+/** Parses a set of components from the body of a "components" tag */
+static ComponentDataSet parse(const string &components) {
+	return ComponentDataSet::parse(PropertyBag(components));
+}
+
+/** Finds the entry for a component in a set */
+static const ComponentDataSet::Entry* find(const ComponentDataSet &set,
+                                           const string &name) {
+	for (ComponentDataSet::const_iterator i = set.begin(); i != set.end(); ++i) {
+		if (i->name == name) {
+			return &(*i);
+		}
+	}
+	
+	return 0;
+}
+
+void testComponentDataSet() {
+	registerTestSchema();
+	
+	ComponentDataSet base = parse(
+	  "<component><name>TestSchema</name><value>1</value></component>"
+	  "<component><name>TestNoSchema</name><value>1</value></component>"
+	  "<component><name>TestUnchanged</name><value>1</value></component>");
+	  
+	vector<string> errors;
+	base.compile(errors);
+	CHECK(errors.empty());
+	
+	const ComponentDataSet sp = parse(
+	  "<component><name>TestSchema</name><value>2</value></component>"
+	  "<component><name>TestNoSchema</name><value>3</value></component>"
+	  "<component><name>TestNotInBase</name><value>4</value></component>");
+	  
+	const ComponentDataSet merged = ComponentDataSet::merge(base, sp);
+	CHECK(merged.size() == 3);
+	
+	// A component with a schema is compiled again from the merged data
+	const ComponentDataSet::Entry *schema = find(merged, "TestSchema");
+	
+	if (CHECK(schema && schema->compiled)) {
+		CHECK(schema->compiled->get<TestComponentData>().value == 2);
+		CHECK(schema->data.getInt("value") == 2);
+	}
+	
+	// A component without a schema keeps the value it was specialized with
+	const ComponentDataSet::Entry *noSchema = find(merged, "TestNoSchema");
+	
+	if (CHECK(noSchema != 0)) {
+		CHECK(!noSchema->compiled);
+		CHECK(noSchema->data.getInt("value") == 3);
+	}
+	
+	// Components that were not specialized are passed through unchanged
+	const ComponentDataSet::Entry *unchanged = find(merged, "TestUnchanged");
+	
+	if (CHECK(unchanged != 0)) {
+		CHECK(unchanged->data.getInt("value") == 1);
+	}
+	
+	// Specializing a set that was never compiled still applies the overrides
+	const ComponentDataSet uncompiled = ComponentDataSet::merge(
+	  parse("<component><name>TestNoSchema</name><value>1</value></component>"),
+	  sp);
+	const ComponentDataSet::Entry *entry = find(uncompiled, "TestNoSchema");
+	
+	if (CHECK(entry != 0)) {
+		CHECK(entry->data.getInt("value") == 3);
+	}
+}
@@ -0,0 +1,140 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "MeshBuilder.h"
+#include "Test.h"
+
+/** Number of quads along each side of the test grid */
+static const int GRID_SIZE = 32;
+
+/** Highest acceptable ACMR of the grid once its faces are reordered */
+static const float MAX_ACMR_AFTER = 0.8f;
+
+/** Gets the index of a point of the grid */
+static int getGridIndex(int x, int y) {
+	return y*(GRID_SIZE+1) + x;
+}
+
+/**
+Makes a grid of quads, with the triangles in a scrambled order so that the
+vertex cache is hit as little as it would be by a careless exporter
+@param vertices Receives a point for each corner of each quad
+@param faces Receives two triangles for each quad
+*/
+static void makeGrid(vector<vec3> &vertices, vector<Face> &faces) {
+	for (int y=0; y<=GRID_SIZE; ++y) {
+		for (int x=0; x<=GRID_SIZE; ++x) {
+			vertices.push_back(vec3((float)x, (float)y, 0.0f));
+		}
+	}
+	
+	for (int y=0; y<GRID_SIZE; ++y) {
+		for (int x=0; x<GRID_SIZE; ++x) {
+			const int corners[2][3] = {
+				{ getGridIndex(x, y), getGridIndex(x+1, y), getGridIndex(x+1, y+1) },
+				{ getGridIndex(x, y), getGridIndex(x+1, y+1), getGridIndex(x, y+1) }
+			};
+			
+			for (int i=0; i<2; ++i) {
+				Face face;
+				
+				for (int j=0; j<3; ++j) {
+					face.vertIndex[j] = corners[i][j];
+					face.normalIndex[j] = corners[i][j];
+					face.coordIndex[j] = corners[i][j];
+				}
+				
+				faces.push_back(face);
+			}
+		}
+	}
+	
+	// A fixed permutation, so that every run measures the same order
+	for (size_t i=faces.size()-1; i>0; --i) {
+		swap(faces[i], faces[(i*7919 + 17) % (i+1)]);
+	}
+}
+
+/**
+Gets the triangles of built geometry as sorted triples of points, so that
+geometry may be compared regardless of the order of vertices and faces
+*/
+static vector<vector<float> > getTriangles(const MeshBuilder &builder) {
+	const vector<index_t> &indices = builder.getIndices();
+	const vector<vec3> &vertices = builder.getVertices();
+	vector<vector<float> > triangles;
+	
+	for (size_t i=0; i+2<indices.size(); i+=3) {
+		vector<float> points;
+		
+		for (size_t j=0; j<3; ++j) {
+			const vec3 &v = vertices[indices[i+j]];
+			points.push_back(v.y * (GRID_SIZE+1) + v.x);
+		}
+		
+		// Rotate the smallest point first, which preserves the winding
+		rotate(points.begin(),
+		       min_element(points.begin(), points.end()),
+		       points.end());
+		triangles.push_back(points);
+	}
+	
+	sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+void testMeshBuilder() {
+	vector<vec3> vertices;
+	vector<Face> faces;
+	makeGrid(vertices, faces);
+	
+	const vector<vec3> normals(vertices.size(), vec3(0.0f, 0.0f, 1.0f));
+	const vector<vec2> texcoords(vertices.size(), vec2(0.0f, 0.0f));
+	const size_t numPoints = (GRID_SIZE+1)*(GRID_SIZE+1);
+	const float numTriangles = (float)faces.size();
+	
+	// Welding by index leaves one vertex for each point of the grid
+	MeshBuilder builder(vertices, normals, texcoords, vector<color>(),
+	                    faces, MeshBuilder::WELD_INDICES);
+	CHECK(builder.getVertices().size() == numPoints);
+	CHECK(builder.getIndices().size() == faces.size()*3);
+	
+	const vector<vector<float> > trianglesBefore = getTriangles(builder);
+	const float acmrBefore =
+	  MeshBuilder::countCacheMisses(builder.getIndices(),
+	                                builder.getVertices().size()) / numTriangles;
+	                                
+	builder.optimize();
+	
+	const float acmrAfter =
+	  MeshBuilder::countCacheMisses(builder.getIndices(),
+	                                builder.getVertices().size()) / numTriangles;
+	                                
+	cout << "MeshBuilder: " << faces.size()*3 << " corners welded into "
+	     << builder.getVertices().size() << " vertices, ACMR "
+	     << acmrBefore << " before and " << acmrAfter << " after reordering"
+	     << endl;
+	     
+	CHECK(acmrAfter < acmrBefore);
+	CHECK(acmrAfter <= MAX_ACMR_AFTER);
+	
+	// Reordering must neither lose triangles nor flip their winding
+	CHECK(getTriangles(builder) == trianglesBefore);
+	CHECK(builder.getVertices().size() == numPoints);
+	
+	// Welding by value joins corners that only have equal attributes
+	vector<vec3> duplicated;
+	vector<Face> separateFaces = faces;
+	
+	for (size_t i=0; i<separateFaces.size(); ++i) {
+		for (int j=0; j<3; ++j) {
+			duplicated.push_back(vertices[faces[i].vertIndex[j]]);
+			separateFaces[i].vertIndex[j] = (int)duplicated.size()-1;
+			separateFaces[i].normalIndex[j] = 0;
+			separateFaces[i].coordIndex[j] = 0;
+		}
+	}
+	
+	MeshBuilder byValue(duplicated, normals, texcoords, vector<color>(),
+	                    separateFaces, MeshBuilder::WELD_VALUES);
+	CHECK(byValue.getVertices().size() == numPoints);
+}
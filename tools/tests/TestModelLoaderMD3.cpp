@@ -0,0 +1,266 @@
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "BufferPool.h"
+#include "ModelLoaderMD3.h"
+#include "Test.h"
+
+extern shared_ptr<BufferPool> g_BufferPool;
+
+/** Directory of the shipped model that the loader is tested on */
+static const char MODEL_DIRECTORY[] = "data/models/hero-green/";
+
+/**
+Model written by the test alongside the shipped model, with the surfaces of
+both of its MD3 files in a single MD3 file
+*/
+static const char SURFACES_MODEL[] = "test-surfaces";
+
+/** Counts read from the headers of an MD3 file */
+struct MD3Counts {
+	/** Frames of animation, and surfaces and triangles over all surfaces */
+	int numFrames, numSurfaces, numTriangles;
+	
+	/** Bytes of the file before its surfaces, and of its surfaces */
+	string head, surfaces;
+};
+
+/** Reads the whole of a binary file */
+static string readFile(const string &fileName) {
+	string contents;
+	FILE *stream = fopen(fileName.c_str(), "rb");
+	
+	if (stream) {
+		char buffer[4096];
+		size_t count;
+		
+		while ((count = fread(buffer, 1, sizeof(buffer), stream)) > 0) {
+			contents.append(buffer, count);
+		}
+		
+		fclose(stream);
+	}
+	
+	return contents;
+}
+
+/** Writes the whole of a binary file */
+static void writeFile(const string &fileName, const string &contents) {
+	FILE *stream = fopen(fileName.c_str(), "wb");
+	fwrite(contents.data(), 1, contents.size(), stream);
+	fclose(stream);
+}
+
+/** Reads a little-endian 32-bit integer from a file's contents */
+static int readInt(const string &contents, size_t offset) {
+	const unsigned char *p = (const unsigned char*)contents.data() + offset;
+	return (int)(p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));
+}
+
+/** Writes a little-endian 32-bit integer into a file's contents */
+static void writeInt(string &contents, size_t offset, int value) {
+	for (int i=0; i<4; ++i) {
+		contents[offset + i] = (char)((value >> (i*8)) & 0xFF);
+	}
+}
+
+/** Offsets of the fields of the header of an MD3 file */
+enum {
+	HEADER_NUM_FRAMES = 76,
+	HEADER_NUM_SURFACES = 84,
+	HEADER_SURFACES = 100,
+	HEADER_END = 104
+};
+
+/** Offsets of the fields of the header of an MD3 surface */
+enum {
+	SURFACE_NUM_TRIANGLES = 84,
+	SURFACE_END = 104
+};
+
+/**
+Reads the counts of an MD3 file straight from its headers, apart from the
+loader, and its surfaces as bytes
+*/
+static MD3Counts readCounts(const string &fileName) {
+	MD3Counts counts;
+	const string contents = readFile(fileName);
+	
+	counts.numFrames = readInt(contents, HEADER_NUM_FRAMES);
+	counts.numSurfaces = readInt(contents, HEADER_NUM_SURFACES);
+	counts.numTriangles = 0;
+	
+	const size_t surfacesOffset = readInt(contents, HEADER_SURFACES);
+	size_t offset = surfacesOffset;
+	
+	for (int i=0; i<counts.numSurfaces; ++i) {
+		counts.numTriangles += readInt(contents, offset + SURFACE_NUM_TRIANGLES);
+		offset += readInt(contents, offset + SURFACE_END);
+	}
+	
+	counts.head = contents.substr(0, surfacesOffset);
+	counts.surfaces = contents.substr(surfacesOffset, offset - surfacesOffset);
+	
+	return counts;
+}
+
+/** Gets the mesh of the first key frame of a model */
+static const Mesh& getFirstMesh(const AnimationController &model) {
+	return *model.getAnimation(0).getKeyFrames()[0].getMeshes()[0];
+}
+
+/** Checks that the material ranges of a mesh cover its indices in order */
+static void checkRanges(const Mesh &mesh, size_t numRanges) {
+	CHECK(mesh.materialRanges.size() == numRanges);
+	
+	int next = 0;
+	
+	for (size_t i=0; i<mesh.materialRanges.size(); ++i) {
+		CHECK(mesh.materialRanges[i].firstIndex == next);
+		next += mesh.materialRanges[i].numIndices;
+	}
+	
+	CHECK(next == mesh.indexArray->getNumber());
+}
+
+/** Makes a mesh of a strip of triangles */
+static Mesh* makeStrip(int numTriangles) {
+	vector<vec3> vertices, normals;
+	vector<vec2> texCoords;
+	vector<Face> faces;
+	
+	for (int i=0; i<numTriangles+2; ++i) {
+		vertices.push_back(vec3((float)(i/2), (float)(i%2), 0.0f));
+		normals.push_back(vec3(0.0f, 0.0f, 1.0f));
+		texCoords.push_back(vec2(0.0f, 0.0f));
+	}
+	
+	for (int i=0; i<numTriangles; ++i) {
+		Face face;
+		
+		for (int j=0; j<3; ++j) {
+			face.vertIndex[j] = face.normalIndex[j] = face.coordIndex[j] = i + j;
+		}
+		
+		faces.push_back(face);
+	}
+	
+	return new Mesh(vertices, normals, texCoords, faces);
+}
+
+/**
+Appends several meshes at once, and checks that the combined buffers are
+created once rather than once for each mesh
+*/
+static void testAppend() {
+	shared_ptr<Mesh> mesh(makeStrip(1));
+	shared_ptr<Mesh> second(makeStrip(2));
+	shared_ptr<Mesh> third(makeStrip(3));
+	
+	const int firstVertices = mesh->vertexArray->getNumber();
+	const int secondVertices = second->vertexArray->getNumber();
+	const int numVertices = firstVertices + secondVertices
+	                        + third->vertexArray->getNumber();
+	
+	vector<const Mesh*> others;
+	others.push_back(second.get());
+	others.push_back(third.get());
+	
+	const size_t uploadsBefore = g_BufferPool->getStatistics().uploads;
+	mesh->append(others);
+	const size_t uploads = g_BufferPool->getStatistics().uploads - uploadsBefore;
+	
+	// Vertices, normals, tex-coords and indices; there are no colors
+	CHECK(uploads == 4);
+	CHECK(mesh->vertexArray->getNumber() == numVertices);
+	CHECK(mesh->normalArray->getNumber() == numVertices);
+	CHECK(mesh->texCoordArray->getNumber() == numVertices);
+	CHECK(mesh->indexArray->getNumber() == 3*(1+2+3));
+	checkRanges(*mesh, 3);
+	
+	// The indices of each mesh refer to its own vertices
+	const index_t *indices = (const index_t*)mesh->indexArray->read_lock();
+	const int secondRange = mesh->materialRanges[1].firstIndex;
+	const int thirdRange = mesh->materialRanges[2].firstIndex;
+	CHECK(*min_element(indices + secondRange, indices + thirdRange) == (index_t)firstVertices);
+	CHECK(*min_element(indices + thirdRange, indices + 3*(1+2+3)) ==
+	      (index_t)(firstVertices + secondVertices));
+	mesh->indexArray->unlock();
+}
+
+/**
+Loads the shipped model, whose two MD3 files each have a surface, and
+checks the meshes against the counts in the files' headers
+*/
+static void testShippedModel() {
+	const MD3Counts body = readCounts(string(MODEL_DIRECTORY) + "green.md3");
+	const MD3Counts sword = readCounts(string(MODEL_DIRECTORY) + "sword.md3");
+	
+	const FileName fileName(string(MODEL_DIRECTORY) + "hero-green.md3xml");
+	TextureFactory textureFactory;
+	ModelLoaderMD3 loader;
+	shared_ptr<AnimationController> model(loader.loadFromSource(fileName, textureFactory));
+	CHECK(model);
+	
+	if (!model) {
+		return;
+	}
+	
+	const Mesh &mesh = getFirstMesh(*model);
+	CHECK(body.numFrames == sword.numFrames);
+	CHECK(mesh.indexArray->getNumber() == 3*(body.numTriangles + sword.numTriangles));
+	checkRanges(mesh, body.numSurfaces + sword.numSurfaces);
+}
+
+/**
+Loads an MD3 file holding several surfaces, made up of the surfaces of the
+shipped model's two files, and checks that no surface is dropped
+*/
+static void testSurfaces() {
+	const MD3Counts body = readCounts(string(MODEL_DIRECTORY) + "green.md3");
+	const MD3Counts sword = readCounts(string(MODEL_DIRECTORY) + "sword.md3");
+	
+	string contents = body.head + body.surfaces + sword.surfaces;
+	writeInt(contents, HEADER_NUM_SURFACES, body.numSurfaces + sword.numSurfaces);
+	writeInt(contents, HEADER_END, (int)contents.size());
+	
+	const string md3 = string(MODEL_DIRECTORY) + SURFACES_MODEL + ".md3";
+	const string md3xml = string(MODEL_DIRECTORY) + SURFACES_MODEL + ".md3xml";
+	
+	writeFile(md3, contents);
+	writeFile(md3xml,
+	          string("<model><file>") + SURFACES_MODEL + ".md3</file>"
+	          "<skin>skin.tif</skin></model>"
+	          "<animation><name>idle</name><start>0</start><length>1</length>"
+	          "<fps>1.0</fps></animation>");
+	
+	TextureFactory textureFactory;
+	ModelLoaderMD3 loader;
+	shared_ptr<AnimationController> model(loader.loadFromSource(FileName(md3xml),
+	                                                            textureFactory));
+	
+	remove(md3.c_str());
+	remove(md3xml.c_str());
+	
+	CHECK(model);
+	
+	if (!model) {
+		return;
+	}
+	
+	const Mesh &mesh = getFirstMesh(*model);
+	CHECK(mesh.indexArray->getNumber() == 3*(body.numTriangles + sword.numTriangles));
+	checkRanges(mesh, body.numSurfaces + sword.numSurfaces);
+	
+	// Every key frame holds all of the surfaces
+	const vector<KeyFrame> &keyFrames = model->getAnimation(0).getKeyFrames();
+	
+	for (size_t i=0; i<keyFrames.size(); ++i) {
+		CHECK(keyFrames[i].getMeshes().size() == 1);
+	}
+}
+
+void testModelLoaderMD3() {
+	testAppend();
+	testShippedModel();
+	testSurfaces();
+}
@@ -0,0 +1,62 @@
+/*
+Runs the engine's headless tests.
+
+Usage: Tests
+
+Run from the directory holding "data". Each suite exercises one part of the
+engine without opening a window or a GL context; meshes are built in a
+buffer pool whose backend keeps no buffer objects. A check that fails is reported with its file and line, and the
+program exits with a failure status if any check failed.
+*/
+
+#include "Core.h"
+#include "gl_wrapper.h"
+#include "BufferPool.h"
+#include "Test.h"
+
+/** Buffer pool that the meshes under test are built in */
+shared_ptr<BufferPool> g_BufferPool;
+
+static size_t numChecks = 0;
+static size_t numFailures = 0;
+
+bool checkResult(bool passed, const char *expression, const char *file, int line) {
+	numChecks++;
+	
+	if (!passed) {
+		numFailures++;
+		cout << file << "(" << line << "): FAILED " << expression << endl;
+	}
+	
+	return passed;
+}
+
+/**
+Runs a test suite and reports the checks that it failed
+@param name Name of the suite
+@param suite Function running the suite
+*/
+static void run(const string &name, void (*suite)()) {
+	const size_t failuresBefore = numFailures;
+	suite();
+	cout << (numFailures == failuresBefore ? "passed " : "FAILED ")
+	     << name << endl;
+}
+
+int main(int, char *[]) {
+	shared_ptr<BufferBackend> backend(new BufferBackendNull());
+	g_BufferPool = shared_ptr<BufferPool>(new BufferPool(backend));
+	
+	run("Bounds", testBounds);
+	run("BufferPool", testBufferPool);
+	run("ComponentDataSet", testComponentDataSet);
+	run("MeshBuilder", testMeshBuilder);
+	run("ModelLoaderMD3", testModelLoaderMD3);
+	
+	g_BufferPool.reset();
+	
+	cout << (numChecks - numFailures) << " of " << numChecks
+	     << " checks passed" << endl;
+	     
+	return numFailures==0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}